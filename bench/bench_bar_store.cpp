@@ -0,0 +1,83 @@
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "bar_store.h"
+#include "indicators.h"
+#include "symbol_table.h"
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+namespace {
+    const unsigned DAYS = 30;
+    const int64_t MINUTE = 60LL * 1000000000LL;
+    const char* const SYMBOLS[] = {"BTC/USD", "ETH/USD", "SOL/USD", "LTC/USD"};
+
+    double millisSince(std::chrono::steady_clock::time_point start) {
+        return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+// Writes DAYS of one-minute bars per symbol, then times the start-up path:
+// mapping the last DAYS days and running every bar (as CompactBar) and
+// every close column (through batch::sma) past the caller.
+int main(int argc, char* argv[]) {
+    const std::string root = argc > 1 ? argv[1] : "/tmp/bench_bar_store";
+    std::filesystem::remove_all(root);
+
+    SymbolTable& table = SymbolTable::get_instance();
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    const int64_t first = bar_store::dayStart(now) - static_cast<int64_t>(DAYS - 1) * bar_store::NS_PER_DAY;
+
+    auto start = std::chrono::steady_clock::now();
+    size_t written = 0;
+    {
+        BarStoreWriter writer(root);
+        for (const char* symbol : SYMBOLS) {
+            const uint32_t id = table.intern(symbol);
+            int64_t price = 6000000000000;
+            for (int64_t t = first; t <= now; t += MINUTE, ++written) {
+                price += (t / MINUTE) % 7 - 3;
+                writer.append(CompactBar{t, price, price + 5, price - 5, price, 100000000, price, id, 12});
+            }
+        }
+    }
+    cout << "Wrote " << written << " bars in " << millisSince(start) << " ms" << endl;
+
+    start = std::chrono::steady_clock::now();
+    BarStoreReader reader(root);
+    size_t bars = 0;
+    int64_t checksum = 0;
+    for (const char* symbol : SYMBOLS) {
+        for (const BarSlice& slice : reader.lastDays(symbol, DAYS, now)) {
+            for (size_t i = 0; i < slice.size(); ++i) {
+                checksum += slice.bar(i).close;
+            }
+            bars += slice.size();
+        }
+    }
+    const double warmMs = millisSince(start);
+    cout << "Warm-up over " << DAYS << " days: " << bars << " bars in " << warmMs << " ms ("
+         << static_cast<uint64_t>(bars / (warmMs / 1000.0)) << " bars/s)" << endl;
+
+    start = std::chrono::steady_clock::now();
+    std::vector<double> sma;
+    double last = 0;
+    for (const char* symbol : SYMBOLS) {
+        for (const BarSlice& slice : reader.lastDays(symbol, DAYS, now)) {
+            sma.resize(slice.size());
+            indicators::batch::sma(slice.close.data(), slice.size(), 30, sma.data());
+            last += sma.back();
+        }
+    }
+    cout << "batch::sma straight off the mapped columns: " << millisSince(start) << " ms" << endl;
+
+    std::filesystem::remove_all(root);
+    return checksum == 0 || last == 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
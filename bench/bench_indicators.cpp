@@ -0,0 +1,150 @@
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <random>
+#include <vector>
+
+#include "indicators.h"
+
+using std::cout;
+using std::endl;
+
+namespace {
+    const size_t SAMPLES = 1 << 20;
+
+    // Keeps the optimiser from discarding results.
+    volatile double sink;
+
+    std::vector<double> randomWalk(size_t n) {
+        std::mt19937_64 rng(7);
+        std::normal_distribution<double> step(0.0, 0.05);
+        std::vector<double> prices(n);
+        double price = 100.0;
+        for (auto& p : prices) {
+            price += step(rng);
+            p = price;
+        }
+        return prices;
+    }
+
+    template <typename F>
+    double nsPerUpdate(F&& body) {
+        auto start = std::chrono::steady_clock::now();
+        body();
+        auto end = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count() / SAMPLES;
+    }
+
+    void report(const char* name, double naive, double streaming) {
+        cout << "  " << name << ": naive " << naive << " ns, streaming " << streaming
+             << " ns (" << naive / streaming << "x)" << endl;
+    }
+
+    template <size_t N>
+    void compare(const std::vector<double>& prices) {
+        cout << "window " << N << " (per update)" << endl;
+
+        // Naive baselines recompute over the trailing window every sample.
+        double naiveSma = nsPerUpdate([&]() {
+            double acc = 0;
+            for (size_t i = N; i < prices.size(); ++i) {
+                double sum = 0;
+                for (size_t j = i - N; j < i; ++j) sum += prices[j];
+                acc += sum / N;
+            }
+            sink = acc;
+        });
+        double streamSma = nsPerUpdate([&]() {
+            indicators::Sma<N> sma;
+            double acc = 0;
+            for (double p : prices) acc += sma.update(p);
+            sink = acc;
+        });
+        report("sma", naiveSma, streamSma);
+
+        double naiveMax = nsPerUpdate([&]() {
+            double acc = 0;
+            for (size_t i = N; i < prices.size(); ++i) {
+                acc += *std::max_element(prices.begin() + (i - N), prices.begin() + i);
+            }
+            sink = acc;
+        });
+        double streamMax = nsPerUpdate([&]() {
+            indicators::RollingMax<N> high;
+            double acc = 0;
+            for (double p : prices) acc += high.update(p);
+            sink = acc;
+        });
+        report("rolling max", naiveMax, streamMax);
+
+        double naiveZ = nsPerUpdate([&]() {
+            double acc = 0;
+            for (size_t i = N; i < prices.size(); ++i) {
+                double sum = 0, squares = 0;
+                for (size_t j = i - N; j < i; ++j) sum += prices[j];
+                double mean = sum / N;
+                for (size_t j = i - N; j < i; ++j) squares += (prices[j] - mean) * (prices[j] - mean);
+                double sd = std::sqrt(squares / N);
+                acc += sd > 0 ? (prices[i - 1] - mean) / sd : 0;
+            }
+            sink = acc;
+        });
+        double streamZ = nsPerUpdate([&]() {
+            indicators::RollingVariance<N> variance;
+            double acc = 0;
+            for (double p : prices) {
+                variance.update(p);
+                acc += variance.zScore(p);
+            }
+            sink = acc;
+        });
+        report("z-score", naiveZ, streamZ);
+
+        std::vector<double> out(prices.size());
+        double batchSma = nsPerUpdate([&]() {
+            indicators::batch::sma(prices.data(), prices.size(), N, out.data());
+            sink = out.back();
+        });
+        double batchMax = nsPerUpdate([&]() {
+            indicators::batch::rollingMax(prices.data(), prices.size(), N, out.data());
+            sink = out.back();
+        });
+        double batchZ = nsPerUpdate([&]() {
+            indicators::batch::zScore(prices.data(), prices.size(), N, out.data());
+            sink = out.back();
+        });
+        cout << "  batch: sma " << batchSma << " ns, rolling max " << batchMax
+             << " ns, z-score " << batchZ << " ns" << endl;
+    }
+}
+
+int main() {
+    std::vector<double> prices = randomWalk(SAMPLES);
+
+    compare<20>(prices);
+    compare<200>(prices);
+
+    double ema = nsPerUpdate([&]() {
+        indicators::Ema<20> e;
+        double acc = 0;
+        for (double p : prices) acc += e.update(p);
+        sink = acc;
+    });
+    double rsi = nsPerUpdate([&]() {
+        indicators::Rsi<14> r;
+        double acc = 0;
+        for (double p : prices) acc += r.update(p);
+        sink = acc;
+    });
+    double atr = nsPerUpdate([&]() {
+        indicators::Atr<14> a;
+        double acc = 0;
+        for (double p : prices) acc += a.update(p + 0.02, p - 0.02, p);
+        sink = acc;
+    });
+    cout << "ema " << ema << " ns, rsi " << rsi << " ns, atr " << atr << " ns per update" << endl;
+
+    return 0;
+}
@@ -0,0 +1,53 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+
+#include "latency.h"
+
+using std::cout;
+using std::endl;
+
+namespace {
+    // Below the per-thread ring size, so nothing is dropped mid-run.
+    const size_t SAMPLES = 8192;
+    const int ROUNDS = 200;
+
+    volatile uint64_t sink;
+
+    template <typename F>
+    double nsPerCall(F&& body) {
+        double best = 1e9;
+        for (int round = 0; round < ROUNDS; ++round) {
+            auto start = std::chrono::steady_clock::now();
+            body();
+            auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count() / SAMPLES);
+            latency::reset();
+        }
+        return best;
+    }
+}
+
+int main() {
+    if (!latency::enabled) {
+        cout << "Latency tracing is compiled out (HFT_LATENCY=0); stamps and records are no-ops." << endl;
+    }
+    cout << "TSC: " << latency::nsPerTick() << " ns per tick" << endl;
+
+    double stamp = nsPerCall([]() {
+        uint64_t acc = 0;
+        for (size_t i = 0; i < SAMPLES; ++i) acc += latency::now();
+        sink = acc;
+    });
+    double stampAndRecord = nsPerCall([]() {
+        for (size_t i = 0; i < SAMPLES; ++i) {
+            const uint64_t start = latency::now();
+            latency::record(latency::Stage::Decode, start, latency::now());
+        }
+    });
+
+    cout << "latency::now():             " << stamp << " ns" << endl;
+    cout << "two stamps plus a record:   " << stampAndRecord << " ns" << endl;
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "feed_decoder.h"
+#include "order_book.h"
+#include "symbol_table.h"
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+namespace {
+    const size_t SYNTHETIC_UPDATES = 2000000;
+
+    // Loads recorded order book frames (one JSON frame per line) through the
+    // live decoder.
+    bool loadRecording(const char* path, std::vector<BookLevelUpdate>& out) {
+        std::ifstream in(path);
+        if (!in) return false;
+
+        FeedDecoder decoder;
+        DecodedBatch batch;
+        std::string line;
+        while (std::getline(in, line)) {
+            batch.clear();
+            if (decoder.decode(line, batch) == DecodeStatus::Ok) {
+                out.insert(out.end(), batch.bookLevels.begin(), batch.bookLevels.end());
+            }
+        }
+        return !out.empty();
+    }
+
+    // Deltas shaped like a busy crypto book: a drifting mid with most
+    // changes within a few ticks of the top and ~30% of them removals.
+    std::vector<BookLevelUpdate> synthesize(size_t count) {
+        std::vector<BookLevelUpdate> updates;
+        updates.reserve(count + 100);
+
+        const uint32_t symbolId = SymbolTable::get_instance().intern("BENCH/USD");
+        int64_t mid = 6400000;
+        for (int64_t tick = 1; tick <= 50; ++tick) {
+            updates.push_back(BookLevelUpdate{symbolId, 'b', tick == 1 ? BookLevelUpdate::BOOK_RESET : uint8_t(0), 0, mid - tick, 100 * tick});
+            updates.push_back(BookLevelUpdate{symbolId, 'a', tick == 50 ? BookLevelUpdate::BOOK_END : uint8_t(0), 0, mid + tick, 100 * tick});
+        }
+
+        std::mt19937_64 rng(11);
+        std::geometric_distribution<int64_t> distance(0.25);
+        std::uniform_int_distribution<int> coin(0, 99);
+        std::uniform_int_distribution<int64_t> size(1, 5000);
+        for (size_t i = 0; i < count; ++i) {
+            if (coin(rng) == 0) mid += coin(rng) < 50 ? -1 : 1;
+            const bool bid = coin(rng) < 50;
+            const int64_t offset = 1 + distance(rng);
+            const int64_t price = bid ? mid - offset : mid + offset;
+            const int64_t qty = coin(rng) < 30 ? 0 : size(rng);
+            updates.push_back(BookLevelUpdate{symbolId, bid ? 'b' : 'a', BookLevelUpdate::BOOK_END,
+                                              static_cast<int64_t>(i), price, qty});
+        }
+        return updates;
+    }
+
+    // std::map book, the layout this replaces.
+    struct MapBook {
+        std::map<int64_t, int64_t, std::greater<int64_t>> bids;
+        std::map<int64_t, int64_t> asks;
+
+        void apply(const BookLevelUpdate& u) {
+            if (u.flags & BookLevelUpdate::BOOK_RESET) {
+                bids.clear();
+                asks.clear();
+            }
+            if (u.side == 'b') {
+                if (u.size == 0) bids.erase(u.price); else bids[u.price] = u.size;
+            } else if (u.side == 'a') {
+                if (u.size == 0) asks.erase(u.price); else asks[u.price] = u.size;
+            }
+        }
+    };
+
+    template <typename Apply>
+    void run(const char* name, const std::vector<BookLevelUpdate>& updates, Apply&& apply) {
+        auto start = std::chrono::steady_clock::now();
+        for (const auto& u : updates) apply(u);
+        auto end = std::chrono::steady_clock::now();
+        const double seconds = std::chrono::duration<double>(end - start).count();
+
+        // Second pass timing every update individually for the tail.
+        std::vector<int64_t> latencies;
+        latencies.reserve(updates.size());
+        for (const auto& u : updates) {
+            auto t0 = std::chrono::steady_clock::now();
+            apply(u);
+            auto t1 = std::chrono::steady_clock::now();
+            latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+        }
+        std::sort(latencies.begin(), latencies.end());
+        auto pct = [&](double p) { return latencies[static_cast<size_t>(p * (latencies.size() - 1))]; };
+
+        cout << name << ": " << static_cast<uint64_t>(updates.size() / seconds) << " updates/s, p50 "
+             << pct(0.50) << " ns, p99 " << pct(0.99) << " ns, p99.9 " << pct(0.999)
+             << " ns (per-update figures include ~20 ns of clock reads)" << endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<BookLevelUpdate> updates;
+    if (argc > 1) {
+        if (!loadRecording(argv[1], updates)) {
+            cerr << "No order book updates found in " << argv[1] << endl;
+            return EXIT_FAILURE;
+        }
+        cout << "Replaying " << updates.size() << " recorded level updates from " << argv[1] << endl;
+    } else {
+        updates = synthesize(SYNTHETIC_UPDATES);
+        cout << "Replaying " << updates.size() << " synthetic level updates" << endl;
+    }
+
+    OrderBookSet books;
+    uint64_t touched = 0;
+    run("flat book", updates, [&](const BookLevelUpdate& u) {
+        if (const OrderBook* book = books.apply(u)) touched += book->bids().size();
+    });
+
+    MapBook map;
+    run("std::map book", updates, [&](const BookLevelUpdate& u) { map.apply(u); });
+
+    return touched == 0 ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,100 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <boost/beast/version.hpp>
+#include <nlohmann/json.hpp>
+
+#include "fixed_point.h"
+#include "order.h"
+#include "order_encoder.h"
+#include "symbol_table.h"
+
+using std::cout;
+using std::endl;
+
+namespace http = boost::beast::http;
+
+namespace {
+    const int BATCH = 10000;
+    const int ROUNDS = 20;
+
+    template <typename F>
+    double nsPerOrder(F&& body) {
+        double best = 1e9;
+        for (int round = 0; round < ROUNDS; ++round) {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < BATCH; ++i) body(i);
+            auto end = std::chrono::steady_clock::now();
+            best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count() / BATCH);
+        }
+        return best;
+    }
+
+    // What the client did before the encoder: a JSON object, a Beast
+    // request with every header set per order, then serialization.
+    size_t beastRequest(const Order& order) {
+        nlohmann::json body;
+        body["symbol"] = order.symbol;
+        body["qty"] = order.qty;
+        body["side"] = order.side;
+        body["type"] = order.type;
+        body["time_in_force"] = order.time_in_force;
+        if (!order.limit_price.empty()) body["limit_price"] = order.limit_price;
+
+        http::request<http::string_body> req{http::verb::post, "/v2/orders", 11};
+        req.set(http::field::content_type, "application/json");
+        req.set(http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+        req.set(http::field::host, "paper-api.alpaca.markets");
+        req.set("APCA-API-KEY-ID", "PKTESTKEY0123456789");
+        req.set("APCA-API-SECRET-KEY", "secret0123456789secret0123456789secret01");
+        req.keep_alive(true);
+        req.body() = body.dump();
+        req.prepare_payload();
+
+        std::ostringstream out;
+        out << req;
+        return out.str().size();
+    }
+}
+
+int main() {
+    SymbolTable& table = SymbolTable::get_instance();
+    const uint32_t symbolId = table.intern("BTC/USD");
+
+    OrderIntent intent{};
+    intent.symbolId = symbolId;
+    intent.side = OrderSide::Buy;
+    intent.type = OrderType::Limit;
+    intent.timeInForce = TimeInForce::Gtc;
+    intent.quantity = fixed_point::fromDouble(0.0125, table.sizeDecimals(symbolId));
+    intent.limitPrice = fixed_point::fromDouble(64000.5, table.priceDecimals(symbolId));
+
+    Order order("BTCUSD", "0.0125", "buy", "limit", "gtc");
+    order.limit_price = "64000.5";
+
+    OrderEncoder encoder("paper-api.alpaca.markets", "PKTESTKEY0123456789",
+                         "secret0123456789secret0123456789secret01");
+    EncodedOrder encoded;
+    size_t sink = 0;
+
+    double beast = nsPerOrder([&](int) { sink += beastRequest(order); });
+    double fromOrder = nsPerOrder([&](int i) {
+        encoder.encode(order, static_cast<uint64_t>(i), encoded);
+        sink += encoded.size;
+    });
+    double fromIntent = nsPerOrder([&](int i) {
+        encoder.encode(intent, static_cast<uint64_t>(i), encoded);
+        sink += encoded.size;
+    });
+
+    cout << "json + beast request + serialize: " << beast << " ns/order" << endl;
+    cout << "OrderEncoder from Order:          " << fromOrder << " ns/order" << endl;
+    cout << "OrderEncoder from OrderIntent:    " << fromIntent << " ns/order" << endl;
+    cout << "(" << sink << " bytes)" << endl;
+    return 0;
+}
@@ -0,0 +1,200 @@
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/beast/http.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "order_gateway.h"
+#include "session_pool.h"
+#include "tls_certificate.h"
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+namespace http = boost::beast::http;
+using tcp = boost::asio::ip::tcp;
+
+namespace {
+    const char* ORDER_BODY = "{\"symbol\":\"BTCUSD\",\"qty\":\"0.001\",\"side\":\"sell\",\"type\":\"market\",\"time_in_force\":\"gtc\"}";
+
+    // Minimal keep-alive HTTPS endpoint that accepts every order.
+    void serveConnection(tcp::socket socket, boost::asio::ssl::context& ctx) {
+        boost::system::error_code ec;
+        boost::beast::ssl_stream<tcp::socket> stream(std::move(socket), ctx);
+        stream.handshake(boost::asio::ssl::stream_base::server, ec);
+        if (ec) return;
+
+        boost::beast::flat_buffer buffer;
+        for (;;) {
+            http_request req;
+            http::read(stream, buffer, req, ec);
+            if (ec) break;
+
+            http_response res{http::status::ok, req.version()};
+            res.set(http::field::content_type, "application/json");
+            res.keep_alive(req.keep_alive());
+            res.body() = "{\"id\":\"stub\",\"status\":\"accepted\"}";
+            res.prepare_payload();
+            http::write(stream, res, ec);
+            if (ec || !res.keep_alive()) break;
+        }
+        stream.shutdown(ec);
+    }
+
+    void runStub(tcp::acceptor& acceptor, boost::asio::ssl::context& ctx) {
+        for (;;) {
+            boost::system::error_code ec;
+            tcp::socket socket(acceptor.get_executor());
+            acceptor.accept(socket, ec);
+            if (ec) return;
+            std::thread(serveConnection, std::move(socket), std::ref(ctx)).detach();
+        }
+    }
+
+    http_request makeOrderRequest() {
+        http_request req{http::verb::post, "/v2/orders", 11};
+        req.set(http::field::content_type, "application/json");
+        req.body() = ORDER_BODY;
+        req.prepare_payload();
+        return req;
+    }
+
+    // The pre-pool path: resolve, connect and handshake for every order.
+    unsigned connectPerOrder(const string& host, const string& port) {
+        boost::asio::io_context ioc;
+        boost::asio::ssl::context sslCtx(boost::asio::ssl::context::tlsv12_client);
+        sslCtx.set_verify_mode(boost::asio::ssl::verify_none);
+
+        tcp::resolver resolver(ioc);
+        auto const results = resolver.resolve(host, port);
+
+        boost::beast::tcp_stream plain_stream(ioc);
+        plain_stream.connect(results);
+
+        https_stream sslStream(std::move(plain_stream), sslCtx);
+        ::SSL_set_tlsext_host_name(sslStream.native_handle(), host.c_str());
+        sslStream.handshake(boost::asio::ssl::stream_base::client);
+
+        http_request req = makeOrderRequest();
+        req.set(http::field::host, host);
+        http::write(sslStream, req);
+
+        boost::beast::flat_buffer buffer;
+        http_response res;
+        http::read(sslStream, buffer, res);
+
+        boost::system::error_code ec;
+        sslStream.shutdown(ec);
+        return res.result_int();
+    }
+
+    void report(const char* name, std::vector<double>& latenciesUs, double seconds) {
+        std::sort(latenciesUs.begin(), latenciesUs.end());
+        double sum = 0.0;
+        for (double l : latenciesUs) sum += l;
+        auto pct = [&](double p) { return latenciesUs[std::min(latenciesUs.size() - 1, size_t(p * latenciesUs.size()))]; };
+
+        cout << name << ": " << latenciesUs.size() << " orders"
+             << " mean=" << sum / latenciesUs.size() << "us"
+             << " p50=" << pct(0.50) << "us"
+             << " p99=" << pct(0.99) << "us"
+             << " orders/sec=" << latenciesUs.size() / seconds << endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    size_t n = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 500;
+
+    boost::asio::io_context ioc;
+    boost::asio::ssl::context serverCtx(boost::asio::ssl::context::tls_server);
+    useSelfSignedCertificate(serverCtx, "localhost");
+
+    tcp::acceptor acceptor(ioc, tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0));
+    const string host = "127.0.0.1";
+    const string port = std::to_string(acceptor.local_endpoint().port());
+    std::thread(runStub, std::ref(acceptor), std::ref(serverCtx)).detach();
+
+    try {
+        std::vector<double> latencies;
+        latencies.reserve(n);
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; ++i) {
+            auto t0 = std::chrono::steady_clock::now();
+            connectPerOrder(host, port);
+            latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count());
+        }
+        report("connect-per-order", latencies, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+        SessionPoolConfig config;
+        config.host = host;
+        config.port = port;
+        config.maxSessions = 1;
+        config.warmSessions = 1;
+        SessionPool pool(config);
+        pool.start();
+        {
+            http_request warm = makeOrderRequest();
+            http_response res;
+            pool.send(warm, res);
+        }
+
+        latencies.clear();
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; ++i) {
+            http_request req = makeOrderRequest();
+            http_response res;
+            auto t0 = std::chrono::steady_clock::now();
+            pool.send(req, res);
+            latencies.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - t0).count());
+        }
+        report("session-pool", latencies, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+        SessionPoolStats stats = pool.stats();
+        cout << "pool connects=" << stats.connects << " resumed=" << stats.resumedHandshakes
+             << " reuses=" << stats.reuses << " failures=" << stats.failures << endl;
+
+        OrderGatewayConfig gatewayConfig;
+        gatewayConfig.host = host;
+        gatewayConfig.port = port;
+        OrderGateway gateway(gatewayConfig);
+        gateway.start();
+
+        // The whole burst is submitted up front; latency is submit-to-response.
+        std::vector<std::chrono::steady_clock::time_point> submittedAt(n);
+        std::mutex latencyMutex;
+        latencies.assign(n, 0.0);
+        start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < n; ++i) {
+            submittedAt[i] = std::chrono::steady_clock::now();
+            auto handler = [&, i](const OrderResult&) {
+                double us = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - submittedAt[i]).count();
+                std::lock_guard<std::mutex> lock(latencyMutex);
+                latencies[i] = us;
+            };
+            while (!gateway.submit(makeOrderRequest(), handler)) {
+                gateway.awaitCapacity();
+            }
+        }
+        gateway.drain();
+        report("async-gateway", latencies, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+
+        OrderGatewayStats gatewayStats = gateway.stats();
+        cout << "gateway completed=" << gatewayStats.completed << " failed=" << gatewayStats.failed
+             << " peak-in-flight=" << gatewayStats.peakInFlight << endl;
+    } catch (const std::exception& e) {
+        cerr << "Benchmark failed: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    acceptor.close();
+    return EXIT_SUCCESS;
+}
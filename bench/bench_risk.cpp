@@ -0,0 +1,51 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+
+#include "fixed_point.h"
+#include "risk.h"
+#include "symbol_table.h"
+
+using std::cout;
+using std::endl;
+
+int main() {
+    SymbolTable& table = SymbolTable::get_instance();
+    const uint32_t symbolId = table.intern("BTC/USD");
+
+    // Every check on, none of them failing.
+    RiskConfig config;
+    config.defaults.maxOrderQuantity = 10;
+    config.defaults.maxOrderNotional = 1e6;
+    config.defaults.maxPosition = 100;
+    config.defaults.priceBandBps = 500;
+    config.defaults.ordersPerSecond = 1e9;
+    config.defaults.burst = 1e6;
+    config.ordersPerSecond = 1e9;
+    config.burst = 1e6;
+    RiskGate gate(config);
+    gate.observe(symbolId, fixed_point::fromDouble(64000, table.priceDecimals(symbolId)));
+
+    OrderIntent intent{};
+    intent.symbolId = symbolId;
+    intent.side = OrderSide::Buy;
+    intent.type = OrderType::Limit;
+    intent.quantity = fixed_point::fromDouble(0.01, table.sizeDecimals(symbolId));
+    intent.limitPrice = fixed_point::fromDouble(64010, table.priceDecimals(symbolId));
+
+    const int BATCH = 100000;
+    double best = 1e9;
+    size_t passed = 0;
+    for (int round = 0; round < 20; ++round) {
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < BATCH; ++i) {
+            passed += gate.check(intent, 0) == RiskReject::None;
+        }
+        auto end = std::chrono::steady_clock::now();
+        best = std::min(best, std::chrono::duration<double, std::nano>(end - start).count() / BATCH);
+    }
+
+    cout << "RiskGate::check, all checks on: " << best << " ns" << endl;
+    cout << "(" << passed << " passed, " << gate.stats().checked << " checked)" << endl;
+    return 0;
+}
@@ -0,0 +1,104 @@
+#ifndef BACKTEST_H
+#define BACKTEST_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "market_data.h"
+#include "strategy.h"
+
+using std::string;
+
+// How intents become fills. A market order fills at the open of the bar
+// delayBars after the bar that produced it, moved against the order by
+// slippageBps. A limit order is first eligible on that bar and fills at
+// its limit (or the open, if better) once the bar trades through it; IOC
+// limits get that one bar, day limits expire with the UTC day, GTC limits
+// wait. Fees are charged on notional.
+struct FillModelConfig {
+    unsigned delayBars = 1;
+    double slippageBps = 1.0;
+    double feeBps = 2.5;
+};
+
+struct BacktestConfig {
+    FillModelConfig fills;
+    // Strategy callback latency is timed on every Nth bar; 0 turns it off.
+    size_t latencySampleEvery = 64;
+    bool recordFills = false;
+};
+
+struct BacktestFill {
+    uint32_t symbolId;
+    uint16_t strategyId;
+    OrderSide side;
+    int64_t signalNs;
+    int64_t timestampNs;
+    double price;
+    double quantity;
+    double fee;
+};
+
+struct LatencySummary {
+    uint64_t samples = 0;
+    double meanNs = 0;
+    int64_t p50Ns = 0;
+    int64_t p99Ns = 0;
+    int64_t maxNs = 0;
+};
+
+// PnL is in quote currency (prices and sizes converted out of fixed point
+// at each symbol's scale), marked to the last close.
+struct BacktestResult {
+    string name;
+    uint64_t bars = 0;
+    uint64_t intents = 0;
+    uint64_t fills = 0;
+    // Limit orders that expired or were never reached before the data ended.
+    uint64_t unfilled = 0;
+    double realizedPnl = 0;
+    double unrealizedPnl = 0;
+    double fees = 0;
+    double netPnl = 0;
+    double maxDrawdown = 0;
+    double elapsedSeconds = 0;
+    LatencySummary strategyLatency;
+    std::vector<BacktestFill> fillLog;
+
+    // Adds another run's totals (e.g. the same parameters on another symbol).
+    void merge(const BacktestResult& other);
+};
+
+// Drives the runner exactly as a live pipeline shard does (onEvents with
+// one bar event per call, so fills can be attributed to the bar) and
+// settles its intents with the fill model. bars must be in time order and
+// may mix symbols.
+BacktestResult runBacktest(StrategyRunner& runner, const CompactBar* bars, size_t count,
+                           const BacktestConfig& config = BacktestConfig());
+
+struct BacktestJob {
+    string name;
+    StrategyFactory factory;
+    const std::vector<CompactBar>* bars;
+};
+
+// Runs independent jobs (parameter sets x symbols) on `threads` workers,
+// all cores when 0. Results come back in job order.
+std::vector<BacktestResult> runBacktests(const std::vector<BacktestJob>& jobs,
+                                         const BacktestConfig& config = BacktestConfig(), size_t threads = 0);
+
+// CSV rows of timestamp,open,high,low,close,volume[,trade_count[,vwap]]
+// where the timestamp is RFC 3339 or integer epoch seconds, milliseconds,
+// microseconds or nanoseconds. A header row is skipped. Throws on a file
+// that cannot be read; malformed rows are counted and skipped.
+size_t loadCsvBars(const string& path, const string& symbol, std::vector<CompactBar>& out, size_t* skipped = nullptr);
+
+// Bars from a BarStore root (see bar_store.h).
+size_t loadStoredBars(const string& root, const string& symbol, int64_t fromNs, int64_t toNs,
+                      std::vector<CompactBar>& out);
+
+// Random-walk minute bars for throughput runs.
+void syntheticBars(const string& symbol, size_t count, uint64_t seed, std::vector<CompactBar>& out);
+
+#endif
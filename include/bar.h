@@ -4,6 +4,8 @@
 #include <string>
 #include <nlohmann/json.hpp>
 
+#include "market_data.h"
+
 using nlohmann::json;
 
 class Bar {
@@ -33,6 +35,11 @@ public:
         if (j.contains("n") && j["n"].is_number()) { n = j["n"]; }
         if (j.contains("vw") && j["vw"].is_number()) { vw = j["vw"]; }
     }
+
+    explicit Bar(const CompactBar& bar);
+
+    // Interns S and converts prices and volume at the symbol's scale.
+    CompactBar toCompact() const;
 };
 
 #endif
@@ -0,0 +1,166 @@
+#ifndef BAR_STORE_H
+#define BAR_STORE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "market_data.h"
+#include "ring_buffer.h"
+#include "thread_util.h"
+
+using std::string;
+
+// Columnar bar history on disk, one file per field per symbol per UTC day:
+//   <root>/<symbol>/<YYYYMMDD>/<field>.col
+// with '/' in the symbol replaced by '-'. Each file is a 32-byte header
+//   "HFTCOL1" NUL | uint32 version | uint8 field | uint8 width |
+//   uint8 priceDecimals | uint8 sizeDecimals | int64 dayStartNs | 8 reserved
+// followed by packed values, one per bar:
+//   time                    uint32, milliseconds since dayStartNs
+//   open/high/low/close/vwap int64, fixed point at priceDecimals
+//   volume                  int64, fixed point at sizeDecimals
+//   trades                  uint32
+// Files only grow by appending whole values, so a reader can map them while
+// the writer is running; the shortest column bounds the readable rows.
+enum class BarField : uint8_t {
+    Time,
+    Open,
+    High,
+    Low,
+    Close,
+    Volume,
+    Vwap,
+    Trades,
+    Count
+};
+
+template <typename T>
+struct ColumnSpan {
+    const T* ptr = nullptr;
+    size_t count = 0;
+
+    const T* data() const { return ptr; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    const T& operator[](size_t i) const { return ptr[i]; }
+    const T* begin() const { return ptr; }
+    const T* end() const { return ptr + count; }
+};
+
+// Consecutive bars of one symbol from one day. The columns point straight
+// into the mapped files (and can go to indicators::batch as is); the slice
+// keeps them mapped.
+struct BarSlice {
+    uint32_t symbolId = 0;
+    int64_t dayStartNs = 0;
+    uint8_t priceDecimals = 0;
+    uint8_t sizeDecimals = 0;
+
+    ColumnSpan<uint32_t> timeMs;
+    ColumnSpan<int64_t> open;
+    ColumnSpan<int64_t> high;
+    ColumnSpan<int64_t> low;
+    ColumnSpan<int64_t> close;
+    ColumnSpan<int64_t> volume;
+    ColumnSpan<int64_t> vwap;
+    ColumnSpan<uint32_t> trades;
+
+    std::shared_ptr<const void> mapping;
+
+    size_t size() const { return close.size(); }
+    int64_t timestampNs(size_t i) const { return dayStartNs + static_cast<int64_t>(timeMs[i]) * 1000000; }
+    // Row i at the symbol's current SymbolTable scale.
+    CompactBar bar(size_t i) const;
+};
+
+struct BarStoreStats {
+    uint64_t written = 0;
+    // Bars at or before the last stored time of their day (updates, replays).
+    uint64_t late = 0;
+    // Bars the live stream could not queue.
+    uint64_t drops = 0;
+};
+
+// Appends bars to the store. Live bars go through publish(), which only
+// pushes onto a ring; a background thread does the file I/O and flushes
+// whenever it catches up. append() writes synchronously for tools and
+// tests and must not be mixed with a running writer thread.
+class BarStoreWriter {
+public:
+    explicit BarStoreWriter(const string& root, size_t queueCapacity = 65536);
+    ~BarStoreWriter();
+
+    BarStoreWriter(const BarStoreWriter&) = delete;
+    BarStoreWriter& operator=(const BarStoreWriter&) = delete;
+
+    void start(const ThreadPlacement& placement = ThreadPlacement());
+    // Writes everything already published, then joins.
+    void stop();
+
+    // Feed thread; never blocks. False when the bar was dropped.
+    bool publish(const CompactBar& bar);
+
+    void append(const CompactBar& bar);
+    void flush();
+
+    BarStoreStats stats() const;
+
+private:
+    struct Partition {
+        int64_t dayStartNs = 0;
+        uint32_t lastTimeMs = 0;
+        bool hasRows = false;
+        // From the headers; every value is written at these decimals.
+        uint8_t priceDecimals = 0;
+        uint8_t sizeDecimals = 0;
+        FILE* files[static_cast<size_t>(BarField::Count)] = {};
+    };
+
+    void run();
+    Partition& partition(uint32_t symbolId, int64_t dayStartNs);
+    void open(Partition& part, uint32_t symbolId);
+    void close(Partition& part);
+
+    const string root;
+    SpscRing<CompactBar> ring;
+    std::thread worker;
+    std::unordered_map<uint32_t, Partition> partitions;
+
+    std::atomic<uint64_t> written{0};
+    std::atomic<uint64_t> late{0};
+};
+
+class BarStoreReader {
+public:
+    explicit BarStoreReader(const string& root);
+
+    // Bars with fromNs <= timestamp < toNs, oldest first, one slice per day.
+    std::vector<BarSlice> query(const string& symbol, int64_t fromNs, int64_t toNs) const;
+    // Every bar of the `days` UTC days ending with the day containing toNs,
+    // up to toNs.
+    std::vector<BarSlice> lastDays(const string& symbol, unsigned days, int64_t toNs) const;
+
+private:
+    const string root;
+};
+
+namespace bar_store {
+    constexpr int64_t NS_PER_DAY = 86400LL * 1000000000LL;
+
+    inline int64_t dayStart(int64_t timestampNs) {
+        int64_t day = timestampNs / NS_PER_DAY;
+        if (timestampNs < 0 && day * NS_PER_DAY != timestampNs) --day;
+        return day * NS_PER_DAY;
+    }
+
+    // "BTC/USD" -> "BTC-USD".
+    string directoryName(const string& symbol);
+}
+
+#endif
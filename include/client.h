@@ -21,6 +21,7 @@
 #include <cstdlib>
 #include <ctime>
 #include <map>
+#include <unordered_map>
 #include <set>
 #include <mutex>
 #include <queue>
@@ -29,7 +30,24 @@
 #include <curl/curl.h>
 
 #include "bar.h"
+#include "bar_store.h"
+#include "feed_merger.h"
+#include "feed_session.h"
+#include "journal.h"
+#include "latency.h"
+#include "market_data.h"
+#include "market_feed.h"
 #include "order.h"
+#include "order_batcher.h"
+#include "order_book.h"
+#include "order_gateway.h"
+#include "order_manager.h"
+#include "risk.h"
+#include "session_pool.h"
+#include "shard_pipeline.h"
+#include "strategy.h"
+#include "thread_util.h"
+#include "trade_update_stream.h"
 
 typedef websocketpp::client<websocketpp::config::asio_tls_client> client;
 typedef client::connection_ptr connection_ptr;
@@ -48,47 +66,190 @@ using std::cin;
 using std::cerr;
 using std::endl;
 
-class WebClient {
+class WebClient;
+
+// Owns the per-symbol state and pending orders of the symbols routed to one
+// pipeline shard. Only the shard's worker touches it, except for the
+// once-per-batch hand-off of staged orders to executeOrders.
+class OrderShard {
+public:
+    OrderShard(WebClient& owner, size_t index, std::unique_ptr<StrategyRunner> runner);
+
+    void onBatch(const MarketEvent* events, size_t count);
+    void moveSymbol(uint32_t symbolId, OrderShard& to);
+    void takeOrders(vector<Order>& out);
+
+    const size_t index;
+
+private:
+    struct SymbolState {
+        CompactBar lastBar;
+        QuoteRecord lastQuote;
+        uint64_t barCount = 0;
+    };
+
+    WebClient& owner;
+    std::unique_ptr<StrategyRunner> runner;
+    IntentBuffer intents;
+    OrderBookSet books;
+    std::unordered_map<uint32_t, SymbolState> symbols;
+    vector<Order> staged;
+    uint64_t barsSeen = 0;
+
+    mutex handoffMutex;
+    vector<Order> pending;
+};
+
+class WebClient : private FeedListener {
 public:
     WebClient();
     WebClient(string& apiKey, string& apiSecretKey);
     ~WebClient();
 
+    // Adds a market data feed, e.g. crypto next to IEX or SIP stocks. Each
+    // feed runs its own websocket thread; with more than one, their events
+    // are merged in timestamp order before the pipeline (see FeedMerger).
+    // Must be called before connecting; returns the index MarketEvent::feed
+    // carries for the feed's events.
+    size_t addFeed(const MarketFeedConfig& config);
+
+    // Adds a crypto feed for uri with the setFeedSession() settings, then
+    // connects every feed.
     void connect(const string& uri, const string& hostname);
+    // Opens every feed added. Dropped connections are re-opened with
+    // jittered exponential backoff, re-authenticated and resubscribed to
+    // everything subscribed so far; the connect and authenticate callbacks
+    // fire once every feed's first session has got that far.
+    void connect();
     void disconnect();
 
     void authenticate();
 
+    // Each symbol goes to the feeds that carry it (see MarketFeed::carries).
+    void subscribe(FeedChannel channel, const vector<string>& symbols);
+    void unsubscribe(FeedChannel channel, const vector<string>& symbols);
+
     void subscribeBars(const vector<string>& symbols);
 
     void unsubscribeBars(const vector<string>& symbols);
 
+    // Top-of-book quotes and L2 order books; books are kept per symbol by
+    // the shard that owns it and reach strategies through onBook.
+    void subscribeQuotes(const vector<string>& symbols);
+    void unsubscribeQuotes(const vector<string>& symbols);
+    void subscribeOrderBooks(const vector<string>& symbols);
+    void unsubscribeOrderBooks(const vector<string>& symbols);
+
     void placeOrder(Order& order);
 
-    void createOrder(Bar& bar);
+    // Stages an order if it passes the pre-trade risk checks.
+    void createOrder(const OrderIntent& intent);
 
+    // Sends every staged order through the order gateway, pipelined over
+    // its keep-alive connections, and waits for the responses. With
+    // batching on, first coalesces the burst (see setOrderBatching).
     void executeOrders();
+    // Collects the orders staged so far without sending them; they no
+    // longer count against the position limit.
+    vector<Order> takeOrders();
+    // Looks up every Unconfirmed order (written, but the connection failed
+    // before the response) on the exchange by its client_order_id and
+    // settles it; one the exchange does not know becomes Rejected. Orders
+    // the lookup fails for stay Unconfirmed. Returns how many were settled.
+    // executeOrders() calls it whenever a batch leaves any behind.
+    size_t reconcileOrders();
+
+    // Has executeOrders() collect staged orders for the config's window and
+    // net the orders of the strategies it names per symbol before sending
+    // them. Off by default; safe to change between executeOrders() calls.
+    void setOrderBatching(const OrderBatchConfig& config);
+    // Requests saved by batching so far; the wait it adds shows up as the
+    // "batch" latency stage and in the end-to-end one.
+    OrderBatchStats orderBatchStats() const { return batcher.stats(); }
+
+    // Order states and positions, kept current by the trade update stream.
+    // Strategies that need their position can hold a reference to it.
+    OrderManager& orderManager() { return manager; }
+    // Follows the account's trade_updates stream (Alpaca:
+    // wss://paper-api.alpaca.markets/stream) on its own connection.
+    void connectTradeUpdates(const string& uri, const string& hostname);
+
+    // Every order a strategy or createOrder emits passes these checks before
+    // it is staged; limits, the kill switch and rejection counts live here.
+    RiskGate& riskGate() { return risk; }
+
+    // Orders go out through the order gateway; setOrderEndpoint takes the
+    // host, port, timeouts and heartbeat settings from a pool config.
+    void setOrderEndpoint(const SessionPoolConfig& config);
+    void setOrderGateway(const OrderGatewayConfig& config);
+    // Connects the order gateway ahead of the first order and keeps its
+    // connections open until the client is destroyed.
+    void warmOrderSessions();
+
+    // Strategies that turn market data into orders; without one the client
+    // streams and logs bars but never trades. Must be set before connecting.
+    void setStrategyFactory(StrategyFactory factory);
+
+    void setMarketDataPipeline(const ShardPipelineConfig& config);
+    // Spreads the symbols evenly over the pipeline shards; safe while streaming.
+    void rebalanceShards(const vector<string>& symbols);
+    RingStats marketDataStats() const;
+
+    // Appends every received frame, with its receive time, to a journal;
+    // feeds after the first write to path.<feed name>. Must be called
+    // before connecting.
+    void setCapture(const string& path, JournalWriterConfig config = JournalWriterConfig());
+    // Use instead of connect(): feeds a captured journal through the same
+    // decode, strategy and order staging path as the live feed and returns
+    // once every shard has processed it. Send the staged orders with
+    // executeOrders() or inspect them with takeOrders().
+    ReplayStats replay(const string& path, const ReplayConfig& config = ReplayConfig());
+
+    // Keeps every streamed bar in a columnar store under root, written by a
+    // background thread. Must be called before connecting.
+    void setBarStore(const string& root);
+    // Runs the last `days` UTC days of stored bars for the symbols through
+    // the strategies so indicators are warm before the first live bar.
+    // Orders the strategies emit meanwhile are discarded. Call before
+    // connect() or replay(); returns the number of bars replayed.
+    size_t warmUp(const string& root, const vector<string>& symbols, unsigned days);
+
+    // Backoff, ping/pong liveness and bar gap backfill of the feed that
+    // connect(uri, hostname) adds. Must be called before connecting.
+    void setFeedSession(const FeedSessionConfig& config);
+    // Summed over every feed.
+    FeedSessionStats feedSessionStats() const;
+    void setFeedMerger(const FeedMergerConfig& config);
+    FeedMergerStats feedMergerStats() const;
+
+    // Places every engine thread the client starts by role; roles left
+    // empty keep the placement of the component's own config. Must be
+    // called before adding feeds and before anything starts a thread:
+    // rebalanceShards, warmUp, setBarStore, connecting or warming order
+    // sessions. The logger is process wide and takes its placement from
+    // LoggerConfig::writerThread; threadReport() shows where they all ended
+    // up.
+    void setThreadTopology(const ThreadTopology& topology);
 
     void setOnConnect(function<void()> callback);
     void setOnAuthenticate(function<void()> callback);
     void setOnSubscribe(function<void()> callback);
 
 private:
-    void run();
+    void onFeedEvents(MarketFeed& feed, const MarketEvent* events, size_t count) override;
+    void onFeedOpen(MarketFeed& feed) override;
+    void onFeedAuthenticated(MarketFeed& feed) override;
+    void onFeedSubscribed(MarketFeed& feed) override;
 
-    void onOpen(connection_hdl hdl);
-    void onClose(connection_hdl hdl);
-    void onFail(connection_hdl hdl);
-    void onMessage(connection_hdl hdl, message_ptr msg);
-    context_ptr onTLS(const char* hostname, connection_hdl);
+    bool streaming() const;
 
-    client c;
-    websocketpp::lib::thread thread;
-    connection_hdl hdl;
-    bool connected;
-
-    mutex subMutex;
-    set<string> subscriptions;
+    vector<std::unique_ptr<MarketFeed>> feeds;
+    FeedSessionConfig sessionConfig;
+    FeedMergerConfig mergerConfig;
+    std::unique_ptr<FeedMerger> merger;
+    ThreadTopology topology;
+    std::atomic<size_t> feedsOpen{0};
+    std::atomic<size_t> feedsAuthenticated{0};
 
     string ALPACA_API_KEY;
     string ALPACA_API_SECRET_KEY;
@@ -103,9 +264,66 @@ private:
 
     vector<Order> orders;
     std::mutex orderMutex;
+    // Swapped with orders on every executeOrders() call.
+    vector<Order> executeBuffer;
+    std::mutex executeMutex;
+    // Used under executeMutex.
+    OrderBatcher batcher;
+    struct Reservation {
+        uint32_t symbolId;
+        OrderSide side;
+        int64_t quantity;
+    };
+    // What the staged orders held before coalescing; used under
+    // executeMutex.
+    vector<Reservation> heldBeforeBatch;
     std::condition_variable orderCV;
     bool stopOrderThread = false;
-    boost::asio::thread_pool processingPool;
+
+    void startPipeline();
+    void stopPipeline();
+    // The pipeline's only producer: the single feed's websocket thread, or
+    // the merge thread when there are several feeds. Takes a frame's or a
+    // merged batch's events with one wake per shard.
+    void publishEvents(const MarketEvent* events, size_t count);
+    // Runs the task on that producer, or right away when nothing streams.
+    void runOnProducer(function<void()> task);
+    // Appends the staged orders to out.
+    void takeOrders(vector<Order>& out);
+    // Keeps taking staged orders into executeBuffer for the batching
+    // window, then coalesces them.
+    void collectBatch();
+    // Rounds the intent to its symbol's rules and, if it passes the risk
+    // checks, appends its order to out with its quantity reserved in the
+    // order manager until executeOrders() opens it.
+    bool stageOrder(const OrderIntent& requested, vector<Order>& out);
+    // Gives back the reservation of an order that will not be opened.
+    void release(Order& order);
+
+    friend class OrderShard;
+
+    string capturePath;
+    JournalWriterConfig captureConfig;
+    std::unique_ptr<BarStoreWriter> barStore;
+    // Off while warming up so history is not echoed bar by bar.
+    std::atomic<bool> logBars{true};
+    ShardPipelineConfig pipelineConfig;
+    StrategyFactory strategyFactory;
+    // Each symbol's events are processed in arrival order by the shard that
+    // owns it.
+    std::unique_ptr<ShardPipeline<OrderShard, MarketEvent>> pipeline;
+
+    OrderGateway& orderGateway();
+    http_request buildOrderRequest(const Order& order) const;
+
+    OrderGatewayConfig gatewayConfig;
+    std::unique_ptr<OrderGateway> gateway;
+    std::once_flag gatewayOnce;
+
+    // Declared before the stream that updates it.
+    OrderManager manager;
+    std::unique_ptr<TradeUpdateStream> tradeUpdates;
+    RiskGate risk;
 };
 
 #endif
\ No newline at end of file
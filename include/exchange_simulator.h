@@ -0,0 +1,176 @@
+#ifndef EXCHANGE_SIMULATOR_H
+#define EXCHANGE_SIMULATOR_H
+
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast/http.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "market_data.h"
+#include "matching_engine.h"
+
+using std::string;
+
+// Delay added to every response (orders) or frame (market data): base plus a
+// uniformly distributed extra of up to jitter. Market data keeps its order.
+struct LatencyModel {
+    std::chrono::microseconds base{0};
+    std::chrono::microseconds jitter{0};
+};
+
+struct ExchangeSimulatorConfig {
+    string address = "127.0.0.1";
+    // 0 binds an ephemeral port; see restPort()/streamPort().
+    unsigned short restPort = 8443;
+    unsigned short streamPort = 8444;
+    // WebClient, SessionPool and OrderGateway only speak TLS; plain HTTP and
+    // ws:// are for curl and other tools.
+    bool tls = true;
+
+    // Empty accepts any credentials.
+    string apiKey;
+    string apiSecret;
+
+    std::vector<string> symbols{"BTC/USD"};
+
+    // Recorded feed frames, one JSON frame per line, replayed one per tick.
+    // Synthetic data is generated when empty.
+    string replayPath;
+    std::chrono::milliseconds tickInterval{100};
+    // Synthetic data: a bar is emitted every barTicks ticks.
+    unsigned barTicks = 10;
+    // Bars per symbol kept for the historical bars endpoint.
+    size_t barHistory = 10000;
+    double startPrice = 60000.0;
+    double volatilityBps = 2.0;
+    double halfSpreadBps = 1.0;
+    double quoteSize = 5.0;
+    unsigned seed = 42;
+
+    LatencyModel orderLatency;
+    LatencyModel marketDataLatency;
+};
+
+// Local stand-in for Alpaca: the /v2/orders REST contract (plus /v2/clock
+// for heartbeats), the market-data WebSocket protocol (auth, subscribe,
+// bars/trades/quotes/orderbooks) and, on the stream port's /stream path, the
+// account stream's trade_updates over localhost. Orders are matched with
+// price-time priority against a liquidity provider that requotes around the
+// replayed or synthetic market on every tick, so resting limits fill when
+// the market moves through them. Bars already streamed are served again by
+// the historical bars endpoint, GET /v1beta3/crypto/us/bars, for backfills.
+//
+// Everything runs on one io_context thread, so the matching engine needs no
+// locking and latency injection uses timers rather than sleeps.
+class ExchangeSimulator {
+public:
+    explicit ExchangeSimulator(const ExchangeSimulatorConfig& config);
+    ~ExchangeSimulator();
+
+    ExchangeSimulator(const ExchangeSimulator&) = delete;
+    ExchangeSimulator& operator=(const ExchangeSimulator&) = delete;
+
+    void start();
+    void stop();
+
+    unsigned short restPort() const { return boundRestPort; }
+    unsigned short streamPort() const { return boundStreamPort; }
+
+    MatchingEngineStats engineStats();
+
+private:
+    typedef boost::beast::http::request<boost::beast::http::string_body> request_type;
+    typedef boost::beast::http::response<boost::beast::http::string_body> response_type;
+
+    class Session;
+    class Subscriber;
+    template <typename Stream> class HttpSession;
+    template <typename Stream> class StreamSession;
+
+    struct SymbolState {
+        uint32_t id;
+        string name;
+        double price;
+        double barOpen, barHigh, barLow, barNotional, barVolume;
+        uint32_t barTrades = 0;
+    };
+
+    struct PendingFrame {
+        std::chrono::steady_clock::time_point due;
+        const char* channel;
+        string symbol;
+        std::shared_ptr<const string> frame;
+    };
+
+    void acceptRest();
+    void acceptStream();
+    void track(const std::shared_ptr<Session>& session);
+
+    void handleRequest(const request_type& req, response_type& res);
+    void handleOrder(const request_type& req, response_type& res);
+    void handleBars(const string& query, response_type& res);
+    void recordBar(const CompactBar& bar);
+    string orderJson(const SimOrder& order) const;
+    // Trade updates for the client orders in fills, and for one order.
+    void publishTradeUpdates();
+    void publishTradeUpdate(const char* event, const SimOrder& order, int64_t price, int64_t quantity);
+    const SymbolState* resolveSymbol(const string& symbol) const;
+    std::chrono::microseconds sample(const LatencyModel& model);
+
+    // Called by stream sessions as they authenticate and subscribe.
+    bool checkCredentials(const string& key, const string& secret) const;
+    void attach(const std::shared_ptr<Subscriber>& subscriber);
+
+    void scheduleTick();
+    void tick();
+    void syntheticTick();
+    void replayTick();
+    // channel null sends the frame to every authenticated subscriber.
+    void publish(const char* channel, const string& symbol, string frame);
+    void flushFrames();
+
+    ExchangeSimulatorConfig cfg;
+
+    boost::asio::io_context ioc;
+    std::optional<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> work;
+    std::thread ioThread;
+    boost::asio::ssl::context tlsContext;
+    boost::asio::ip::tcp::acceptor restAcceptor;
+    boost::asio::ip::tcp::acceptor streamAcceptor;
+    boost::asio::steady_timer tickTimer;
+    boost::asio::steady_timer frameTimer;
+    unsigned short boundRestPort = 0;
+    unsigned short boundStreamPort = 0;
+    std::atomic<bool> running{false};
+
+    MatchingEngine engine;
+    std::vector<SimFill> fills;
+    std::vector<SymbolState> symbols;
+    std::unordered_map<string, size_t> symbolIndex;
+    // client_order_id -> engine order id, for GET /v2/orders:by_client_order_id.
+    std::unordered_map<string, uint64_t> clientOrders;
+    std::unordered_map<uint32_t, std::deque<CompactBar>> barHistory;
+    std::vector<std::weak_ptr<Session>> sessions;
+    std::vector<std::weak_ptr<Subscriber>> subscribers;
+    std::deque<PendingFrame> frames;
+    std::chrono::steady_clock::time_point lastDue;
+
+    std::mt19937_64 rng;
+    std::ifstream replay;
+    uint64_t ticks = 0;
+    int64_t tradeIds = 0;
+};
+
+#endif
@@ -0,0 +1,83 @@
+#ifndef FEED_DECODER_H
+#define FEED_DECODER_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "market_data.h"
+#include "symbol_table.h"
+
+enum class DecodeStatus {
+    Ok,
+    Fallback,
+    Malformed
+};
+
+struct DecodedBatch {
+    explicit DecodedBatch(size_t reserve = 1024) {
+        bars.reserve(reserve);
+        updatedBars.reserve(reserve);
+        dailyBars.reserve(reserve);
+        trades.reserve(reserve);
+        quotes.reserve(reserve);
+        bookLevels.reserve(reserve);
+        order.reserve(reserve);
+    }
+
+    void clear() {
+        bars.clear();
+        updatedBars.clear();
+        dailyBars.clear();
+        trades.clear();
+        quotes.clear();
+        bookLevels.clear();
+        order.clear();
+    }
+
+    bool empty() const {
+        return bars.empty() && updatedBars.empty() && dailyBars.empty() && trades.empty() && quotes.empty() &&
+               bookLevels.empty();
+    }
+
+    std::vector<CompactBar> bars;
+    std::vector<CompactBar> updatedBars;
+    std::vector<CompactBar> dailyBars;
+    std::vector<TradeRecord> trades;
+    std::vector<QuoteRecord> quotes;
+    std::vector<BookLevelUpdate> bookLevels;
+    // The type of every record above in the order the frame carried them,
+    // so a consumer can interleave the vectors back into wire order.
+    std::vector<EventType> order;
+};
+
+// Single-pass scanner for Alpaca market-data frames. Bars (minute, updated
+// and daily, each into its own vector), trades, quotes and order book
+// messages (as runs of BookLevelUpdate) are written straight into the batch
+// with prices and sizes parsed directly into the symbol's fixed-point scale;
+// once the batch vectors have grown to the feed's burst size a frame decodes
+// without touching the heap. Frames carrying anything else (auth,
+// subscription, error) return Fallback and leave the batch as it was so the
+// caller can hand them to nlohmann::json. A market-data element with an
+// empty symbol or a missing or invalid timestamp is skipped and counted in
+// skipped(); the frame's other elements are still decoded.
+class FeedDecoder {
+public:
+    explicit FeedDecoder(SymbolTable& symbols = SymbolTable::get_instance()) : symbols(symbols) {}
+
+    DecodeStatus decode(std::string_view frame, DecodedBatch& out);
+
+    // Parses RFC 3339 UTC timestamps ("2024-03-12T15:04:05.123456789Z").
+    static bool parseTimestamp(std::string_view text, int64_t& epochNs);
+    static std::string formatTimestamp(int64_t epochNs);
+
+    // Elements dropped for a missing symbol or timestamp since construction.
+    uint64_t skipped() const { return skippedElements; }
+
+private:
+    SymbolTable& symbols;
+    uint64_t skippedElements = 0;
+};
+
+#endif
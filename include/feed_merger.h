@@ -0,0 +1,102 @@
+#ifndef FEED_MERGER_H
+#define FEED_MERGER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "market_data.h"
+#include "ring_buffer.h"
+#include "thread_util.h"
+
+struct FeedMergerConfig {
+    size_t ringCapacity = 65536;
+    // Longest an event is held back waiting for a quiet feed to show it has
+    // nothing older. Feeds further apart than this come out in arrival order,
+    // and a feed that has sent nothing for this long holds nothing back.
+    std::chrono::microseconds maxHold{500};
+    // Most events handed to the sink in one call. Released events go out
+    // together before the merge thread waits or runs a task.
+    size_t batchSize = 256;
+    WaitPolicy waitPolicy = WaitPolicy::Block;
+    ThreadPlacement thread;
+};
+
+struct FeedMergerStats {
+    uint64_t merged = 0;
+    // Released before an event of another feed with an older timestamp
+    // because that one arrived after maxHold.
+    uint64_t outOfOrder = 0;
+    RingStats rings;
+};
+
+// Merges the events of several feeds, each pushed from its own websocket
+// thread, into one stream in timestamp order, so the shard pipeline keeps a
+// single producer. Each feed has an SPSC ring and the merge thread keeps
+// releasing the oldest head among them. A head is only held while some
+// other feed has nothing queued but sent something within maxHold, and for
+// at most maxHold.
+class FeedMerger {
+public:
+    typedef std::function<void(EventSpan)> sink_type;
+
+    FeedMerger(size_t feeds, const FeedMergerConfig& config, sink_type sink);
+    ~FeedMerger();
+
+    FeedMerger(const FeedMerger&) = delete;
+    FeedMerger& operator=(const FeedMerger&) = delete;
+
+    void start();
+    // Releases everything already pushed, then joins. The feeds must have
+    // stopped pushing.
+    void stop();
+
+    // Feed side; only the feed's own thread may push to its index. Waits
+    // while the feed's ring is full and returns false once stopped.
+    bool push(size_t feed, const MarketEvent& event);
+
+    // Runs the task on the merge thread between two events, or right away
+    // when the merger is not running. For work that has to happen on the
+    // pipeline's producer, such as a rebalance.
+    void post(std::function<void()> task);
+
+    FeedMergerStats stats() const;
+
+private:
+    struct Lane {
+        std::unique_ptr<SpscRing<MarketEvent>> ring;
+        MarketEvent head;
+        bool hasHead = false;
+        std::chrono::steady_clock::time_point heldSince;
+        std::chrono::steady_clock::time_point lastArrival;
+    };
+
+    void run();
+    void runTasks();
+    void flush();
+    // New events for a lane without a head, a task, or optionally a stop.
+    bool pendingInput(bool orStopping) const;
+
+    const FeedMergerConfig cfg;
+    const sink_type sink;
+    std::vector<Lane> lanes;
+    std::thread worker;
+    Waiter input;
+    std::atomic<bool> stopping{false};
+
+    std::mutex taskMutex;
+    std::vector<std::function<void()>> tasks;
+    std::atomic<bool> hasTasks{false};
+
+    std::vector<MarketEvent> released;
+    int64_t lastReleasedNs = INT64_MIN;
+    std::atomic<uint64_t> merged{0};
+    std::atomic<uint64_t> outOfOrder{0};
+};
+
+#endif
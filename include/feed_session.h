@@ -0,0 +1,211 @@
+#ifndef FEED_SESSION_H
+#define FEED_SESSION_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "market_data.h"
+#include "thread_util.h"
+
+using std::string;
+
+class SessionPool;
+
+struct FeedSessionConfig {
+    // Reconnect delays grow from backoffInitial by backoffMultiplier per
+    // failed attempt up to backoffMax; each delay is drawn uniformly from
+    // the upper half of that window so clients do not reconnect in lockstep.
+    std::chrono::milliseconds backoffInitial{250};
+    std::chrono::milliseconds backoffMax{30000};
+    double backoffMultiplier = 2.0;
+
+    // A ping goes out every pingInterval; no pong within pongTimeout closes
+    // the connection and reconnects. 0 disables the liveness check.
+    std::chrono::milliseconds pingInterval{5000};
+    std::chrono::milliseconds pongTimeout{3000};
+
+    // Bar spacing of the stream; a bar further than this after the previous
+    // one for its symbol opens a gap. 0 disables gap detection.
+    std::chrono::seconds barInterval{60};
+    string barTimeframe = "1Min";
+    // Live bars held back per symbol while its gap is filled; past this the
+    // gap is given up and the bars go downstream as they are.
+    size_t maxHeldBars = 1024;
+
+    // Gaps are filled from the local bar store first, then from the REST
+    // historical bars endpoint. Either source is skipped when empty.
+    string barStoreRoot;
+    string restHost = "data.alpaca.markets";
+    string restPort = "443";
+    string barsTarget = "/v1beta3/crypto/us/bars";
+    // The backfill thread's placement.
+    ThreadPlacement backfillThread;
+};
+
+struct FeedSessionStats {
+    uint64_t connects = 0;
+    uint64_t reconnects = 0;
+    uint64_t failures = 0;
+    uint64_t pongTimeouts = 0;
+    uint64_t gaps = 0;
+    // Bars the gaps were missing, by bar interval, and how many were found.
+    uint64_t missingBars = 0;
+    uint64_t backfilledBars = 0;
+    uint64_t duplicateBars = 0;
+    // Gaps given up on because too many live bars arrived meanwhile.
+    uint64_t abandonedGaps = 0;
+
+    FeedSessionStats& operator+=(const FeedSessionStats& other) {
+        connects += other.connects;
+        reconnects += other.reconnects;
+        failures += other.failures;
+        pongTimeouts += other.pongTimeouts;
+        gaps += other.gaps;
+        missingBars += other.missingBars;
+        backfilledBars += other.backfilledBars;
+        duplicateBars += other.duplicateBars;
+        abandonedGaps += other.abandonedGaps;
+        return *this;
+    }
+};
+
+// Jittered exponential backoff for reconnects. Not thread-safe.
+class Backoff {
+public:
+    explicit Backoff(const FeedSessionConfig& config = FeedSessionConfig());
+
+    std::chrono::milliseconds next();
+    void reset() { attempt = 0; }
+    unsigned attempts() const { return attempt; }
+
+private:
+    std::chrono::milliseconds initial;
+    std::chrono::milliseconds max;
+    double multiplier;
+    unsigned attempt = 0;
+    std::mt19937_64 rng;
+};
+
+// What the stream is subscribed to, per channel, so it can be replayed
+// after a reconnect.
+class SubscriptionSet {
+public:
+    void add(const string& channel, const std::vector<string>& symbols);
+    void remove(const string& channel, const std::vector<string>& symbols);
+
+    std::vector<string> symbols(const string& channel) const;
+    bool empty() const;
+    // One subscribe message for every channel, or "" when there is nothing
+    // to subscribe to.
+    string subscribeMessage() const;
+
+private:
+    mutable std::mutex mutex;
+    std::map<string, std::set<string>> channels;
+};
+
+// Bars of one symbol missing between two received bars, exclusive.
+struct BarGap {
+    uint32_t symbolId = 0;
+    int64_t afterNs = 0;
+    int64_t beforeNs = 0;
+    int64_t intervalNs = 0;
+
+    size_t missing() const {
+        return intervalNs > 0 ? static_cast<size_t>((beforeNs - afterNs) / intervalNs - 1) : 0;
+    }
+};
+
+// Per-symbol bar sequencing on the feed thread. A bar that arrives more
+// than one interval after its predecessor opens a gap: it and every later
+// bar of that symbol are held until complete() hands over the backfill,
+// so everything downstream still sees the symbol's bars in time order.
+// Repeated or older bars, e.g. resent after a reconnect, are dropped.
+class GapDetector {
+public:
+    GapDetector(std::chrono::nanoseconds interval, size_t maxHeld);
+
+    // Appends the bars that may go downstream now to out. Returns true when
+    // this bar opened a gap, described in gap, that should be backfilled.
+    bool onBar(const CompactBar& bar, std::vector<CompactBar>& out, BarGap& gap);
+    // Ends the symbol's gap: appends the backfilled bars that fall inside
+    // it, then the bars held meanwhile. bars may be empty or unsorted.
+    void complete(const BarGap& gap, std::vector<CompactBar> bars, std::vector<CompactBar>& out);
+
+    bool pending(uint32_t symbolId) const;
+
+    // Fills the gap-related fields.
+    void stats(FeedSessionStats& out) const;
+
+private:
+    struct SymbolGap {
+        int64_t lastNs = 0;
+        bool pending = false;
+        BarGap gap;
+        std::vector<CompactBar> held;
+    };
+
+    const int64_t intervalNs;
+    const size_t maxHeld;
+    std::unordered_map<uint32_t, SymbolGap> symbols;
+
+    std::atomic<uint64_t> gaps{0};
+    std::atomic<uint64_t> missing{0};
+    std::atomic<uint64_t> filled{0};
+    std::atomic<uint64_t> duplicates{0};
+    std::atomic<uint64_t> abandoned{0};
+};
+
+// Fetches the bars of a gap on a background thread and hands them to the
+// callback, also on that thread. fetch() does the same synchronously.
+class BarBackfill {
+public:
+    typedef std::function<void(const BarGap&, std::vector<CompactBar>)> Callback;
+
+    BarBackfill(const FeedSessionConfig& config, const string& apiKey, const string& apiSecretKey);
+    ~BarBackfill();
+
+    BarBackfill(const BarBackfill&) = delete;
+    BarBackfill& operator=(const BarBackfill&) = delete;
+
+    void start(Callback callback);
+    // Drops gaps not yet fetched.
+    void stop();
+
+    void request(const BarGap& gap);
+
+    // Bars strictly inside the gap, oldest first; what the sources had.
+    std::vector<CompactBar> fetch(const BarGap& gap);
+
+private:
+    void run();
+    void fetchStore(const BarGap& gap, std::vector<CompactBar>& out) const;
+    void fetchRest(const BarGap& gap, std::vector<CompactBar>& out);
+
+    const FeedSessionConfig cfg;
+    const string ALPACA_API_KEY;
+    const string ALPACA_API_SECRET_KEY;
+    std::unique_ptr<SessionPool> rest;
+
+    Callback done;
+    std::thread worker;
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::deque<BarGap> queue;
+    bool stopping = false;
+};
+
+#endif
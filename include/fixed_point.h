@@ -0,0 +1,167 @@
+#ifndef FIXED_POINT_H
+#define FIXED_POINT_H
+
+#include <charconv>
+#include <cmath>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Prices and quantities are carried as int64 counts of 10^-decimals units.
+// The decimals are a per-symbol property kept in the SymbolTable.
+namespace fixed_point {
+
+    constexpr uint8_t MAX_DECIMALS = 18;
+
+    constexpr int64_t POW10[MAX_DECIMALS + 1] = {
+        1LL, 10LL, 100LL, 1000LL, 10000LL, 100000LL, 1000000LL, 10000000LL, 100000000LL,
+        1000000000LL, 10000000000LL, 100000000000LL, 1000000000000LL, 10000000000000LL,
+        100000000000000LL, 1000000000000000LL, 10000000000000000LL, 100000000000000000LL,
+        1000000000000000000LL
+    };
+
+    inline int64_t fromDouble(double value, uint8_t decimals) {
+        return std::llround(value * static_cast<double>(POW10[decimals]));
+    }
+
+    inline double toDouble(int64_t value, uint8_t decimals) {
+        return static_cast<double>(value) / static_cast<double>(POW10[decimals]);
+    }
+
+    // Converts between two scales, rounding half away from zero when narrowing.
+    inline int64_t rescale(int64_t value, uint8_t from, uint8_t to) {
+        if (from == to) return value;
+        if (to > from) return value * POW10[to - from];
+        int64_t divisor = POW10[from - to];
+        int64_t half = divisor / 2;
+        return value >= 0 ? (value + half) / divisor : (value - half) / divisor;
+    }
+
+    // Formats without going through a double; trailing fractional zeros are
+    // dropped ("0.001", "42").
+    inline std::string toString(int64_t value, uint8_t decimals) {
+        uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+        uint64_t scale = static_cast<uint64_t>(POW10[decimals]);
+        std::string text = value < 0 ? "-" : "";
+        text += std::to_string(magnitude / scale);
+
+        uint64_t fraction = magnitude % scale;
+        if (fraction != 0) {
+            std::string digits = std::to_string(fraction);
+            digits.insert(0, decimals - digits.size(), '0');
+            digits.erase(digits.find_last_not_of('0') + 1);
+            text += '.';
+            text += digits;
+        }
+        return text;
+    }
+
+    // toString() into [first, last) with std::to_chars and no allocation.
+    // Returns one past the last character written, or nullptr if it did not fit.
+    inline char* toChars(char* first, char* last, int64_t value, uint8_t decimals) {
+        uint64_t magnitude = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+        uint64_t scale = static_cast<uint64_t>(POW10[decimals]);
+        if (value < 0) {
+            if (first == last) return nullptr;
+            *first++ = '-';
+        }
+        auto whole = std::to_chars(first, last, magnitude / scale);
+        if (whole.ec != std::errc()) return nullptr;
+        first = whole.ptr;
+
+        uint64_t fraction = magnitude % scale;
+        if (fraction == 0) return first;
+        int digits = decimals;
+        while (fraction % 10 == 0) {
+            fraction /= 10;
+            --digits;
+        }
+        if (last - first < digits + 1) return nullptr;
+        *first++ = '.';
+        for (int i = digits - 1; i >= 0; --i) {
+            first[i] = static_cast<char>('0' + fraction % 10);
+            fraction /= 10;
+        }
+        return first + digits;
+    }
+
+    // Parses a JSON number ("-12.345", "1.5e-05") straight into fixed point
+    // without going through a double. Digits beyond the scale are rounded.
+    // Returns false on syntax errors or overflow.
+    inline bool parse(std::string_view text, uint8_t decimals, int64_t& out) {
+        size_t i = 0;
+        bool negative = false;
+        if (i < text.size() && (text[i] == '-' || text[i] == '+')) {
+            negative = text[i] == '-';
+            ++i;
+        }
+
+        uint64_t mantissa = 0;
+        int exponent = 0;
+        int significant = 0;
+        bool anyDigit = false;
+        bool roundUp = false;
+
+        auto accumulate = [&](char ch, bool fractional) {
+            anyDigit = true;
+            if (significant < 18) {
+                if (mantissa != 0 || ch != '0') ++significant;
+                mantissa = mantissa * 10 + static_cast<uint64_t>(ch - '0');
+                if (fractional) --exponent;
+            } else {
+                if (significant == 18) {
+                    roundUp = ch >= '5';
+                    ++significant;
+                }
+                if (!fractional) ++exponent;
+            }
+        };
+
+        for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i) accumulate(text[i], false);
+        if (i < text.size() && text[i] == '.') {
+            for (++i; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i) accumulate(text[i], true);
+        }
+        if (!anyDigit) return false;
+
+        if (i < text.size() && (text[i] == 'e' || text[i] == 'E')) {
+            ++i;
+            bool negativeExp = false;
+            if (i < text.size() && (text[i] == '-' || text[i] == '+')) {
+                negativeExp = text[i] == '-';
+                ++i;
+            }
+            int e = 0;
+            bool expDigit = false;
+            for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i) {
+                expDigit = true;
+                if (e < 1000) e = e * 10 + (text[i] - '0');
+            }
+            if (!expDigit) return false;
+            exponent += negativeExp ? -e : e;
+        }
+        if (i != text.size()) return false;
+
+        if (roundUp) ++mantissa;
+
+        int shift = exponent + decimals;
+        if (shift >= 0) {
+            if (shift > MAX_DECIMALS) return mantissa == 0 ? (out = 0, true) : false;
+            if (mantissa > static_cast<uint64_t>(INT64_MAX) / static_cast<uint64_t>(POW10[shift])) return false;
+            mantissa *= static_cast<uint64_t>(POW10[shift]);
+        } else {
+            if (-shift > MAX_DECIMALS) {
+                mantissa = 0;
+            } else {
+                uint64_t divisor = static_cast<uint64_t>(POW10[-shift]);
+                mantissa = (mantissa + divisor / 2) / divisor;
+            }
+        }
+        if (mantissa > static_cast<uint64_t>(INT64_MAX)) return false;
+
+        out = negative ? -static_cast<int64_t>(mantissa) : static_cast<int64_t>(mantissa);
+        return true;
+    }
+
+}
+
+#endif
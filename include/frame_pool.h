@@ -0,0 +1,85 @@
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <websocketpp/config/asio_client.hpp>
+#include <websocketpp/message_buffer/message.hpp>
+
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace frame_pool {
+    // websocketpp's default message manager makes a new message, and a new
+    // payload string, for every frame read or sent. This one keeps the
+    // messages of its connection and hands one out again once nobody else
+    // holds it, with the payload capacity it grew to, so a connection in
+    // steady state reads and writes frames without touching the heap.
+    // Reads happen on the connection's thread and sends may come from any
+    // thread, hence the mutex.
+    template <typename message>
+    class con_msg_manager : public websocketpp::lib::enable_shared_from_this<con_msg_manager<message>> {
+    public:
+        typedef con_msg_manager<message> type;
+        typedef websocketpp::lib::shared_ptr<con_msg_manager> ptr;
+        typedef websocketpp::lib::weak_ptr<con_msg_manager> weak_ptr;
+        typedef typename message::ptr message_ptr;
+
+        // Messages kept per connection; a burst beyond this falls back to
+        // one-off messages.
+        static constexpr size_t MAX_POOLED = 64;
+
+        message_ptr get_message() {
+            return get_message(websocketpp::frame::opcode::text, 0);
+        }
+
+        message_ptr get_message(websocketpp::frame::opcode::value op, size_t size) {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (const message_ptr& msg : pooled) {
+                // Only the pool holds it: the last frame it carried is done.
+                if (msg.use_count() != 1) continue;
+                msg->set_opcode(op);
+                msg->set_prepared(false);
+                msg->set_fin(true);
+                msg->set_terminal(false);
+                msg->set_compressed(false);
+                msg->set_header(empty);
+                std::string& payload = msg->get_raw_payload();
+                payload.clear();
+                payload.reserve(size);
+                return msg;
+            }
+            message_ptr msg = websocketpp::lib::make_shared<message>(type::shared_from_this(), op, size);
+            if (pooled.size() < MAX_POOLED) pooled.push_back(msg);
+            return msg;
+        }
+
+        // Messages come back through use_count(), not through recycle().
+        bool recycle(message*) { return false; }
+
+    private:
+        std::mutex mutex;
+        std::vector<message_ptr> pooled;
+        const std::string empty;
+    };
+
+    template <typename con_msg_manager>
+    class endpoint_msg_manager {
+    public:
+        typedef typename con_msg_manager::ptr con_msg_man_ptr;
+
+        con_msg_man_ptr get_manager(websocketpp::connection_hdl) const {
+            return websocketpp::lib::make_shared<con_msg_manager>();
+        }
+    };
+}
+
+// asio_tls_client with pooled frame buffers; see frame_pool::con_msg_manager.
+struct pooled_asio_tls_client : public websocketpp::config::asio_tls_client {
+    typedef pooled_asio_tls_client type;
+
+    typedef websocketpp::message_buffer::message<frame_pool::con_msg_manager> message_type;
+    typedef frame_pool::con_msg_manager<message_type> con_msg_manager_type;
+    typedef frame_pool::endpoint_msg_manager<con_msg_manager_type> endpoint_msg_manager_type;
+};
+
+#endif
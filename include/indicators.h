@@ -0,0 +1,432 @@
+#ifndef INDICATORS_H
+#define INDICATORS_H
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+// Streaming technical indicators with O(1) updates. Window lengths are
+// template parameters, so each indicator is a fixed-size object with its
+// history in an inline ring buffer and can live on the stack or inside
+// per-symbol strategy state without touching the heap.
+//
+// Inputs are doubles; callers holding fixed-point bars convert with
+// fixed_point::toDouble at the symbol's decimals. Every indicator reports
+// ready() once it has seen enough samples for value() to be meaningful.
+namespace indicators {
+
+    // Fixed-capacity FIFO holding the last N samples.
+    template <typename T, size_t N>
+    class RingWindow {
+        static_assert(N > 0, "window must hold at least one sample");
+
+    public:
+        // Appends value and returns the sample it displaced (T() until full).
+        T push(T value) {
+            T evicted = full() ? values[head] : T();
+            values[head] = value;
+            head = head + 1 == N ? 0 : head + 1;
+            if (count < N) ++count;
+            return evicted;
+        }
+
+        // i = 0 is the oldest sample still in the window.
+        const T& operator[](size_t i) const {
+            size_t index = (full() ? head : 0) + i;
+            return values[index >= N ? index - N : index];
+        }
+
+        size_t size() const { return count; }
+        bool full() const { return count == N; }
+        // True right after a push that completed a lap of the ring.
+        bool wrapped() const { return head == 0 && full(); }
+
+    private:
+        std::array<T, N> values{};
+        size_t head = 0;
+        size_t count = 0;
+    };
+
+    template <size_t N>
+    class Sma {
+    public:
+        double update(double value) {
+            sum += value - window.push(value);
+            // Re-summing once per lap keeps rounding drift from the running
+            // sum bounded at O(1) amortised cost.
+            if (window.wrapped()) {
+                sum = 0;
+                for (size_t i = 0; i < N; ++i) sum += window[i];
+            }
+            return value_();
+        }
+
+        double value() const { return value_(); }
+        bool ready() const { return window.full(); }
+
+    private:
+        double value_() const { return window.size() ? sum / static_cast<double>(window.size()) : 0; }
+
+        RingWindow<double, N> window;
+        double sum = 0;
+    };
+
+    // Exponential moving average with alpha = 2 / (N + 1), seeded with the
+    // simple average of the first N samples.
+    template <size_t N>
+    class Ema {
+    public:
+        static constexpr double ALPHA = 2.0 / (static_cast<double>(N) + 1.0);
+
+        double update(double value) {
+            if (seen < N) {
+                current += (value - current) / static_cast<double>(++seen);
+            } else {
+                current += ALPHA * (value - current);
+            }
+            return current;
+        }
+
+        double value() const { return current; }
+        bool ready() const { return seen >= N; }
+
+    private:
+        double current = 0;
+        size_t seen = 0;
+    };
+
+    // Volume-weighted average price over the last N bars.
+    template <size_t N>
+    class RollingVwap {
+    public:
+        double update(double price, double volume) {
+            Sample evicted = window.push(Sample{price * volume, volume});
+            notional += price * volume - evicted.notional;
+            totalVolume += volume - evicted.volume;
+            if (window.wrapped()) {
+                notional = totalVolume = 0;
+                for (size_t i = 0; i < N; ++i) {
+                    notional += window[i].notional;
+                    totalVolume += window[i].volume;
+                }
+            }
+            return value();
+        }
+
+        double value() const { return totalVolume > 0 ? notional / totalVolume : 0; }
+        double volume() const { return totalVolume; }
+        bool ready() const { return window.full(); }
+
+    private:
+        struct Sample {
+            double notional;
+            double volume;
+        };
+
+        RingWindow<Sample, N> window;
+        double notional = 0;
+        double totalVolume = 0;
+    };
+
+    // Rolling minimum or maximum with a monotonic deque: each sample is
+    // pushed and popped at most once, so updates are amortised O(1).
+    template <size_t N, typename Compare>
+    class RollingExtremum {
+    public:
+        double update(double value) {
+            ++sequence;
+            while (count > 0 && !Compare()(entries[slot(count - 1)].value, value)) {
+                --count;
+            }
+            entries[slot(count)] = Entry{sequence, value};
+            ++count;
+            if (entries[front].sequence + N <= sequence) {
+                front = slot(1);
+                --count;
+            }
+            return entries[front].value;
+        }
+
+        double value() const { return count ? entries[front].value : 0; }
+        bool ready() const { return sequence >= N; }
+
+    private:
+        // One spare slot: the incoming sample is stored before the expired
+        // front is dropped.
+        static constexpr size_t CAPACITY = N + 1;
+
+        struct Entry {
+            uint64_t sequence;
+            double value;
+        };
+
+        size_t slot(size_t offset) const {
+            size_t index = front + offset;
+            return index >= CAPACITY ? index - CAPACITY : index;
+        }
+
+        std::array<Entry, CAPACITY> entries{};
+        size_t front = 0;
+        size_t count = 0;
+        uint64_t sequence = 0;
+    };
+
+    template <size_t N>
+    using RollingMin = RollingExtremum<N, std::less<double>>;
+
+    template <size_t N>
+    using RollingMax = RollingExtremum<N, std::greater<double>>;
+
+    // Windowed mean and variance with Welford's update, adding the new
+    // sample and retiring the evicted one in a single step.
+    template <size_t N>
+    class RollingVariance {
+    public:
+        void update(double value) {
+            const bool wasFull = window.full();
+            const double evicted = window.push(value);
+            if (!wasFull) {
+                const double delta = value - avg;
+                avg += delta / static_cast<double>(window.size());
+                m2 += delta * (value - avg);
+            } else {
+                const double previous = avg;
+                avg += (value - evicted) / static_cast<double>(N);
+                m2 += (value - evicted) * (value - avg + evicted - previous);
+            }
+            if (m2 < 0) m2 = 0;
+        }
+
+        double mean() const { return avg; }
+        // Population variance over the window.
+        double variance() const { return window.size() ? m2 / static_cast<double>(window.size()) : 0; }
+        double sampleVariance() const { return window.size() > 1 ? m2 / static_cast<double>(window.size() - 1) : 0; }
+        double stddev() const { return std::sqrt(variance()); }
+
+        // Standard score of value against the current window; 0 when flat.
+        double zScore(double value) const {
+            const double sd = stddev();
+            return sd > 0 ? (value - avg) / sd : 0;
+        }
+
+        bool ready() const { return window.full(); }
+
+    private:
+        RingWindow<double, N> window;
+        double avg = 0;
+        double m2 = 0;
+    };
+
+    // Average true range with Wilder's smoothing, seeded with the simple
+    // average of the first N true ranges.
+    template <size_t N>
+    class Atr {
+    public:
+        double update(double high, double low, double close) {
+            double range = high - low;
+            if (seen > 0) {
+                range = std::max(range, std::max(std::fabs(high - previousClose), std::fabs(low - previousClose)));
+            }
+            previousClose = close;
+
+            if (seen < N) {
+                current += (range - current) / static_cast<double>(++seen);
+            } else {
+                current = (current * static_cast<double>(N - 1) + range) / static_cast<double>(N);
+            }
+            return current;
+        }
+
+        double value() const { return current; }
+        bool ready() const { return seen >= N; }
+
+    private:
+        double current = 0;
+        double previousClose = 0;
+        size_t seen = 0;
+    };
+
+    // Relative strength index (0-100) with Wilder's smoothing.
+    template <size_t N>
+    class Rsi {
+    public:
+        double update(double close) {
+            if (!primed) {
+                primed = true;
+                previousClose = close;
+                return value();
+            }
+
+            const double change = close - previousClose;
+            previousClose = close;
+            const double gain = change > 0 ? change : 0;
+            const double loss = change < 0 ? -change : 0;
+
+            if (seen < N) {
+                ++seen;
+                averageGain += (gain - averageGain) / static_cast<double>(seen);
+                averageLoss += (loss - averageLoss) / static_cast<double>(seen);
+            } else {
+                averageGain = (averageGain * static_cast<double>(N - 1) + gain) / static_cast<double>(N);
+                averageLoss = (averageLoss * static_cast<double>(N - 1) + loss) / static_cast<double>(N);
+            }
+            return value();
+        }
+
+        double value() const {
+            if (averageLoss == 0) return averageGain == 0 ? 50.0 : 100.0;
+            return 100.0 - 100.0 / (1.0 + averageGain / averageLoss);
+        }
+
+        bool ready() const { return seen >= N; }
+
+    private:
+        double averageGain = 0;
+        double averageLoss = 0;
+        double previousClose = 0;
+        size_t seen = 0;
+        bool primed = false;
+    };
+
+    // Batch versions over a whole column (e.g. the close prices of a stored
+    // bar history), used for backtests and warm-up. Each kernel is split into
+    // a short sequential scan and element-wise passes over __restrict
+    // pointers with no loop-carried dependency, which the compiler turns into
+    // SIMD at -O3. out[i] covers in[i - window + 1 .. i]; the first
+    // window - 1 outputs are NaN. T is double or a fixed-point integer
+    // column, with scale converting it to doubles (e.g. 1e-8).
+    namespace batch {
+
+        namespace detail {
+            // prefix[i] = sum of in[0 .. i - 1] * scale; prefix has n + 1 entries.
+            template <typename T, typename F>
+            void prefixSum(const T* in, size_t n, double scale, double* prefix, F&& transform) {
+                prefix[0] = 0;
+                double running = 0;
+                for (size_t i = 0; i < n; ++i) {
+                    running += transform(static_cast<double>(in[i]) * scale);
+                    prefix[i + 1] = running;
+                }
+            }
+
+            inline void fillWarmup(double* out, size_t n, size_t window) {
+                std::fill(out, out + std::min(n, window - 1), std::numeric_limits<double>::quiet_NaN());
+            }
+        }
+
+        template <typename T>
+        void sma(const T* in, size_t n, size_t window, double* out, double scale = 1.0) {
+            if (n == 0 || window == 0) return;
+            std::vector<double> prefix(n + 1);
+            detail::prefixSum(in, n, scale, prefix.data(), [](double x) { return x; });
+
+            const double inverse = 1.0 / static_cast<double>(window);
+            const double* __restrict upper = prefix.data() + window;
+            const double* __restrict lower = prefix.data();
+            double* __restrict dst = out + window - 1;
+            for (size_t i = 0; i + window <= n; ++i) {
+                dst[i] = (upper[i] - lower[i]) * inverse;
+            }
+            detail::fillWarmup(out, n, window);
+        }
+
+        template <typename P, typename V>
+        void rollingVwap(const P* price, const V* volume, size_t n, size_t window, double* out,
+                         double priceScale = 1.0, double volumeScale = 1.0) {
+            if (n == 0 || window == 0) return;
+            std::vector<double> notional(n + 1), traded(n + 1);
+            notional[0] = 0;
+            double running = 0;
+            for (size_t i = 0; i < n; ++i) {
+                running += static_cast<double>(price[i]) * priceScale * static_cast<double>(volume[i]) * volumeScale;
+                notional[i + 1] = running;
+            }
+            detail::prefixSum(volume, n, volumeScale, traded.data(), [](double x) { return x; });
+
+            const double* __restrict nu = notional.data() + window;
+            const double* __restrict nl = notional.data();
+            const double* __restrict vu = traded.data() + window;
+            const double* __restrict vl = traded.data();
+            double* __restrict dst = out + window - 1;
+            for (size_t i = 0; i + window <= n; ++i) {
+                const double vol = vu[i] - vl[i];
+                dst[i] = vol > 0 ? (nu[i] - nl[i]) / vol : 0;
+            }
+            detail::fillWarmup(out, n, window);
+        }
+
+        // van Herk/Gil-Werman: per-block prefix and suffix extremes, then one
+        // element-wise combine. Three comparisons per sample for any window.
+        template <typename T, typename Pick>
+        void rollingExtremum(const T* in, size_t n, size_t window, double* out, double scale, Pick pick) {
+            if (n == 0 || window == 0) return;
+            std::vector<double> prefix(n), suffix(n);
+
+            for (size_t start = 0; start < n; start += window) {
+                const size_t end = std::min(n, start + window);
+                prefix[start] = static_cast<double>(in[start]) * scale;
+                for (size_t i = start + 1; i < end; ++i) {
+                    prefix[i] = pick(prefix[i - 1], static_cast<double>(in[i]) * scale);
+                }
+                suffix[end - 1] = static_cast<double>(in[end - 1]) * scale;
+                for (size_t i = end - 1; i > start; --i) {
+                    suffix[i - 1] = pick(suffix[i], static_cast<double>(in[i - 1]) * scale);
+                }
+            }
+
+            const double* __restrict s = suffix.data();
+            const double* __restrict p = prefix.data() + window - 1;
+            double* __restrict dst = out + window - 1;
+            for (size_t i = 0; i + window <= n; ++i) {
+                dst[i] = pick(s[i], p[i]);
+            }
+            detail::fillWarmup(out, n, window);
+        }
+
+        template <typename T>
+        void rollingMin(const T* in, size_t n, size_t window, double* out, double scale = 1.0) {
+            rollingExtremum(in, n, window, out, scale, [](double a, double b) { return b < a ? b : a; });
+        }
+
+        template <typename T>
+        void rollingMax(const T* in, size_t n, size_t window, double* out, double scale = 1.0) {
+            rollingExtremum(in, n, window, out, scale, [](double a, double b) { return b > a ? b : a; });
+        }
+
+        // Rolling z-score of each sample against its own window. Values are
+        // centred on the first sample before the sum-of-squares prefix to
+        // limit cancellation.
+        template <typename T>
+        void zScore(const T* in, size_t n, size_t window, double* out, double scale = 1.0) {
+            if (n == 0 || window == 0) return;
+            std::vector<double> sums(n + 1), sumSquares(n + 1);
+            const double origin = static_cast<double>(in[0]) * scale;
+            detail::prefixSum(in, n, scale, sums.data(), [origin](double x) { return x - origin; });
+            detail::prefixSum(in, n, scale, sumSquares.data(), [origin](double x) { return (x - origin) * (x - origin); });
+
+            const double inverse = 1.0 / static_cast<double>(window);
+            const T* __restrict x = in + window - 1;
+            const double* __restrict su = sums.data() + window;
+            const double* __restrict sl = sums.data();
+            const double* __restrict qu = sumSquares.data() + window;
+            const double* __restrict ql = sumSquares.data();
+            double* __restrict dst = out + window - 1;
+            for (size_t i = 0; i + window <= n; ++i) {
+                const double mean = (su[i] - sl[i]) * inverse;
+                const double variance = std::max(0.0, (qu[i] - ql[i]) * inverse - mean * mean);
+                const double sd = std::sqrt(variance);
+                dst[i] = sd > 0 ? (static_cast<double>(x[i]) * scale - origin - mean) / sd : 0;
+            }
+            detail::fillWarmup(out, n, window);
+        }
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,125 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <thread>
+
+using std::string;
+
+// Append-only, memory-mapped capture of raw feed frames.
+//
+// File layout: a 16-byte header ("HFTJRNL" NUL, uint32 version, uint32
+// reserved) followed by records, each padded to 8 bytes:
+//   uint32 length | uint32 reserved | int64 receiveNs | payload[length]
+// The length is stored after the payload, so a zero length marks the end
+// of the journal even if the writer died mid-record.
+struct JournalRecord {
+    int64_t receiveNs;
+    std::string_view payload;
+};
+
+struct JournalWriterConfig {
+    // The file is extended (and its blocks allocated) this much at a time,
+    // so appends are a memcpy and only every growth step touches the kernel.
+    size_t growBytes = size_t(64) << 20;
+};
+
+// Single writer; meant to be called from the feed thread.
+class JournalWriter {
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    explicit JournalWriter(const string& path, JournalWriterConfig config = JournalWriterConfig());
+    ~JournalWriter();
+
+    JournalWriter(const JournalWriter&) = delete;
+    JournalWriter& operator=(const JournalWriter&) = delete;
+
+    // Empty payloads are not recorded; a zero length is the end marker.
+    void append(int64_t receiveNs, std::string_view payload);
+    // Schedules write-back of what has been appended so far without waiting.
+    void flush();
+    // Trims the file to the bytes written and unmaps it; called by the
+    // destructor.
+    void close();
+
+    uint64_t records() const { return count; }
+    size_t bytes() const { return used; }
+
+private:
+    void grow(size_t need);
+
+    JournalWriterConfig cfg;
+    int fd = -1;
+    char* base = nullptr;
+    size_t mapped = 0;
+    size_t used = 0;
+    uint64_t count = 0;
+};
+
+class JournalReader {
+public:
+    explicit JournalReader(const string& path);
+    ~JournalReader();
+
+    JournalReader(const JournalReader&) = delete;
+    JournalReader& operator=(const JournalReader&) = delete;
+
+    // Payloads point into the mapping and stay valid for the reader's lifetime.
+    bool next(JournalRecord& record);
+    void rewind();
+
+private:
+    int fd = -1;
+    const char* base = nullptr;
+    size_t size = 0;
+    size_t offset = 0;
+};
+
+struct ReplayConfig {
+    // 0 replays as fast as possible, 1 at the recorded pace, 2 twice as fast.
+    double speed = 0;
+};
+
+struct ReplayStats {
+    uint64_t frames = 0;
+    uint64_t bytes = 0;
+    // Receive-time span covered by the journal and the wall time replay took.
+    int64_t recordedNs = 0;
+    int64_t elapsedNs = 0;
+};
+
+// Feeds every record to sink(const JournalRecord&) in journal order, paced
+// on the recorded receive timestamps. Pacing only changes when a frame is
+// delivered, never which frames or in what order.
+template <typename Sink>
+ReplayStats replayJournal(JournalReader& reader, const ReplayConfig& config, Sink&& sink) {
+    ReplayStats stats;
+    const auto start = std::chrono::steady_clock::now();
+    int64_t first = 0;
+
+    JournalRecord record;
+    while (reader.next(record)) {
+        if (stats.frames == 0) first = record.receiveNs;
+        stats.recordedNs = record.receiveNs - first;
+
+        if (config.speed > 0) {
+            auto offset = std::chrono::nanoseconds(static_cast<int64_t>(stats.recordedNs / config.speed));
+            std::this_thread::sleep_until(start + offset);
+        }
+
+        sink(record);
+        ++stats.frames;
+        stats.bytes += record.payload.size();
+    }
+
+    stats.elapsedNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef LATENCY_H
+#define LATENCY_H
+
+#include <cstdint>
+#include <string>
+
+#include "tsc.h"
+
+// Build with -DHFT_LATENCY=0 (cmake -DHFT_LATENCY=OFF) to compile every
+// stamp and record below down to nothing.
+#ifndef HFT_LATENCY
+#define HFT_LATENCY 1
+#endif
+
+using std::string;
+
+// Tick-to-order latency tracing. The feed thread stamps each frame when it
+// arrives; the stamp travels with the frame's events and the orders they
+// lead to, and each stage records the time since an earlier stamp.
+// Samples go to a lock-free ring owned by the recording thread and are only
+// turned into histograms when someone asks for a report.
+namespace latency {
+    constexpr bool enabled = HFT_LATENCY != 0;
+
+    enum class Stage : uint8_t {
+        Decode,      // frame received -> events decoded
+        Strategy,    // frame received -> strategy emitted the intent
+        Batch,       // intent -> released by the order batcher (when batching)
+        Serialize,   // intent -> order request built (includes the hand-off wait)
+        Write,       // request built -> last byte written to the socket
+        Response,    // request written -> response read
+        EndToEnd,    // frame received -> response read
+        Count
+    };
+
+    const char* stageName(Stage stage);
+
+    // Raw timestamp counter (tsc::nowOrdered); 0 when tracing is compiled out.
+    inline uint64_t now() {
+#if HFT_LATENCY
+        return tsc::nowOrdered();
+#else
+        return 0;
+#endif
+    }
+
+    inline double nsPerTick() { return enabled ? tsc::nsPerTick() : 1.0; }
+
+    struct Sample {
+        uint64_t ticks;
+        Stage stage;
+    };
+
+    // Returns false if the calling thread's ring was full and the sample was
+    // dropped.
+    bool push(const Sample& sample);
+
+    // Samples with a missing (0) or later start are ignored.
+    inline void record(Stage stage, uint64_t startTicks, uint64_t endTicks) {
+#if HFT_LATENCY
+        if (startTicks != 0 && endTicks >= startTicks) {
+            push(Sample{endTicks - startTicks, stage});
+        }
+#else
+        (void)stage;
+        (void)startTicks;
+        (void)endTicks;
+#endif
+    }
+
+    // Log-linear histogram in the style of HdrHistogram: exact below
+    // 2^SUB_BITS and within 1 / 2^SUB_BITS of the true value above it, over
+    // the whole uint64 range, in a fixed array.
+    class Histogram {
+    public:
+        static constexpr unsigned SUB_BITS = 7;
+        static constexpr size_t SUB_BUCKETS = size_t(1) << SUB_BITS;
+        static constexpr size_t BUCKETS = (64 - SUB_BITS + 1) * SUB_BUCKETS;
+
+        void record(uint64_t value, uint64_t count = 1);
+        void merge(const Histogram& other);
+        void reset();
+
+        uint64_t count() const { return total; }
+        uint64_t min() const { return total ? lowest : 0; }
+        uint64_t max() const { return highest; }
+        double mean() const { return total ? sum / static_cast<double>(total) : 0; }
+        // Smallest recorded bucket's upper bound covering fraction q (0..1)
+        // of the samples.
+        uint64_t quantile(double q) const;
+
+        static size_t indexOf(uint64_t value);
+        static uint64_t highestEquivalent(size_t index);
+
+    private:
+        uint64_t counts[BUCKETS] = {};
+        uint64_t total = 0;
+        uint64_t lowest = UINT64_MAX;
+        uint64_t highest = 0;
+        double sum = 0;
+    };
+
+    // Nanoseconds.
+    struct StageSummary {
+        uint64_t count = 0;
+        double mean = 0;
+        uint64_t min = 0;
+        uint64_t p50 = 0;
+        uint64_t p99 = 0;
+        uint64_t p999 = 0;
+        uint64_t max = 0;
+    };
+
+    struct Report {
+        StageSummary stages[static_cast<size_t>(Stage::Count)];
+        // Samples lost to full thread rings since the last reset.
+        uint64_t drops = 0;
+
+        const StageSummary& operator[](Stage stage) const { return stages[static_cast<size_t>(stage)]; }
+        string format() const;
+    };
+
+    // Drains every thread's ring into the process-wide histograms and
+    // summarizes them. Safe to call from any thread at any time.
+    Report collect();
+    // Drains and then forgets everything recorded so far.
+    void reset();
+}
+
+#endif
@@ -0,0 +1,194 @@
+#ifndef LOGGER_H
+#define LOGGER_H
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "thread_util.h"
+#include "tsc.h"
+
+using std::string;
+
+// Asynchronous binary logging for hot threads. A log call copies a pointer
+// to its static call site (level and format string) and its raw arguments
+// into a fixed-size entry on a lock-free ring owned by the calling thread;
+// a background thread formats entries and writes them to stdout/stderr or
+// to rotating files. Nothing on the calling side locks, allocates, formats
+// or enters the kernel, and a full ring drops the entry instead of waiting.
+//
+//   LOG_INFO("order for {} rejected with {}", symbol, status);
+//
+// "{}" placeholders take the arguments in order. Integers, floating point,
+// bool, char and strings are supported; strings are copied and, with the
+// other arguments, truncated to the entry's ~100 bytes of payload.
+//
+// Levels below HFT_LOG_LEVEL (cmake -DHFT_LOG_LEVEL=...) are compiled out:
+// their arguments are not even evaluated.
+enum class LogLevel : uint8_t {
+    Debug,
+    Info,
+    Warn,
+    Error
+};
+
+#ifndef HFT_LOG_LEVEL
+#define HFT_LOG_LEVEL 1
+#endif
+
+#define HFT_LOG(level, format, ...)                                                           \
+    do {                                                                                      \
+        if constexpr (static_cast<int>(level) >= HFT_LOG_LEVEL) {                             \
+            static constexpr logging::Site hftLogSite{level, __FILE__, __LINE__, format};     \
+            logging::write(hftLogSite, ##__VA_ARGS__);                                        \
+        }                                                                                     \
+    } while (0)
+
+#define LOG_DEBUG(format, ...) HFT_LOG(LogLevel::Debug, format, ##__VA_ARGS__)
+#define LOG_INFO(format, ...) HFT_LOG(LogLevel::Info, format, ##__VA_ARGS__)
+#define LOG_WARN(format, ...) HFT_LOG(LogLevel::Warn, format, ##__VA_ARGS__)
+#define LOG_ERROR(format, ...) HFT_LOG(LogLevel::Error, format, ##__VA_ARGS__)
+
+struct LoggerConfig {
+    // Empty writes Debug/Info to stdout and Warn/Error to stderr. Otherwise
+    // everything goes to path, which is rotated to path.1 ... path.N once it
+    // reaches maxFileBytes.
+    string path;
+    size_t maxFileBytes = size_t(64) << 20;
+    unsigned maxFiles = 5;
+    // Entries per thread ring; applies to threads that log for the first
+    // time after start().
+    size_t threadEntries = 8192;
+    // The writer thread's placement; applied whenever start() is called.
+    ThreadPlacement writerThread;
+};
+
+struct LoggerStats {
+    uint64_t written = 0;
+    uint64_t drops = 0;
+    // One per thread that has logged, until the thread exits and the writer
+    // has drained what it left.
+    size_t threadRings = 0;
+};
+
+namespace logging {
+    struct Site {
+        LogLevel level;
+        const char* file;
+        int line;
+        const char* format;
+    };
+
+    enum class ArgType : uint8_t {
+        Int,
+        Uint,
+        Double,
+        Bool,
+        Char,
+        String
+    };
+
+    // One ring slot: two cache lines.
+    struct alignas(64) Entry {
+        static constexpr size_t PAYLOAD = 110;
+
+        const Site* site;
+        uint64_t ticks;
+        uint8_t size;
+        uint8_t truncated;
+        char payload[PAYLOAD];
+    };
+
+    static_assert(sizeof(Entry) == 128, "log entries must stay two cache lines");
+
+    // Starts the writer thread with the given sinks, or switches the running
+    // one to them. Logging before start() uses the default config.
+    void start(const LoggerConfig& config = LoggerConfig());
+    // Writes everything logged so far and stops the writer thread. Also
+    // runs at exit.
+    void stop();
+    // Returns once everything logged before the call has been written.
+    void flush();
+    LoggerStats stats();
+
+    // Appends to the calling thread's ring; false if it was full and the
+    // entry was dropped (and counted).
+    bool push(const Entry& entry);
+
+    namespace detail {
+        class ArgWriter {
+        public:
+            explicit ArgWriter(Entry& entry) : entry(entry) {}
+
+            template <typename T>
+            void put(const T& value) {
+                if constexpr (std::is_same_v<T, bool>) {
+                    raw(ArgType::Bool, static_cast<uint8_t>(value));
+                } else if constexpr (std::is_same_v<T, char>) {
+                    raw(ArgType::Char, value);
+                } else if constexpr (std::is_enum_v<T>) {
+                    put(static_cast<std::underlying_type_t<T>>(value));
+                } else if constexpr (std::is_integral_v<T> && std::is_signed_v<T>) {
+                    raw(ArgType::Int, static_cast<int64_t>(value));
+                } else if constexpr (std::is_integral_v<T>) {
+                    raw(ArgType::Uint, static_cast<uint64_t>(value));
+                } else if constexpr (std::is_floating_point_v<T>) {
+                    raw(ArgType::Double, static_cast<double>(value));
+                } else if constexpr (std::is_pointer_v<T>) {
+                    text(value ? std::string_view(value) : std::string_view("(null)"));
+                } else {
+                    text(std::string_view(value));
+                }
+            }
+
+        private:
+            template <typename V>
+            void raw(ArgType type, V value) {
+                if (entry.size + 1 + sizeof(V) > Entry::PAYLOAD) {
+                    entry.truncated = 1;
+                    return;
+                }
+                entry.payload[entry.size] = static_cast<char>(type);
+                std::memcpy(entry.payload + entry.size + 1, &value, sizeof(V));
+                entry.size = static_cast<uint8_t>(entry.size + 1 + sizeof(V));
+            }
+
+            void text(std::string_view value) {
+                if (size_t(entry.size) + 2 > Entry::PAYLOAD) {
+                    entry.truncated = 1;
+                    return;
+                }
+                size_t room = Entry::PAYLOAD - entry.size - 2;
+                if (value.size() > room) {
+                    value = value.substr(0, room);
+                    entry.truncated = 1;
+                }
+                entry.payload[entry.size] = static_cast<char>(ArgType::String);
+                entry.payload[entry.size + 1] = static_cast<char>(value.size());
+                std::memcpy(entry.payload + entry.size + 2, value.data(), value.size());
+                entry.size = static_cast<uint8_t>(entry.size + 2 + value.size());
+            }
+
+            Entry& entry;
+        };
+    }
+
+    template <typename... Args>
+    void write(const Site& site, const Args&... args) {
+        Entry entry;
+        entry.site = &site;
+        entry.ticks = tsc::now();
+        entry.size = 0;
+        entry.truncated = 0;
+        detail::ArgWriter writer(entry);
+        (writer.put(args), ...);
+        push(entry);
+    }
+
+    // Renders an entry as the writer thread does, without the timestamp.
+    string format(const Entry& entry);
+}
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef MARKET_DATA_H
+#define MARKET_DATA_H
+
+#include <cstdint>
+#include <type_traits>
+
+// Canonical in-memory bar: one cache line, no heap indirections. Prices and
+// volume are fixed point in the symbol's price/size decimals (see
+// SymbolTable::priceDecimals and SymbolTable::sizeDecimals).
+struct alignas(64) CompactBar {
+    int64_t timestampNs;
+    int64_t open;
+    int64_t high;
+    int64_t low;
+    int64_t close;
+    int64_t volume;
+    int64_t vwap;
+    uint32_t symbolId;
+    uint32_t tradeCount;
+};
+
+struct TradeRecord {
+    uint32_t symbolId;
+    char takerSide;
+    int64_t timestampNs;
+    int64_t tradeId;
+    int64_t price;
+    int64_t size;
+};
+
+struct QuoteRecord {
+    uint32_t symbolId;
+    int64_t timestampNs;
+    int64_t bidPrice;
+    int64_t bidSize;
+    int64_t askPrice;
+    int64_t askSize;
+};
+
+// One price level change from an order book message. A message becomes a
+// run of these for the same symbol: the first carries BOOK_RESET when the
+// message is a full snapshot, the last carries BOOK_END. A message with no
+// levels still produces one entry (side 0) so the flags are not lost.
+struct BookLevelUpdate {
+    static constexpr uint8_t BOOK_RESET = 1;
+    static constexpr uint8_t BOOK_END = 2;
+
+    uint32_t symbolId;
+    char side;      // 'b' bid, 'a' ask
+    uint8_t flags;
+    int64_t timestampNs;
+    int64_t price;
+    int64_t size;   // 0 removes the level
+};
+
+enum class EventType : uint8_t {
+    Bar,
+    Trade,
+    Quote,
+    BookLevel,
+    // Late corrections of an already sent minute bar, and the running daily
+    // bar. Both carry a CompactBar but never reach onBar.
+    UpdatedBar,
+    DailyBar
+};
+
+// Tagged union of everything the feeds deliver, so one ring per shard keeps
+// a symbol's bars, trades, quotes and book changes in arrival order. The
+// cache-line aligned bar makes this two lines wide; the feed index and the
+// receive stamp live in what would otherwise be padding.
+struct MarketEvent {
+    union {
+        CompactBar bar;
+        TradeRecord trade;
+        QuoteRecord quote;
+        BookLevelUpdate level;
+    };
+    EventType type;
+    // Index of the feed the event came from (see WebClient::addFeed).
+    uint8_t feed;
+    // latency::now() when the frame carrying the event arrived; 0 if unknown.
+    uint64_t receiveTicks;
+
+    static MarketEvent of(const CompactBar& bar, EventType type = EventType::Bar) {
+        MarketEvent event;
+        event.bar = bar;
+        event.type = type;
+        event.feed = 0;
+        event.receiveTicks = 0;
+        return event;
+    }
+
+    static MarketEvent of(const TradeRecord& trade) {
+        MarketEvent event;
+        event.trade = trade;
+        event.type = EventType::Trade;
+        event.feed = 0;
+        event.receiveTicks = 0;
+        return event;
+    }
+
+    static MarketEvent of(const QuoteRecord& quote) {
+        MarketEvent event;
+        event.quote = quote;
+        event.type = EventType::Quote;
+        event.feed = 0;
+        event.receiveTicks = 0;
+        return event;
+    }
+
+    static MarketEvent of(const BookLevelUpdate& level) {
+        MarketEvent event;
+        event.level = level;
+        event.type = EventType::BookLevel;
+        event.feed = 0;
+        event.receiveTicks = 0;
+        return event;
+    }
+
+    uint32_t symbolId() const {
+        switch (type) {
+        case EventType::Bar: return bar.symbolId;
+        case EventType::Trade: return trade.symbolId;
+        case EventType::Quote: return quote.symbolId;
+        case EventType::BookLevel: return level.symbolId;
+        case EventType::UpdatedBar:
+        case EventType::DailyBar: return bar.symbolId;
+        }
+        return 0;
+    }
+
+    // Exchange time of the event; feeds are merged in this order.
+    int64_t timestampNs() const {
+        switch (type) {
+        case EventType::Bar:
+        case EventType::UpdatedBar:
+        case EventType::DailyBar: return bar.timestampNs;
+        case EventType::Trade: return trade.timestampNs;
+        case EventType::Quote: return quote.timestampNs;
+        case EventType::BookLevel: return level.timestampNs;
+        }
+        return 0;
+    }
+};
+
+// A contiguous run of events, e.g. everything one feed frame decoded to;
+// stands in for std::span<const MarketEvent> until the tree moves to C++20.
+class EventSpan {
+public:
+    EventSpan() = default;
+    EventSpan(const MarketEvent* events, size_t count) : events(events), count(count) {}
+
+    const MarketEvent* begin() const { return events; }
+    const MarketEvent* end() const { return events + count; }
+    const MarketEvent* data() const { return events; }
+    const MarketEvent& operator[](size_t i) const { return events[i]; }
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+private:
+    const MarketEvent* events = nullptr;
+    size_t count = 0;
+};
+
+// Routing key used by ShardPipeline.
+inline uint32_t symbolOf(const CompactBar& bar) { return bar.symbolId; }
+inline uint32_t symbolOf(const MarketEvent& event) { return event.symbolId(); }
+
+static_assert(sizeof(CompactBar) == 64, "CompactBar must fit one cache line");
+static_assert(std::is_trivially_copyable<CompactBar>::value, "CompactBar must stay POD");
+static_assert(std::is_trivially_copyable<TradeRecord>::value, "TradeRecord must stay POD");
+static_assert(std::is_trivially_copyable<QuoteRecord>::value, "QuoteRecord must stay POD");
+static_assert(std::is_trivially_copyable<BookLevelUpdate>::value, "BookLevelUpdate must stay POD");
+static_assert(std::is_trivially_copyable<MarketEvent>::value, "MarketEvent must stay POD");
+static_assert(sizeof(MarketEvent) == 128, "MarketEvent must stay two cache lines");
+
+#endif
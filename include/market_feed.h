@@ -0,0 +1,176 @@
+#ifndef MARKET_FEED_H
+#define MARKET_FEED_H
+
+#include <websocketpp/config/asio_client.hpp>
+#include <websocketpp/client.hpp>
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "feed_decoder.h"
+#include "frame_pool.h"
+#include "feed_session.h"
+#include "journal.h"
+#include "market_data.h"
+#include "thread_util.h"
+
+using std::string;
+
+// Alpaca market data channels; every one has its own decode path and event
+// type, so a feed subscribed to trades and quotes decodes bars no slower.
+enum class FeedChannel : uint8_t {
+    Trades,
+    Quotes,
+    Bars,
+    UpdatedBars,
+    DailyBars,
+    OrderBooks
+};
+
+// The channel's name in subscribe messages, e.g. "updatedBars".
+const char* toString(FeedChannel channel);
+
+// Crypto feeds carry pairs ("BTC/USD"); stock feeds (IEX, SIP) carry plain
+// tickers and have no order books.
+enum class AssetClass : uint8_t {
+    Crypto,
+    Stock
+};
+
+AssetClass assetClassOf(std::string_view symbol);
+
+struct MarketFeedConfig {
+    // Shows up in logs and capture file names.
+    string name = "crypto";
+    string uri = "wss://stream.data.alpaca.markets/v1beta3/crypto/us";
+    string hostname = "stream.data.alpaca.markets";
+    AssetClass assetClass = AssetClass::Crypto;
+    FeedSessionConfig session;
+    // Every received frame is appended here when set.
+    string capturePath;
+    JournalWriterConfig capture;
+    // The websocket thread, which also decodes.
+    ThreadPlacement thread;
+};
+
+class MarketFeed;
+
+// Receives what a feed decodes and its session milestones, all on the
+// feed's websocket thread.
+class FeedListener {
+public:
+    virtual ~FeedListener() = default;
+
+    // Once per frame or backfill, in decode order.
+    virtual void onFeedEvents(MarketFeed& feed, const MarketEvent* events, size_t count) = 0;
+    // The first session only; reconnects are handled by the feed.
+    virtual void onFeedOpen(MarketFeed& feed) = 0;
+    virtual void onFeedAuthenticated(MarketFeed& feed) = 0;
+    virtual void onFeedSubscribed(MarketFeed& feed) = 0;
+};
+
+// One market data websocket (Alpaca: one per asset class and source) on its
+// own thread. Dropped connections are re-opened with jittered exponential
+// backoff, re-authenticated and resubscribed to everything subscribed so
+// far; ping/pong catches dead peers and bar gaps are backfilled (see
+// FeedSessionConfig). Frames are decoded on the websocket thread and handed
+// to the listener as MarketEvents stamped with the feed's index.
+class MarketFeed {
+public:
+    MarketFeed(uint8_t index, const MarketFeedConfig& config, FeedListener& listener, const string& apiKey,
+               const string& apiSecretKey);
+    ~MarketFeed();
+
+    MarketFeed(const MarketFeed&) = delete;
+    MarketFeed& operator=(const MarketFeed&) = delete;
+
+    void connect();
+    void disconnect();
+    void authenticate();
+
+    // Tracked even while disconnected; the next session subscribes to
+    // whatever is tracked once it has authenticated.
+    void subscribe(FeedChannel channel, const std::vector<string>& symbols);
+    void unsubscribe(FeedChannel channel, const std::vector<string>& symbols);
+
+    bool carries(std::string_view symbol, FeedChannel channel) const;
+
+    // Runs a frame through the decode path as if it had just arrived; used
+    // by replay, where the feed is never connected.
+    void handleFrame(std::string_view payload, uint64_t receiveTicks);
+
+    // Runs the task on the websocket thread, or right away when the feed is
+    // not running.
+    void post(std::function<void()> task);
+
+    bool running() const { return thread.joinable(); }
+    const MarketFeedConfig& config() const { return cfg; }
+    FeedSessionStats stats() const;
+
+    const uint8_t index;
+
+private:
+    typedef websocketpp::client<pooled_asio_tls_client> endpoint_type;
+
+    void onOpen(websocketpp::connection_hdl hdl);
+    void onClose(websocketpp::connection_hdl hdl);
+    void onFail(websocketpp::connection_hdl hdl);
+    void onPongTimeout(websocketpp::connection_hdl hdl, string payload);
+    void onMessage(websocketpp::connection_hdl hdl, endpoint_type::message_ptr msg);
+    void handleJsonMessage(const string& payload);
+
+    void openConnection(websocketpp::lib::error_code& ec);
+    void scheduleReconnect();
+    void schedulePing(uint64_t session);
+    void resubscribe();
+    void sendSubscription(bool subscribe, FeedChannel channel, const std::vector<string>& symbols);
+
+    // Appends the bar to events after gap detection, with whatever bars it
+    // releases.
+    void appendBar(const CompactBar& bar, uint64_t receiveTicks);
+    void append(MarketEvent event, uint64_t receiveTicks);
+    void publishBatch(const DecodedBatch& decoded, uint64_t receiveTicks);
+    void onBackfill(const BarGap& gap, std::vector<CompactBar> bars);
+    void deliver();
+
+    const MarketFeedConfig cfg;
+    FeedListener& listener;
+    const string ALPACA_API_KEY;
+    const string ALPACA_API_SECRET_KEY;
+
+    // Session state below is only touched on the websocket thread, except
+    // the atomics.
+    endpoint_type endpoint;
+    std::thread thread;
+    websocketpp::connection_hdl hdl;
+    std::atomic<bool> connected{false};
+    Backoff backoff;
+    endpoint_type::timer_ptr reconnectTimer;
+    endpoint_type::timer_ptr pingTimer;
+    // Bumped by every open and close so an older connection's pings stop.
+    uint64_t sessionId = 0;
+    // Set by the first authentication; later sessions authenticate themselves.
+    bool resumeSession = false;
+    std::atomic<bool> closing{false};
+    std::atomic<uint64_t> connects{0};
+    std::atomic<uint64_t> reconnects{0};
+    std::atomic<uint64_t> connectFailures{0};
+    std::atomic<uint64_t> pongTimeouts{0};
+
+    SubscriptionSet subscriptions;
+
+    FeedDecoder decoder;
+    DecodedBatch batch;
+    std::vector<MarketEvent> events;
+    std::unique_ptr<JournalWriter> capture;
+    std::unique_ptr<GapDetector> gaps;
+    std::unique_ptr<BarBackfill> backfill;
+    std::vector<CompactBar> releasedBars;
+};
+
+#endif
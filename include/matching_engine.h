@@ -0,0 +1,120 @@
+#ifndef MATCHING_ENGINE_H
+#define MATCHING_ENGINE_H
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "order.h"
+
+enum class SimOrderStatus : uint8_t {
+    New,
+    PartiallyFilled,
+    Filled,
+    Canceled,
+    Rejected
+};
+
+const char* toString(SimOrderStatus status);
+
+// An order as the simulator tracks it. Quantities and prices are fixed point
+// in the symbol's size/price decimals.
+struct SimOrder {
+    uint64_t id = 0;
+    // 0 is the simulator's own liquidity provider.
+    uint64_t owner = 0;
+    string clientOrderId;
+    uint32_t symbolId = 0;
+    OrderSide side = OrderSide::Buy;
+    OrderType type = OrderType::Market;
+    TimeInForce timeInForce = TimeInForce::Gtc;
+    int64_t quantity = 0;
+    int64_t limitPrice = 0;
+    int64_t filledQuantity = 0;
+    // Sum of price * quantity over fills, in price units times size units.
+    double filledNotional = 0;
+    SimOrderStatus status = SimOrderStatus::New;
+    int64_t createdNs = 0;
+
+    int64_t remaining() const { return quantity - filledQuantity; }
+    double averagePrice() const { return filledQuantity ? filledNotional / static_cast<double>(filledQuantity) : 0; }
+};
+
+struct SimFill {
+    uint64_t takerId;
+    uint64_t makerId;
+    uint32_t symbolId;
+    OrderSide takerSide;
+    int64_t price;
+    int64_t quantity;
+    int64_t timestampNs;
+};
+
+struct MatchingEngineStats {
+    uint64_t orders = 0;
+    uint64_t fills = 0;
+    uint64_t cancels = 0;
+    uint64_t rejects = 0;
+};
+
+// Price-time priority matching for the exchange simulator. Each side of a
+// symbol's book is a flat vector of price levels sorted worst price first
+// (as in BookSide) with a FIFO of resting orders per level. Market orders
+// and IOC limits never rest; whatever they cannot fill is canceled.
+// Not thread-safe; the simulator serialises access.
+class MatchingEngine {
+public:
+    // Matches the order, rests any GTC/day limit remainder and appends the
+    // resulting fills. Returns the order's final state.
+    const SimOrder& submit(SimOrder order, std::vector<SimFill>& fills);
+
+    bool cancel(uint64_t orderId);
+    const SimOrder* find(uint64_t orderId) const;
+
+    // Replaces the liquidity provider's resting quote for a symbol. A quote
+    // that crosses resting client orders trades with them first. A side with
+    // zero size is left empty.
+    void requote(uint32_t symbolId, int64_t bidPrice, int64_t bidSize, int64_t askPrice, int64_t askSize,
+                 int64_t timestampNs, std::vector<SimFill>& fills);
+
+    // Best resting price on each side; 0 when the side is empty.
+    int64_t bestBid(uint32_t symbolId) const;
+    int64_t bestAsk(uint32_t symbolId) const;
+
+    const MatchingEngineStats& stats() const { return counters; }
+
+private:
+    struct Level {
+        int64_t price;
+        std::deque<uint64_t> queue;
+    };
+
+    struct Side {
+        bool bids;
+        std::vector<Level> levels;
+
+        bool worse(int64_t a, int64_t b) const { return bids ? a < b : a > b; }
+    };
+
+    struct Book {
+        Side bids{true, {}};
+        Side asks{false, {}};
+        uint64_t quoteBid = 0;
+        uint64_t quoteAsk = 0;
+    };
+
+    Book& book(uint32_t symbolId);
+    void match(SimOrder& taker, Side& opposite, int64_t timestampNs, std::vector<SimFill>& fills);
+    void rest(SimOrder& order, Side& side);
+    void removeFromBook(const SimOrder& order);
+    SimOrder& store(SimOrder order);
+
+    std::unordered_map<uint32_t, Book> books;
+    std::unordered_map<uint64_t, SimOrder> orders;
+    uint64_t nextId = 1;
+    MatchingEngineStats counters;
+};
+
+#endif
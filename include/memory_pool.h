@@ -0,0 +1,390 @@
+#ifndef MEMORY_POOL_H
+#define MEMORY_POOL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <utility>
+#include <vector>
+
+struct MemoryPoolStats {
+    // Heap allocations made to grow the pool or arena; flat once warm.
+    uint64_t growths = 0;
+    size_t capacity = 0;
+    size_t inUse = 0;
+    size_t highWater = 0;
+};
+
+// Bump allocator over a list of blocks. deallocate() is a no-op; reset()
+// rewinds to the first block and keeps every block, so once the arena has
+// grown to the largest batch it handles it never allocates again. Not
+// thread-safe: one owner, which resets it between batches once nothing
+// allocated from it is alive.
+class MonotonicArena {
+public:
+    explicit MonotonicArena(size_t blockSize = 64 * 1024) : blockSize(blockSize) {}
+
+    MonotonicArena(const MonotonicArena&) = delete;
+    MonotonicArena& operator=(const MonotonicArena&) = delete;
+
+    void* allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        for (;;) {
+            if (current < blocks.size()) {
+                Block& block = blocks[current];
+                size_t offset = (used + alignment - 1) & ~(alignment - 1);
+                if (offset + bytes <= block.size) {
+                    used = offset + bytes;
+                    inUse += bytes;
+                    if (inUse > highWater) highWater = inUse;
+                    return block.data.get() + offset;
+                }
+                if (current + 1 < blocks.size() && bytes + alignment <= blocks[current + 1].size) {
+                    ++current;
+                    used = 0;
+                    continue;
+                }
+            }
+            grow(bytes + alignment);
+        }
+    }
+
+    void deallocate(void*, size_t) {}
+
+    void reset() {
+        current = 0;
+        used = 0;
+        inUse = 0;
+    }
+
+    // Where the next allocation would go; rewind() frees everything
+    // allocated since. Blocks only ever grow after the current one, so a
+    // mark stays valid.
+    struct Mark {
+        size_t block;
+        size_t used;
+        size_t inUse;
+    };
+    Mark mark() const { return Mark{current, used, inUse}; }
+    void rewind(const Mark& to) {
+        current = to.block;
+        used = to.used;
+        inUse = to.inUse;
+    }
+
+    MemoryPoolStats stats() const {
+        MemoryPoolStats s;
+        s.growths = growths;
+        for (const Block& block : blocks) s.capacity += block.size;
+        s.inUse = inUse;
+        s.highWater = highWater;
+        return s;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<char[]> data;
+        size_t size;
+    };
+
+    // Appends a block after the current one; oversized requests get a block
+    // of their own.
+    void grow(size_t minimum) {
+        const size_t size = minimum > blockSize ? minimum : blockSize;
+        Block block{std::unique_ptr<char[]>(new char[size]), size};
+        const size_t at = blocks.empty() ? 0 : current + 1;
+        blocks.insert(blocks.begin() + static_cast<std::ptrdiff_t>(at), std::move(block));
+        current = at;
+        used = 0;
+        ++growths;
+    }
+
+    const size_t blockSize;
+    std::vector<Block> blocks;
+    size_t current = 0;
+    size_t used = 0;
+    size_t inUse = 0;
+    size_t highWater = 0;
+    uint64_t growths = 0;
+};
+
+// The calling thread's scratch arena. Code that allocates from it holds an
+// ArenaScope around the batch (a frame, a trade update) and must not keep
+// anything allocated from it past that scope.
+inline MonotonicArena& threadArena() {
+    thread_local MonotonicArena arena;
+    return arena;
+}
+
+// Frees everything allocated from the arena during its lifetime. Scopes
+// nest, so a callee may take one while its caller's allocations are live.
+class ArenaScope {
+public:
+    explicit ArenaScope(MonotonicArena& arena = threadArena()) : arena(arena), start(arena.mark()) {}
+    ~ArenaScope() { arena.rewind(start); }
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+private:
+    MonotonicArena& arena;
+    const MonotonicArena::Mark start;
+};
+
+// Standard allocator over a MonotonicArena, e.g. for the header fields of a
+// Beast message that is cleared after every response.
+template <typename T>
+class ArenaAllocator {
+public:
+    typedef T value_type;
+
+    explicit ArenaAllocator(MonotonicArena& arena) noexcept : arena(&arena) {}
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U>& other) noexcept : arena(other.arena) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(arena->allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) noexcept {}
+
+    template <typename U>
+    bool operator==(const ArenaAllocator<U>& other) const noexcept { return arena == other.arena; }
+    template <typename U>
+    bool operator!=(const ArenaAllocator<U>& other) const noexcept { return arena != other.arena; }
+
+private:
+    template <typename U>
+    friend class ArenaAllocator;
+
+    MonotonicArena* arena;
+};
+
+// Stateless allocator over threadArena(), for containers that
+// default-construct their allocator (nlohmann::basic_json's AllocatorType).
+template <typename T>
+struct ThreadArenaAllocator {
+    typedef T value_type;
+
+    ThreadArenaAllocator() noexcept = default;
+    template <typename U>
+    ThreadArenaAllocator(const ThreadArenaAllocator<U>&) noexcept {}
+
+    T* allocate(size_t n) { return static_cast<T*>(threadArena().allocate(n * sizeof(T), alignof(T))); }
+    void deallocate(T*, size_t) noexcept {}
+
+    template <typename U>
+    bool operator==(const ThreadArenaAllocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator!=(const ThreadArenaAllocator<U>&) const noexcept { return false; }
+};
+
+// Fixed-size objects handed out and taken back without being destroyed, so
+// whatever capacity they built up (buffers, strings) is kept for the next
+// user. Objects are default-constructed in slabs of slabSize; a slab is only
+// added when every object is out. Thread-safe: acquire and release take an
+// uncontended mutex, never the heap.
+template <typename T>
+class SlabPool {
+public:
+    struct Recycler {
+        SlabPool* pool = nullptr;
+        void operator()(T* object) const { pool->release(object); }
+    };
+    typedef std::unique_ptr<T, Recycler> Ptr;
+
+    explicit SlabPool(size_t slabSize = 256, size_t prefill = 0) : slabSize(slabSize ? slabSize : 1) {
+        std::lock_guard<std::mutex> lock(mutex);
+        while (freeObjects.size() < prefill) addSlab();
+    }
+
+    SlabPool(const SlabPool&) = delete;
+    SlabPool& operator=(const SlabPool&) = delete;
+
+    Ptr acquire() {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (freeObjects.empty()) addSlab();
+        T* object = freeObjects.back();
+        freeObjects.pop_back();
+        const size_t inUse = slabs.size() * slabSize - freeObjects.size();
+        if (inUse > highWater) highWater = inUse;
+        return Ptr(object, Recycler{this});
+    }
+
+    MemoryPoolStats stats() {
+        std::lock_guard<std::mutex> lock(mutex);
+        MemoryPoolStats s;
+        s.growths = slabs.size();
+        s.capacity = slabs.size() * slabSize;
+        s.inUse = s.capacity - freeObjects.size();
+        s.highWater = highWater;
+        return s;
+    }
+
+private:
+    void release(T* object) {
+        std::lock_guard<std::mutex> lock(mutex);
+        // Reserved to the pool's capacity in addSlab, so this never grows.
+        freeObjects.push_back(object);
+    }
+
+    // Caller holds the mutex.
+    void addSlab() {
+        slabs.push_back(std::make_unique<T[]>(slabSize));
+        freeObjects.reserve(slabs.size() * slabSize);
+        T* slab = slabs.back().get();
+        for (size_t i = slabSize; i-- > 0;) freeObjects.push_back(slab + i);
+    }
+
+    const size_t slabSize;
+    std::mutex mutex;
+    std::vector<std::unique_ptr<T[]>> slabs;
+    std::vector<T*> freeObjects;
+    size_t highWater = 0;
+};
+
+// A double-ended queue over one ring that doubles when full and never
+// shrinks. std::deque allocates and frees blocks as its contents move
+// through it; this one stops allocating once it has been as deep as it gets.
+// Popping assigns a default T over the slot, so whatever the element held is
+// released then. Not thread-safe.
+template <typename T>
+class RingQueue {
+public:
+    bool empty() const { return count == 0; }
+    size_t size() const { return count; }
+
+    T& front() { return slots[head]; }
+    T& back() { return slots[(head + count - 1) & (slots.size() - 1)]; }
+
+    void push_back(T value) {
+        if (count == slots.size()) grow();
+        slots[(head + count) & (slots.size() - 1)] = std::move(value);
+        ++count;
+    }
+    void push_front(T value) {
+        if (count == slots.size()) grow();
+        head = (head + slots.size() - 1) & (slots.size() - 1);
+        slots[head] = std::move(value);
+        ++count;
+    }
+    void pop_front() {
+        slots[head] = T();
+        head = (head + 1) & (slots.size() - 1);
+        --count;
+    }
+    void pop_back() {
+        back() = T();
+        --count;
+    }
+
+private:
+    void grow() {
+        std::vector<T> bigger(slots.empty() ? 16 : slots.size() * 2);
+        for (size_t i = 0; i < count; ++i) {
+            bigger[i] = std::move(slots[(head + i) & (slots.size() - 1)]);
+        }
+        slots.swap(bigger);
+        head = 0;
+    }
+
+    std::vector<T> slots;
+    size_t head = 0;
+    size_t count = 0;
+};
+
+// A few fixed blocks for the state of the asynchronous operations a
+// connection starts over and over (what Asio allocates behind every read,
+// write and post), so steady-state I/O reuses them instead of the heap.
+// Requests that are too large, or find every block taken, fall back to it.
+// Not thread-safe.
+class HandlerMemory {
+public:
+    explicit HandlerMemory(size_t blocks = 4, size_t blockSize = 1024)
+        : blockSize((blockSize + alignof(std::max_align_t) - 1) & ~(alignof(std::max_align_t) - 1)),
+          blocks(blocks),
+          storage(new std::max_align_t[blocks * this->blockSize / sizeof(std::max_align_t)]),
+          used(blocks, false) {}
+
+    HandlerMemory(const HandlerMemory&) = delete;
+    HandlerMemory& operator=(const HandlerMemory&) = delete;
+
+    void* allocate(size_t bytes) {
+        if (bytes <= blockSize) {
+            for (size_t i = 0; i < blocks; ++i) {
+                if (used[i]) continue;
+                used[i] = true;
+                return base() + i * blockSize;
+            }
+        }
+        return ::operator new(bytes);
+    }
+
+    void deallocate(void* p) {
+        char* block = static_cast<char*>(p);
+        if (block >= base() && block < base() + blocks * blockSize) {
+            used[static_cast<size_t>(block - base()) / blockSize] = false;
+            return;
+        }
+        ::operator delete(p);
+    }
+
+private:
+    char* base() const { return reinterpret_cast<char*>(storage.get()); }
+
+    const size_t blockSize;
+    const size_t blocks;
+    std::unique_ptr<std::max_align_t[]> storage;
+    std::vector<bool> used;
+};
+
+// Standard allocator over a HandlerMemory.
+template <typename T>
+class HandlerAllocator {
+public:
+    typedef T value_type;
+
+    explicit HandlerAllocator(HandlerMemory& memory) noexcept : memory(&memory) {}
+    template <typename U>
+    HandlerAllocator(const HandlerAllocator<U>& other) noexcept : memory(other.memory) {}
+
+    T* allocate(size_t n) { return static_cast<T*>(memory->allocate(n * sizeof(T))); }
+    void deallocate(T* p, size_t) noexcept { memory->deallocate(p); }
+
+    template <typename U>
+    bool operator==(const HandlerAllocator<U>& other) const noexcept { return memory == other.memory; }
+    template <typename U>
+    bool operator!=(const HandlerAllocator<U>& other) const noexcept { return memory != other.memory; }
+
+private:
+    template <typename U>
+    friend class HandlerAllocator;
+
+    HandlerMemory* memory;
+};
+
+// A completion handler whose associated allocator (allocator_type and
+// get_allocator(), which Asio and Beast look up) draws on a HandlerMemory.
+template <typename Handler>
+class MemoryBoundHandler {
+public:
+    typedef HandlerAllocator<void> allocator_type;
+
+    MemoryBoundHandler(HandlerMemory& memory, Handler handler) : memory(&memory), handler(std::move(handler)) {}
+
+    allocator_type get_allocator() const noexcept { return allocator_type(*memory); }
+
+    template <typename... Args>
+    void operator()(Args&&... args) {
+        handler(std::forward<Args>(args)...);
+    }
+
+private:
+    HandlerMemory* memory;
+    Handler handler;
+};
+
+template <typename Handler>
+MemoryBoundHandler<typename std::decay<Handler>::type> bindHandlerMemory(HandlerMemory& memory, Handler&& handler) {
+    return MemoryBoundHandler<typename std::decay<Handler>::type>(memory, std::forward<Handler>(handler));
+}
+
+#endif
@@ -1,11 +1,28 @@
 #ifndef ORDER_H
 #define ORDER_H
 
+#include <cstdint>
 #include <string>
 #include <nlohmann/json.hpp>
 
 using std::string;
 
+enum class OrderSide : uint8_t {
+    Buy,
+    Sell
+};
+
+enum class OrderType : uint8_t {
+    Market,
+    Limit
+};
+
+enum class TimeInForce : uint8_t {
+    Gtc,
+    Ioc,
+    Day
+};
+
 class Order {
 public:
     Order(const string& symbol,
@@ -24,6 +41,9 @@ public:
             {"type", type},
             {"time_in_force", time_in_force}
         };
+        if (!limit_price.empty()) {
+            order_json["limit_price"] = limit_price;
+        }
         return order_json.dump();
     }
 
@@ -32,6 +52,23 @@ public:
     string side;
     string type;
     string time_in_force;
+    string limit_price;
+
+    // Symbol table id for position tracking and the strategy that emitted
+    // the order; UINT32_MAX and UINT16_MAX for orders created by hand.
+    // clientOrderId is the OrderManager sequence once sent.
+    uint32_t symbolId = UINT32_MAX;
+    uint16_t strategyId = UINT16_MAX;
+    uint64_t clientOrderId = 0;
+    // Size-scale quantity held on the symbol's open orders since the order
+    // passed risk (see OrderManager::reserve); 0 for orders created by hand.
+    int64_t reserved = 0;
+
+    // Latency stamps (latency::now()) of the triggering frame, the strategy
+    // decision and the encoding; 0 for orders created by hand.
+    uint64_t receiveTicks = 0;
+    uint64_t decisionTicks = 0;
+    uint64_t serializedTicks = 0;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,93 @@
+#ifndef ORDER_BATCHER_H
+#define ORDER_BATCHER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+#include "order.h"
+
+using std::vector;
+
+class RiskGate;
+
+struct OrderBatchConfig {
+    // Strategies (StrategyEngine ids, see OrderIntent::strategyId) whose
+    // orders are coalesced; orders of other strategies and orders made by
+    // hand go out one request each, as before.
+    vector<uint16_t> strategies;
+    bool allStrategies = false;
+    // How long executeOrders() keeps collecting staged orders before it
+    // coalesces and sends them, and how many it collects at most before it
+    // stops waiting; 0 coalesces whatever is staged when it is called.
+    std::chrono::microseconds window{0};
+    size_t maxOrders = 0;
+
+    bool enabled() const { return allStrategies || !strategies.empty(); }
+    bool coalesces(uint16_t strategyId) const;
+};
+
+struct OrderBatchStats {
+    uint64_t batches = 0;
+    uint64_t ordersIn = 0;
+    uint64_t requestsOut = 0;
+    // Orders folded into another order's request.
+    uint64_t coalesced = 0;
+    // Orders dropped because opposing orders cancelled them out exactly.
+    uint64_t netted = 0;
+    // Orders sent as they were because their group's order would have
+    // broken a risk limit.
+    uint64_t overLimit = 0;
+
+    uint64_t requestsSaved() const { return ordersIn - requestsOut; }
+};
+
+// Coalesces a burst of staged orders before it is sent: the orders of the
+// coalescing strategies for one symbol, order type, time in force and limit
+// price become a single order for their net quantity, on the side of the
+// larger total, or none when buys and sells cancel out. The order keeps the
+// place of the first one in its group, the earliest receive stamp (so the
+// end-to-end latency still counts from the first trigger) and the latest
+// decision stamp. A group whose order would fail the RiskGate's order
+// checks (size, notional, minimums) is left as it was, since each of its
+// orders passed them on its own. Everything else passes through in order.
+// Not thread-safe; executeOrders() runs it under its own lock. stats() may
+// be read from any thread.
+class OrderBatcher {
+public:
+    explicit OrderBatcher(const OrderBatchConfig& config = OrderBatchConfig());
+
+    OrderBatcher(const OrderBatcher&) = delete;
+    OrderBatcher& operator=(const OrderBatcher&) = delete;
+
+    void configure(const OrderBatchConfig& config);
+    const OrderBatchConfig& config() const { return settings; }
+
+    // Returns the number of orders removed. Orders whose quantity does not
+    // parse at their symbol's size scale are left alone. Without risk,
+    // groups are merged whatever their size.
+    size_t coalesce(vector<Order>& orders, const RiskGate* risk = nullptr);
+
+    OrderBatchStats stats() const;
+
+private:
+    struct Candidate {
+        uint32_t index;
+        int64_t quantity;
+    };
+
+    OrderBatchConfig settings;
+    // Scratch kept between batches so a burst does not allocate.
+    vector<Candidate> candidates;
+    vector<char> dropped;
+
+    std::atomic<uint64_t> batches{0};
+    std::atomic<uint64_t> ordersIn{0};
+    std::atomic<uint64_t> requestsOut{0};
+    std::atomic<uint64_t> coalesced{0};
+    std::atomic<uint64_t> netted{0};
+    std::atomic<uint64_t> overLimit{0};
+};
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef ORDER_BOOK_H
+#define ORDER_BOOK_H
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "market_data.h"
+
+// Aggregated (L2) price level. Price and size are fixed point in the
+// symbol's price/size decimals.
+struct BookLevel {
+    int64_t price;
+    int64_t size;
+};
+
+// One side of a book as a flat array sorted worst price first, so the best
+// level is the last element. Most changes land near the top of the book,
+// where inserting or erasing shifts only a few contiguous levels, and the
+// best price is a single load.
+class BookSide {
+public:
+    explicit BookSide(bool bids, size_t reserve = 64);
+
+    // Sets the size resting at price; a size of 0 removes the level.
+    void set(int64_t price, int64_t size);
+    void clear() { levels.clear(); }
+
+    size_t size() const { return levels.size(); }
+    bool empty() const { return levels.empty(); }
+    const BookLevel* best() const { return levels.empty() ? nullptr : &levels.back(); }
+    // i = 0 is the best level; i must be below size().
+    const BookLevel& level(size_t i) const { return levels[levels.size() - 1 - i]; }
+    // Copies up to n levels, best first, and returns how many were copied.
+    size_t depth(BookLevel* out, size_t n) const;
+
+private:
+    // True when a is a worse price than b for this side.
+    bool worse(int64_t a, int64_t b) const { return bids ? a < b : a > b; }
+
+    std::vector<BookLevel> levels;
+    bool bids;
+};
+
+class OrderBook {
+public:
+    explicit OrderBook(uint32_t symbolId = 0);
+
+    void apply(const BookLevelUpdate& update);
+    void clear();
+
+    const BookSide& bids() const { return bidSide; }
+    const BookSide& asks() const { return askSide; }
+    const BookLevel* bestBid() const { return bidSide.best(); }
+    const BookLevel* bestAsk() const { return askSide.best(); }
+
+    // Both are 0 unless each side has at least one level.
+    int64_t spread() const;
+    int64_t mid() const;
+
+    uint32_t symbolId;
+    int64_t timestampNs = 0;
+    uint64_t updates = 0;
+
+private:
+    BookSide bidSide;
+    BookSide askSide;
+};
+
+// The books of every symbol one shard owns, indexed by symbol id.
+class OrderBookSet {
+public:
+    // Applies one level change; returns the book once the message it belongs
+    // to is complete (BOOK_END), nullptr while it is still being applied.
+    const OrderBook* apply(const BookLevelUpdate& update);
+
+    OrderBook& book(uint32_t symbolId);
+    const OrderBook* find(uint32_t symbolId) const;
+    void moveSymbol(uint32_t symbolId, OrderBookSet& to);
+
+private:
+    std::vector<std::unique_ptr<OrderBook>> books;
+};
+
+#endif
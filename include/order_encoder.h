@@ -0,0 +1,72 @@
+#ifndef ORDER_ENCODER_H
+#define ORDER_ENCODER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+#include "order.h"
+#include "strategy.h"
+
+using std::string;
+
+// One complete POST /v2/orders request, headers and body, in a fixed
+// buffer that can go to the socket as is.
+struct EncodedOrder {
+    static constexpr size_t CAPACITY = 1024;
+
+    size_t size = 0;
+    char data[CAPACITY];
+
+    std::string_view view() const { return std::string_view(data, size); }
+};
+
+// The intent with its quantity rounded down to the symbol's lot size and
+// its limit price to the tick size, buys down and sells up so rounding
+// never makes an order more aggressive. Unknown rules leave it as is.
+OrderIntent roundToRules(const OrderIntent& intent);
+// The Order an intent stands for, rounded by roundToRules and formatted the
+// way encode() sends it. Typical symbols, sizes and prices fit the strings'
+// inline storage, so this does not allocate.
+Order makeOrder(const OrderIntent& intent);
+
+// Renders order requests without JSON objects, Beast messages or heap
+// allocation. The request line and every fixed header (host, credentials,
+// keep-alive, content type) are rendered once at construction; an order
+// only appends Content-Length and the body, with numbers written by
+// std::to_chars. Body:
+//   {"symbol":"BTCUSD","qty":"0.001","side":"buy","type":"limit",
+//    "time_in_force":"gtc","limit_price":"64000.5","client_order_id":"..."}
+class OrderEncoder {
+public:
+    // clientIdPrefix defaults to one unique to this process start.
+    OrderEncoder(const string& host, const string& apiKey, const string& apiSecretKey,
+                 const string& clientIdPrefix = string());
+
+    // Prices and sizes at the symbol's SymbolTable scale, rounded by
+    // roundToRules; the symbol is sent as its SymbolTable::orderSymbol.
+    // False if the order does not fit the buffer.
+    bool encode(const OrderIntent& intent, uint64_t clientOrderId, EncodedOrder& out) const;
+    // The same request from an Order's already formatted fields.
+    bool encode(const Order& order, uint64_t clientOrderId, EncodedOrder& out) const;
+
+    // Thread-safe; ids start at 1.
+    uint64_t nextClientOrderId() { return sequence.fetch_add(1, std::memory_order_relaxed); }
+    // The client_order_id the encoder sends for id.
+    string clientOrderId(uint64_t id) const;
+
+    std::string_view headers() const { return head; }
+
+private:
+    bool assemble(std::string_view symbol, std::string_view qty, std::string_view side, std::string_view type,
+                  std::string_view timeInForce, std::string_view limitPrice, uint64_t clientOrderId,
+                  EncodedOrder& out) const;
+
+    string head;
+    string prefix;
+    std::atomic<uint64_t> sequence{1};
+};
+
+#endif
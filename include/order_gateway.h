@@ -0,0 +1,204 @@
+#ifndef ORDER_GATEWAY_H
+#define ORDER_GATEWAY_H
+
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/beast/http.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "latency.h"
+#include "memory_pool.h"
+#include "order_encoder.h"
+#include "session_pool.h"
+
+using std::string;
+
+// An order buffer from the gateway's pool; it goes back when released.
+typedef SlabPool<EncodedOrder>::Ptr EncodedOrderPtr;
+
+struct OrderGatewayConfig {
+    string host = "paper-api.alpaca.markets";
+    string port = "443";
+    size_t connections = 8;
+    // Requests written to one connection ahead of their responses. 0 spreads
+    // maxInFlight over the connections: 32 each with the defaults.
+    size_t pipelineDepth = 0;
+    // Requests on the wire at once. Each connection carries at most
+    // pipelineDepth of them, so an explicit depth caps it at
+    // connections * pipelineDepth.
+    size_t maxInFlight = 256;
+    size_t maxQueued = 16384;
+    // Bounds every resolve, connect, handshake, write and read, so an
+    // unresponsive exchange fails its requests instead of stalling drain().
+    std::chrono::milliseconds ioTimeout{5000};
+    // Once warmUp() has connected them, idle connections send
+    // heartbeatTarget this often to stay open, and dropped ones reconnect
+    // on the same schedule.
+    std::chrono::milliseconds heartbeatInterval{15000};
+    string heartbeatTarget = "/v2/clock";
+    bool verifyPeer = false;
+    // The I/O thread every connection is driven from.
+    ThreadPlacement ioThread;
+};
+
+struct OrderResult {
+    boost::system::error_code ec;
+    unsigned status = 0;
+    string body;
+    // latency::now() when the request finished writing and when the
+    // response was read; 0 if it never got that far.
+    uint64_t writtenTicks = 0;
+    uint64_t responseTicks = 0;
+    // Whether any of the request may have reached the server. A failed
+    // request that was never sent certainly did not take effect; one that
+    // was may have.
+    bool sent = false;
+
+    bool ok() const { return !ec && status >= 200 && status < 300; }
+};
+
+struct OrderGatewayStats {
+    uint64_t submitted = 0;
+    uint64_t completed = 0;
+    uint64_t failed = 0;
+    uint64_t rejected = 0;
+    uint64_t peakInFlight = 0;
+    uint64_t connects = 0;
+    uint64_t resumedHandshakes = 0;
+    uint64_t heartbeats = 0;
+};
+
+// Sends orders over a small set of keep-alive TLS connections driven by a
+// single io_context thread. Requests beyond maxInFlight, or beyond what the
+// connections' pipelines can take, wait in a queue; once that queue is full
+// submit() refuses new work so callers see backpressure instead of unbounded
+// buffering. Reconnects resume the last TLS session.
+class OrderGateway {
+public:
+    typedef std::function<void(const OrderResult&)> completion_handler;
+
+    explicit OrderGateway(OrderGatewayConfig config);
+    ~OrderGateway();
+
+    OrderGateway(const OrderGateway&) = delete;
+    OrderGateway& operator=(const OrderGateway&) = delete;
+
+    // clientIdPrefix is passed to the encoder; see OrderEncoder.
+    void setCredentials(const string& apiKey, const string& apiSecretKey, const string& clientIdPrefix = string());
+
+    void start();
+    void stop();
+    // Connects every connection now instead of on the first order and keeps
+    // them open with heartbeats until stop(). Returns without waiting for
+    // the handshakes; see stats().connects.
+    void warmUp();
+
+    // Thread-safe. Returns false without invoking the handler when the
+    // gateway is saturated; the handler runs on the gateway's I/O thread.
+    bool submit(http_request req, completion_handler handler);
+    std::future<OrderResult> submit(http_request req);
+    // Sends an already encoded request as is. The buffer is taken only when
+    // this returns true and goes back to the gateway's pool once the
+    // response is in; on false it is left with the caller to retry.
+    bool submit(EncodedOrderPtr&& order, completion_handler handler);
+
+    // Encodes order requests with this gateway's host and credentials; set
+    // by setCredentials().
+    OrderEncoder& encoder();
+    // A buffer from the pool, which starts with maxInFlight of them and
+    // only grows while every buffer is out. Thread-safe.
+    EncodedOrderPtr orderBuffer();
+
+    // Blocks until the gateway can accept another request.
+    void awaitCapacity();
+    // Blocks until every accepted request has completed.
+    void drain();
+
+    size_t outstanding() const { return accepted.load(std::memory_order_relaxed); }
+    OrderGatewayStats stats() const;
+    const OrderGatewayConfig& config() const { return cfg; }
+
+private:
+    struct Pending {
+        http_request req;
+        completion_handler handler;
+        uint64_t writtenTicks = 0;
+        bool started = false;
+        // Sent by the connection itself; no caller waits for it.
+        bool heartbeat = false;
+        // Pre-encoded request; when set, req is unused.
+        EncodedOrderPtr raw;
+    };
+    struct Connection;
+
+    bool reserve();
+    void handOff(Pending pending);
+    void drainInbox();
+    void dispatch();
+    void complete(Pending& pending, const OrderResult& result);
+    void scheduleHeartbeat();
+    http_request heartbeatRequest() const;
+
+    OrderGatewayConfig cfg;
+    string ALPACA_API_KEY;
+    string ALPACA_API_SECRET_KEY;
+    std::unique_ptr<OrderEncoder> orderEncoder;
+
+    // Declared before everything that can hold its buffers.
+    SlabPool<EncodedOrder> buffers;
+
+    // Submitted requests on their way to the I/O thread. One posted
+    // drainInbox() carries however many arrive before it runs. It returns
+    // its memory before running and takes the lock, so the submitting
+    // threads and the I/O thread never use drainMemory at once.
+    std::mutex inboxMutex;
+    std::vector<Pending> inbox;
+    std::vector<Pending> draining;
+    bool drainPosted = false;
+    HandlerMemory drainMemory{1, 256};
+
+    boost::asio::io_context ioc;
+    std::optional<boost::asio::executor_work_guard<boost::asio::io_context::executor_type>> work;
+    std::thread ioThread;
+    boost::asio::ssl::context sslCtx;
+    boost::asio::steady_timer heartbeatTimer;
+
+    // Only touched on the I/O thread.
+    std::vector<std::shared_ptr<Connection>> connections;
+    RingQueue<Pending> queued;
+    std::optional<boost::asio::ip::tcp::resolver::results_type> endpoints;
+    size_t onWire = 0;
+    bool closing = false;
+    bool warm = false;
+    // Offered by every new connection; owned here.
+    SSL_SESSION* resumeSession = nullptr;
+
+    std::atomic<size_t> accepted{0};
+    std::mutex capacityMutex;
+    std::condition_variable capacityCV;
+
+    std::atomic<uint64_t> submitted{0};
+    std::atomic<uint64_t> completed{0};
+    std::atomic<uint64_t> failed{0};
+    std::atomic<uint64_t> rejected{0};
+    std::atomic<uint64_t> peakInFlight{0};
+    std::atomic<uint64_t> connects{0};
+    std::atomic<uint64_t> resumedHandshakes{0};
+    std::atomic<uint64_t> heartbeats{0};
+};
+
+#endif
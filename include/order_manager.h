@@ -0,0 +1,188 @@
+#ifndef ORDER_MANAGER_H
+#define ORDER_MANAGER_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "order.h"
+#include "strategy.h"
+
+using std::string;
+
+enum class OrderStatus : uint8_t {
+    New,             // sent, not yet acknowledged
+    Unconfirmed,     // written, but the connection failed before the response
+    Accepted,
+    PartiallyFilled,
+    Filled,
+    Canceled,        // also expired and done for day
+    Rejected
+};
+
+const char* toString(OrderStatus status);
+
+inline bool isTerminal(OrderStatus status) {
+    return status == OrderStatus::Filled || status == OrderStatus::Canceled || status == OrderStatus::Rejected;
+}
+
+// An order as the engine tracks it. Quantities and prices are fixed point
+// in the symbol's size/price decimals.
+struct OrderRecord {
+    // Sequence part of the client_order_id; 0 marks an empty slot.
+    uint64_t clientOrderId = 0;
+    uint32_t symbolId = 0;
+    OrderSide side = OrderSide::Buy;
+    OrderType type = OrderType::Market;
+    TimeInForce timeInForce = TimeInForce::Gtc;
+    OrderStatus status = OrderStatus::New;
+    int64_t quantity = 0;
+    int64_t limitPrice = 0;
+    int64_t filledQuantity = 0;
+    int64_t averagePrice = 0;
+};
+
+// Net holding of one symbol from our own fills. quantity is signed (short
+// below zero); averagePrice is the average entry price of the open
+// quantity and realizedPnl is in quote currency. openBuy and openSell are
+// the unfilled quantities of orders reserved or sent and not yet finished,
+// which the position may still move by.
+struct Position {
+    int64_t quantity = 0;
+    int64_t averagePrice = 0;
+    double realizedPnl = 0;
+    int64_t openBuy = 0;
+    int64_t openSell = 0;
+};
+
+struct OrderManagerConfig {
+    // Orders tracked at once. Finished orders stay queryable until their
+    // slot is needed; open orders are never evicted.
+    size_t capacity = 65536;
+    // client_order_id = prefix + sequence. Empty picks one unique to this
+    // process start so ids never repeat across restarts.
+    string clientIdPrefix;
+};
+
+struct OrderManagerStats {
+    uint64_t opened = 0;
+    uint64_t updates = 0;
+    // Updates for orders this process did not send or already evicted.
+    uint64_t unknown = 0;
+    // Updates that would have moved an order backwards, e.g. a late "new"
+    // after a fill.
+    uint64_t stale = 0;
+    uint64_t fills = 0;
+    uint64_t evicted = 0;
+};
+
+// Order lifecycle and positions. open() assigns each outgoing order a
+// monotonic client_order_id and records it as New; the REST response and
+// the trade_updates stream then move it forward through
+//   New -> Accepted -> PartiallyFilled* -> Filled | Canceled | Rejected
+// and every fill is applied to the symbol's position. An order whose
+// request may have reached the exchange without an answer is Unconfirmed:
+// it stays open until the trade_updates stream or onOrder() settles it.
+//
+// Orders live in a preallocated open-addressing table (linear probing,
+// backward-shift deletion) keyed by the sequence number, guarded by one
+// mutex held for a few probes. Positions are a flat array indexed by symbol
+// id behind a per-symbol sequence lock, so strategies read them in O(1)
+// without blocking the update thread.
+class OrderManager {
+public:
+    explicit OrderManager(OrderManagerConfig config = OrderManagerConfig());
+
+    OrderManager(const OrderManager&) = delete;
+    OrderManager& operator=(const OrderManager&) = delete;
+
+    // Start tracking an order about to be sent. Returns its sequence
+    // number, or 0 when the table is full of open orders.
+    uint64_t open(const OrderIntent& intent);
+    // From an Order's formatted fields; order.symbolId must be set for
+    // its fills to reach a position. Takes over order.reserved, also when
+    // it returns 0.
+    uint64_t open(const Order& order);
+
+    // Counts quantity on the symbol's open orders for an order that has
+    // passed risk but is not sent yet, so orders staged after it see it.
+    // open() takes the reservation over; an order dropped before that
+    // must release it.
+    void reserve(uint32_t symbolId, OrderSide side, int64_t quantity);
+    void release(uint32_t symbolId, OrderSide side, int64_t quantity);
+
+    // Moves an order forward; fills are given as the cumulative filled
+    // quantity and the price of the newly filled part. Returns false for
+    // unknown orders and backward transitions.
+    bool apply(uint64_t clientOrderId, OrderStatus status, int64_t filledQuantity = -1, int64_t fillPrice = 0);
+
+    // One trade_updates frame, e.g.
+    //   {"stream":"trade_updates","data":{"event":"fill","price":"64000",
+    //    "order":{"client_order_id":"...","filled_qty":"0.5",...}}}
+    // Control frames (authorization, listening) are ignored. Returns true
+    // if the frame updated an order.
+    bool onTradeUpdate(std::string_view frame);
+    // One order object as GET /v2/orders returns it, e.g.
+    //   {"client_order_id":"...","status":"filled","filled_qty":"0.5",
+    //    "filled_avg_price":"64000",...}
+    // Returns true if it updated an order.
+    bool onOrder(std::string_view body);
+
+    bool find(uint64_t clientOrderId, OrderRecord& out) const;
+    Position position(uint32_t symbolId) const;
+    size_t openOrders() const;
+    // Appends the ids of the Unconfirmed orders to out.
+    void unconfirmedOrders(std::vector<uint64_t>& out) const;
+    OrderManagerStats stats() const;
+
+    const string& clientIdPrefix() const { return prefix; }
+    string clientOrderId(uint64_t id) const { return prefix + std::to_string(id); }
+    // 0 unless the text is one of our ids.
+    uint64_t parseClientOrderId(std::string_view text) const;
+
+private:
+    struct PositionSlot {
+        // Odd while a write is in progress.
+        std::atomic<uint64_t> sequence{0};
+        std::atomic<int64_t> quantity{0};
+        std::atomic<int64_t> averagePrice{0};
+        std::atomic<double> realizedPnl{0};
+        std::atomic<int64_t> openBuy{0};
+        std::atomic<int64_t> openSell{0};
+    };
+
+    // Caller holds the mutex.
+    OrderRecord* lookup(uint64_t clientOrderId);
+    const OrderRecord* lookup(uint64_t clientOrderId) const;
+    // reserved is open quantity already held for the order.
+    uint64_t insert(OrderRecord record, int64_t reserved = 0);
+    void erase(uint64_t clientOrderId);
+    bool evictFinished();
+    size_t home(uint64_t clientOrderId) const;
+    void fill(uint32_t symbolId, OrderSide side, int64_t quantity, int64_t price);
+    // Moves the symbol's open quantity on one side by delta.
+    void adjustOpen(uint32_t symbolId, OrderSide side, int64_t delta);
+
+    const size_t capacity;
+    const size_t mask;
+    string prefix;
+
+    mutable std::mutex mutex;
+    std::vector<OrderRecord> slots;
+    size_t count = 0;
+    size_t openCount = 0;
+    uint64_t nextId = 1;
+    // Finished orders, oldest first, as a ring; evicted when space runs out.
+    std::vector<uint64_t> finished;
+    size_t finishedHead = 0;
+    size_t finishedCount = 0;
+    OrderManagerStats counters;
+
+    std::unique_ptr<PositionSlot[]> positions;
+};
+
+#endif
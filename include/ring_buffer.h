@@ -0,0 +1,441 @@
+#ifndef RING_BUFFER_H
+#define RING_BUFFER_H
+
+#include <atomic>
+#include <chrono>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <ctime>
+#include <memory>
+#include <thread>
+#include <type_traits>
+
+#ifdef __linux__
+#include <linux/futex.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+constexpr size_t CACHE_LINE_SIZE = 64;
+
+enum class WaitPolicy {
+    BusySpin,
+    Yield,
+    Block
+};
+
+struct RingStats {
+    uint64_t pushed = 0;
+    uint64_t popped = 0;
+    uint64_t drops = 0;
+    uint64_t backpressureWaits = 0;
+};
+
+inline void cpuRelax() {
+#if defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+// Parks a thread until another thread calls notify(). BusySpin and Yield never
+// enter the kernel; Block spins briefly and then sleeps on a futex so an idle
+// consumer costs no CPU while a busy one never pays for a syscall.
+class Waiter {
+public:
+    explicit Waiter(WaitPolicy policy = WaitPolicy::Block) : policy(policy) {}
+
+    template <typename Ready>
+    void waitUntil(Ready ready) {
+        for (int spins = 0; !ready(); ++spins) {
+            if (policy == WaitPolicy::BusySpin || spins < 128) {
+                cpuRelax();
+            } else if (policy == WaitPolicy::Yield || spins < 256) {
+                std::this_thread::yield();
+            } else {
+                sleep(ready, nullptr);
+            }
+        }
+    }
+
+    // Like waitUntil(ready), but gives up at the deadline. Returns whether
+    // ready() held.
+    template <typename Ready>
+    bool waitUntil(Ready ready, std::chrono::steady_clock::time_point deadline) {
+        for (int spins = 0; !ready(); ++spins) {
+            const auto now = std::chrono::steady_clock::now();
+            if (now >= deadline) return false;
+            if (policy == WaitPolicy::BusySpin || spins < 128) {
+                cpuRelax();
+            } else if (policy == WaitPolicy::Yield || spins < 256) {
+                std::this_thread::yield();
+            } else {
+                const auto left = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - now).count();
+                const timespec timeout{static_cast<time_t>(left / 1000000000), static_cast<long>(left % 1000000000)};
+                sleep(ready, &timeout);
+            }
+        }
+        return true;
+    }
+
+    // Call after publishing the state change the waiter is waiting for. The
+    // fence pairs with the sleeper's registration so that either the sleeper
+    // sees the new state or this side sees the sleeper and wakes it.
+    void notify() {
+        if (policy != WaitPolicy::Block) return;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (sleepers.load(std::memory_order_relaxed) != 0) {
+            sequence.fetch_add(1, std::memory_order_seq_cst);
+#ifdef __linux__
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&sequence), FUTEX_WAKE_PRIVATE, INT_MAX, nullptr, nullptr, 0);
+#endif
+        }
+    }
+
+private:
+    // timeout is relative; nullptr sleeps until notified.
+    template <typename Ready>
+    void sleep(Ready& ready, const timespec* timeout) {
+#ifdef __linux__
+        sleepers.fetch_add(1, std::memory_order_seq_cst);
+        uint32_t observed = sequence.load(std::memory_order_seq_cst);
+        if (!ready()) {
+            syscall(SYS_futex, reinterpret_cast<uint32_t*>(&sequence), FUTEX_WAIT_PRIVATE, observed, timeout, nullptr,
+                    0);
+        }
+        sleepers.fetch_sub(1, std::memory_order_seq_cst);
+#else
+        (void)ready;
+        (void)timeout;
+        std::this_thread::yield();
+#endif
+    }
+
+    static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "futex word must be a plain 32-bit integer");
+
+    WaitPolicy policy;
+    alignas(CACHE_LINE_SIZE) std::atomic<uint32_t> sequence{0};
+    std::atomic<uint32_t> sleepers{0};
+};
+
+// Bounded single-producer/single-consumer queue with pre-allocated slots.
+// Producer and consumer indices live on separate cache lines and each side
+// caches the other's index so the shared line is only touched when the
+// cached view says the ring is full or empty.
+template <typename T>
+class SpscRing {
+    static_assert(std::is_trivially_copyable<T>::value, "SpscRing slots are copied with plain stores");
+
+public:
+    explicit SpscRing(size_t capacity, WaitPolicy policy = WaitPolicy::Block)
+        : mask(roundUp(capacity) - 1), slots(new T[mask + 1]), notEmpty(policy), notFull(policy) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    size_t capacity() const { return mask + 1; }
+
+    // Producer side. Fails (and counts a drop) when the ring is full.
+    bool tryPush(const T& item) {
+        if (!pushNoWait(item)) {
+            drops.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    // Producer side. Waits for space; each wait is counted as backpressure.
+    // Returns false only if the ring was closed.
+    bool push(const T& item) {
+        if (pushNoWait(item)) return true;
+
+        backpressureWaits.fetch_add(1, std::memory_order_relaxed);
+        for (;;) {
+            notFull.waitUntil([this] {
+                return closed.load(std::memory_order_acquire) ||
+                       tail.load(std::memory_order_relaxed) - head.load(std::memory_order_acquire) <= mask;
+            });
+            if (closed.load(std::memory_order_acquire)) return false;
+            if (pushNoWait(item)) return true;
+        }
+    }
+
+    // Producer side: tryPush() and push() without waking the consumer, for
+    // handing over a batch of items with a single wake() at the end.
+    // pushQuiet() still wakes the consumer before it waits for space.
+    bool tryPushQuiet(const T& item) {
+        if (!storeNoWait(item)) {
+            drops.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    bool pushQuiet(const T& item) {
+        if (storeNoWait(item)) return true;
+        notEmpty.notify();
+        return push(item);
+    }
+
+    void wake() { notEmpty.notify(); }
+
+    // Consumer side.
+    bool tryPop(T& out) {
+        const uint64_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) return false;
+        }
+        out = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        popped.fetch_add(1, std::memory_order_relaxed);
+        notFull.notify();
+        return true;
+    }
+
+    // Consumer side. Copies up to max items and releases them in one store.
+    size_t tryPopBatch(T* out, size_t max) {
+        const uint64_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) return 0;
+        }
+        size_t n = static_cast<size_t>(cachedTail - h);
+        if (n > max) n = max;
+        for (size_t i = 0; i < n; ++i) {
+            out[i] = slots[(h + i) & mask];
+        }
+        head.store(h + n, std::memory_order_release);
+        popped.fetch_add(n, std::memory_order_relaxed);
+        notFull.notify();
+        return n;
+    }
+
+    // Consumer side. Waits for data; returns false once closed and drained.
+    bool pop(T& out) {
+        for (;;) {
+            if (tryPop(out)) return true;
+            if (closed.load(std::memory_order_acquire)) return tryPop(out);
+            notEmpty.waitUntil([this] {
+                return closed.load(std::memory_order_acquire) ||
+                       tail.load(std::memory_order_acquire) != head.load(std::memory_order_relaxed);
+            });
+        }
+    }
+
+    size_t popBatch(T* out, size_t max) {
+        for (;;) {
+            size_t n = tryPopBatch(out, max);
+            if (n != 0) return n;
+            if (closed.load(std::memory_order_acquire)) return tryPopBatch(out, max);
+            notEmpty.waitUntil([this] {
+                return closed.load(std::memory_order_acquire) ||
+                       tail.load(std::memory_order_acquire) != head.load(std::memory_order_relaxed);
+            });
+        }
+    }
+
+    void close() {
+        closed.store(true, std::memory_order_release);
+        notEmpty.notify();
+        notFull.notify();
+    }
+
+    bool isClosed() const { return closed.load(std::memory_order_acquire); }
+
+    size_t size() const {
+        return static_cast<size_t>(tail.load(std::memory_order_acquire) - head.load(std::memory_order_acquire));
+    }
+
+    RingStats stats() const {
+        RingStats s;
+        s.pushed = tail.load(std::memory_order_relaxed);
+        s.popped = popped.load(std::memory_order_relaxed);
+        s.drops = drops.load(std::memory_order_relaxed);
+        s.backpressureWaits = backpressureWaits.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    static size_t roundUp(size_t n) {
+        if (n < 2) n = 2;
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    bool pushNoWait(const T& item) {
+        if (!storeNoWait(item)) return false;
+        notEmpty.notify();
+        return true;
+    }
+
+    bool storeNoWait(const T& item) {
+        const uint64_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead > mask) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead > mask) return false;
+        }
+        slots[t & mask] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    const size_t mask;
+    std::unique_ptr<T[]> slots;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> tail{0};
+    uint64_t cachedHead = 0;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> head{0};
+    uint64_t cachedTail = 0;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> popped{0};
+    std::atomic<uint64_t> drops{0};
+    std::atomic<uint64_t> backpressureWaits{0};
+    std::atomic<bool> closed{false};
+
+    Waiter notEmpty;
+    Waiter notFull;
+};
+
+// Bounded multi-producer/single-consumer queue (Vyukov-style sequenced
+// slots). Producers claim a slot with one CAS on the tail; the consumer
+// never writes a shared counter other than the slot sequence.
+template <typename T>
+class MpscRing {
+    static_assert(std::is_trivially_copyable<T>::value, "MpscRing slots are copied with plain stores");
+
+public:
+    explicit MpscRing(size_t capacity, WaitPolicy policy = WaitPolicy::Block)
+        : mask(roundUp(capacity) - 1), slots(new Slot[mask + 1]), notEmpty(policy), notFull(policy) {
+        for (size_t i = 0; i <= mask; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpscRing(const MpscRing&) = delete;
+    MpscRing& operator=(const MpscRing&) = delete;
+
+    size_t capacity() const { return mask + 1; }
+
+    bool tryPush(const T& item) {
+        if (!pushNoWait(item)) {
+            drops.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    bool push(const T& item) {
+        if (pushNoWait(item)) return true;
+
+        backpressureWaits.fetch_add(1, std::memory_order_relaxed);
+        for (;;) {
+            notFull.waitUntil([this] {
+                if (closed.load(std::memory_order_acquire)) return true;
+                uint64_t t = tail.load(std::memory_order_relaxed);
+                return slots[t & mask].sequence.load(std::memory_order_acquire) == t;
+            });
+            if (closed.load(std::memory_order_acquire)) return false;
+            if (pushNoWait(item)) return true;
+        }
+    }
+
+    bool tryPop(T& out) {
+        Slot& slot = slots[head & mask];
+        if (slot.sequence.load(std::memory_order_acquire) != head + 1) return false;
+        out = slot.value;
+        slot.sequence.store(head + mask + 1, std::memory_order_release);
+        ++head;
+        popped.fetch_add(1, std::memory_order_relaxed);
+        notFull.notify();
+        return true;
+    }
+
+    bool pop(T& out) {
+        for (;;) {
+            if (tryPop(out)) return true;
+            if (closed.load(std::memory_order_acquire)) return tryPop(out);
+            notEmpty.waitUntil([this] {
+                return closed.load(std::memory_order_acquire) ||
+                       slots[head & mask].sequence.load(std::memory_order_acquire) == head + 1;
+            });
+        }
+    }
+
+    void close() {
+        closed.store(true, std::memory_order_release);
+        notEmpty.notify();
+        notFull.notify();
+    }
+
+    bool isClosed() const { return closed.load(std::memory_order_acquire); }
+
+    RingStats stats() const {
+        RingStats s;
+        s.pushed = pushed.load(std::memory_order_relaxed);
+        s.popped = popped.load(std::memory_order_relaxed);
+        s.drops = drops.load(std::memory_order_relaxed);
+        s.backpressureWaits = backpressureWaits.load(std::memory_order_relaxed);
+        return s;
+    }
+
+private:
+    struct alignas(CACHE_LINE_SIZE) Slot {
+        std::atomic<uint64_t> sequence;
+        T value;
+    };
+
+    static size_t roundUp(size_t n) {
+        if (n < 2) n = 2;
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+
+    bool pushNoWait(const T& item) {
+        uint64_t t = tail.load(std::memory_order_relaxed);
+        for (;;) {
+            Slot& slot = slots[t & mask];
+            uint64_t seq = slot.sequence.load(std::memory_order_acquire);
+            int64_t diff = static_cast<int64_t>(seq) - static_cast<int64_t>(t);
+            if (diff == 0) {
+                if (tail.compare_exchange_weak(t, t + 1, std::memory_order_relaxed)) {
+                    slot.value = item;
+                    slot.sequence.store(t + 1, std::memory_order_release);
+                    pushed.fetch_add(1, std::memory_order_relaxed);
+                    notEmpty.notify();
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                t = tail.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    const size_t mask;
+    std::unique_ptr<Slot[]> slots;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> tail{0};
+    alignas(CACHE_LINE_SIZE) uint64_t head = 0;
+
+    alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> pushed{0};
+    std::atomic<uint64_t> popped{0};
+    std::atomic<uint64_t> drops{0};
+    std::atomic<uint64_t> backpressureWaits{0};
+    std::atomic<bool> closed{false};
+
+    Waiter notEmpty;
+    Waiter notFull;
+};
+
+#endif
@@ -0,0 +1,141 @@
+#ifndef RISK_H
+#define RISK_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "strategy.h"
+
+// Limits for one symbol. Quantities are in asset units and notionals in
+// quote currency; 0 disables a check.
+struct RiskLimits {
+    double maxOrderQuantity = 0;
+    // At the limit price, or the reference price for market orders.
+    double maxOrderNotional = 0;
+    // Largest absolute position the order, together with the symbol's open
+    // orders on its side, may leave behind.
+    double maxPosition = 0;
+    // Fat-finger band: a limit price further than this from the reference
+    // price (the latest quote mid or bar close) is rejected.
+    double priceBandBps = 0;
+    // Token bucket per symbol: sustained rate and burst size.
+    double ordersPerSecond = 0;
+    double burst = 1;
+};
+
+struct RiskConfig {
+    // Applies to every symbol without limits of its own.
+    RiskLimits defaults;
+    // Token bucket over all symbols.
+    double ordersPerSecond = 0;
+    double burst = 1;
+};
+
+enum class RiskReject : uint8_t {
+    None,
+    KillSwitch,
+    // Notional or band checks are on, or a market order has a minimum
+    // notional, but no price has been seen yet.
+    NoReference,
+    OrderSize,
+    Notional,
+    Position,
+    PriceBand,
+    RateLimit,
+    Count
+};
+
+const char* toString(RiskReject reason);
+
+struct RiskStats {
+    uint64_t checked = 0;
+    uint64_t passed = 0;
+    uint64_t rejected[static_cast<size_t>(RiskReject::Count)] = {};
+
+    uint64_t operator[](RiskReject reason) const { return rejected[static_cast<size_t>(reason)]; }
+};
+
+// Pre-trade checks every order passes before it is staged: order size,
+// notional, resulting position, price band, order rate and a global kill
+// switch. Size and notional also have to meet the symbol's minimums from its
+// SymbolInfo; check the intent after roundToRules. All state is per-symbol
+// atomics and a couple of global ones, so the feed shards check concurrently
+// without locks. The static checks are evaluated together into a bitmask
+// rather than as a chain of early exits; rate tokens are only taken by
+// orders that pass everything else.
+class RiskGate {
+public:
+    explicit RiskGate(const RiskConfig& config = RiskConfig());
+
+    RiskGate(const RiskGate&) = delete;
+    RiskGate& operator=(const RiskGate&) = delete;
+
+    // Replaces the global bucket and every symbol's limits with the
+    // defaults, dropping per-symbol overrides.
+    void configure(const RiskConfig& config);
+    void setLimits(uint32_t symbolId, const RiskLimits& limits);
+
+    // Feeds the reference price for the band and market order notionals.
+    void observe(uint32_t symbolId, int64_t price) {
+        if (symbolId < capacity) symbols[symbolId].reference.store(price, std::memory_order_relaxed);
+    }
+
+    // position is the symbol's current signed position in fixed point;
+    // openBuy and openSell the unfilled quantities of its orders already
+    // sent. The position limit holds even if every open order on the
+    // intent's side fills along with it.
+    RiskReject check(const OrderIntent& intent, int64_t position, int64_t openBuy = 0, int64_t openSell = 0);
+    // Only the checks on the order itself: size, notional, the symbol's
+    // minimums and the reference price they need. Takes no rate token and
+    // is not counted in stats(); for orders built from ones that already
+    // passed check(), e.g. by coalescing.
+    RiskReject checkOrder(const OrderIntent& intent) const;
+
+    // Kill switch: while halted every order is rejected.
+    void halt() { halted.store(true, std::memory_order_relaxed); }
+    void resume() { halted.store(false, std::memory_order_relaxed); }
+    bool isHalted() const { return halted.load(std::memory_order_relaxed); }
+
+    RiskStats stats() const;
+
+private:
+    // Token bucket as a theoretical arrival time (GCRA): a token is free
+    // while the next arrival time is at most `tolerance` ahead of now.
+    struct Bucket {
+        std::atomic<uint64_t> arrival{0};
+        std::atomic<uint64_t> interval{0};
+        std::atomic<uint64_t> tolerance{0};
+
+        void set(double perSecond, double burst, double ticksPerSecond);
+        bool take(uint64_t now);
+    };
+
+    // Bitmask of the checkOrder() failures.
+    uint32_t orderFailures(const OrderIntent& intent) const;
+
+    // Limits are kept with "disabled" as infinity so every comparison
+    // runs unconditionally.
+    struct alignas(64) SymbolRisk {
+        std::atomic<double> maxQuantity{0};
+        std::atomic<double> maxNotional{0};
+        std::atomic<double> maxPosition{0};
+        std::atomic<double> band{0};
+        std::atomic<bool> needsReference{false};
+        std::atomic<int64_t> reference{0};
+        Bucket rate;
+
+        void set(const RiskLimits& limits, double ticksPerSecond);
+    };
+
+    const size_t capacity;
+    const double ticksPerSecond;
+    std::unique_ptr<SymbolRisk[]> symbols;
+    Bucket global;
+    std::atomic<bool> halted{false};
+
+    std::atomic<uint64_t> checked{0};
+    std::atomic<uint64_t> rejected[static_cast<size_t>(RiskReject::Count)] = {};
+};
+
+#endif
@@ -0,0 +1,171 @@
+#ifndef SESSION_POOL_H
+#define SESSION_POOL_H
+
+#include <boost/asio.hpp>
+#include <boost/asio/ssl.hpp>
+#include <boost/beast.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/beast/http.hpp>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "thread_util.h"
+
+using std::string;
+
+typedef boost::beast::ssl_stream<boost::beast::tcp_stream> https_stream;
+typedef boost::beast::http::request<boost::beast::http::string_body> http_request;
+typedef boost::beast::http::response<boost::beast::http::string_body> http_response;
+
+struct SessionPoolConfig {
+    string host = "paper-api.alpaca.markets";
+    string port = "443";
+    size_t maxSessions = 4;
+    size_t warmSessions = 2;
+    std::chrono::milliseconds heartbeatInterval{15000};
+    std::chrono::seconds dnsTtl{300};
+    string heartbeatTarget = "/v2/clock";
+    // Bounds every connect, handshake, write and read on a session, and the
+    // wait for a free one, so an unresponsive peer fails the request instead
+    // of blocking it.
+    std::chrono::milliseconds ioTimeout{5000};
+    bool verifyPeer = false;
+    // The thread that warms, heartbeats and reconnects sessions.
+    ThreadPlacement maintenanceThread;
+};
+
+struct SessionPoolStats {
+    uint64_t connects = 0;
+    uint64_t resumedHandshakes = 0;
+    uint64_t reuses = 0;
+    uint64_t heartbeats = 0;
+    uint64_t reconnects = 0;
+    uint64_t failures = 0;
+};
+
+class DnsCache {
+public:
+    typedef boost::asio::ip::tcp::resolver::results_type results_type;
+
+    DnsCache(boost::asio::io_context& ioc, std::chrono::seconds ttl);
+
+    results_type resolve(const string& host, const string& port);
+    void invalidate();
+
+private:
+    boost::asio::ip::tcp::resolver resolver;
+    std::chrono::seconds ttl;
+
+    std::mutex mtx;
+    string cachedHost;
+    string cachedPort;
+    results_type cached;
+    std::chrono::steady_clock::time_point expiresAt;
+};
+
+struct HttpsSession {
+    explicit HttpsSession(boost::asio::ssl::context& ctx) : stream(ioc, ctx) {}
+
+    // Only the thread holding the session runs it, one operation at a time,
+    // so each can be bounded by the stream's deadline.
+    boost::asio::io_context ioc;
+    https_stream stream;
+    boost::beast::flat_buffer buffer;
+    std::chrono::steady_clock::time_point lastUsed;
+    uint64_t requests = 0;
+};
+
+// Keeps a set of HTTP/1.1 keep-alive TLS sessions to a single host warm so
+// that an order costs one request/response round trip instead of a DNS lookup,
+// TCP connect and full handshake. Dropped sessions are re-established by a
+// background thread which also sends heartbeats over idle sessions.
+class SessionPool {
+public:
+    class Lease {
+    public:
+        Lease(SessionPool* pool, std::unique_ptr<HttpsSession> session);
+        Lease(Lease&& other) noexcept;
+        Lease(const Lease&) = delete;
+        Lease& operator=(const Lease&) = delete;
+        ~Lease();
+
+        HttpsSession* operator->() const { return session.get(); }
+        HttpsSession& operator*() const { return *session; }
+
+        void markBroken() { healthy = false; }
+
+    private:
+        SessionPool* pool;
+        std::unique_ptr<HttpsSession> session;
+        bool healthy = true;
+    };
+
+    explicit SessionPool(SessionPoolConfig config);
+    ~SessionPool();
+
+    SessionPool(const SessionPool&) = delete;
+    SessionPool& operator=(const SessionPool&) = delete;
+
+    void setCredentials(const string& apiKey, const string& apiSecretKey);
+
+    void start();
+    void stop();
+
+    // An idle session, or a new one while fewer than maxSessions are open.
+    // Otherwise waits up to ioTimeout for one to be released, then throws.
+    Lease acquire();
+
+    // Stamps host, credentials and keep-alive on the request, sends it over a
+    // pooled session and reads the response. Returns the HTTP status code.
+    unsigned send(http_request& req, http_response& res);
+
+    SessionPoolStats stats() const;
+    const SessionPoolConfig& config() const { return cfg; }
+
+private:
+    std::unique_ptr<HttpsSession> connectSession();
+    void release(std::unique_ptr<HttpsSession> session, bool healthy);
+    void rememberTlsSession(HttpsSession& session);
+    // Starts an asynchronous operation on the session and runs its context
+    // until the operation completes or ioTimeout passes.
+    template <typename Operation>
+    boost::system::error_code runWithDeadline(HttpsSession& session, Operation operation);
+    bool heartbeat(HttpsSession& session);
+    void maintain();
+
+    SessionPoolConfig cfg;
+    string ALPACA_API_KEY;
+    string ALPACA_API_SECRET_KEY;
+
+    boost::asio::io_context ioc;
+    boost::asio::ssl::context sslCtx;
+    DnsCache dns;
+
+    std::mutex resumeMutex;
+    SSL_SESSION* resumeSession = nullptr;
+
+    mutable std::mutex poolMutex;
+    std::condition_variable poolCV;
+    std::vector<std::unique_ptr<HttpsSession>> idle;
+    size_t openSessions = 0;
+    size_t pendingReconnects = 0;
+    bool stopping = false;
+    std::thread maintenanceThread;
+
+    std::atomic<uint64_t> connects{0};
+    std::atomic<uint64_t> resumedHandshakes{0};
+    std::atomic<uint64_t> reuses{0};
+    std::atomic<uint64_t> heartbeats{0};
+    std::atomic<uint64_t> reconnects{0};
+    std::atomic<uint64_t> failures{0};
+};
+
+#endif
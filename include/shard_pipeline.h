@@ -0,0 +1,205 @@
+#ifndef SHARD_PIPELINE_H
+#define SHARD_PIPELINE_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "market_data.h"
+#include "ring_buffer.h"
+#include "symbol_table.h"
+#include "thread_util.h"
+
+struct ShardPipelineConfig {
+    // 0 picks one shard per core, leaving a core for the feed thread.
+    size_t shards = 0;
+    size_t ringCapacity = 65536;
+    size_t batchSize = 256;
+    WaitPolicy waitPolicy = WaitPolicy::Block;
+    bool dropWhenFull = false;
+    // threads[i] places shard i's worker; missing entries leave it to the
+    // scheduler.
+    std::vector<ThreadPlacement> threads;
+};
+
+// Routes each event to the shard that owns its symbol (see symbolOf). Every
+// shard has its own SPSC ring and worker thread, so a symbol's events are
+// processed in arrival order by one thread and shard state needs no
+// locking. The feed thread is the only producer; publish(), quiesce() and
+// rebalance() must be called from it (or while it is stopped).
+//
+// Shard must provide:
+//   void onBatch(const Event* events, size_t count);
+//   void moveSymbol(uint32_t symbolId, Shard& to);
+template <typename Shard, typename Event = CompactBar>
+class ShardPipeline {
+public:
+    typedef std::function<std::unique_ptr<Shard>(size_t)> factory_type;
+
+    ShardPipeline(const ShardPipelineConfig& config, factory_type factory) : cfg(config) {
+        size_t count = cfg.shards;
+        if (count == 0) {
+            unsigned cores = std::thread::hardware_concurrency();
+            count = cores > 1 ? cores - 1 : 1;
+        }
+        if (count > UINT16_MAX) count = UINT16_MAX;
+        if (cfg.batchSize == 0) cfg.batchSize = 1;
+
+        for (size_t i = 0; i < count; ++i) {
+            auto lane = std::make_unique<Lane>();
+            lane->ring = std::make_unique<SpscRing<Event>>(cfg.ringCapacity, cfg.waitPolicy);
+            lane->shard = factory(i);
+            lanes.push_back(std::move(lane));
+        }
+
+        route.reset(new std::atomic<uint16_t>[SymbolTable::CAPACITY]);
+        for (size_t id = 0; id < SymbolTable::CAPACITY; ++id) {
+            route[id].store(static_cast<uint16_t>(id % count), std::memory_order_relaxed);
+        }
+    }
+
+    ~ShardPipeline() {
+        stop();
+    }
+
+    ShardPipeline(const ShardPipeline&) = delete;
+    ShardPipeline& operator=(const ShardPipeline&) = delete;
+
+    void start() {
+        for (size_t i = 0; i < lanes.size(); ++i) {
+            Lane& lane = *lanes[i];
+            if (lane.worker.joinable()) continue;
+            ThreadPlacement placement = i < cfg.threads.size() ? cfg.threads[i] : ThreadPlacement();
+            lane.worker = std::thread([this, &lane, i, placement]() {
+                placeThisThread("shard-" + std::to_string(i), placement);
+                run(lane);
+            });
+        }
+    }
+
+    // Lets every shard drain what was already published, then joins.
+    void stop() {
+        for (auto& lane : lanes) {
+            lane->ring->close();
+        }
+        for (auto& lane : lanes) {
+            if (lane->worker.joinable()) lane->worker.join();
+        }
+    }
+
+    size_t shardCount() const { return lanes.size(); }
+    size_t shardOf(uint32_t symbolId) const { return route[symbolId].load(std::memory_order_relaxed); }
+    Shard& shard(size_t index) { return *lanes[index]->shard; }
+
+    bool publish(const Event& event) {
+        Lane& lane = *lanes[route[symbolOf(event)].load(std::memory_order_relaxed)];
+        bool accepted = cfg.dropWhenFull ? lane.ring->tryPush(event) : lane.ring->push(event);
+        if (accepted) ++lane.published;
+        return accepted;
+    }
+
+    // Publishes a run of events, e.g. everything one frame decoded to,
+    // waking each shard it reaches once rather than once per event. Returns
+    // how many were accepted.
+    size_t publish(const Event* events, size_t count) {
+        size_t accepted = 0;
+        for (size_t i = 0; i < count; ++i) {
+            Lane& lane = *lanes[route[symbolOf(events[i])].load(std::memory_order_relaxed)];
+            if (cfg.dropWhenFull ? lane.ring->tryPushQuiet(events[i]) : lane.ring->pushQuiet(events[i])) {
+                ++lane.published;
+                lane.wakePending = true;
+                ++accepted;
+            }
+        }
+        for (auto& lane : lanes) {
+            if (!lane->wakePending) continue;
+            lane->wakePending = false;
+            lane->ring->wake();
+        }
+        return accepted;
+    }
+
+    // Waits until every shard has processed everything published so far.
+    void quiesce() {
+        for (auto& lane : lanes) {
+            while (lane->worker.joinable() && lane->processed.load(std::memory_order_acquire) != lane->published) {
+                std::this_thread::yield();
+            }
+        }
+    }
+
+    // Reassigns the given symbols across shards, heaviest first onto the
+    // least loaded shard. weights[i] is the relative message rate of
+    // symbols[i]; all symbols weigh the same when weights is empty. Shards
+    // are quiesced first and per-symbol state follows the symbol, so
+    // ordering holds across the move.
+    void rebalance(const std::vector<uint32_t>& symbols, const std::vector<uint64_t>& weights = {}) {
+        std::vector<size_t> order(symbols.size());
+        std::iota(order.begin(), order.end(), 0);
+        auto weightOf = [&](size_t i) { return i < weights.size() ? weights[i] : 1; };
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return weightOf(a) > weightOf(b); });
+
+        std::vector<uint64_t> load(lanes.size(), 0);
+        std::vector<uint16_t> target(symbols.size());
+        for (size_t i : order) {
+            size_t lightest = std::min_element(load.begin(), load.end()) - load.begin();
+            target[i] = static_cast<uint16_t>(lightest);
+            load[lightest] += weightOf(i);
+        }
+
+        quiesce();
+        for (size_t i = 0; i < symbols.size(); ++i) {
+            uint32_t id = symbols[i];
+            if (id >= SymbolTable::CAPACITY) continue;
+            uint16_t from = route[id].load(std::memory_order_relaxed);
+            if (from == target[i]) continue;
+            lanes[from]->shard->moveSymbol(id, *lanes[target[i]]->shard);
+            route[id].store(target[i], std::memory_order_relaxed);
+        }
+    }
+
+    RingStats stats() const {
+        RingStats total;
+        for (auto& lane : lanes) {
+            RingStats s = lane->ring->stats();
+            total.pushed += s.pushed;
+            total.popped += s.popped;
+            total.drops += s.drops;
+            total.backpressureWaits += s.backpressureWaits;
+        }
+        return total;
+    }
+
+private:
+    struct Lane {
+        std::unique_ptr<SpscRing<Event>> ring;
+        std::unique_ptr<Shard> shard;
+        std::thread worker;
+        uint64_t published = 0;
+        // Set by publish(events, count) until its single wake.
+        bool wakePending = false;
+        alignas(CACHE_LINE_SIZE) std::atomic<uint64_t> processed{0};
+    };
+
+    void run(Lane& lane) {
+        std::vector<Event> drained(cfg.batchSize);
+        for (;;) {
+            size_t n = lane.ring->popBatch(drained.data(), drained.size());
+            if (n == 0) return;
+            lane.shard->onBatch(drained.data(), n);
+            lane.processed.fetch_add(n, std::memory_order_release);
+        }
+    }
+
+    ShardPipelineConfig cfg;
+    std::vector<std::unique_ptr<Lane>> lanes;
+    std::unique_ptr<std::atomic<uint16_t>[]> route;
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef SMA_CROSSOVER_H
+#define SMA_CROSSOVER_H
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+#include "fixed_point.h"
+#include "strategy.h"
+#include "symbol_table.h"
+
+// Sample strategy: buys when the fast simple moving average of closes
+// crosses above the slow one and sells when it crosses back below. Sums are
+// kept in fixed point and compared cross-multiplied, so there is no division
+// or floating point per bar. Per-symbol state is allocated the first time a
+// symbol is seen and reused afterwards.
+template <size_t Fast, size_t Slow>
+class SmaCrossover : public Strategy<SmaCrossover<Fast, Slow>> {
+    static_assert(Fast > 0 && Fast < Slow, "fast window must be shorter than the slow one");
+
+public:
+    // quantity is in units of the asset and converted to each symbol's size
+    // decimals once.
+    explicit SmaCrossover(double quantity = 1.0, SymbolTable& symbols = SymbolTable::get_instance())
+        : quantity(quantity), symbols(&symbols) {}
+
+    void onBar(const CompactBar& bar, IntentBuffer& out) {
+        State& s = state(bar.symbolId);
+
+        const size_t slot = s.count % Slow;
+        const int64_t leavingSlow = s.closes[slot];
+        const int64_t leavingFast = s.closes[(s.count + Slow - Fast) % Slow];
+        s.closes[slot] = bar.close;
+
+        s.slowSum += bar.close - (s.count >= Slow ? leavingSlow : 0);
+        s.fastSum += bar.close - (s.count >= Fast ? leavingFast : 0);
+        ++s.count;
+        if (s.count < Slow) return;
+
+        // fastSum / Fast vs slowSum / Slow without dividing.
+        const int64_t spread = s.fastSum * static_cast<int64_t>(Slow) - s.slowSum * static_cast<int64_t>(Fast);
+        const int8_t regime = spread > 0 ? 1 : (spread < 0 ? -1 : 0);
+        if (regime != 0 && s.regime != 0 && regime != s.regime) {
+            OrderIntent intent{};
+            intent.symbolId = bar.symbolId;
+            intent.side = regime > 0 ? OrderSide::Buy : OrderSide::Sell;
+            intent.type = OrderType::Market;
+            intent.timeInForce = TimeInForce::Gtc;
+            intent.quantity = s.quantity;
+            this->emit(out, intent);
+        }
+        if (regime != 0) s.regime = regime;
+    }
+
+    void moveSymbol(uint32_t symbolId, SmaCrossover& to) {
+        if (symbolId >= states.size() || !states[symbolId].active) return;
+        to.state(symbolId) = states[symbolId];
+        states[symbolId] = State();
+    }
+
+    // Fast and slow averages in the symbol's price scale; 0 until warm.
+    int64_t fastAverage(uint32_t symbolId) const {
+        return warm(symbolId) ? states[symbolId].fastSum / static_cast<int64_t>(Fast) : 0;
+    }
+
+    int64_t slowAverage(uint32_t symbolId) const {
+        return warm(symbolId) ? states[symbolId].slowSum / static_cast<int64_t>(Slow) : 0;
+    }
+
+private:
+    struct State {
+        std::array<int64_t, Slow> closes{};
+        int64_t fastSum = 0;
+        int64_t slowSum = 0;
+        int64_t quantity = 0;
+        uint64_t count = 0;
+        int8_t regime = 0;
+        bool active = false;
+    };
+
+    bool warm(uint32_t symbolId) const {
+        return symbolId < states.size() && states[symbolId].count >= Slow;
+    }
+
+    State& state(uint32_t symbolId) {
+        if (symbolId >= states.size()) {
+            states.resize(symbolId + 1);
+        }
+        State& s = states[symbolId];
+        if (!s.active) {
+            s.active = true;
+            s.quantity = fixed_point::fromDouble(quantity, symbols->sizeDecimals(symbolId));
+        }
+        return s;
+    }
+
+    double quantity;
+    SymbolTable* symbols;
+    std::vector<State> states;
+};
+
+#endif
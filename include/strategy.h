@@ -0,0 +1,304 @@
+#ifndef STRATEGY_H
+#define STRATEGY_H
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "market_data.h"
+#include "order.h"
+#include "order_book.h"
+
+// What a strategy wants traded. Quantity and limit price are fixed point in
+// the symbol's size/price decimals; the client turns intents into orders.
+struct OrderIntent {
+    uint32_t symbolId;
+    uint16_t strategyId;
+    OrderSide side;
+    OrderType type;
+    TimeInForce timeInForce;
+    int64_t quantity;
+    int64_t limitPrice;
+};
+
+static_assert(std::is_trivially_copyable<OrderIntent>::value, "OrderIntent must stay POD");
+
+// Fixed-capacity output buffer strategies write intents into. Storage is
+// allocated once up front; intents past capacity are counted and dropped
+// rather than growing the buffer on the hot path.
+class IntentBuffer {
+public:
+    explicit IntentBuffer(size_t capacity = 1024) : intents(capacity) {}
+
+    bool push(const OrderIntent& intent) {
+        if (count == intents.size()) {
+            ++dropped;
+            return false;
+        }
+        intents[count++] = intent;
+        return true;
+    }
+
+    const OrderIntent* begin() const { return intents.data(); }
+    const OrderIntent* end() const { return intents.data() + count; }
+    const OrderIntent& operator[](size_t i) const { return intents[i]; }
+    size_t size() const { return count; }
+    size_t capacity() const { return intents.size(); }
+    bool empty() const { return count == 0; }
+    uint64_t drops() const { return dropped; }
+    void clear() { count = 0; }
+
+private:
+    std::vector<OrderIntent> intents;
+    size_t count = 0;
+    uint64_t dropped = 0;
+};
+
+// CRTP base for strategies. A strategy derives from Strategy<Self> and hides
+// the callbacks it cares about; the rest fall back to these no-ops, and
+// every call is resolved at compile time.
+//
+//   class MyStrategy : public Strategy<MyStrategy> {
+//   public:
+//       void onBar(const CompactBar& bar, IntentBuffer& out);
+//   };
+//
+// A strategy that would rather see a whole batch at once (to work across
+// symbols or vectorize an indicator update) hides onBatch() instead; it then
+// gets each batch of events in one call and no per-event callbacks.
+//
+// A strategy that keeps per-symbol state should also hide moveSymbol() so
+// the state follows the symbol when shards are rebalanced.
+template <typename Derived>
+class Strategy {
+public:
+    // Every event of a batch, in arrival order, with the books as they are
+    // once all of the batch's levels are applied.
+    void onBatch(EventSpan, const OrderBookSet&, IntentBuffer&) {}
+
+    void onBar(const CompactBar&, IntentBuffer&) {}
+    // A correction of a minute bar already passed to onBar, and the day's
+    // running bar; neither is a new interval.
+    void onUpdatedBar(const CompactBar&, IntentBuffer&) {}
+    void onDailyBar(const CompactBar&, IntentBuffer&) {}
+    void onTrade(const TradeRecord&, IntentBuffer&) {}
+    void onQuote(const QuoteRecord&, IntentBuffer&) {}
+    // Called once per order book message, after all its levels are applied.
+    void onBook(const OrderBook&, IntentBuffer&) {}
+    void moveSymbol(uint32_t, Derived&) {}
+
+    uint16_t strategyId() const { return id; }
+    void setStrategyId(uint16_t strategyId) { id = strategyId; }
+
+protected:
+    // Fills in the strategy id so intents can be attributed downstream.
+    bool emit(IntentBuffer& out, OrderIntent intent) const {
+        intent.strategyId = id;
+        return out.push(intent);
+    }
+
+private:
+    uint16_t id = 0;
+};
+
+// True for strategies that hide Strategy::onBatch.
+template <typename S>
+constexpr bool handlesBatches =
+    !std::is_same<decltype(&S::onBatch), decltype(&Strategy<S>::onBatch)>::value;
+
+// Runs a fixed set of strategies side by side on the same events. Each
+// event is handed to every per-event strategy in declaration order through
+// a fold over the tuple, so there is no virtual call per event; batch
+// strategies get one onBatch call per onEvents.
+template <typename... Strategies>
+class StrategyEngine {
+public:
+    StrategyEngine() { assignIds(std::index_sequence_for<Strategies...>()); }
+
+    explicit StrategyEngine(Strategies... strategies) : strategies(std::move(strategies)...) {
+        assignIds(std::index_sequence_for<Strategies...>());
+    }
+
+    // Single events, e.g. from a backtest; batch strategies see each as a
+    // batch of one.
+    void onBar(const CompactBar& bar, IntentBuffer& out) {
+        forEach([&](auto& s) { s.onBar(bar, out); });
+        batchOfOne(MarketEvent::of(bar), out);
+    }
+
+    void onUpdatedBar(const CompactBar& bar, IntentBuffer& out) {
+        forEach([&](auto& s) { s.onUpdatedBar(bar, out); });
+        batchOfOne(MarketEvent::of(bar, EventType::UpdatedBar), out);
+    }
+
+    void onDailyBar(const CompactBar& bar, IntentBuffer& out) {
+        forEach([&](auto& s) { s.onDailyBar(bar, out); });
+        batchOfOne(MarketEvent::of(bar, EventType::DailyBar), out);
+    }
+
+    void onTrade(const TradeRecord& trade, IntentBuffer& out) {
+        forEach([&](auto& s) { s.onTrade(trade, out); });
+        batchOfOne(MarketEvent::of(trade), out);
+    }
+
+    void onQuote(const QuoteRecord& quote, IntentBuffer& out) {
+        forEach([&](auto& s) { s.onQuote(quote, out); });
+        batchOfOne(MarketEvent::of(quote), out);
+    }
+
+    void onBook(const OrderBook& book, IntentBuffer& out) {
+        forEach([&](auto& s) { s.onBook(book, out); });
+    }
+
+    void onBars(const CompactBar* bars, size_t count, IntentBuffer& out) {
+        for (size_t i = 0; i < count; ++i) {
+            onBar(bars[i], out);
+        }
+    }
+
+    // Dispatches a mixed run of feed events: book levels are applied to
+    // books, per-event strategies get each event in order (and onBook as
+    // each book message completes), then batch strategies get the run.
+    void onEvents(const MarketEvent* events, size_t count, OrderBookSet& books, IntentBuffer& out) {
+        for (size_t i = 0; i < count; ++i) {
+            const MarketEvent& event = events[i];
+            if constexpr (!PER_EVENT) {
+                if (event.type == EventType::BookLevel) books.apply(event.level);
+                continue;
+            }
+            switch (event.type) {
+            case EventType::Bar:
+                forEach([&](auto& s) { s.onBar(event.bar, out); });
+                break;
+            case EventType::Trade:
+                forEach([&](auto& s) { s.onTrade(event.trade, out); });
+                break;
+            case EventType::Quote:
+                forEach([&](auto& s) { s.onQuote(event.quote, out); });
+                break;
+            case EventType::BookLevel:
+                if (const OrderBook* book = books.apply(event.level)) {
+                    onBook(*book, out);
+                }
+                break;
+            case EventType::UpdatedBar:
+                forEach([&](auto& s) { s.onUpdatedBar(event.bar, out); });
+                break;
+            case EventType::DailyBar:
+                forEach([&](auto& s) { s.onDailyBar(event.bar, out); });
+                break;
+            }
+        }
+        if constexpr (BATCHED) {
+            const EventSpan batch(events, count);
+            std::apply([&](auto&... s) { (batchTo(s, batch, books, out), ...); }, strategies);
+        }
+    }
+
+    void moveSymbol(uint32_t symbolId, StrategyEngine& to) {
+        moveSymbol(symbolId, to, std::index_sequence_for<Strategies...>());
+    }
+
+    template <size_t I>
+    auto& get() { return std::get<I>(strategies); }
+
+    static constexpr size_t size() { return sizeof...(Strategies); }
+
+private:
+    static constexpr bool PER_EVENT = (!handlesBatches<Strategies> || ...);
+    static constexpr bool BATCHED = (handlesBatches<Strategies> || ...);
+
+    // Calls f on every per-event strategy.
+    template <typename F>
+    void forEach(F&& f) {
+        std::apply([&](auto&... s) { (perEvent(s, f), ...); }, strategies);
+    }
+
+    template <typename S, typename F>
+    static void perEvent(S& s, F& f) {
+        if constexpr (!handlesBatches<S>) f(s);
+    }
+
+    template <typename S>
+    static void batchTo(S& s, EventSpan batch, const OrderBookSet& books, IntentBuffer& out) {
+        if constexpr (handlesBatches<S>) s.onBatch(batch, books, out);
+    }
+
+    void batchOfOne(const MarketEvent& event, IntentBuffer& out) {
+        if constexpr (BATCHED) {
+            static const OrderBookSet noBooks;
+            const EventSpan batch(&event, 1);
+            std::apply([&](auto&... s) { (batchTo(s, batch, noBooks, out), ...); }, strategies);
+        }
+    }
+
+    template <size_t... I>
+    void assignIds(std::index_sequence<I...>) {
+        (std::get<I>(strategies).setStrategyId(static_cast<uint16_t>(I)), ...);
+    }
+
+    template <size_t... I>
+    void moveSymbol(uint32_t symbolId, StrategyEngine& to, std::index_sequence<I...>) {
+        (std::get<I>(strategies).moveSymbol(symbolId, std::get<I>(to.strategies)), ...);
+    }
+
+    std::tuple<Strategies...> strategies;
+};
+
+// Lets code that cannot be templated on the strategy set (the client's
+// pipeline shards) drive an engine. The virtual call is per batch; each
+// event within it is dispatched statically.
+class StrategyRunner {
+public:
+    virtual ~StrategyRunner() = default;
+
+    virtual void onBars(const CompactBar* bars, size_t count, IntentBuffer& out) = 0;
+    virtual void onTrades(const TradeRecord* trades, size_t count, IntentBuffer& out) = 0;
+    virtual void onQuotes(const QuoteRecord* quotes, size_t count, IntentBuffer& out) = 0;
+    virtual void onEvents(const MarketEvent* events, size_t count, OrderBookSet& books, IntentBuffer& out) = 0;
+    // Hands the symbol's state to another runner built by the same factory.
+    virtual void moveSymbol(uint32_t symbolId, StrategyRunner& to) = 0;
+};
+
+template <typename Engine>
+class EngineRunner : public StrategyRunner {
+public:
+    explicit EngineRunner(Engine engine) : engine(std::move(engine)) {}
+
+    void onBars(const CompactBar* bars, size_t count, IntentBuffer& out) override {
+        for (size_t i = 0; i < count; ++i) engine.onBar(bars[i], out);
+    }
+
+    void onTrades(const TradeRecord* trades, size_t count, IntentBuffer& out) override {
+        for (size_t i = 0; i < count; ++i) engine.onTrade(trades[i], out);
+    }
+
+    void onQuotes(const QuoteRecord* quotes, size_t count, IntentBuffer& out) override {
+        for (size_t i = 0; i < count; ++i) engine.onQuote(quotes[i], out);
+    }
+
+    void onEvents(const MarketEvent* events, size_t count, OrderBookSet& books, IntentBuffer& out) override {
+        engine.onEvents(events, count, books, out);
+    }
+
+    void moveSymbol(uint32_t symbolId, StrategyRunner& to) override {
+        engine.moveSymbol(symbolId, static_cast<EngineRunner&>(to).engine);
+    }
+
+    Engine engine;
+};
+
+template <typename Engine>
+std::unique_ptr<StrategyRunner> makeStrategyRunner(Engine engine) {
+    return std::make_unique<EngineRunner<Engine>>(std::move(engine));
+}
+
+// Builds a fresh runner, one per pipeline shard or backtest job, e.g.
+//   [] { return makeStrategyRunner(StrategyEngine<SmaCrossover<10, 30>>()); }
+typedef std::function<std::unique_ptr<StrategyRunner>()> StrategyFactory;
+
+#endif
@@ -0,0 +1,44 @@
+#ifndef SYMBOL_REGISTRY_H
+#define SYMBOL_REGISTRY_H
+
+#include <string>
+#include <vector>
+
+#include "symbol_table.h"
+
+using std::string;
+using std::vector;
+
+struct SymbolRegistryConfig {
+    // Feed names ("BTC/USD", "AAPL"), e.g. the SYMBOL_LIST of the .env.
+    vector<string> symbols;
+    // An Alpaca asset list (the JSON array GET /v2/assets returns) saved to
+    // a file. Assets may also carry "min_notional", which the API does not.
+    string assetsFile;
+    // Without a file, fetch the list from the trading API instead.
+    bool fetchAssets = false;
+    string host = "paper-api.alpaca.markets";
+    string port = "443";
+    string assetsTarget = "/v2/assets?status=active";
+    // For symbols whose asset has no min_notional (Alpaca: $1 for crypto
+    // and fractional stock orders), in quote currency; 0 for none.
+    double defaultMinNotional = 0;
+};
+
+// Applies an asset list to the symbols: price and size decimals from the
+// asset's price_increment and min_trade_increment, which are also its tick
+// and lot size, min_order_size as the minimum quantity and min_notional.
+// Symbols are matched by name, with or without the '/'; ones missing from
+// the list keep the defaults. Returns how many symbols were found. Throws
+// std::runtime_error if assetsJson is not an asset list.
+size_t applyAssets(SymbolTable& table, const string& assetsJson, const vector<string>& symbols,
+                   double defaultMinNotional = 0);
+
+// Interns every configured symbol, so ids are dense and fixed from
+// startup, and loads their metadata from the file or the API if one is
+// configured. Call before market data or orders flow. Returns how many
+// symbols got metadata.
+size_t loadSymbolRegistry(const SymbolRegistryConfig& config, const string& apiKey, const string& apiSecretKey,
+                          SymbolTable& table = SymbolTable::get_instance());
+
+#endif
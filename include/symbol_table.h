@@ -0,0 +1,84 @@
+#ifndef SYMBOL_TABLE_H
+#define SYMBOL_TABLE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+
+// Trading rules of a symbol, fixed point at its scales: tick size and
+// minimum notional in price decimals, lot size and minimum quantity in size
+// decimals. 0 where unknown.
+struct SymbolInfo {
+    int64_t tickSize = 0;
+    int64_t lotSize = 0;
+    int64_t minQuantity = 0;
+    int64_t minNotional = 0;
+};
+
+// Process-wide interning of feed symbols ("BTC/USD") to dense 32-bit ids.
+// Lookups are lock-free and allocation-free: the raw bytes of the payload
+// are hashed in place, and each slot keeps the upper hash bits next to the
+// id, so a probe only compares names on a tag match. Only the first
+// sighting of a symbol takes the insert lock and copies its name, along
+// with the name orders use ("BTCUSD"). Each symbol also carries the
+// decimals its fixed-point prices and sizes are stored in and its trading
+// rules; see symbol_registry.h for loading them at startup.
+class SymbolTable {
+public:
+    static constexpr uint32_t INVALID_ID = UINT32_MAX;
+    static constexpr size_t CAPACITY = 8192;
+    static constexpr uint8_t DEFAULT_PRICE_DECIMALS = 8;
+    static constexpr uint8_t DEFAULT_SIZE_DECIMALS = 8;
+
+    SymbolTable(const SymbolTable&) = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+
+    static SymbolTable& get_instance();
+
+    uint32_t intern(std::string_view name);
+    uint32_t find(std::string_view name) const;
+    std::string_view name(uint32_t id) const;
+    // The name without its '/', as the orders API expects it.
+    std::string_view orderSymbol(uint32_t id) const;
+    size_t size() const { return count.load(std::memory_order_acquire); }
+
+    // Scales should be set before market data for the symbol is decoded;
+    // values already stored are not rescaled. Ids past the table, such as
+    // INVALID_ID, read as the default scales.
+    void setScale(uint32_t id, uint8_t priceDecimals, uint8_t sizeDecimals);
+    uint8_t priceDecimals(uint32_t id) const {
+        return id < CAPACITY ? scales[id].load(std::memory_order_relaxed) >> 8 : DEFAULT_PRICE_DECIMALS;
+    }
+    uint8_t sizeDecimals(uint32_t id) const {
+        return id < CAPACITY ? scales[id].load(std::memory_order_relaxed) & 0xff : DEFAULT_SIZE_DECIMALS;
+    }
+
+    // Like scales, set before the symbol's market data flows: the rules are
+    // plain values, published to the threads started afterwards.
+    void setInfo(uint32_t id, const SymbolInfo& info);
+    const SymbolInfo& info(uint32_t id) const { return infos[id]; }
+
+private:
+    SymbolTable();
+
+    static constexpr size_t SLOTS = CAPACITY * 2;
+
+    // A slot holds the upper 32 hash bits over the id; EMPTY_SLOT when free.
+    static constexpr uint64_t EMPTY_SLOT = UINT64_MAX;
+
+    static uint64_t hash(std::string_view name);
+
+    std::unique_ptr<std::atomic<uint64_t>[]> slots;
+    std::unique_ptr<std::string[]> names;
+    std::unique_ptr<std::string[]> orderSymbols;
+    std::unique_ptr<SymbolInfo[]> infos;
+    std::unique_ptr<std::atomic<uint16_t>[]> scales;
+    std::atomic<uint32_t> count{0};
+
+    std::mutex insertMutex;
+};
+
+#endif
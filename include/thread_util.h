@@ -0,0 +1,64 @@
+#ifndef THREAD_UTIL_H
+#define THREAD_UTIL_H
+
+#include <string>
+#include <vector>
+
+// Where one engine thread runs and how it is scheduled.
+struct ThreadPlacement {
+    // CPUs the thread may run on; empty leaves it to the scheduler. Cores
+    // kept free with isolcpus= or a cpuset are the ones to list here.
+    std::vector<int> cpus;
+    // 1-99 runs the thread SCHED_FIFO at that priority (needs CAP_SYS_NICE
+    // or an rtprio limit); 0 keeps the default policy.
+    int fifoPriority = 0;
+    // Pages the thread touches first come from the NUMA node it runs on
+    // (MPOL_LOCAL) instead of following the process policy.
+    bool numaLocal = false;
+
+    bool empty() const { return cpus.empty() && fifoPriority == 0 && !numaLocal; }
+};
+
+// Names the calling thread, applies the placement and records the outcome
+// for threadReport(). Called first thing on the thread itself, since the
+// memory policy is per thread and should be in place before the thread
+// allocates its working set. A placement the system refuses is recorded,
+// not thrown; the thread then runs wherever it was.
+bool placeThisThread(const std::string& name, const ThreadPlacement& placement);
+
+// One line per thread placed so far, with the CPUs it may actually run on,
+// its scheduling policy and NUMA node, and any placement errors.
+std::string threadReport();
+
+// Engine threads by role. Every role is created once, when its component
+// starts, and lives until it stops; nothing spawns threads per call.
+struct ThreadTopology {
+    // feeds[i] is feed i's websocket thread, which also decodes its frames.
+    std::vector<ThreadPlacement> feeds;
+    // Merges the feeds in timestamp order when there are several.
+    ThreadPlacement merger;
+    // shards[i] runs strategy shard i; when set, the pipeline gets one
+    // shard per entry unless its config names a count.
+    std::vector<ThreadPlacement> shards;
+    // The order gateway's I/O thread.
+    ThreadPlacement orderGateway;
+    ThreadPlacement tradeUpdates;
+    ThreadPlacement logger;
+    // Bar store writer, gap backfill and order session upkeep; none of them
+    // is latency sensitive.
+    ThreadPlacement housekeeping;
+
+    ThreadPlacement feed(size_t index) const { return index < feeds.size() ? feeds[index] : ThreadPlacement(); }
+    ThreadPlacement shard(size_t index) const { return index < shards.size() ? shards[index] : ThreadPlacement(); }
+
+    // Parses "role=cpus[:fifo=N][:numa]" entries separated by ';', e.g.
+    //   feeds=2:fifo=80;shards=4-7:fifo=70;gateway=3:fifo=60;logger=0;housekeeping=0-1;numa
+    // Roles are feeds, merger, shards, gateway, tradeUpdates, logger and
+    // housekeeping. cpus is a list of CPUs and ranges ("0,2,4-7"); feeds
+    // and shards take one CPU per thread from it in order, the other roles
+    // may run on any of them. A bare "numa" makes every role NUMA local.
+    // Throws std::invalid_argument on anything else.
+    static ThreadTopology parse(const std::string& spec);
+};
+
+#endif
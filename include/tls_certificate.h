@@ -0,0 +1,11 @@
+#ifndef TLS_CERTIFICATE_H
+#define TLS_CERTIFICATE_H
+
+#include <boost/asio/ssl.hpp>
+#include <string>
+
+// Generates an ephemeral P-256 key and self-signed certificate for the given
+// common name and installs both into the context. Used by local stubs only.
+void useSelfSignedCertificate(boost::asio::ssl::context& ctx, const std::string& commonName);
+
+#endif
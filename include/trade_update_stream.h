@@ -0,0 +1,55 @@
+#ifndef TRADE_UPDATE_STREAM_H
+#define TRADE_UPDATE_STREAM_H
+
+#include <websocketpp/config/asio_client.hpp>
+#include <websocketpp/client.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+
+#include "frame_pool.h"
+#include "order_manager.h"
+#include "thread_util.h"
+
+using std::string;
+
+// Alpaca's account stream (wss://paper-api.alpaca.markets/stream): after
+// auth it listens to trade_updates and feeds every frame to an
+// OrderManager, so order states and positions follow the exchange in real
+// time. Runs its own websocket thread, separate from market data.
+class TradeUpdateStream {
+public:
+    TradeUpdateStream(OrderManager& manager, const string& apiKey, const string& apiSecretKey);
+    ~TradeUpdateStream();
+
+    TradeUpdateStream(const TradeUpdateStream&) = delete;
+    TradeUpdateStream& operator=(const TradeUpdateStream&) = delete;
+
+    void connect(const string& uri, const string& hostname, const ThreadPlacement& placement = ThreadPlacement());
+    void disconnect();
+
+    // The server confirmed the trade_updates subscription.
+    bool listening() const { return isListening.load(std::memory_order_acquire); }
+
+private:
+    typedef websocketpp::client<pooled_asio_tls_client> endpoint_type;
+
+    void onOpen(websocketpp::connection_hdl hdl);
+    void onClose(websocketpp::connection_hdl hdl);
+    void onFail(websocketpp::connection_hdl hdl);
+    void onMessage(websocketpp::connection_hdl hdl, endpoint_type::message_ptr msg);
+
+    OrderManager& manager;
+    string ALPACA_API_KEY;
+    string ALPACA_API_SECRET_KEY;
+    string host;
+
+    endpoint_type endpoint;
+    std::thread thread;
+    websocketpp::connection_hdl hdl;
+    std::atomic<bool> connected{false};
+    std::atomic<bool> isListening{false};
+};
+
+#endif
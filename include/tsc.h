@@ -0,0 +1,39 @@
+#ifndef TSC_H
+#define TSC_H
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// The CPU timestamp counter, for stamps that must cost a few nanoseconds.
+// Other architectures fall back to steady_clock nanoseconds.
+namespace tsc {
+    inline uint64_t now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    // Like now(), but waits for earlier instructions to retire first, so
+    // the stamp is not taken early.
+    inline uint64_t nowOrdered() {
+#if defined(__x86_64__) || defined(__i386__)
+        unsigned aux;
+        return __rdtscp(&aux);
+#else
+        return now();
+#endif
+    }
+
+    // Measures the counter against steady_clock once (about 20 ms); later
+    // calls return the cached ratio.
+    double nsPerTick();
+}
+
+#endif
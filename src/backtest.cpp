@@ -0,0 +1,403 @@
+#include "backtest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+#include <thread>
+
+#include "bar_store.h"
+#include "feed_decoder.h"
+#include "fixed_point.h"
+#include "symbol_table.h"
+
+namespace {
+    struct Pending {
+        OrderIntent intent;
+        int64_t signalNs;
+        int64_t dayStartNs;
+        uint64_t eligibleAt;
+    };
+
+    struct Position {
+        bool active = false;
+        double priceScale = 1;
+        double sizeScale = 1;
+        uint64_t bars = 0;
+        double quantity = 0;
+        double averagePrice = 0;
+        double lastClose = 0;
+        std::vector<Pending> pending;
+    };
+
+    class Book {
+    public:
+        Book(const BacktestConfig& config, BacktestResult& result) : cfg(config), result(result) {}
+
+        Position& position(uint32_t symbolId) {
+            if (symbolId >= positions.size()) positions.resize(symbolId + 1);
+            Position& pos = positions[symbolId];
+            if (!pos.active) {
+                const SymbolTable& table = SymbolTable::get_instance();
+                pos.active = true;
+                pos.priceScale = 1.0 / std::pow(10.0, table.priceDecimals(symbolId));
+                pos.sizeScale = 1.0 / std::pow(10.0, table.sizeDecimals(symbolId));
+            }
+            return pos;
+        }
+
+        // Settles whatever is due on this bar, before the strategy sees it.
+        void settle(Position& pos, const CompactBar& bar) {
+            const int64_t dayStartNs = bar_store::dayStart(bar.timestampNs);
+            size_t kept = 0;
+            for (size_t i = 0; i < pos.pending.size(); ++i) {
+                Pending& order = pos.pending[i];
+                if (order.eligibleAt > pos.bars) {
+                    pos.pending[kept++] = order;
+                    continue;
+                }
+
+                const OrderIntent& intent = order.intent;
+                if (intent.timeInForce == TimeInForce::Day && dayStartNs != order.dayStartNs) {
+                    ++result.unfilled;
+                    continue;
+                }
+
+                const bool buy = intent.side == OrderSide::Buy;
+                double price = 0;
+                bool filled = false;
+
+                if (intent.type == OrderType::Market) {
+                    const double slip = cfg.fills.slippageBps / 10000.0;
+                    price = static_cast<double>(bar.open) * pos.priceScale * (buy ? 1 + slip : 1 - slip);
+                    filled = true;
+                } else if (buy ? bar.low <= intent.limitPrice : bar.high >= intent.limitPrice) {
+                    const int64_t fixed = buy ? std::min(bar.open, intent.limitPrice) : std::max(bar.open, intent.limitPrice);
+                    price = static_cast<double>(fixed) * pos.priceScale;
+                    filled = true;
+                }
+
+                if (filled) {
+                    fill(pos, order, bar.timestampNs, price);
+                } else if (intent.timeInForce == TimeInForce::Ioc) {
+                    ++result.unfilled;
+                } else {
+                    pos.pending[kept++] = order;
+                }
+            }
+            pos.pending.resize(kept);
+        }
+
+        void submit(Position& pos, const OrderIntent& intent, const CompactBar& bar) {
+            pos.pending.push_back(Pending{intent, bar.timestampNs, bar_store::dayStart(bar.timestampNs),
+                                          pos.bars + std::max(1u, cfg.fills.delayBars)});
+        }
+
+        void mark(Position& pos, const CompactBar& bar) {
+            const double close = static_cast<double>(bar.close) * pos.priceScale;
+            markValue += pos.quantity * (close - pos.lastClose);
+            pos.lastClose = close;
+
+            const double equity = cash + markValue;
+            peak = std::max(peak, equity);
+            result.maxDrawdown = std::max(result.maxDrawdown, peak - equity);
+        }
+
+        void finish() {
+            for (const Position& pos : positions) {
+                result.unfilled += pos.pending.size();
+                result.unrealizedPnl += pos.quantity * (pos.lastClose - pos.averagePrice);
+            }
+            result.netPnl = result.realizedPnl + result.unrealizedPnl - result.fees;
+        }
+
+    private:
+        void fill(Position& pos, const Pending& order, int64_t timestampNs, double price) {
+            const OrderIntent& intent = order.intent;
+            const double size = static_cast<double>(intent.quantity) * pos.sizeScale;
+            const double delta = intent.side == OrderSide::Buy ? size : -size;
+            const double fee = size * price * cfg.fills.feeBps / 10000.0;
+
+            if (pos.quantity == 0 || (pos.quantity > 0) == (delta > 0)) {
+                const double total = std::abs(pos.quantity) + size;
+                pos.averagePrice = (pos.averagePrice * std::abs(pos.quantity) + price * size) / total;
+            } else {
+                const double closing = std::min(size, std::abs(pos.quantity));
+                result.realizedPnl += closing * (price - pos.averagePrice) * (pos.quantity > 0 ? 1 : -1);
+                if (size > closing) pos.averagePrice = price;
+            }
+            pos.quantity += delta;
+            if (std::abs(pos.quantity) < 1e-12) {
+                pos.quantity = 0;
+                pos.averagePrice = 0;
+            }
+
+            cash -= delta * price + fee;
+            markValue += delta * pos.lastClose;
+            result.fees += fee;
+            ++result.fills;
+
+            if (cfg.recordFills) {
+                result.fillLog.push_back(BacktestFill{intent.symbolId, intent.strategyId, intent.side, order.signalNs,
+                                                      timestampNs, price, size, fee});
+            }
+        }
+
+        const BacktestConfig& cfg;
+        BacktestResult& result;
+        std::vector<Position> positions;
+        double cash = 0;
+        double markValue = 0;
+        double peak = 0;
+    };
+
+    LatencySummary summarize(std::vector<int64_t>& samples) {
+        LatencySummary s;
+        if (samples.empty()) return s;
+        std::sort(samples.begin(), samples.end());
+        double sum = 0;
+        for (int64_t ns : samples) sum += static_cast<double>(ns);
+        s.samples = samples.size();
+        s.meanNs = sum / static_cast<double>(samples.size());
+        s.p50Ns = samples[samples.size() / 2];
+        s.p99Ns = samples[static_cast<size_t>(0.99 * static_cast<double>(samples.size() - 1))];
+        s.maxNs = samples.back();
+        return s;
+    }
+
+    bool parseCsvTimestamp(std::string_view text, int64_t& epochNs) {
+        if (text.find('T') != std::string_view::npos) {
+            return FeedDecoder::parseTimestamp(text, epochNs);
+        }
+        if (text.empty()) return false;
+        int64_t value = 0;
+        for (char ch : text) {
+            if (ch < '0' || ch > '9') return false;
+            value = value * 10 + (ch - '0');
+        }
+        // Seconds, milliseconds, microseconds or nanoseconds since the epoch.
+        if (value < 100000000000LL) epochNs = value * 1000000000LL;
+        else if (value < 100000000000000LL) epochNs = value * 1000000LL;
+        else if (value < 100000000000000000LL) epochNs = value * 1000LL;
+        else epochNs = value;
+        return true;
+    }
+}
+
+void BacktestResult::merge(const BacktestResult& other) {
+    const uint64_t samples = strategyLatency.samples + other.strategyLatency.samples;
+    if (samples) {
+        strategyLatency.meanNs = (strategyLatency.meanNs * static_cast<double>(strategyLatency.samples) +
+                                  other.strategyLatency.meanNs * static_cast<double>(other.strategyLatency.samples)) /
+                                 static_cast<double>(samples);
+    }
+    strategyLatency.samples = samples;
+    // Percentiles do not combine; keep the worse of the two.
+    strategyLatency.p50Ns = std::max(strategyLatency.p50Ns, other.strategyLatency.p50Ns);
+    strategyLatency.p99Ns = std::max(strategyLatency.p99Ns, other.strategyLatency.p99Ns);
+    strategyLatency.maxNs = std::max(strategyLatency.maxNs, other.strategyLatency.maxNs);
+
+    bars += other.bars;
+    intents += other.intents;
+    fills += other.fills;
+    unfilled += other.unfilled;
+    realizedPnl += other.realizedPnl;
+    unrealizedPnl += other.unrealizedPnl;
+    fees += other.fees;
+    netPnl += other.netPnl;
+    // Runs on different symbols have no common equity curve; report the
+    // worst single drawdown.
+    maxDrawdown = std::max(maxDrawdown, other.maxDrawdown);
+    elapsedSeconds += other.elapsedSeconds;
+    fillLog.insert(fillLog.end(), other.fillLog.begin(), other.fillLog.end());
+}
+
+BacktestResult runBacktest(StrategyRunner& runner, const CompactBar* bars, size_t count, const BacktestConfig& config) {
+    BacktestResult result;
+    Book book(config, result);
+    OrderBookSet books;
+    IntentBuffer intents;
+    std::vector<int64_t> latencies;
+    if (config.latencySampleEvery) latencies.reserve(count / config.latencySampleEvery + 1);
+
+    const auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        const CompactBar& bar = bars[i];
+        Position& pos = book.position(bar.symbolId);
+        ++pos.bars;
+        if (!pos.pending.empty()) book.settle(pos, bar);
+
+        const MarketEvent event = MarketEvent::of(bar);
+        intents.clear();
+        if (config.latencySampleEvery && i % config.latencySampleEvery == 0) {
+            const auto t0 = std::chrono::steady_clock::now();
+            runner.onEvents(&event, 1, books, intents);
+            const auto t1 = std::chrono::steady_clock::now();
+            latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count());
+        } else {
+            runner.onEvents(&event, 1, books, intents);
+        }
+
+        for (const OrderIntent& intent : intents) {
+            ++result.intents;
+            book.submit(book.position(intent.symbolId), intent, bar);
+        }
+        // Submitting may have grown the positions and moved pos.
+        book.mark(book.position(bar.symbolId), bar);
+    }
+    result.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    result.bars = count;
+    book.finish();
+    result.strategyLatency = summarize(latencies);
+    return result;
+}
+
+std::vector<BacktestResult> runBacktests(const std::vector<BacktestJob>& jobs, const BacktestConfig& config,
+                                         size_t threads) {
+    std::vector<BacktestResult> results(jobs.size());
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = std::min(threads, jobs.size());
+
+    std::atomic<size_t> next{0};
+    std::exception_ptr failure;
+    std::mutex failureMutex;
+
+    auto work = [&]() {
+        for (size_t i = next++; i < jobs.size(); i = next++) {
+            try {
+                std::unique_ptr<StrategyRunner> runner = jobs[i].factory();
+                const std::vector<CompactBar>& bars = *jobs[i].bars;
+                results[i] = runBacktest(*runner, bars.data(), bars.size(), config);
+                results[i].name = jobs[i].name;
+            } catch (...) {
+                std::lock_guard<std::mutex> lock(failureMutex);
+                if (!failure) failure = std::current_exception();
+            }
+        }
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t t = 1; t < threads; ++t) workers.emplace_back(work);
+    work();
+    for (auto& worker : workers) worker.join();
+
+    if (failure) std::rethrow_exception(failure);
+    return results;
+}
+
+size_t loadCsvBars(const string& path, const string& symbol, std::vector<CompactBar>& out, size_t* skipped) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        throw std::runtime_error("Cannot open bar file " + path);
+    }
+    std::stringstream contents;
+    contents << in.rdbuf();
+    const string text = contents.str();
+
+    SymbolTable& table = SymbolTable::get_instance();
+    const uint32_t symbolId = table.intern(symbol);
+    const uint8_t pd = table.priceDecimals(symbolId);
+    const uint8_t sd = table.sizeDecimals(symbolId);
+
+    const size_t before = out.size();
+    size_t bad = 0;
+    std::string_view fields[8];
+    size_t pos = 0;
+    bool firstRow = true;
+
+    while (pos < text.size()) {
+        size_t end = text.find('\n', pos);
+        if (end == string::npos) end = text.size();
+        std::string_view line(text.data() + pos, end - pos);
+        pos = end + 1;
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (line.empty()) continue;
+
+        size_t n = 0;
+        for (size_t start = 0; n < 8;) {
+            size_t comma = line.find(',', start);
+            fields[n++] = line.substr(start, comma == std::string_view::npos ? std::string_view::npos : comma - start);
+            if (comma == std::string_view::npos) break;
+            start = comma + 1;
+        }
+
+        CompactBar bar{};
+        bar.symbolId = symbolId;
+        bool ok = n >= 6 && parseCsvTimestamp(fields[0], bar.timestampNs) &&
+                  fixed_point::parse(fields[1], pd, bar.open) && fixed_point::parse(fields[2], pd, bar.high) &&
+                  fixed_point::parse(fields[3], pd, bar.low) && fixed_point::parse(fields[4], pd, bar.close) &&
+                  fixed_point::parse(fields[5], sd, bar.volume);
+        if (ok && n >= 7) {
+            int64_t trades = 0;
+            ok = fixed_point::parse(fields[6], 0, trades);
+            bar.tradeCount = static_cast<uint32_t>(trades);
+        }
+        bar.vwap = bar.close;
+        if (ok && n >= 8) ok = fixed_point::parse(fields[7], pd, bar.vwap);
+
+        if (ok) {
+            out.push_back(bar);
+        } else if (!firstRow) {
+            ++bad;
+        }
+        firstRow = false;
+    }
+
+    if (skipped) *skipped = bad;
+    return out.size() - before;
+}
+
+size_t loadStoredBars(const string& root, const string& symbol, int64_t fromNs, int64_t toNs,
+                      std::vector<CompactBar>& out) {
+    BarStoreReader reader(root);
+    const size_t before = out.size();
+    for (const BarSlice& slice : reader.query(symbol, fromNs, toNs)) {
+        out.reserve(out.size() + slice.size());
+        for (size_t i = 0; i < slice.size(); ++i) {
+            out.push_back(slice.bar(i));
+        }
+    }
+    return out.size() - before;
+}
+
+void syntheticBars(const string& symbol, size_t count, uint64_t seed, std::vector<CompactBar>& out) {
+    SymbolTable& table = SymbolTable::get_instance();
+    const uint32_t symbolId = table.intern(symbol);
+    const uint8_t pd = table.priceDecimals(symbolId);
+    const uint8_t sd = table.sizeDecimals(symbolId);
+
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> move(0.0, 0.001);
+    std::uniform_real_distribution<double> range(0.0, 0.0005);
+
+    // 2024-01-01T00:00:00Z, one bar a minute.
+    int64_t timestampNs = 1704067200LL * 1000000000LL;
+    double price = 100.0;
+    out.reserve(out.size() + count);
+    for (size_t i = 0; i < count; ++i, timestampNs += 60000000000LL) {
+        const double open = price;
+        price *= 1.0 + move(rng);
+        const double high = std::max(open, price) * (1.0 + range(rng));
+        const double low = std::min(open, price) * (1.0 - range(rng));
+
+        CompactBar bar{};
+        bar.timestampNs = timestampNs;
+        bar.open = fixed_point::fromDouble(open, pd);
+        bar.high = fixed_point::fromDouble(high, pd);
+        bar.low = fixed_point::fromDouble(low, pd);
+        bar.close = fixed_point::fromDouble(price, pd);
+        bar.volume = fixed_point::fromDouble(10.0, sd);
+        bar.vwap = fixed_point::fromDouble((open + price) / 2, pd);
+        bar.symbolId = symbolId;
+        bar.tradeCount = 20;
+        out.push_back(bar);
+    }
+}
@@ -0,0 +1,45 @@
+#include "bar.h"
+
+#include <stdexcept>
+
+#include "feed_decoder.h"
+#include "fixed_point.h"
+#include "symbol_table.h"
+
+Bar::Bar(const CompactBar& bar) {
+    const SymbolTable& symbols = SymbolTable::get_instance();
+    const uint8_t priceDecimals = symbols.priceDecimals(bar.symbolId);
+    const uint8_t sizeDecimals = symbols.sizeDecimals(bar.symbolId);
+
+    T  = "b";
+    S  = std::string(symbols.name(bar.symbolId));
+    o  = fixed_point::toDouble(bar.open, priceDecimals);
+    h  = fixed_point::toDouble(bar.high, priceDecimals);
+    l  = fixed_point::toDouble(bar.low, priceDecimals);
+    c  = fixed_point::toDouble(bar.close, priceDecimals);
+    v  = fixed_point::toDouble(bar.volume, sizeDecimals);
+    t  = FeedDecoder::formatTimestamp(bar.timestampNs);
+    n  = bar.tradeCount;
+    vw = fixed_point::toDouble(bar.vwap, priceDecimals);
+}
+
+CompactBar Bar::toCompact() const {
+    SymbolTable& symbols = SymbolTable::get_instance();
+
+    CompactBar bar{};
+    bar.symbolId = symbols.intern(S);
+    if (!FeedDecoder::parseTimestamp(t, bar.timestampNs)) {
+        throw std::invalid_argument("Bar has an invalid timestamp: " + t);
+    }
+
+    const uint8_t priceDecimals = symbols.priceDecimals(bar.symbolId);
+    const uint8_t sizeDecimals = symbols.sizeDecimals(bar.symbolId);
+    bar.open       = fixed_point::fromDouble(o, priceDecimals);
+    bar.high       = fixed_point::fromDouble(h, priceDecimals);
+    bar.low        = fixed_point::fromDouble(l, priceDecimals);
+    bar.close      = fixed_point::fromDouble(c, priceDecimals);
+    bar.volume     = fixed_point::fromDouble(v, sizeDecimals);
+    bar.vwap       = fixed_point::fromDouble(vw, priceDecimals);
+    bar.tradeCount = static_cast<uint32_t>(n);
+    return bar;
+}
@@ -0,0 +1,376 @@
+#include "bar_store.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <stdexcept>
+
+#include "fixed_point.h"
+#include "logger.h"
+#include "symbol_table.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+    const char MAGIC[8] = {'H', 'F', 'T', 'C', 'O', 'L', '1', '\0'};
+    const uint32_t VERSION = 1;
+    const size_t HEADER_BYTES = 32;
+    const size_t FIELDS = static_cast<size_t>(BarField::Count);
+
+    const char* const FIELD_NAMES[FIELDS] = {"time", "open", "high", "low", "close", "volume", "vwap", "trades"};
+
+    uint8_t widthOf(size_t field) {
+        return field == static_cast<size_t>(BarField::Time) || field == static_cast<size_t>(BarField::Trades) ? 4 : 8;
+    }
+
+    string dayName(int64_t dayStartNs) {
+        std::time_t seconds = static_cast<std::time_t>(dayStartNs / 1000000000LL);
+        std::tm utc{};
+        ::gmtime_r(&seconds, &utc);
+        char name[16];
+        std::strftime(name, sizeof(name), "%Y%m%d", &utc);
+        return name;
+    }
+
+    bool parseDayName(const string& name, int64_t& dayStartNs) {
+        if (name.size() != 8 || !std::all_of(name.begin(), name.end(), ::isdigit)) return false;
+        std::tm utc{};
+        utc.tm_year = std::stoi(name.substr(0, 4)) - 1900;
+        utc.tm_mon = std::stoi(name.substr(4, 2)) - 1;
+        utc.tm_mday = std::stoi(name.substr(6, 2));
+        dayStartNs = static_cast<int64_t>(::timegm(&utc)) * 1000000000LL;
+        return true;
+    }
+
+    string columnPath(const fs::path& dir, size_t field) {
+        return (dir / (string(FIELD_NAMES[field]) + ".col")).string();
+    }
+
+    // All columns of one day, mapped read-only.
+    struct MappedDay {
+        struct Column {
+            const char* base = nullptr;
+            size_t size = 0;
+        };
+
+        Column columns[FIELDS];
+        int64_t dayStartNs = 0;
+        uint8_t priceDecimals = 0;
+        uint8_t sizeDecimals = 0;
+        size_t rows = 0;
+
+        ~MappedDay() {
+            for (auto& column : columns) {
+                if (column.base) ::munmap(const_cast<char*>(column.base), column.size);
+            }
+        }
+
+        template <typename T>
+        const T* values(BarField field) const {
+            return reinterpret_cast<const T*>(columns[static_cast<size_t>(field)].base + HEADER_BYTES);
+        }
+
+        static std::shared_ptr<MappedDay> open(const fs::path& dir) {
+            auto day = std::make_shared<MappedDay>();
+            day->rows = SIZE_MAX;
+
+            for (size_t field = 0; field < FIELDS; ++field) {
+                const string path = columnPath(dir, field);
+                int fd = ::open(path.c_str(), O_RDONLY);
+                if (fd < 0) return nullptr;
+
+                struct stat st;
+                if (::fstat(fd, &st) != 0 || static_cast<size_t>(st.st_size) < HEADER_BYTES) {
+                    ::close(fd);
+                    return nullptr;
+                }
+                const size_t size = static_cast<size_t>(st.st_size);
+                void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+                ::close(fd);
+                if (mapping == MAP_FAILED) return nullptr;
+
+                MappedDay::Column& column = day->columns[field];
+                column.base = static_cast<const char*>(mapping);
+                column.size = size;
+
+                uint32_t version = 0;
+                std::memcpy(&version, column.base + 8, sizeof(version));
+                const uint8_t width = static_cast<uint8_t>(column.base[13]);
+                if (std::memcmp(column.base, MAGIC, sizeof(MAGIC)) != 0 || version != VERSION ||
+                    static_cast<uint8_t>(column.base[12]) != field || width != widthOf(field)) {
+                    LOG_WARN("Skipping malformed bar column {}", path);
+                    return nullptr;
+                }
+                if (field == 0) {
+                    day->priceDecimals = static_cast<uint8_t>(column.base[14]);
+                    day->sizeDecimals = static_cast<uint8_t>(column.base[15]);
+                    std::memcpy(&day->dayStartNs, column.base + 16, sizeof(day->dayStartNs));
+                }
+                day->rows = std::min(day->rows, (size - HEADER_BYTES) / width);
+            }
+            return day;
+        }
+    };
+
+    BarSlice sliceOf(const std::shared_ptr<MappedDay>& day, uint32_t symbolId, size_t from, size_t to) {
+        BarSlice slice;
+        slice.symbolId = symbolId;
+        slice.dayStartNs = day->dayStartNs;
+        slice.priceDecimals = day->priceDecimals;
+        slice.sizeDecimals = day->sizeDecimals;
+
+        const size_t n = to - from;
+        slice.timeMs = {day->values<uint32_t>(BarField::Time) + from, n};
+        slice.open = {day->values<int64_t>(BarField::Open) + from, n};
+        slice.high = {day->values<int64_t>(BarField::High) + from, n};
+        slice.low = {day->values<int64_t>(BarField::Low) + from, n};
+        slice.close = {day->values<int64_t>(BarField::Close) + from, n};
+        slice.volume = {day->values<int64_t>(BarField::Volume) + from, n};
+        slice.vwap = {day->values<int64_t>(BarField::Vwap) + from, n};
+        slice.trades = {day->values<uint32_t>(BarField::Trades) + from, n};
+        slice.mapping = day;
+        return slice;
+    }
+}
+
+string bar_store::directoryName(const string& symbol) {
+    string name = symbol;
+    std::replace(name.begin(), name.end(), '/', '-');
+    return name;
+}
+
+CompactBar BarSlice::bar(size_t i) const {
+    const SymbolTable& table = SymbolTable::get_instance();
+    const uint8_t pd = table.priceDecimals(symbolId);
+    const uint8_t sd = table.sizeDecimals(symbolId);
+
+    CompactBar out{};
+    out.timestampNs = timestampNs(i);
+    out.open = fixed_point::rescale(open[i], priceDecimals, pd);
+    out.high = fixed_point::rescale(high[i], priceDecimals, pd);
+    out.low = fixed_point::rescale(low[i], priceDecimals, pd);
+    out.close = fixed_point::rescale(close[i], priceDecimals, pd);
+    out.volume = fixed_point::rescale(volume[i], sizeDecimals, sd);
+    out.vwap = fixed_point::rescale(vwap[i], priceDecimals, pd);
+    out.symbolId = symbolId;
+    out.tradeCount = trades[i];
+    return out;
+}
+
+BarStoreWriter::BarStoreWriter(const string& root, size_t queueCapacity) : root(root), ring(queueCapacity) {
+    fs::create_directories(root);
+}
+
+BarStoreWriter::~BarStoreWriter() {
+    stop();
+    for (auto& entry : partitions) {
+        close(entry.second);
+    }
+}
+
+void BarStoreWriter::start(const ThreadPlacement& placement) {
+    if (worker.joinable()) return;
+    worker = std::thread([this, placement]() {
+        placeThisThread("bar-store", placement);
+        run();
+    });
+}
+
+void BarStoreWriter::stop() {
+    ring.close();
+    if (worker.joinable()) worker.join();
+    flush();
+}
+
+bool BarStoreWriter::publish(const CompactBar& bar) {
+    return ring.tryPush(bar);
+}
+
+void BarStoreWriter::run() {
+    std::vector<CompactBar> batch(256);
+    for (;;) {
+        size_t n = ring.popBatch(batch.data(), batch.size());
+        if (n == 0) break;
+        for (size_t i = 0; i < n; ++i) {
+            append(batch[i]);
+        }
+        // Caught up: make what we have visible to readers.
+        if (ring.size() == 0) flush();
+    }
+}
+
+BarStoreWriter::Partition& BarStoreWriter::partition(uint32_t symbolId, int64_t dayStartNs) {
+    Partition& part = partitions[symbolId];
+    if (part.files[0] && part.dayStartNs != dayStartNs) {
+        close(part);
+    }
+    if (!part.files[0]) {
+        part.dayStartNs = dayStartNs;
+        open(part, symbolId);
+    }
+    return part;
+}
+
+void BarStoreWriter::open(Partition& part, uint32_t symbolId) {
+    const SymbolTable& table = SymbolTable::get_instance();
+    const fs::path dir = fs::path(root) / bar_store::directoryName(string(table.name(symbolId))) / dayName(part.dayStartNs);
+    fs::create_directories(dir);
+
+    // Reopening a day (e.g. after a restart): cut every column back to the
+    // rows all of them have, and continue after the last stored time.
+    size_t rows = SIZE_MAX;
+    for (size_t field = 0; field < FIELDS; ++field) {
+        std::error_code ec;
+        const uintmax_t size = fs::file_size(columnPath(dir, field), ec);
+        rows = std::min(rows, ec || size < HEADER_BYTES ? size_t(0) : (size - HEADER_BYTES) / widthOf(field));
+    }
+
+    part.hasRows = rows > 0;
+    part.priceDecimals = table.priceDecimals(symbolId);
+    part.sizeDecimals = table.sizeDecimals(symbolId);
+    for (size_t field = 0; field < FIELDS; ++field) {
+        const string path = columnPath(dir, field);
+        if (rows == 0) {
+            FILE* file = std::fopen(path.c_str(), "wb");
+            if (!file) throw std::runtime_error("Cannot create bar column " + path + ": " + std::strerror(errno));
+
+            char header[HEADER_BYTES] = {};
+            std::memcpy(header, MAGIC, sizeof(MAGIC));
+            std::memcpy(header + 8, &VERSION, sizeof(VERSION));
+            header[12] = static_cast<char>(field);
+            header[13] = static_cast<char>(widthOf(field));
+            header[14] = static_cast<char>(part.priceDecimals);
+            header[15] = static_cast<char>(part.sizeDecimals);
+            std::memcpy(header + 16, &part.dayStartNs, sizeof(part.dayStartNs));
+            std::fwrite(header, 1, sizeof(header), file);
+            part.files[field] = file;
+        } else {
+            fs::resize_file(path, HEADER_BYTES + rows * widthOf(field));
+            FILE* file = std::fopen(path.c_str(), "r+b");
+            if (!file) throw std::runtime_error("Cannot open bar column " + path + ": " + std::strerror(errno));
+            if (field == static_cast<size_t>(BarField::Time)) {
+                // The day keeps the scale it was created with.
+                unsigned char decimals[2];
+                std::fseek(file, 14, SEEK_SET);
+                if (std::fread(decimals, 1, sizeof(decimals), file) == sizeof(decimals)) {
+                    part.priceDecimals = decimals[0];
+                    part.sizeDecimals = decimals[1];
+                }
+                std::fseek(file, static_cast<long>(HEADER_BYTES + (rows - 1) * 4), SEEK_SET);
+                if (std::fread(&part.lastTimeMs, sizeof(part.lastTimeMs), 1, file) != 1) part.lastTimeMs = 0;
+            }
+            std::fseek(file, 0, SEEK_END);
+            part.files[field] = file;
+        }
+    }
+}
+
+void BarStoreWriter::close(Partition& part) {
+    for (FILE*& file : part.files) {
+        if (file) std::fclose(file);
+        file = nullptr;
+    }
+    part.hasRows = false;
+    part.lastTimeMs = 0;
+}
+
+void BarStoreWriter::append(const CompactBar& bar) {
+    const int64_t dayStartNs = bar_store::dayStart(bar.timestampNs);
+    Partition& part = partition(bar.symbolId, dayStartNs);
+
+    const uint32_t timeMs = static_cast<uint32_t>((bar.timestampNs - dayStartNs) / 1000000);
+    if (part.hasRows && timeMs <= part.lastTimeMs) {
+        late.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    // Bars carry the symbol's current scale; the day's files keep the one in
+    // their headers, which differs if the scale changed since they were created.
+    const SymbolTable& table = SymbolTable::get_instance();
+    const uint8_t pd = table.priceDecimals(bar.symbolId);
+    const uint8_t sd = table.sizeDecimals(bar.symbolId);
+    std::fwrite(&timeMs, sizeof(timeMs), 1, part.files[0]);
+    const int64_t values[] = {
+        fixed_point::rescale(bar.open, pd, part.priceDecimals),
+        fixed_point::rescale(bar.high, pd, part.priceDecimals),
+        fixed_point::rescale(bar.low, pd, part.priceDecimals),
+        fixed_point::rescale(bar.close, pd, part.priceDecimals),
+        fixed_point::rescale(bar.volume, sd, part.sizeDecimals),
+        fixed_point::rescale(bar.vwap, pd, part.priceDecimals),
+    };
+    for (size_t i = 0; i < 6; ++i) {
+        std::fwrite(&values[i], sizeof(int64_t), 1, part.files[1 + i]);
+    }
+    std::fwrite(&bar.tradeCount, sizeof(bar.tradeCount), 1, part.files[static_cast<size_t>(BarField::Trades)]);
+
+    part.lastTimeMs = timeMs;
+    part.hasRows = true;
+    written.fetch_add(1, std::memory_order_relaxed);
+}
+
+void BarStoreWriter::flush() {
+    for (auto& entry : partitions) {
+        for (FILE* file : entry.second.files) {
+            if (file) std::fflush(file);
+        }
+    }
+}
+
+BarStoreStats BarStoreWriter::stats() const {
+    BarStoreStats s;
+    s.written = written.load(std::memory_order_relaxed);
+    s.late = late.load(std::memory_order_relaxed);
+    s.drops = ring.stats().drops;
+    return s;
+}
+
+BarStoreReader::BarStoreReader(const string& root) : root(root) {}
+
+std::vector<BarSlice> BarStoreReader::query(const string& symbol, int64_t fromNs, int64_t toNs) const {
+    std::vector<BarSlice> slices;
+    const fs::path dir = fs::path(root) / bar_store::directoryName(symbol);
+    std::error_code ec;
+    if (!fs::is_directory(dir, ec)) return slices;
+
+    std::vector<std::pair<int64_t, fs::path>> days;
+    for (const auto& entry : fs::directory_iterator(dir, ec)) {
+        int64_t dayStartNs = 0;
+        if (!entry.is_directory() || !parseDayName(entry.path().filename().string(), dayStartNs)) continue;
+        if (dayStartNs + bar_store::NS_PER_DAY <= fromNs || dayStartNs >= toNs) continue;
+        days.emplace_back(dayStartNs, entry.path());
+    }
+    std::sort(days.begin(), days.end());
+
+    const uint32_t symbolId = SymbolTable::get_instance().intern(symbol);
+    for (const auto& day : days) {
+        std::shared_ptr<MappedDay> mapped = MappedDay::open(day.second);
+        if (!mapped || mapped->rows == 0) continue;
+
+        const uint32_t* time = mapped->values<uint32_t>(BarField::Time);
+        auto offsetOf = [&](int64_t ns) -> size_t {
+            if (ns <= mapped->dayStartNs) return 0;
+            if (ns >= mapped->dayStartNs + bar_store::NS_PER_DAY) return mapped->rows;
+            // Round up so a partial millisecond excludes the bar before it.
+            const uint32_t ms = static_cast<uint32_t>((ns - mapped->dayStartNs + 999999) / 1000000);
+            return std::lower_bound(time, time + mapped->rows, ms) - time;
+        };
+
+        const size_t from = offsetOf(fromNs);
+        const size_t to = offsetOf(toNs);
+        if (from < to) slices.push_back(sliceOf(mapped, symbolId, from, to));
+    }
+    return slices;
+}
+
+std::vector<BarSlice> BarStoreReader::lastDays(const string& symbol, unsigned days, int64_t toNs) const {
+    if (days == 0) return {};
+    const int64_t fromNs = bar_store::dayStart(toNs) - static_cast<int64_t>(days - 1) * bar_store::NS_PER_DAY;
+    return query(symbol, fromNs, toNs + 1);
+}
@@ -1,27 +1,60 @@
 #include "client.h"
+
+#include <algorithm>
+
 #include "bar.h"
+#include "feed_decoder.h"
+#include "fixed_point.h"
+#include "logger.h"
+
+namespace {
+    // A role the topology leaves empty keeps the component's own placement.
+    void assignRole(ThreadPlacement& placement, const ThreadPlacement& role) {
+        if (!role.empty()) placement = role;
+    }
 
-using websocketpp::lib::bind;
-using websocketpp::lib::placeholders::_1;
-using websocketpp::lib::placeholders::_2;
-using websocketpp::lib::thread;
+    // What the completion handlers of one executeOrders() call share.
+    struct ExecutionTally {
+        OrderManager& manager;
+        std::mutex mutex;
+        size_t succeeded = 0;
+        size_t unconfirmed = 0;
+    };
 
-using json = nlohmann::json;
+    // Orders staged per shard and per executeOrders() call before any
+    // vector on the way has to grow.
+    constexpr size_t ORDER_BATCH_RESERVE = 1024;
+
+    // How often executeOrders() picks up newly staged orders while a
+    // batching window is open.
+    constexpr std::chrono::microseconds BATCH_POLL{50};
+
+    OrderSide sideOf(const Order& order) {
+        return order.side == "sell" ? OrderSide::Sell : OrderSide::Buy;
+    }
+}
 
-WebClient::WebClient() : connected(false) {
-    c.init_asio();
+WebClient::WebClient() {
+    orders.reserve(ORDER_BATCH_RESERVE);
+    executeBuffer.reserve(ORDER_BATCH_RESERVE);
+    heldBeforeBatch.reserve(ORDER_BATCH_RESERVE);
 }
 
 WebClient::WebClient(string& api_key, string& api_secret_key) 
-    : ALPACA_API_KEY(api_key), ALPACA_API_SECRET_KEY(api_secret_key), connected(false), processingPool(std::thread::hardware_concurrency()) {
-    c.init_asio();
+    : ALPACA_API_KEY(api_key), ALPACA_API_SECRET_KEY(api_secret_key) {
+    orders.reserve(ORDER_BATCH_RESERVE);
+    executeBuffer.reserve(ORDER_BATCH_RESERVE);
+    heldBeforeBatch.reserve(ORDER_BATCH_RESERVE);
 }
 
 WebClient::~WebClient() {
-    if (thread.joinable()) {
-        thread.join();
+    // Feeds first, then the merger they push into, then the pipeline.
+    disconnect();
+    feeds.clear();
+    if (merger) {
+        merger->stop();
     }
-    processingPool.join();
+    stopPipeline();
 }
 
 void WebClient::setOnConnect(function<void()> callback) {
@@ -36,311 +69,710 @@ void WebClient::setOnSubscribe(function<void()> callback) {
     onSubscribeCallback = callback;
 }
 
-void WebClient::connect(const string& uri, const string& hostname) {
-    c.clear_access_channels(websocketpp::log::alevel::all);
+bool WebClient::streaming() const {
+    for (const auto& feed : feeds) {
+        if (feed->running()) return true;
+    }
+    return false;
+}
 
-    c.set_message_handler(bind(&WebClient::onMessage, this, _1, _2));
-    c.set_tls_init_handler(bind(&WebClient::onTLS, this, hostname.c_str(), _1));
-    c.set_open_handler(bind(&WebClient::onOpen, this, _1));
-    c.set_close_handler(bind(&WebClient::onClose, this, _1));
-    c.set_fail_handler(bind(&WebClient::onFail, this, _1));
+void WebClient::setFeedSession(const FeedSessionConfig& config) {
+    if (streaming()) {
+        throw std::runtime_error("Feed session must be configured before connecting");
+    }
+    sessionConfig = config;
+}
 
-    error_code ec;
-    client::connection_ptr con = c.get_connection(uri, ec);
-    if(ec){
-        throw std::runtime_error("Could not create connection: " + ec.message());
+FeedSessionStats WebClient::feedSessionStats() const {
+    FeedSessionStats stats;
+    for (const auto& feed : feeds) {
+        stats += feed->stats();
     }
+    return stats;
+}
+
+void WebClient::setFeedMerger(const FeedMergerConfig& config) {
+    if (streaming()) {
+        throw std::runtime_error("Feed merger must be configured before connecting");
+    }
+    mergerConfig = config;
+}
 
-    c.connect(con);
+FeedMergerStats WebClient::feedMergerStats() const {
+    return merger ? merger->stats() : FeedMergerStats();
+}
 
-    thread = std::thread(&client::run, &c);
+void WebClient::setThreadTopology(const ThreadTopology& config) {
+    if (!feeds.empty() || pipeline || barStore || gateway || tradeUpdates) {
+        throw std::runtime_error("Thread topology must be set before any engine thread starts");
+    }
+    topology = config;
+}
+
+size_t WebClient::addFeed(const MarketFeedConfig& config) {
+    if (streaming()) {
+        throw std::runtime_error("Feeds must be added before connecting");
+    }
+    if (feeds.size() > UINT8_MAX) {
+        throw std::runtime_error("Too many feeds");
+    }
+
+    MarketFeedConfig feedConfig = config;
+    if (!capturePath.empty()) {
+        feedConfig.capturePath = feeds.empty() ? capturePath : capturePath + "." + config.name;
+        feedConfig.capture = captureConfig;
+    }
+    assignRole(feedConfig.thread, topology.feed(feeds.size()));
+    assignRole(feedConfig.session.backfillThread, topology.housekeeping);
+    FeedListener& listener = *this;
+    feeds.push_back(std::make_unique<MarketFeed>(static_cast<uint8_t>(feeds.size()), feedConfig, listener,
+                                                 ALPACA_API_KEY, ALPACA_API_SECRET_KEY));
+    return feeds.size() - 1;
+}
+
+void WebClient::connect(const string& uri, const string& hostname) {
+    MarketFeedConfig config;
+    config.uri = uri;
+    config.hostname = hostname;
+    config.session = sessionConfig;
+    addFeed(config);
+    connect();
+}
+
+void WebClient::connect() {
+    if (feeds.empty()) {
+        throw std::runtime_error("No market data feed to connect");
+    }
+
+    startPipeline();
+    if (feeds.size() > 1 && !merger) {
+        FeedMergerConfig config = mergerConfig;
+        assignRole(config.thread, topology.merger);
+        merger = std::make_unique<FeedMerger>(
+            feeds.size(), config, [this](EventSpan events) { publishEvents(events.data(), events.size()); });
+        merger->start();
+    }
+    for (auto& feed : feeds) {
+        feed->connect();
+    }
 }
 
 void WebClient::disconnect() {
-    if(connected){
-        c.close(hdl, websocketpp::close::status::normal, "Client disconnecting");
-        connected = false;
+    for (auto& feed : feeds) {
+        feed->disconnect();
     }
 }
 
 void WebClient::authenticate() {
-    if (connected) {
-        json j;
-        j["action"] = "auth";
-        j["key"]    = ALPACA_API_KEY;
-        j["secret"] = ALPACA_API_SECRET_KEY;
-
-        string message = j.dump();
-        c.send(hdl, message, websocketpp::frame::opcode::text);
-        cout << "Sent authentication message to Alpaca." << endl;
-    } else {
-        cerr << "Cannot authenticate; not connected to WebSocket server." << endl;
+    if (feeds.empty()) {
+        LOG_ERROR("Cannot authenticate; not connected to WebSocket server.");
+        return;
+    }
+    for (auto& feed : feeds) {
+        feed->authenticate();
     }
 }
 
-void WebClient::subscribeBars(const vector<string>& symbols) {
-    if (connected) {
-        json j;
-        j["action"] = "subscribe";
-        j["bars"]   = symbols;
-
-        string message = j.dump();
-        c.send(hdl, message, websocketpp::frame::opcode::text);
-        cout << "Sent subscription message: " << message << endl;
-    } else {
-        cerr << "Cannot subscribe; not connected to WebSocket server." << endl;
+void WebClient::subscribe(FeedChannel channel, const vector<string>& symbols) {
+    vector<string> routed;
+    for (auto& feed : feeds) {
+        routed.clear();
+        for (const auto& symbol : symbols) {
+            if (feed->carries(symbol, channel)) routed.push_back(symbol);
+        }
+        if (!routed.empty()) feed->subscribe(channel, routed);
+    }
+    for (const auto& symbol : symbols) {
+        bool carried = false;
+        for (const auto& feed : feeds) carried = carried || feed->carries(symbol, channel);
+        if (!carried) LOG_WARN("No feed carries {} for {}; not subscribed.", toString(channel), symbol);
     }
 }
 
+void WebClient::unsubscribe(FeedChannel channel, const vector<string>& symbols) {
+    vector<string> routed;
+    for (auto& feed : feeds) {
+        routed.clear();
+        for (const auto& symbol : symbols) {
+            if (feed->carries(symbol, channel)) routed.push_back(symbol);
+        }
+        if (!routed.empty()) feed->unsubscribe(channel, routed);
+    }
+}
+
+void WebClient::subscribeBars(const vector<string>& symbols) {
+    subscribe(FeedChannel::Bars, symbols);
+}
 
 void WebClient::unsubscribeBars(const vector<string>& symbols) {
-    if (connected) {
-        json j;
-        j["action"] = "unsubscribe";
-        j["bars"]   = symbols;
+    unsubscribe(FeedChannel::Bars, symbols);
+}
+
+void WebClient::subscribeQuotes(const vector<string>& symbols) {
+    subscribe(FeedChannel::Quotes, symbols);
+}
+
+void WebClient::unsubscribeQuotes(const vector<string>& symbols) {
+    unsubscribe(FeedChannel::Quotes, symbols);
+}
+
+void WebClient::subscribeOrderBooks(const vector<string>& symbols) {
+    subscribe(FeedChannel::OrderBooks, symbols);
+}
+
+void WebClient::unsubscribeOrderBooks(const vector<string>& symbols) {
+    unsubscribe(FeedChannel::OrderBooks, symbols);
+}
+
+void WebClient::onFeedOpen(MarketFeed&) {
+    if (++feedsOpen == feeds.size() && onConnectCallback)
+        onConnectCallback();
+}
+
+void WebClient::onFeedAuthenticated(MarketFeed&) {
+    if (++feedsAuthenticated == feeds.size() && onAuthenticateCallback)
+        onAuthenticateCallback();
+}
 
-        string message = j.dump();
-        c.send(hdl, message, websocketpp::frame::opcode::text);
+void WebClient::onFeedSubscribed(MarketFeed&) {
+    if (onSubscribeCallback)
+        onSubscribeCallback();
+}
 
-        std::lock_guard<std::mutex> lock(subMutex);
-        for (auto &sym : symbols) {
-            subscriptions.erase(sym);
+void WebClient::onFeedEvents(MarketFeed& feed, const MarketEvent* events, size_t count) {
+    if (merger) {
+        for (size_t i = 0; i < count; ++i) {
+            merger->push(feed.index, events[i]);
         }
+        return;
+    }
+    publishEvents(events, count);
+}
 
-        cout << "Unsubscribed from symbols: ";
-        for (auto &sym : symbols) cout << sym << " ";
-        cout << endl;
-    } else {
-        cerr << "Cannot unsubscribe; not connected to WebSocket server." << endl;
+void WebClient::setCapture(const string& path, JournalWriterConfig config) {
+    if (streaming()) {
+        throw std::runtime_error("Capture must be configured before connecting");
     }
+    capturePath = path;
+    captureConfig = config;
 }
 
-void WebClient::run() {
-    c.run();
+void WebClient::setBarStore(const string& root) {
+    if (streaming()) {
+        throw std::runtime_error("Bar store must be configured before connecting");
+    }
+    barStore = std::make_unique<BarStoreWriter>(root);
+    barStore->start(topology.housekeeping);
 }
 
-void WebClient::onOpen(connection_hdl hdl) {
-    this->hdl = hdl;
-    connected = true;
-    cout << "Connection opened." << endl;
+size_t WebClient::warmUp(const string& root, const vector<string>& symbols, unsigned days) {
+    if (streaming()) {
+        throw std::runtime_error("Warm-up must run before connecting");
+    }
+    BarStoreReader reader(root);
+    const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    startPipeline();
+    logBars = false;
+    size_t count = 0;
+    for (const auto& symbol : symbols) {
+        for (const BarSlice& slice : reader.lastDays(symbol, days, now)) {
+            for (size_t i = 0; i < slice.size(); ++i) {
+                pipeline->publish(MarketEvent::of(slice.bar(i)));
+            }
+            count += slice.size();
+        }
+    }
+    pipeline->quiesce();
+    logBars = true;
 
-    if (onConnectCallback)
-        onConnectCallback();
+    vector<Order> discarded;
+    for (size_t i = 0; i < pipeline->shardCount(); ++i) {
+        pipeline->shard(i).takeOrders(discarded);
+    }
+    for (Order& order : discarded) {
+        release(order);
+    }
+    return count;
 }
 
-void WebClient::onClose(connection_hdl hdl) {
-    connected = false;
-    cout << "Connection closed." << endl;
+ReplayStats WebClient::replay(const string& path, const ReplayConfig& config) {
+    if (streaming()) {
+        throw std::runtime_error("Cannot replay while connected");
+    }
+
+    // An unconnected feed gives the journal the live decode path.
+    MarketFeedConfig feedConfig;
+    feedConfig.session.barInterval = std::chrono::seconds(0);
+    MarketFeed feed(0, feedConfig, *this, ALPACA_API_KEY, ALPACA_API_SECRET_KEY);
+
+    JournalReader reader(path);
+    startPipeline();
+    ReplayStats stats = replayJournal(reader, config, [&feed](const JournalRecord& record) {
+        feed.handleFrame(record.payload, latency::now());
+    });
+    pipeline->quiesce();
+    return stats;
 }
 
-void WebClient::onFail(connection_hdl hdl) {
-    cerr << "Connection failed." << endl;
+OrderShard::OrderShard(WebClient& owner, size_t index, std::unique_ptr<StrategyRunner> runner)
+    : index(index), owner(owner), runner(std::move(runner)) {
+    staged.reserve(ORDER_BATCH_RESERVE);
+    pending.reserve(ORDER_BATCH_RESERVE);
 }
 
-void WebClient::onMessage(connection_hdl hdl, message_ptr msg) {
-    boost::asio::post(this->processingPool, [this, msg]() {
-            if (msg->get_opcode() != websocketpp::frame::opcode::text) {
-                cout << "Received non-text message. (Opcode=" << msg->get_opcode() << ") Ignoring." << endl;
-                return;
+void OrderShard::onBatch(const MarketEvent* events, size_t count) {
+    const CompactBar* lastBar = nullptr;
+    size_t bars = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (events[i].type == EventType::Quote) {
+            const QuoteRecord& quote = events[i].quote;
+            symbols[quote.symbolId].lastQuote = quote;
+            if (quote.bidPrice > 0 && quote.askPrice > 0) {
+                owner.risk.observe(quote.symbolId, quote.bidPrice + (quote.askPrice - quote.bidPrice) / 2);
             }
+            continue;
+        }
+        if (events[i].type != EventType::Bar) continue;
+
+        const CompactBar& bar = events[i].bar;
+        owner.risk.observe(bar.symbolId, bar.close);
+        SymbolState& state = symbols[bar.symbolId];
+        state.lastBar = bar;
+        ++state.barCount;
+        lastBar = &bar;
+        ++bars;
+    }
 
-            std::string payload = msg->get_payload();
-            if (payload.empty()) {
-                cout << "Received empty text message. Ignoring." << endl;
-                return;
-            }
+    // One line per batch, however many bars the frames carried.
+    barsSeen += bars;
+    if (lastBar && owner.logBars.load(std::memory_order_relaxed)) {
+        const SymbolTable& table = SymbolTable::get_instance();
+        const uint8_t decimals = table.priceDecimals(lastBar->symbolId);
+        LOG_INFO("[shard {}] {} bars received ({} in total), last: symbol={} open={} close={} time={}", index, bars,
+                 barsSeen, table.name(lastBar->symbolId), fixed_point::toDouble(lastBar->open, decimals),
+                 fixed_point::toDouble(lastBar->close, decimals), lastBar->timestampNs);
+    }
+
+    if (!runner) {
+        for (size_t i = 0; i < count; ++i) {
+            if (events[i].type == EventType::BookLevel) books.apply(events[i].level);
+        }
+        return;
+    }
 
-            try {
-                auto response = json::parse(payload);
-
-                if (response.is_array()) {
-                    for (const auto& elem : response) {
-                        if (elem.is_object()) {
-                            if (elem.value("T", "") == "success" && elem.value("msg", "") == "authenticated") {
-                                cout << "Authentication successful." << endl;
-                                if (onAuthenticateCallback)
-                                    onAuthenticateCallback();
-                                return;
-                            }
-
-                            if(elem.value("T", "") == "subscription") {
-                                cout << "Subscription successful for symbols: " << elem.dump(4) << endl;
-                                if(onSubscribeCallback)
-                                    onSubscribeCallback();
-                                return;
-                            }
-
-                            if(elem.value("T", "") == "b"){
-                                Bar bar(elem);
-                                {
-                                    std::lock_guard<std::mutex> lock(orderMutex);
-                                    createOrder(bar);
-                                    cout << orders.size() << ". Bar received:"
-                                            << " symbol=" << bar.S
-                                            << " open=" << bar.o
-                                            << " close=" << bar.c
-                                            << " time=" << bar.t << endl;
-                                }
-                            } else {
-                                cout << "Unknown JSON object in array: " << elem.dump(4) << endl;
-                            }
-                        } else {
-                            cout << "Non-object JSON in array: " << elem.dump() << endl;
-                        }
-                    }
-                }
-                else if (response.is_object()) {
-                    if (response.value("T", "") == "b") {
-                        Bar bar(response);
-                        cout << "Single bar received: symbol=" << bar.S
-                                  << " open=" << bar.o
-                                  << " close=" << bar.c
-                                  << " time=" << bar.t << endl;
-                    } else if (response.value("T", "") == "subscription") {
-                        cout << "Subscription successful for symbols: " << response.dump(4) << endl;
-                        if (onSubscribeCallback) {
-                            onSubscribeCallback();
-                        }
-                    } else {
-                        cout << "Received object: " << response.dump(4) << endl;
-                    }
-                }
-                else {
-                    cout << "Received non-object, non-array JSON: " << response.dump() << endl;
-                }
-            } catch (const std::exception& e) {
-                cerr << "Failed to parse JSON message: " << e.what()
-                          << "\nPayload was: " << payload << endl;
+    intents.clear();
+    runner->onEvents(events, count, books, intents);
+    if (intents.empty()) return;
+
+    const uint64_t decisionTicks = latency::now();
+    for (const OrderIntent& intent : intents) {
+        if (!owner.stageOrder(intent, staged)) continue;
+        if (!latency::enabled) continue;
+
+        // Attribute the intent to the newest event for its symbol in the batch.
+        uint64_t receiveTicks = 0;
+        for (size_t i = count; i-- > 0;) {
+            if (events[i].symbolId() == intent.symbolId) {
+                receiveTicks = events[i].receiveTicks;
+                break;
             }
-        });
+        }
+        latency::record(latency::Stage::Strategy, receiveTicks, decisionTicks);
+        staged.back().receiveTicks = receiveTicks;
+        staged.back().decisionTicks = decisionTicks;
+    }
+
+    std::lock_guard<std::mutex> lock(handoffMutex);
+    std::move(staged.begin(), staged.end(), std::back_inserter(pending));
+    staged.clear();
 }
 
+void OrderShard::moveSymbol(uint32_t symbolId, OrderShard& to) {
+    auto it = symbols.find(symbolId);
+    if (it != symbols.end()) {
+        to.symbols[symbolId] = it->second;
+        symbols.erase(it);
+    }
+    books.moveSymbol(symbolId, to.books);
+    if (runner && to.runner) {
+        runner->moveSymbol(symbolId, *to.runner);
+    }
+}
 
-void WebClient::placeOrder(Order& order)
-{
-    try {
-        nlohmann::json orderBody;
-        orderBody["symbol"]        = order.symbol;
-        orderBody["qty"]           = order.qty;
-        orderBody["side"]          = order.side;
-        orderBody["type"]          = order.type;
-        orderBody["time_in_force"] = order.time_in_force;
+void OrderShard::takeOrders(vector<Order>& out) {
+    std::lock_guard<std::mutex> lock(handoffMutex);
+    std::move(pending.begin(), pending.end(), std::back_inserter(out));
+    pending.clear();
+}
 
-        string jsonBody = orderBody.dump();
+void WebClient::setStrategyFactory(StrategyFactory factory) {
+    if (pipeline) {
+        throw std::runtime_error("Strategies must be configured before connecting");
+    }
+    strategyFactory = std::move(factory);
+}
 
-        boost::asio::io_context ioc;
-        boost::asio::ssl::context sslCtx(boost::asio::ssl::context::tlsv12_client);
-        sslCtx.set_verify_mode(boost::asio::ssl::verify_none);
+void WebClient::setMarketDataPipeline(const ShardPipelineConfig& config) {
+    if (pipeline) {
+        throw std::runtime_error("Market data pipeline must be configured before connecting");
+    }
+    pipelineConfig = config;
+}
 
-        const string host = "paper-api.alpaca.markets";
-        const string port = "443";
-        boost::asio::ip::tcp::resolver resolver(ioc);
-        auto const results = resolver.resolve(host, port);
+RingStats WebClient::marketDataStats() const {
+    return pipeline ? pipeline->stats() : RingStats();
+}
 
-        boost::beast::tcp_stream plain_stream(ioc);
-        plain_stream.connect(results);
+void WebClient::rebalanceShards(const vector<string>& symbols) {
+    auto rebalance = [this, symbols]() {
+        SymbolTable& table = SymbolTable::get_instance();
+        vector<uint32_t> ids;
+        ids.reserve(symbols.size());
+        for (const auto& symbol : symbols) {
+            ids.push_back(table.intern(symbol));
+        }
+        pipeline->rebalance(ids);
+        LOG_INFO("Rebalanced {} symbols across {} shards.", ids.size(), pipeline->shardCount());
+    };
 
-        boost::beast::ssl_stream<boost::beast::tcp_stream> sslStream(std::move(plain_stream), sslCtx);
+    startPipeline();
+    // Runs between frames on the pipeline's only producer.
+    runOnProducer(rebalance);
+}
 
-        ::SSL_set_tlsext_host_name(sslStream.native_handle(), host.c_str());
+void WebClient::startPipeline() {
+    if (pipeline) return;
 
-        sslStream.handshake(boost::asio::ssl::stream_base::client);
+    ShardPipelineConfig config = pipelineConfig;
+    if (!topology.shards.empty()) {
+        if (config.shards == 0) config.shards = topology.shards.size();
+        config.threads = topology.shards;
+    }
+    pipeline = std::make_unique<ShardPipeline<OrderShard, MarketEvent>>(config, [this](size_t index) {
+        return std::make_unique<OrderShard>(*this, index, strategyFactory ? strategyFactory() : nullptr);
+    });
+    pipeline->start();
+}
 
-        boost::beast::http::request<boost::beast::http::string_body> req{
-            boost::beast::http::verb::post, "/v2/orders", 11
-        };
-        req.set(boost::beast::http::field::host, host);
-        req.set("APCA-API-KEY-ID", ALPACA_API_KEY);
-        req.set("APCA-API-SECRET-KEY", ALPACA_API_SECRET_KEY);
-        req.set(boost::beast::http::field::content_type, "application/json");
-        req.set(boost::beast::http::field::user_agent, BOOST_BEAST_VERSION_STRING);
-        req.body() = jsonBody;
-        req.prepare_payload();
+void WebClient::stopPipeline() {
+    if (pipeline) {
+        pipeline->stop();
+    }
+}
+
+void WebClient::publishEvents(const MarketEvent* events, size_t count) {
+    if (barStore) {
+        for (size_t i = 0; i < count; ++i) {
+            if (events[i].type == EventType::Bar) barStore->publish(events[i].bar);
+        }
+    }
+    pipeline->publish(events, count);
+}
+
+void WebClient::runOnProducer(function<void()> task) {
+    if (merger) {
+        merger->post(std::move(task));
+    } else if (!feeds.empty()) {
+        feeds.front()->post(std::move(task));
+    } else {
+        task();
+    }
+}
 
-        boost::beast::http::write(sslStream, req);
+void WebClient::connectTradeUpdates(const string& uri, const string& hostname) {
+    if (tradeUpdates) {
+        throw std::runtime_error("Trade updates are already connected");
+    }
+    tradeUpdates = std::make_unique<TradeUpdateStream>(manager, ALPACA_API_KEY, ALPACA_API_SECRET_KEY);
+    tradeUpdates->connect(uri, hostname, topology.tradeUpdates);
+}
+
+void WebClient::setOrderEndpoint(const SessionPoolConfig& config) {
+    if (gateway) {
+        throw std::runtime_error("Order endpoint must be set before the first order is placed");
+    }
+    gatewayConfig.host = config.host;
+    gatewayConfig.port = config.port;
+    gatewayConfig.ioTimeout = config.ioTimeout;
+    gatewayConfig.heartbeatInterval = config.heartbeatInterval;
+    gatewayConfig.heartbeatTarget = config.heartbeatTarget;
+    gatewayConfig.verifyPeer = config.verifyPeer;
+}
+
+void WebClient::setOrderGateway(const OrderGatewayConfig& config) {
+    if (gateway) {
+        throw std::runtime_error("Order gateway must be configured before the first order is executed");
+    }
+    gatewayConfig = config;
+}
+
+OrderGateway& WebClient::orderGateway() {
+    std::call_once(gatewayOnce, [this]() {
+        OrderGatewayConfig config = gatewayConfig;
+        assignRole(config.ioThread, topology.orderGateway);
+        gateway = std::make_unique<OrderGateway>(config);
+        gateway->setCredentials(ALPACA_API_KEY, ALPACA_API_SECRET_KEY, manager.clientIdPrefix());
+        gateway->start();
+    });
+    return *gateway;
+}
+
+void WebClient::warmOrderSessions() {
+    orderGateway().warmUp();
+}
+
+http_request WebClient::buildOrderRequest(const Order& order) const {
+    nlohmann::json orderBody;
+    orderBody["symbol"]        = order.symbol;
+    orderBody["qty"]           = order.qty;
+    orderBody["side"]          = order.side;
+    orderBody["type"]          = order.type;
+    orderBody["time_in_force"] = order.time_in_force;
+    if (!order.limit_price.empty()) {
+        orderBody["limit_price"] = order.limit_price;
+    }
 
-        boost::beast::flat_buffer buffer;
-        boost::beast::http::response<boost::beast::http::string_body> res;
-        boost::beast::http::read(sslStream, buffer, res);
-        cout << "Order response code: " << res.result_int() << endl;
-        if (res.result_int() >= 200 && res.result_int() < 300) {
-            cout << "Order placed successfully!" << endl;
+    http_request req{boost::beast::http::verb::post, "/v2/orders", 11};
+    req.set(boost::beast::http::field::content_type, "application/json");
+    req.set(boost::beast::http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+    req.body() = orderBody.dump();
+    req.prepare_payload();
+    return req;
+}
+
+void WebClient::placeOrder(Order& order)
+{
+    try {
+        const OrderResult result = orderGateway().submit(buildOrderRequest(order)).get();
+        if (result.ec) {
+            LOG_ERROR("Exception in placeOrder: {}", result.ec.message());
+        } else if (result.ok()) {
+            LOG_INFO("Order for {} placed successfully ({}).", order.symbol, result.status);
         } else {
-            cerr << "Order failed or partially successful." << endl;
+            LOG_ERROR("Order for {} failed with response code {}.", order.symbol, result.status);
         }
 
-        boost::system::error_code ec;
-        sslStream.shutdown(ec);
-
     } catch (const std::exception &e) {
-        cerr << "Exception in placeOrder: " << e.what() << endl;
+        LOG_ERROR("Exception in placeOrder: {}", e.what());
     }
 }
 
-void WebClient::createOrder(Bar& bar){
-    string symbolBuffer = bar.S;
-    symbolBuffer.erase(symbolBuffer.begin() + 3);
-    const string symbol = symbolBuffer;
-    const string qty = "0.001";
-    const string side = "sell";
-    const string type = "market";
-    const string time_in_force = "gtc";
-    orders.push_back(Order(symbol, qty, side, type, time_in_force));
+bool WebClient::stageOrder(const OrderIntent& requested, vector<Order>& out) {
+    // Risk sees the order as it will be sent.
+    const OrderIntent intent = roundToRules(requested);
+    const Position held = manager.position(intent.symbolId);
+    const RiskReject verdict = risk.check(intent, held.quantity, held.openBuy, held.openSell);
+    if (verdict != RiskReject::None) {
+        LOG_DEBUG("Order for symbol {} rejected by pre-trade risk: {}", intent.symbolId, toString(verdict));
+        return false;
+    }
+    manager.reserve(intent.symbolId, intent.side, intent.quantity);
+    out.push_back(makeOrder(intent));
+    out.back().reserved = intent.quantity;
+    return true;
 }
 
-void WebClient::executeOrders(){
-    unsigned int numThreads = std::thread::hardware_concurrency();
-    if(numThreads == 0) numThreads = 4;
+void WebClient::release(Order& order) {
+    manager.release(order.symbolId, sideOf(order), order.reserved);
+    order.reserved = 0;
+}
+
+void WebClient::createOrder(const OrderIntent& intent){
+    std::lock_guard<std::mutex> lock(orderMutex);
+    stageOrder(intent, orders);
+}
+
+vector<Order> WebClient::takeOrders() {
+    vector<Order> taken;
+    takeOrders(taken);
+    for (Order& order : taken) {
+        release(order);
+    }
+    return taken;
+}
+
+void WebClient::takeOrders(vector<Order>& out) {
+    std::lock_guard<std::mutex> lock(orderMutex);
+    if (pipeline) {
+        for (size_t i = 0; i < pipeline->shardCount(); ++i) {
+            pipeline->shard(i).takeOrders(orders);
+        }
+    }
+    if (out.empty()) {
+        // Both vectors keep their capacity, so staging never regrows either.
+        out.swap(orders);
+        return;
+    }
+    std::move(orders.begin(), orders.end(), std::back_inserter(out));
+    orders.clear();
+}
+
+void WebClient::setOrderBatching(const OrderBatchConfig& config) {
+    std::lock_guard<std::mutex> executing(executeMutex);
+    batcher.configure(config);
+}
+
+void WebClient::collectBatch() {
+    const OrderBatchConfig& config = batcher.config();
+    const auto deadline = std::chrono::steady_clock::now() + config.window;
+    for (;;) {
+        if (config.maxOrders != 0 && executeBuffer.size() >= config.maxOrders) break;
+        const auto now = std::chrono::steady_clock::now();
+        if (now >= deadline) break;
+        // Shards hand orders off once per event batch, so polling at this
+        // rate adds little to the window.
+        std::this_thread::sleep_for(std::min<std::chrono::steady_clock::duration>(deadline - now, BATCH_POLL));
+        takeOrders(executeBuffer);
+    }
+
+    heldBeforeBatch.clear();
+    for (const Order& order : executeBuffer) {
+        if (order.reserved != 0) heldBeforeBatch.push_back(Reservation{order.symbolId, sideOf(order), order.reserved});
+    }
+    const size_t removed = batcher.coalesce(executeBuffer, &risk);
+    if (removed != 0) {
+        // Coalesced orders hold what they send, not what their parts held.
+        // The new reservations go in before the old ones come out, so the
+        // position limit never sees less than either.
+        const SymbolTable& table = SymbolTable::get_instance();
+        for (Order& order : executeBuffer) {
+            if (order.reserved == 0) continue;
+            int64_t quantity = 0;
+            fixed_point::parse(order.qty, table.sizeDecimals(order.symbolId), quantity);
+            manager.reserve(order.symbolId, sideOf(order), quantity);
+            order.reserved = quantity;
+        }
+        for (const Reservation& held : heldBeforeBatch) {
+            manager.release(held.symbolId, held.side, held.quantity);
+        }
+    }
+    const uint64_t releaseTicks = latency::now();
+    for (const Order& order : executeBuffer) {
+        if (config.coalesces(order.strategyId)) {
+            latency::record(latency::Stage::Batch, order.decisionTicks, releaseTicks);
+        }
+    }
+    if (removed != 0) {
+        LOG_INFO("Batching coalesced {} staged orders into {} requests.", executeBuffer.size() + removed,
+                 executeBuffer.size());
+    }
+}
 
-    boost::asio::thread_pool pool(numThreads);
+void WebClient::executeOrders(){
+    std::lock_guard<std::mutex> executing(executeMutex);
+    OrderGateway& orders_gateway = orderGateway();
+    executeBuffer.clear();
+    takeOrders(executeBuffer);
+    if (batcher.config().enabled()) collectBatch();
 
-    std::mutex coutMutex;
+    ExecutionTally tally{manager};
+    // Orders skipped before reaching the gateway are not counted.
+    size_t submitted = 0;
 
     auto start = std::chrono::high_resolution_clock::now();
 
-    for(auto& order : orders){
-        boost::asio::post(pool, [this, &order, &coutMutex]() {
-            try{
-                {
-                    std::lock_guard<std::mutex> lock(coutMutex);
-                    cout << "Placing order for symbol: " << order.symbol << endl;
-                }
-                placeOrder(order);
-            }
-            catch(const std::exception& e){
-                std::lock_guard<std::mutex> lock(coutMutex);
-                cerr << "Exception while placing order for " << order.symbol 
-                          << ": " << e.what() << endl;
+    OrderEncoder& encoder = orders_gateway.encoder();
+    for(auto& order : executeBuffer){
+        order.clientOrderId = manager.open(order);
+        if (order.clientOrderId == 0) {
+            LOG_ERROR("Order for {} skipped; too many open orders to track", order.symbol);
+            continue;
+        }
+        EncodedOrderPtr request = orders_gateway.orderBuffer();
+        if (!encoder.encode(order, order.clientOrderId, *request)) {
+            LOG_ERROR("Order for {} does not fit an order buffer; skipped", order.symbol);
+            manager.apply(order.clientOrderId, OrderStatus::Rejected);
+            continue;
+        }
+        order.serializedTicks = latency::now();
+        latency::record(latency::Stage::Serialize, order.decisionTicks, order.serializedTicks);
+
+        // Two pointers: small enough for std::function to hold without
+        // allocating.
+        auto onResult = [tally = &tally, order = &order](const OrderResult& result) {
+            latency::record(latency::Stage::Write, order->serializedTicks, result.writtenTicks);
+            latency::record(latency::Stage::Response, result.writtenTicks, result.responseTicks);
+            latency::record(latency::Stage::EndToEnd, order->receiveTicks, result.responseTicks);
+
+            if (result.ec && !result.sent) {
+                // Never reached the exchange, so nothing there to wait for.
+                tally->manager.apply(order->clientOrderId, OrderStatus::Rejected);
+                LOG_ERROR("Exception while placing order for {}: {}", order->symbol, result.ec.message());
+            } else if (result.ec) {
+                tally->manager.apply(order->clientOrderId, OrderStatus::Unconfirmed);
+                LOG_ERROR("Order for {} may have been placed; the connection failed before the response: {}",
+                          order->symbol, result.ec.message());
+                std::lock_guard<std::mutex> lock(tally->mutex);
+                ++tally->unconfirmed;
+            } else if (result.ok()) {
+                // The trade update stream usually gets here first.
+                tally->manager.apply(order->clientOrderId, OrderStatus::Accepted);
+                std::lock_guard<std::mutex> lock(tally->mutex);
+                ++tally->succeeded;
+            } else {
+                tally->manager.apply(order->clientOrderId, OrderStatus::Rejected);
+                LOG_ERROR("Order for {} failed with response code {}: {}", order->symbol, result.status,
+                          result.body);
             }
-        });
+        };
+
+        while (!orders_gateway.submit(std::move(request), onResult)) {
+            orders_gateway.awaitCapacity();
+        }
+        ++submitted;
     }
 
-    pool.join();
+    orders_gateway.drain();
 
     auto end = std::chrono::high_resolution_clock::now();
     std::chrono::duration<double> elapsed = end - start;
 
+    size_t unconfirmed = 0;
     {
-        std::lock_guard<std::mutex> lock(coutMutex);
-        cout << "Executed " << orders.size() << " orders concurrently in " 
-                  << elapsed.count() << " seconds." << endl;
+        std::lock_guard<std::mutex> lock(tally.mutex);
+        LOG_INFO("Executed {} orders ({} accepted) in {} seconds.", submitted, tally.succeeded,
+                 elapsed.count());
+        unconfirmed = tally.unconfirmed;
+    }
+    if (unconfirmed != 0) {
+        const size_t settled = reconcileOrders();
+        LOG_INFO("Reconciled {} of {} unconfirmed orders.", settled, unconfirmed);
     }
-
-    orders.clear();
 }
 
+size_t WebClient::reconcileOrders() {
+    vector<uint64_t> ids;
+    manager.unconfirmedOrders(ids);
+    if (ids.empty()) return 0;
 
-context_ptr WebClient::onTLS(const char* hostname, connection_hdl) {
-    context_ptr ctx = websocketpp::lib::make_shared<websocketpp::lib::asio::ssl::context>(
-        websocketpp::lib::asio::ssl::context::tlsv12
-    );
-
-    ctx->set_options(websocketpp::lib::asio::ssl::context::default_workarounds |
-                     websocketpp::lib::asio::ssl::context::no_sslv2 |
-                     websocketpp::lib::asio::ssl::context::no_sslv3 |
-                     websocketpp::lib::asio::ssl::context::single_dh_use);
-
-    ctx->set_verify_mode(boost::asio::ssl::verify_none);
+    OrderGateway& orders_gateway = orderGateway();
+    vector<OrderResult> results(ids.size());
+    for (size_t i = 0; i < ids.size(); ++i) {
+        http_request req{boost::beast::http::verb::get,
+                         "/v2/orders:by_client_order_id?client_order_id=" + manager.clientOrderId(ids[i]), 11};
+        req.set(boost::beast::http::field::user_agent, BOOST_BEAST_VERSION_STRING);
+        auto onResult = [result = &results[i]](const OrderResult& done) { *result = done; };
+        while (!orders_gateway.submit(req, onResult)) {
+            orders_gateway.awaitCapacity();
+        }
+    }
+    orders_gateway.drain();
+
+    size_t settled = 0;
+    for (size_t i = 0; i < ids.size(); ++i) {
+        const OrderResult& result = results[i];
+        if (result.ok()) {
+            if (manager.onOrder(result.body)) ++settled;
+        } else if (!result.ec && result.status == 404) {
+            // The exchange has no order under this id: it never took it.
+            if (manager.apply(ids[i], OrderStatus::Rejected)) ++settled;
+        } else {
+            LOG_WARN("Could not reconcile order {}: {}", manager.clientOrderId(ids[i]),
+                     result.ec ? result.ec.message() : result.body);
+        }
+    }
+    return settled;
+}
 
-    return ctx;
-}
\ No newline at end of file
@@ -0,0 +1,917 @@
+#include "exchange_simulator.h"
+
+#include <boost/beast/core.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <future>
+#include <iostream>
+#include <map>
+#include <set>
+#include <type_traits>
+
+#include <nlohmann/json.hpp>
+
+#include "feed_decoder.h"
+#include "fixed_point.h"
+#include "symbol_table.h"
+#include "tls_certificate.h"
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+namespace http = boost::beast::http;
+namespace websocket = boost::beast::websocket;
+using tcp = boost::asio::ip::tcp;
+using json = nlohmann::json;
+
+namespace {
+    typedef boost::beast::tcp_stream plain_stream;
+    typedef boost::beast::ssl_stream<boost::beast::tcp_stream> tls_stream;
+
+    template <typename Stream>
+    struct IsTls : std::false_type {};
+
+    template <typename Stream>
+    struct IsTls<boost::beast::ssl_stream<Stream>> : std::true_type {};
+
+    int64_t nowNs() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    string errorBody(int code, const string& message) {
+        return json{{"code", code}, {"message", message}}.dump();
+    }
+
+    // JSON numbers in feed frames, strings in REST bodies; same digits.
+    string fixedText(int64_t value, uint8_t decimals) {
+        return fixed_point::toString(value, decimals);
+    }
+
+    string urlDecode(std::string_view text) {
+        string out;
+        out.reserve(text.size());
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (text[i] == '%' && i + 2 < text.size()) {
+                out += static_cast<char>(std::stoi(string(text.substr(i + 1, 2)), nullptr, 16));
+                i += 2;
+            } else {
+                out += text[i] == '+' ? ' ' : text[i];
+            }
+        }
+        return out;
+    }
+
+    std::map<string, string> parseQuery(std::string_view query) {
+        std::map<string, string> params;
+        while (!query.empty()) {
+            const size_t end = query.find('&');
+            const std::string_view pair = query.substr(0, end);
+            const size_t eq = pair.find('=');
+            if (eq != std::string_view::npos) params[urlDecode(pair.substr(0, eq))] = urlDecode(pair.substr(eq + 1));
+            if (end == std::string_view::npos) break;
+            query.remove_prefix(end + 1);
+        }
+        return params;
+    }
+
+    // Channel of account trade updates, sent to /stream sessions that
+    // listen to it.
+    const char* const TRADE_UPDATES = "trade_updates";
+
+    bool parseQuantity(const json& value, uint8_t decimals, int64_t& out) {
+        if (value.is_string()) return fixed_point::parse(value.get<string>(), decimals, out);
+        if (value.is_number()) return fixed_point::parse(value.dump(), decimals, out);
+        return false;
+    }
+}
+
+// A client connection; closed when the simulator stops so peers see EOF
+// instead of a silent socket.
+class ExchangeSimulator::Session {
+public:
+    virtual ~Session() = default;
+
+    virtual void close() = 0;
+};
+
+// A market-data WebSocket session that frames are pushed to.
+class ExchangeSimulator::Subscriber : public Session {
+public:
+
+    // channel is null for replayed frames, which go to every subscriber.
+    virtual void deliver(const char* channel, const string& symbol, const std::shared_ptr<const string>& frame) = 0;
+};
+
+template <typename Stream>
+class ExchangeSimulator::HttpSession : public Session, public std::enable_shared_from_this<HttpSession<Stream>> {
+public:
+    HttpSession(ExchangeSimulator& sim, Stream stream) : sim(sim), stream(std::move(stream)), delay(sim.ioc) {}
+
+    void run() {
+        auto self = this->shared_from_this();
+        if constexpr (IsTls<Stream>::value) {
+            stream.async_handshake(boost::asio::ssl::stream_base::server, [self](boost::system::error_code ec) {
+                if (!ec) self->read();
+            });
+        } else {
+            read();
+        }
+    }
+
+private:
+    void read() {
+        req = {};
+        auto self = this->shared_from_this();
+        http::async_read(stream, buffer, req, [self](boost::system::error_code ec, size_t) {
+            if (ec) return self->close();
+            self->res = {};
+            self->sim.handleRequest(self->req, self->res);
+            self->delay.expires_after(self->sim.sample(self->sim.cfg.orderLatency));
+            self->delay.async_wait([self](boost::system::error_code) { self->write(); });
+        });
+    }
+
+    void write() {
+        auto self = this->shared_from_this();
+        http::async_write(stream, res, [self](boost::system::error_code ec, size_t) {
+            if (ec || !self->res.keep_alive()) return self->close();
+            self->read();
+        });
+    }
+
+public:
+    void close() override {
+        boost::beast::get_lowest_layer(stream).close();
+    }
+
+private:
+
+    ExchangeSimulator& sim;
+    Stream stream;
+    boost::beast::flat_buffer buffer;
+    request_type req;
+    response_type res;
+    boost::asio::steady_timer delay;
+};
+
+template <typename Stream>
+class ExchangeSimulator::StreamSession : public Subscriber, public std::enable_shared_from_this<StreamSession<Stream>> {
+public:
+    StreamSession(ExchangeSimulator& sim, Stream stream) : sim(sim), ws(std::move(stream)) {}
+
+    void run() {
+        auto self = this->shared_from_this();
+        if constexpr (IsTls<Stream>::value) {
+            ws.next_layer().async_handshake(boost::asio::ssl::stream_base::server, [self](boost::system::error_code ec) {
+                if (!ec) self->accept();
+            });
+        } else {
+            accept();
+        }
+    }
+
+    void close() override {
+        closed = true;
+        boost::beast::get_lowest_layer(ws).close();
+    }
+
+    void deliver(const char* channel, const string& symbol, const std::shared_ptr<const string>& frame) override {
+        if (closed || !authenticated) return;
+        if (channel && std::strcmp(channel, TRADE_UPDATES) == 0) {
+            if (listening) send(frame);
+            return;
+        }
+        if (channel ? !wants(channel, symbol) : channels.empty()) return;
+        send(frame);
+    }
+
+private:
+    // The upgrade request's path picks the protocol: "/stream" is the
+    // account stream (trade updates), anything else market data.
+    void accept() {
+        auto self = this->shared_from_this();
+        ws.set_option(websocket::stream_base::timeout::suggested(boost::beast::role_type::server));
+        http::async_read(ws.next_layer(), buffer, upgrade, [self](boost::system::error_code ec, size_t) {
+            if (ec || !websocket::is_upgrade(self->upgrade)) return;
+            self->account = self->upgrade.target() == "/stream";
+            self->ws.async_accept(self->upgrade, [self](boost::system::error_code ec) {
+                if (ec) return;
+                if (!self->account) self->send(R"([{"T":"success","msg":"connected"}])");
+                self->read();
+            });
+        });
+    }
+
+    void read() {
+        auto self = this->shared_from_this();
+        ws.async_read(buffer, [self](boost::system::error_code ec, size_t) {
+            if (ec) {
+                self->closed = true;
+                return;
+            }
+            string text = boost::beast::buffers_to_string(self->buffer.data());
+            self->buffer.consume(self->buffer.size());
+            self->handle(text);
+            self->read();
+        });
+    }
+
+    void handle(const string& text) {
+        json message = json::parse(text, nullptr, false);
+        if (message.is_discarded() || !message.is_object()) {
+            send(R"([{"T":"error","code":400,"msg":"invalid syntax"}])");
+            return;
+        }
+
+        const string action = message.value("action", "");
+        if (account) {
+            handleAccount(action, message);
+            return;
+        }
+        if (action == "auth") {
+            if (!sim.checkCredentials(message.value("key", ""), message.value("secret", ""))) {
+                send(R"([{"T":"error","code":402,"msg":"auth failed"}])");
+                return;
+            }
+            if (!authenticated) {
+                authenticated = true;
+                sim.attach(this->shared_from_this());
+            }
+            send(R"([{"T":"success","msg":"authenticated"}])");
+            return;
+        }
+
+        if (action != "subscribe" && action != "unsubscribe") {
+            send(R"([{"T":"error","code":401,"msg":"invalid action"}])");
+            return;
+        }
+        if (!authenticated) {
+            send(R"([{"T":"error","code":401,"msg":"not authenticated"}])");
+            return;
+        }
+
+        for (const char* channel : {"bars", "trades", "quotes", "orderbooks"}) {
+            if (!message.contains(channel) || !message[channel].is_array()) continue;
+            std::set<string>& symbols = channels[channel];
+            for (const auto& symbol : message[channel]) {
+                if (!symbol.is_string()) continue;
+                if (action == "subscribe") symbols.insert(symbol.get<string>());
+                else symbols.erase(symbol.get<string>());
+            }
+            if (symbols.empty()) channels.erase(channel);
+        }
+
+        json ack = {{"T", "subscription"}};
+        for (const char* channel : {"trades", "quotes", "orderbooks", "bars"}) {
+            auto it = channels.find(channel);
+            ack[channel] = it == channels.end() ? json::array() : json(it->second);
+        }
+        send(json::array({ack}).dump());
+    }
+
+    // Alpaca's account stream: auth, then listen to trade_updates.
+    void handleAccount(const string& action, const json& message) {
+        if (action == "auth" || action == "authenticate") {
+            const json& data = message.contains("data") ? message["data"] : message;
+            const bool ok = sim.checkCredentials(data.value(action == "auth" ? "key" : "key_id", ""),
+                                                 data.value(action == "auth" ? "secret" : "secret_key", ""));
+            send(json{{"stream", "authorization"},
+                      {"data", {{"action", "authenticate"}, {"status", ok ? "authorized" : "unauthorized"}}}}.dump());
+            if (ok && !authenticated) {
+                authenticated = true;
+                sim.attach(this->shared_from_this());
+            }
+            return;
+        }
+        if (action != "listen" || !authenticated) {
+            send(json{{"stream", "authorization"},
+                      {"data", {{"action", action}, {"status", "unauthorized"}}}}.dump());
+            return;
+        }
+
+        listening = false;
+        const json& data = message.contains("data") ? message["data"] : json::object();
+        if (data.contains("streams") && data["streams"].is_array()) {
+            for (const auto& stream : data["streams"]) {
+                if (stream == TRADE_UPDATES) listening = true;
+            }
+        }
+        send(json{{"stream", "listening"},
+                  {"data", {{"streams", listening ? json::array({TRADE_UPDATES}) : json::array()}}}}.dump());
+    }
+
+    bool wants(const char* channel, const string& symbol) const {
+        auto it = channels.find(channel);
+        return it != channels.end() && (it->second.count(symbol) || it->second.count("*"));
+    }
+
+    void send(string text) {
+        send(std::make_shared<const string>(std::move(text)));
+    }
+
+    void send(const std::shared_ptr<const string>& frame) {
+        outbox.push_back(frame);
+        if (outbox.size() == 1) write();
+    }
+
+    void write() {
+        auto self = this->shared_from_this();
+        ws.text(true);
+        ws.async_write(boost::asio::buffer(*outbox.front()), [self](boost::system::error_code ec, size_t) {
+            if (ec) {
+                self->closed = true;
+                self->outbox.clear();
+                return;
+            }
+            self->outbox.pop_front();
+            if (!self->outbox.empty()) self->write();
+        });
+    }
+
+    ExchangeSimulator& sim;
+    websocket::stream<Stream> ws;
+    boost::beast::flat_buffer buffer;
+    http::request<http::string_body> upgrade;
+    std::deque<std::shared_ptr<const string>> outbox;
+    std::map<string, std::set<string>> channels;
+    bool account = false;
+    bool listening = false;
+    bool authenticated = false;
+    bool closed = false;
+};
+
+ExchangeSimulator::ExchangeSimulator(const ExchangeSimulatorConfig& config)
+    : cfg(config),
+      tlsContext(boost::asio::ssl::context::tls_server),
+      restAcceptor(ioc),
+      streamAcceptor(ioc),
+      tickTimer(ioc),
+      frameTimer(ioc),
+      rng(config.seed) {
+    SymbolTable& table = SymbolTable::get_instance();
+    for (const auto& name : cfg.symbols) {
+        SymbolState state{};
+        state.id = table.intern(name);
+        state.name = name;
+        state.price = cfg.startPrice;
+        state.barOpen = state.barHigh = state.barLow = cfg.startPrice;
+        symbolIndex[name] = symbols.size();
+
+        // Orders name crypto pairs without the slash ("BTCUSD").
+        string compact = name;
+        compact.erase(std::remove(compact.begin(), compact.end(), '/'), compact.end());
+        symbolIndex.emplace(compact, symbols.size());
+        symbols.push_back(state);
+    }
+}
+
+ExchangeSimulator::~ExchangeSimulator() {
+    stop();
+}
+
+void ExchangeSimulator::start() {
+    if (running.exchange(true)) return;
+
+    if (cfg.tls) {
+        useSelfSignedCertificate(tlsContext, "localhost");
+    }
+    if (!cfg.replayPath.empty()) {
+        replay.open(cfg.replayPath);
+        if (!replay) {
+            running = false;
+            throw std::runtime_error("Cannot open replay file " + cfg.replayPath);
+        }
+    }
+
+    auto listen = [this](tcp::acceptor& acceptor, unsigned short port) {
+        tcp::endpoint endpoint(boost::asio::ip::make_address(cfg.address), port);
+        acceptor.open(endpoint.protocol());
+        acceptor.set_option(boost::asio::socket_base::reuse_address(true));
+        acceptor.bind(endpoint);
+        acceptor.listen();
+        return acceptor.local_endpoint().port();
+    };
+    boundRestPort = listen(restAcceptor, cfg.restPort);
+    boundStreamPort = listen(streamAcceptor, cfg.streamPort);
+
+    work.emplace(ioc.get_executor());
+    acceptRest();
+    acceptStream();
+    // Quote once up front so orders never meet an empty book.
+    tick();
+    scheduleTick();
+    ioThread = std::thread([this]() { ioc.run(); });
+
+    cout << "Exchange simulator listening: REST " << (cfg.tls ? "https" : "http") << "://" << cfg.address << ":"
+         << boundRestPort << ", stream " << (cfg.tls ? "wss" : "ws") << "://" << cfg.address << ":"
+         << boundStreamPort << endl;
+}
+
+void ExchangeSimulator::stop() {
+    if (!running.exchange(false)) return;
+
+    // Closing everything lets run() drain and return on its own.
+    boost::asio::post(ioc, [this]() {
+        boost::system::error_code ec;
+        restAcceptor.close(ec);
+        streamAcceptor.close(ec);
+        tickTimer.cancel();
+        frameTimer.cancel();
+        for (auto& weak : sessions) {
+            if (auto session = weak.lock()) session->close();
+        }
+        sessions.clear();
+    });
+    work.reset();
+    if (ioThread.joinable()) ioThread.join();
+}
+
+MatchingEngineStats ExchangeSimulator::engineStats() {
+    if (!ioThread.joinable()) return engine.stats();
+    std::promise<MatchingEngineStats> result;
+    boost::asio::post(ioc, [this, &result]() { result.set_value(engine.stats()); });
+    return result.get_future().get();
+}
+
+void ExchangeSimulator::acceptRest() {
+    restAcceptor.async_accept([this](boost::system::error_code ec, tcp::socket socket) {
+        if (ec) return;
+        socket.set_option(tcp::no_delay(true));
+        if (cfg.tls) {
+            auto session = std::make_shared<HttpSession<tls_stream>>(*this, tls_stream(std::move(socket), tlsContext));
+            track(session);
+            session->run();
+        } else {
+            auto session = std::make_shared<HttpSession<plain_stream>>(*this, plain_stream(std::move(socket)));
+            track(session);
+            session->run();
+        }
+        acceptRest();
+    });
+}
+
+void ExchangeSimulator::acceptStream() {
+    streamAcceptor.async_accept([this](boost::system::error_code ec, tcp::socket socket) {
+        if (ec) return;
+        socket.set_option(tcp::no_delay(true));
+        if (cfg.tls) {
+            auto session = std::make_shared<StreamSession<tls_stream>>(*this, tls_stream(std::move(socket), tlsContext));
+            track(session);
+            session->run();
+        } else {
+            auto session = std::make_shared<StreamSession<plain_stream>>(*this, plain_stream(std::move(socket)));
+            track(session);
+            session->run();
+        }
+        acceptStream();
+    });
+}
+
+void ExchangeSimulator::track(const std::shared_ptr<Session>& session) {
+    sessions.erase(std::remove_if(sessions.begin(), sessions.end(),
+                                  [](const std::weak_ptr<Session>& s) { return s.expired(); }),
+                   sessions.end());
+    sessions.push_back(session);
+}
+
+std::chrono::microseconds ExchangeSimulator::sample(const LatencyModel& model) {
+    if (model.jitter.count() <= 0) return model.base;
+    std::uniform_int_distribution<int64_t> extra(0, model.jitter.count());
+    return model.base + std::chrono::microseconds(extra(rng));
+}
+
+bool ExchangeSimulator::checkCredentials(const string& key, const string& secret) const {
+    return cfg.apiKey.empty() || (key == cfg.apiKey && secret == cfg.apiSecret);
+}
+
+const ExchangeSimulator::SymbolState* ExchangeSimulator::resolveSymbol(const string& symbol) const {
+    auto it = symbolIndex.find(symbol);
+    return it == symbolIndex.end() ? nullptr : &symbols[it->second];
+}
+
+void ExchangeSimulator::handleRequest(const request_type& req, response_type& res) {
+    res.version(req.version());
+    res.keep_alive(req.keep_alive());
+    res.set(http::field::server, "hft-exchange-simulator");
+    res.set(http::field::content_type, "application/json");
+    res.result(http::status::ok);
+
+    const string key(req["APCA-API-KEY-ID"]);
+    const string secret(req["APCA-API-SECRET-KEY"]);
+    const string target(req.target());
+    const string orderPrefix = "/v2/orders/";
+    const string byClientIdTarget = "/v2/orders:by_client_order_id";
+    const string barsTarget = "/v1beta3/crypto/us/bars";
+
+    if (!checkCredentials(key, secret)) {
+        res.result(http::status::unauthorized);
+        res.body() = errorBody(40110000, "request is not authorized");
+    } else if (target == "/v2/clock" && req.method() == http::verb::get) {
+        const string now = FeedDecoder::formatTimestamp(nowNs());
+        res.body() = json{{"timestamp", now}, {"is_open", true}, {"next_open", now}, {"next_close", now}}.dump();
+    } else if (target == "/v2/orders" && req.method() == http::verb::post) {
+        handleOrder(req, res);
+    } else if (target.compare(0, barsTarget.size() + 1, barsTarget + "?") == 0 && req.method() == http::verb::get) {
+        handleBars(target.substr(barsTarget.size() + 1), res);
+    } else if (target.compare(0, byClientIdTarget.size() + 1, byClientIdTarget + "?") == 0 &&
+               req.method() == http::verb::get) {
+        const auto params = parseQuery(std::string_view(target).substr(byClientIdTarget.size() + 1));
+        const auto param = params.find("client_order_id");
+        const auto known = param == params.end() ? clientOrders.end() : clientOrders.find(param->second);
+        const SimOrder* order = known == clientOrders.end() ? nullptr : engine.find(known->second);
+        if (!order) {
+            res.result(http::status::not_found);
+            res.body() = errorBody(40410000, "order not found");
+        } else {
+            res.body() = orderJson(*order);
+        }
+    } else if (target.compare(0, orderPrefix.size(), orderPrefix) == 0) {
+        uint64_t id = 0;
+        try {
+            id = std::stoull(target.substr(orderPrefix.size()));
+        } catch (const std::exception&) {
+        }
+        const SimOrder* order = id ? engine.find(id) : nullptr;
+        if (!order || order->owner == 0) {
+            res.result(http::status::not_found);
+            res.body() = errorBody(40410000, "order not found");
+        } else if (req.method() == http::verb::get) {
+            res.body() = orderJson(*order);
+        } else if (req.method() == http::verb::delete_) {
+            if (engine.cancel(id)) {
+                res.result(http::status::no_content);
+                res.body().clear();
+                publishTradeUpdate("canceled", *order, 0, 0);
+            } else {
+                res.result(http::status::unprocessable_entity);
+                res.body() = errorBody(42210000, "order is not cancelable");
+            }
+        } else {
+            res.result(http::status::method_not_allowed);
+            res.body() = errorBody(40510000, "method not allowed");
+        }
+    } else {
+        res.result(http::status::not_found);
+        res.body() = errorBody(40410000, "endpoint not found");
+    }
+    res.prepare_payload();
+}
+
+void ExchangeSimulator::handleBars(const string& query, response_type& res) {
+    auto params = parseQuery(query);
+    int64_t startNs = 0;
+    int64_t endNs = INT64_MAX;
+    if ((!params["start"].empty() && !FeedDecoder::parseTimestamp(params["start"], startNs)) ||
+        (!params["end"].empty() && !FeedDecoder::parseTimestamp(params["end"], endNs))) {
+        res.result(http::status::bad_request);
+        res.body() = errorBody(40010001, "invalid start or end");
+        return;
+    }
+    size_t limit = 1000;
+    try {
+        if (!params["limit"].empty()) limit = std::clamp<size_t>(std::stoul(params["limit"]), 1, 10000);
+        if (!params["page_token"].empty()) startNs = std::max<int64_t>(startNs, std::stoll(params["page_token"]));
+    } catch (const std::exception&) {
+        res.result(http::status::bad_request);
+        res.body() = errorBody(40010001, "invalid limit or page_token");
+        return;
+    }
+
+    // The timeframe is whatever the stream emits.
+    const SymbolTable& table = SymbolTable::get_instance();
+    json bars = json::object();
+    json nextPageToken = nullptr;
+    size_t count = 0;
+    std::string_view symbols = params["symbols"];
+    while (!symbols.empty()) {
+        const size_t comma = symbols.find(',');
+        const string symbol(symbols.substr(0, comma));
+        symbols.remove_prefix(comma == std::string_view::npos ? symbols.size() : comma + 1);
+
+        const uint32_t id = table.find(symbol);
+        auto history = barHistory.find(id);
+        if (id == SymbolTable::INVALID_ID || history == barHistory.end()) continue;
+
+        json& out = bars[symbol] = json::array();
+        const uint8_t pd = table.priceDecimals(id);
+        const uint8_t sd = table.sizeDecimals(id);
+        for (const CompactBar& bar : history->second) {
+            if (bar.timestampNs < startNs || bar.timestampNs > endNs) continue;
+            if (count == limit) {
+                nextPageToken = std::to_string(bar.timestampNs);
+                break;
+            }
+            out.push_back({{"t", FeedDecoder::formatTimestamp(bar.timestampNs)},
+                           {"o", fixed_point::toDouble(bar.open, pd)},
+                           {"h", fixed_point::toDouble(bar.high, pd)},
+                           {"l", fixed_point::toDouble(bar.low, pd)},
+                           {"c", fixed_point::toDouble(bar.close, pd)},
+                           {"v", fixed_point::toDouble(bar.volume, sd)},
+                           {"n", bar.tradeCount},
+                           {"vw", fixed_point::toDouble(bar.vwap, pd)}});
+            ++count;
+        }
+        if (!nextPageToken.is_null()) break;
+    }
+    res.body() = json{{"bars", bars}, {"next_page_token", nextPageToken}}.dump();
+}
+
+void ExchangeSimulator::recordBar(const CompactBar& bar) {
+    std::deque<CompactBar>& history = barHistory[bar.symbolId];
+    history.push_back(bar);
+    if (history.size() > cfg.barHistory) history.pop_front();
+}
+
+void ExchangeSimulator::handleOrder(const request_type& req, response_type& res) {
+    auto reject = [&res](const string& message) {
+        res.result(http::status::unprocessable_entity);
+        res.body() = errorBody(42210000, message);
+    };
+
+    json body = json::parse(req.body(), nullptr, false);
+    if (body.is_discarded() || !body.is_object()) return reject("invalid order body");
+
+    const SymbolState* symbol = resolveSymbol(body.value("symbol", ""));
+    if (!symbol) return reject("asset not found");
+
+    const SymbolTable& table = SymbolTable::get_instance();
+    SimOrder order;
+    order.owner = 1;
+    order.symbolId = symbol->id;
+    order.clientOrderId = body.value("client_order_id", "");
+    order.createdNs = nowNs();
+
+    const string side = body.value("side", "");
+    if (side == "buy") order.side = OrderSide::Buy;
+    else if (side == "sell") order.side = OrderSide::Sell;
+    else return reject("side must be buy or sell");
+
+    const string type = body.value("type", "");
+    if (type == "market") order.type = OrderType::Market;
+    else if (type == "limit") order.type = OrderType::Limit;
+    else return reject("unsupported order type");
+
+    const string timeInForce = body.value("time_in_force", "");
+    if (timeInForce == "gtc") order.timeInForce = TimeInForce::Gtc;
+    else if (timeInForce == "ioc") order.timeInForce = TimeInForce::Ioc;
+    else if (timeInForce == "day") order.timeInForce = TimeInForce::Day;
+    else return reject("unsupported time_in_force");
+
+    if (!body.contains("qty") || !parseQuantity(body["qty"], table.sizeDecimals(symbol->id), order.quantity) ||
+        order.quantity <= 0) {
+        return reject("qty must be a positive number");
+    }
+    if (order.type == OrderType::Limit &&
+        (!body.contains("limit_price") ||
+         !parseQuantity(body["limit_price"], table.priceDecimals(symbol->id), order.limitPrice) ||
+         order.limitPrice <= 0)) {
+        return reject("limit_price is required for limit orders");
+    }
+
+    fills.clear();
+    const SimOrder& placed = engine.submit(std::move(order), fills);
+    if (placed.status == SimOrderStatus::Rejected) return reject("order rejected");
+    res.body() = orderJson(placed);
+    if (!placed.clientOrderId.empty()) clientOrders[placed.clientOrderId] = placed.id;
+
+    const uint64_t placedId = placed.id;
+    publishTradeUpdate("new", placed, 0, 0);
+    publishTradeUpdates();
+    // Market and IOC remainders are canceled as part of the submit.
+    const SimOrder* after = engine.find(placedId);
+    if (after && after->status == SimOrderStatus::Canceled) publishTradeUpdate("canceled", *after, 0, 0);
+}
+
+void ExchangeSimulator::publishTradeUpdates() {
+    // One update per client order per batch of fills, at the batch's
+    // average price, so the cumulative filled_qty always matches.
+    std::vector<std::pair<uint64_t, std::pair<int64_t, double>>> touched;
+    for (const SimFill& fill : fills) {
+        for (uint64_t id : {fill.takerId, fill.makerId}) {
+            const SimOrder* order = engine.find(id);
+            if (!order || order->owner == 0) continue;
+            auto it = std::find_if(touched.begin(), touched.end(), [id](const auto& entry) { return entry.first == id; });
+            if (it == touched.end()) it = touched.insert(touched.end(), {id, {0, 0.0}});
+            it->second.first += fill.quantity;
+            it->second.second += static_cast<double>(fill.price) * static_cast<double>(fill.quantity);
+        }
+    }
+    for (const auto& entry : touched) {
+        const SimOrder& order = *engine.find(entry.first);
+        const int64_t price = std::llround(entry.second.second / static_cast<double>(entry.second.first));
+        publishTradeUpdate(order.remaining() == 0 ? "fill" : "partial_fill", order, price, entry.second.first);
+    }
+}
+
+void ExchangeSimulator::publishTradeUpdate(const char* event, const SimOrder& order, int64_t price, int64_t quantity) {
+    const SymbolTable& table = SymbolTable::get_instance();
+    json data = {
+        {"event", event},
+        {"timestamp", FeedDecoder::formatTimestamp(nowNs())},
+        {"order", json::parse(orderJson(order))}
+    };
+    if (quantity) {
+        data["price"] = fixedText(price, table.priceDecimals(order.symbolId));
+        data["qty"] = fixedText(quantity, table.sizeDecimals(order.symbolId));
+    }
+    publish(TRADE_UPDATES, string(), json{{"stream", TRADE_UPDATES}, {"data", std::move(data)}}.dump());
+}
+
+string ExchangeSimulator::orderJson(const SimOrder& order) const {
+    const SymbolTable& table = SymbolTable::get_instance();
+    const uint8_t priceDecimals = table.priceDecimals(order.symbolId);
+    const uint8_t sizeDecimals = table.sizeDecimals(order.symbolId);
+
+    json body = {
+        {"id", std::to_string(order.id)},
+        {"client_order_id", order.clientOrderId},
+        {"created_at", FeedDecoder::formatTimestamp(order.createdNs)},
+        {"symbol", string(table.name(order.symbolId))},
+        {"qty", fixedText(order.quantity, sizeDecimals)},
+        {"filled_qty", fixedText(order.filledQuantity, sizeDecimals)},
+        {"filled_avg_price", nullptr},
+        {"side", order.side == OrderSide::Buy ? "buy" : "sell"},
+        {"type", order.type == OrderType::Limit ? "limit" : "market"},
+        {"time_in_force", order.timeInForce == TimeInForce::Ioc ? "ioc" : order.timeInForce == TimeInForce::Day ? "day" : "gtc"},
+        {"limit_price", nullptr},
+        {"status", toString(order.status)}
+    };
+    if (order.filledQuantity) {
+        body["filled_avg_price"] = fixedText(std::llround(order.averagePrice()), priceDecimals);
+    }
+    if (order.type == OrderType::Limit) {
+        body["limit_price"] = fixedText(order.limitPrice, priceDecimals);
+    }
+    return body.dump();
+}
+
+void ExchangeSimulator::attach(const std::shared_ptr<Subscriber>& subscriber) {
+    subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(),
+                                     [](const std::weak_ptr<Subscriber>& s) { return s.expired(); }),
+                      subscribers.end());
+    subscribers.push_back(subscriber);
+}
+
+void ExchangeSimulator::scheduleTick() {
+    tickTimer.expires_after(cfg.tickInterval);
+    tickTimer.async_wait([this](boost::system::error_code ec) {
+        if (ec || !running) return;
+        tick();
+        scheduleTick();
+    });
+}
+
+void ExchangeSimulator::tick() {
+    ++ticks;
+    fills.clear();
+    if (replay.is_open()) {
+        replayTick();
+    } else {
+        syntheticTick();
+    }
+    // Requotes that traded through resting client orders.
+    publishTradeUpdates();
+}
+
+void ExchangeSimulator::syntheticTick() {
+    const SymbolTable& table = SymbolTable::get_instance();
+    std::normal_distribution<double> move(0.0, cfg.volatilityBps / 10000.0);
+    std::uniform_int_distribution<int> coin(0, 1);
+    std::uniform_real_distribution<double> tradeSize(0.001, cfg.quoteSize / 10.0);
+    const int64_t ts = nowNs();
+    const string timestamp = FeedDecoder::formatTimestamp(ts);
+
+    for (SymbolState& s : symbols) {
+        const uint8_t pd = table.priceDecimals(s.id);
+        const uint8_t sd = table.sizeDecimals(s.id);
+
+        s.price *= 1.0 + move(rng);
+        const double half = s.price * cfg.halfSpreadBps / 10000.0;
+        const int64_t bid = fixed_point::fromDouble(s.price - half, pd);
+        const int64_t ask = fixed_point::fromDouble(s.price + half, pd);
+        const int64_t size = fixed_point::fromDouble(cfg.quoteSize, sd);
+        engine.requote(s.id, bid, size, ask, size, ts, fills);
+
+        publish("quotes", s.name, "[{\"T\":\"q\",\"S\":\"" + s.name + "\",\"bp\":" + fixedText(bid, pd) +
+                                  ",\"bs\":" + fixedText(size, sd) + ",\"ap\":" + fixedText(ask, pd) +
+                                  ",\"as\":" + fixedText(size, sd) + ",\"t\":\"" + timestamp + "\"}]");
+        publish("orderbooks", s.name, "[{\"T\":\"o\",\"S\":\"" + s.name + "\",\"t\":\"" + timestamp +
+                                      "\",\"b\":[{\"p\":" + fixedText(bid, pd) + ",\"s\":" + fixedText(size, sd) +
+                                      "}],\"a\":[{\"p\":" + fixedText(ask, pd) + ",\"s\":" + fixedText(size, sd) +
+                                      "}],\"r\":true}]");
+
+        const bool buy = coin(rng) == 1;
+        const double qty = tradeSize(rng);
+        const double price = buy ? fixed_point::toDouble(ask, pd) : fixed_point::toDouble(bid, pd);
+        publish("trades", s.name, "[{\"T\":\"t\",\"S\":\"" + s.name + "\",\"p\":" +
+                                  fixedText(fixed_point::fromDouble(price, pd), pd) + ",\"s\":" +
+                                  fixedText(fixed_point::fromDouble(qty, sd), sd) + ",\"t\":\"" + timestamp +
+                                  "\",\"i\":" + std::to_string(++tradeIds) + ",\"tks\":\"" + (buy ? "B" : "S") + "\"}]");
+
+        if (s.barTrades == 0) {
+            s.barOpen = s.barHigh = s.barLow = price;
+        }
+        s.barHigh = std::max(s.barHigh, price);
+        s.barLow = std::min(s.barLow, price);
+        s.barNotional += price * qty;
+        s.barVolume += qty;
+        ++s.barTrades;
+
+        if (cfg.barTicks && ticks % cfg.barTicks == 0) {
+            CompactBar bar{};
+            bar.symbolId = s.id;
+            bar.timestampNs = ts;
+            bar.open = fixed_point::fromDouble(s.barOpen, pd);
+            bar.high = fixed_point::fromDouble(s.barHigh, pd);
+            bar.low = fixed_point::fromDouble(s.barLow, pd);
+            bar.close = fixed_point::fromDouble(price, pd);
+            bar.volume = fixed_point::fromDouble(s.barVolume, sd);
+            bar.vwap = fixed_point::fromDouble(s.barNotional / s.barVolume, pd);
+            bar.tradeCount = s.barTrades;
+            recordBar(bar);
+
+            publish("bars", s.name, "[{\"T\":\"b\",\"S\":\"" + s.name + "\",\"o\":" + fixedText(bar.open, pd) +
+                                    ",\"h\":" + fixedText(bar.high, pd) + ",\"l\":" + fixedText(bar.low, pd) +
+                                    ",\"c\":" + fixedText(bar.close, pd) + ",\"v\":" + fixedText(bar.volume, sd) +
+                                    ",\"t\":\"" + timestamp + "\",\"n\":" + std::to_string(bar.tradeCount) +
+                                    ",\"vw\":" + fixedText(bar.vwap, pd) + "}]");
+            s.barTrades = 0;
+            s.barNotional = s.barVolume = 0;
+        }
+    }
+}
+
+void ExchangeSimulator::replayTick() {
+    string line;
+    if (!std::getline(replay, line)) {
+        // Loop the recording.
+        replay.clear();
+        replay.seekg(0);
+        if (!std::getline(replay, line)) return;
+    }
+    if (line.empty()) return;
+
+    // Keep the liquidity provider on the recorded market.
+    FeedDecoder decoder;
+    DecodedBatch batch(16);
+    if (decoder.decode(line, batch) == DecodeStatus::Ok) {
+        const SymbolTable& table = SymbolTable::get_instance();
+        for (const QuoteRecord& q : batch.quotes) {
+            engine.requote(q.symbolId, q.bidPrice, q.bidSize, q.askPrice, q.askSize, q.timestampNs, fills);
+        }
+        for (const CompactBar& bar : batch.bars) {
+            recordBar(bar);
+            const int64_t half = static_cast<int64_t>(static_cast<double>(bar.close) * cfg.halfSpreadBps / 10000.0);
+            const int64_t size = fixed_point::fromDouble(cfg.quoteSize, table.sizeDecimals(bar.symbolId));
+            engine.requote(bar.symbolId, bar.close - half, size, bar.close + half, size, bar.timestampNs, fills);
+        }
+    }
+    publish(nullptr, string(), std::move(line));
+}
+
+void ExchangeSimulator::publish(const char* channel, const string& symbol, string frame) {
+    auto shared = std::make_shared<const string>(std::move(frame));
+    const auto delay = sample(cfg.marketDataLatency);
+
+    if (delay.count() == 0 && frames.empty()) {
+        for (auto& weak : subscribers) {
+            if (auto subscriber = weak.lock()) subscriber->deliver(channel, symbol, shared);
+        }
+        return;
+    }
+
+    // Never let jitter reorder frames.
+    const auto due = std::max(std::chrono::steady_clock::now() + delay, lastDue);
+    lastDue = due;
+    frames.push_back(PendingFrame{due, channel, symbol, shared});
+    if (frames.size() == 1) {
+        frameTimer.expires_at(due);
+        frameTimer.async_wait([this](boost::system::error_code ec) {
+            if (!ec) flushFrames();
+        });
+    }
+}
+
+void ExchangeSimulator::flushFrames() {
+    const auto now = std::chrono::steady_clock::now();
+    while (!frames.empty() && frames.front().due <= now) {
+        PendingFrame& pending = frames.front();
+        for (auto& weak : subscribers) {
+            if (auto subscriber = weak.lock()) subscriber->deliver(pending.channel, pending.symbol, pending.frame);
+        }
+        frames.pop_front();
+    }
+    if (!frames.empty()) {
+        frameTimer.expires_at(frames.front().due);
+        frameTimer.async_wait([this](boost::system::error_code ec) {
+            if (!ec) flushFrames();
+        });
+    }
+}
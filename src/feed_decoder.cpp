@@ -0,0 +1,468 @@
+#include "feed_decoder.h"
+
+#include <charconv>
+#include <cstdio>
+
+#include "fixed_point.h"
+
+namespace {
+    struct Cursor {
+        const char* p;
+        const char* end;
+    };
+
+    inline void skipWhitespace(Cursor& c) {
+        while (c.p < c.end && (*c.p == ' ' || *c.p == '\n' || *c.p == '\r' || *c.p == '\t')) {
+            ++c.p;
+        }
+    }
+
+    inline bool consume(Cursor& c, char ch) {
+        skipWhitespace(c);
+        if (c.p < c.end && *c.p == ch) {
+            ++c.p;
+            return true;
+        }
+        return false;
+    }
+
+    // Returns the raw bytes between the quotes; escapes are skipped, not decoded.
+    inline bool readString(Cursor& c, std::string_view& out) {
+        if (!consume(c, '"')) return false;
+        const char* start = c.p;
+        while (c.p < c.end && *c.p != '"') {
+            if (*c.p == '\\') ++c.p;
+            ++c.p;
+        }
+        if (c.p >= c.end) return false;
+        out = std::string_view(start, c.p - start);
+        ++c.p;
+        return true;
+    }
+
+    template <typename T>
+    inline bool readNumber(Cursor& c, T& out) {
+        skipWhitespace(c);
+        auto result = std::from_chars(c.p, c.end, out);
+        if (result.ec != std::errc()) return false;
+        c.p = result.ptr;
+        return true;
+    }
+
+    // Captures the number's text so it can be parsed at the symbol's scale
+    // once the symbol is known; keys are not guaranteed to arrive in order.
+    inline bool readNumberText(Cursor& c, std::string_view& out) {
+        skipWhitespace(c);
+        const char* start = c.p;
+        while (c.p < c.end && ((*c.p >= '0' && *c.p <= '9') || *c.p == '-' || *c.p == '+' ||
+                               *c.p == '.' || *c.p == 'e' || *c.p == 'E')) {
+            ++c.p;
+        }
+        if (c.p == start) return false;
+        out = std::string_view(start, c.p - start);
+        return true;
+    }
+
+    inline bool toFixed(std::string_view text, uint8_t decimals, int64_t& out) {
+        if (text.empty()) {
+            out = 0;
+            return true;
+        }
+        return fixed_point::parse(text, decimals, out);
+    }
+
+    bool skipValue(Cursor& c) {
+        skipWhitespace(c);
+        if (c.p >= c.end) return false;
+
+        if (*c.p == '"') {
+            std::string_view ignored;
+            return readString(c, ignored);
+        }
+
+        if (*c.p == '{' || *c.p == '[') {
+            int depth = 0;
+            while (c.p < c.end) {
+                char ch = *c.p;
+                if (ch == '"') {
+                    std::string_view ignored;
+                    if (!readString(c, ignored)) return false;
+                    continue;
+                }
+                ++c.p;
+                if (ch == '{' || ch == '[') ++depth;
+                else if ((ch == '}' || ch == ']') && --depth == 0) return true;
+            }
+            return false;
+        }
+
+        while (c.p < c.end && *c.p != ',' && *c.p != '}' && *c.p != ']' &&
+               *c.p != ' ' && *c.p != '\n' && *c.p != '\r' && *c.p != '\t') {
+            ++c.p;
+        }
+        return true;
+    }
+
+    // Union of every field the bar, trade, quote and order book messages carry.
+    struct Fields {
+        std::string_view type;
+        std::string_view symbol;
+        std::string_view time;
+        std::string_view takerSide;
+        std::string_view o, h, l, c, v, vw;
+        std::string_view p, s;
+        std::string_view bp, bs, ap, as;
+        // Raw "[...]" of an order book's bid and ask levels.
+        std::string_view bids, asks;
+        bool reset = false;
+        int64_t n = 0;
+        int64_t i = 0;
+    };
+
+    bool readSpan(Cursor& c, std::string_view& out) {
+        skipWhitespace(c);
+        const char* start = c.p;
+        if (!skipValue(c)) return false;
+        out = std::string_view(start, c.p - start);
+        return true;
+    }
+
+    bool readBool(Cursor& c, bool& out) {
+        skipWhitespace(c);
+        std::string_view rest(c.p, c.end - c.p);
+        if (rest.substr(0, 4) == "true") {
+            out = true;
+            c.p += 4;
+            return true;
+        }
+        if (rest.substr(0, 5) == "false") {
+            out = false;
+            c.p += 5;
+            return true;
+        }
+        return false;
+    }
+
+    bool readField(Cursor& c, std::string_view key, Fields& f) {
+        if (key == "b") return readSpan(c, f.bids);
+        if (key == "a") return readSpan(c, f.asks);
+        if (key == "r") return readBool(c, f.reset);
+
+        // Stock trades and quotes reuse "c" for a conditions array.
+        skipWhitespace(c);
+        if (c.p < c.end && (*c.p == '[' || *c.p == '{')) return skipValue(c);
+
+        switch (key.size()) {
+        case 1:
+            switch (key[0]) {
+            case 'T': return readString(c, f.type);
+            case 'S': return readString(c, f.symbol);
+            case 't': return readString(c, f.time);
+            case 'o': return readNumberText(c, f.o);
+            case 'h': return readNumberText(c, f.h);
+            case 'l': return readNumberText(c, f.l);
+            case 'c': return readNumberText(c, f.c);
+            case 'v': return readNumberText(c, f.v);
+            case 'p': return readNumberText(c, f.p);
+            case 's': return readNumberText(c, f.s);
+            case 'n': return readNumber(c, f.n);
+            case 'i': return readNumber(c, f.i);
+            }
+            break;
+        case 2:
+            if (key == "vw") return readNumberText(c, f.vw);
+            if (key == "bp") return readNumberText(c, f.bp);
+            if (key == "bs") return readNumberText(c, f.bs);
+            if (key == "ap") return readNumberText(c, f.ap);
+            if (key == "as") return readNumberText(c, f.as);
+            break;
+        case 3:
+            if (key == "tks") return readString(c, f.takerSide);
+            break;
+        }
+        return skipValue(c);
+    }
+
+    // Appends one BookLevelUpdate per {"p":..,"s":..} entry of a level array.
+    bool readLevels(std::string_view levels, char side, const BookLevelUpdate& proto,
+                    uint8_t priceDecimals, uint8_t sizeDecimals, std::vector<BookLevelUpdate>& out) {
+        if (levels.empty()) return true;
+        Cursor c{levels.data(), levels.data() + levels.size()};
+        if (!consume(c, '[')) return false;
+        if (consume(c, ']')) return true;
+
+        for (;;) {
+            if (!consume(c, '{')) return false;
+            std::string_view price, size;
+            if (!consume(c, '}')) {
+                for (;;) {
+                    std::string_view key;
+                    if (!readString(c, key) || !consume(c, ':')) return false;
+                    bool ok = key == "p" ? readNumberText(c, price)
+                            : key == "s" ? readNumberText(c, size)
+                            : skipValue(c);
+                    if (!ok) return false;
+                    if (consume(c, ',')) continue;
+                    if (consume(c, '}')) break;
+                    return false;
+                }
+            }
+
+            BookLevelUpdate level = proto;
+            level.side = side;
+            if (price.empty() || !toFixed(price, priceDecimals, level.price) || !toFixed(size, sizeDecimals, level.size)) {
+                return false;
+            }
+            out.push_back(level);
+
+            if (consume(c, ',')) continue;
+            if (consume(c, ']')) return true;
+            return false;
+        }
+    }
+
+    int64_t daysFromCivil(int64_t y, unsigned m, unsigned d) {
+        y -= m <= 2;
+        const int64_t era = (y >= 0 ? y : y - 399) / 400;
+        const unsigned yoe = static_cast<unsigned>(y - era * 400);
+        const unsigned doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+        const unsigned doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+        return era * 146097 + static_cast<int64_t>(doe) - 719468;
+    }
+
+    void civilFromDays(int64_t z, int64_t& y, unsigned& m, unsigned& d) {
+        z += 719468;
+        const int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+        const unsigned doe = static_cast<unsigned>(z - era * 146097);
+        const unsigned yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+        const unsigned doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+        const unsigned mp = (5 * doy + 2) / 153;
+        d = doy - (153 * mp + 2) / 5 + 1;
+        m = mp < 10 ? mp + 3 : mp - 9;
+        y = static_cast<int64_t>(yoe) + era * 400 + (m <= 2);
+    }
+
+    inline bool digits(const char* p, int count, int& out) {
+        out = 0;
+        for (int k = 0; k < count; ++k) {
+            if (p[k] < '0' || p[k] > '9') return false;
+            out = out * 10 + (p[k] - '0');
+        }
+        return true;
+    }
+}
+
+bool FeedDecoder::parseTimestamp(std::string_view text, int64_t& epochNs) {
+    if (text.size() < 20) return false;
+
+    const char* p = text.data();
+    int year, month, day, hour, minute, second;
+    if (!digits(p, 4, year) || p[4] != '-' || !digits(p + 5, 2, month) || p[7] != '-' ||
+        !digits(p + 8, 2, day) || (p[10] != 'T' && p[10] != ' ') || !digits(p + 11, 2, hour) ||
+        p[13] != ':' || !digits(p + 14, 2, minute) || p[16] != ':' || !digits(p + 17, 2, second)) {
+        return false;
+    }
+
+    size_t pos = 19;
+    int64_t fraction = 0;
+    if (pos < text.size() && text[pos] == '.') {
+        ++pos;
+        int scale = 0;
+        while (pos < text.size() && text[pos] >= '0' && text[pos] <= '9') {
+            if (scale < 9) {
+                fraction = fraction * 10 + (text[pos] - '0');
+                ++scale;
+            }
+            ++pos;
+        }
+        for (; scale < 9; ++scale) fraction *= 10;
+    }
+
+    int64_t offsetSeconds = 0;
+    if (pos < text.size() && (text[pos] == '+' || text[pos] == '-')) {
+        int offHour, offMinute;
+        if (pos + 6 > text.size() || !digits(p + pos + 1, 2, offHour) || p[pos + 3] != ':' ||
+            !digits(p + pos + 4, 2, offMinute)) {
+            return false;
+        }
+        offsetSeconds = (offHour * 3600 + offMinute * 60) * (text[pos] == '+' ? 1 : -1);
+        pos += 6;
+    } else if (pos < text.size() && text[pos] == 'Z') {
+        ++pos;
+    } else {
+        return false;
+    }
+    if (pos != text.size()) return false;
+
+    int64_t seconds = daysFromCivil(year, month, day) * 86400 + hour * 3600 + minute * 60 + second - offsetSeconds;
+    epochNs = seconds * 1000000000LL + fraction;
+    return true;
+}
+
+std::string FeedDecoder::formatTimestamp(int64_t epochNs) {
+    int64_t seconds = epochNs / 1000000000LL;
+    int64_t fraction = epochNs % 1000000000LL;
+    if (fraction < 0) {
+        fraction += 1000000000LL;
+        --seconds;
+    }
+    int64_t days = seconds / 86400;
+    int64_t secondOfDay = seconds % 86400;
+    if (secondOfDay < 0) {
+        secondOfDay += 86400;
+        --days;
+    }
+
+    int64_t year;
+    unsigned month, day;
+    civilFromDays(days, year, month, day);
+
+    char buffer[40];
+    int length = std::snprintf(buffer, sizeof(buffer), "%04lld-%02u-%02uT%02lld:%02lld:%02lld",
+                               static_cast<long long>(year), month, day,
+                               static_cast<long long>(secondOfDay / 3600),
+                               static_cast<long long>(secondOfDay / 60 % 60),
+                               static_cast<long long>(secondOfDay % 60));
+    if (fraction != 0) {
+        int width = 9;
+        while (fraction % 10 == 0) {
+            fraction /= 10;
+            --width;
+        }
+        length += std::snprintf(buffer + length, sizeof(buffer) - length, ".%0*lld", width, static_cast<long long>(fraction));
+    }
+    buffer[length++] = 'Z';
+    return std::string(buffer, length);
+}
+
+DecodeStatus FeedDecoder::decode(std::string_view frame, DecodedBatch& out) {
+    const size_t barMark = out.bars.size();
+    const size_t updatedBarMark = out.updatedBars.size();
+    const size_t dailyBarMark = out.dailyBars.size();
+    const size_t tradeMark = out.trades.size();
+    const size_t quoteMark = out.quotes.size();
+    const size_t levelMark = out.bookLevels.size();
+    const size_t orderMark = out.order.size();
+
+    auto rollback = [&](DecodeStatus status) {
+        out.bars.resize(barMark);
+        out.updatedBars.resize(updatedBarMark);
+        out.dailyBars.resize(dailyBarMark);
+        out.trades.resize(tradeMark);
+        out.quotes.resize(quoteMark);
+        out.bookLevels.resize(levelMark);
+        out.order.resize(orderMark);
+        return status;
+    };
+
+    Cursor c{frame.data(), frame.data() + frame.size()};
+    bool array = consume(c, '[');
+    if (!array) {
+        skipWhitespace(c);
+        if (c.p >= c.end || *c.p != '{') return DecodeStatus::Malformed;
+    }
+
+    if (array && consume(c, ']')) return DecodeStatus::Ok;
+
+    for (;;) {
+        if (!consume(c, '{')) return rollback(DecodeStatus::Malformed);
+
+        Fields f;
+        if (!consume(c, '}')) {
+            for (;;) {
+                std::string_view key;
+                if (!readString(c, key) || !consume(c, ':')) return rollback(DecodeStatus::Malformed);
+                if (!readField(c, key, f)) return rollback(DecodeStatus::Malformed);
+                if (consume(c, ',')) continue;
+                if (consume(c, '}')) break;
+                return rollback(DecodeStatus::Malformed);
+            }
+        }
+
+        if (f.type.size() != 1 || std::string_view("budtqo").find(f.type[0]) == std::string_view::npos) {
+            return rollback(DecodeStatus::Fallback);
+        }
+
+        // An element without a symbol or a usable timestamp is dropped on
+        // its own; the rest of the frame is still good market data.
+        int64_t timestampNs = 0;
+        if (f.symbol.empty() || !parseTimestamp(f.time, timestampNs)) {
+            ++skippedElements;
+            if (!array) break;
+            if (consume(c, ',')) continue;
+            if (consume(c, ']')) break;
+            return rollback(DecodeStatus::Malformed);
+        }
+
+        uint32_t symbolId = symbols.intern(f.symbol);
+        const uint8_t priceDecimals = symbols.priceDecimals(symbolId);
+        const uint8_t sizeDecimals = symbols.sizeDecimals(symbolId);
+
+        switch (f.type[0]) {
+        case 'b':
+        case 'u':
+        case 'd': {
+            CompactBar bar;
+            bar.timestampNs = timestampNs;
+            bar.symbolId = symbolId;
+            bar.tradeCount = static_cast<uint32_t>(f.n);
+            if (!toFixed(f.o, priceDecimals, bar.open) || !toFixed(f.h, priceDecimals, bar.high) ||
+                !toFixed(f.l, priceDecimals, bar.low) || !toFixed(f.c, priceDecimals, bar.close) ||
+                !toFixed(f.vw, priceDecimals, bar.vwap) || !toFixed(f.v, sizeDecimals, bar.volume)) {
+                return rollback(DecodeStatus::Malformed);
+            }
+            std::vector<CompactBar>& bars = f.type[0] == 'b' ? out.bars
+                                          : f.type[0] == 'u' ? out.updatedBars
+                                          : out.dailyBars;
+            bars.push_back(bar);
+            out.order.push_back(f.type[0] == 'b' ? EventType::Bar
+                                : f.type[0] == 'u' ? EventType::UpdatedBar
+                                : EventType::DailyBar);
+            break;
+        }
+        case 't': {
+            TradeRecord trade{symbolId, f.takerSide.empty() ? '\0' : f.takerSide[0], timestampNs, f.i, 0, 0};
+            if (!toFixed(f.p, priceDecimals, trade.price) || !toFixed(f.s, sizeDecimals, trade.size)) {
+                return rollback(DecodeStatus::Malformed);
+            }
+            out.trades.push_back(trade);
+            out.order.push_back(EventType::Trade);
+            break;
+        }
+        case 'q': {
+            QuoteRecord quote{symbolId, timestampNs, 0, 0, 0, 0};
+            if (!toFixed(f.bp, priceDecimals, quote.bidPrice) || !toFixed(f.bs, sizeDecimals, quote.bidSize) ||
+                !toFixed(f.ap, priceDecimals, quote.askPrice) || !toFixed(f.as, sizeDecimals, quote.askSize)) {
+                return rollback(DecodeStatus::Malformed);
+            }
+            out.quotes.push_back(quote);
+            out.order.push_back(EventType::Quote);
+            break;
+        }
+        case 'o': {
+            const size_t first = out.bookLevels.size();
+            BookLevelUpdate proto{symbolId, '\0', 0, timestampNs, 0, 0};
+            if (!readLevels(f.bids, 'b', proto, priceDecimals, sizeDecimals, out.bookLevels) ||
+                !readLevels(f.asks, 'a', proto, priceDecimals, sizeDecimals, out.bookLevels)) {
+                return rollback(DecodeStatus::Malformed);
+            }
+            if (out.bookLevels.size() == first) {
+                out.bookLevels.push_back(proto);
+            }
+            if (f.reset) out.bookLevels[first].flags |= BookLevelUpdate::BOOK_RESET;
+            out.bookLevels.back().flags |= BookLevelUpdate::BOOK_END;
+            out.order.insert(out.order.end(), out.bookLevels.size() - first, EventType::BookLevel);
+            break;
+        }
+        }
+
+        if (!array) break;
+        if (consume(c, ',')) continue;
+        if (consume(c, ']')) break;
+        return rollback(DecodeStatus::Malformed);
+    }
+
+    skipWhitespace(c);
+    if (c.p != c.end) return rollback(DecodeStatus::Malformed);
+    return DecodeStatus::Ok;
+}
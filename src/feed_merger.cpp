@@ -0,0 +1,155 @@
+#include "feed_merger.h"
+
+#include <algorithm>
+
+#include "thread_util.h"
+
+FeedMerger::FeedMerger(size_t feeds, const FeedMergerConfig& config, sink_type sink)
+    : cfg(config), sink(std::move(sink)), lanes(feeds), input(config.waitPolicy) {
+    for (Lane& lane : lanes) {
+        lane.ring = std::make_unique<SpscRing<MarketEvent>>(cfg.ringCapacity, cfg.waitPolicy);
+    }
+    released.reserve(std::max<size_t>(cfg.batchSize, 1));
+}
+
+FeedMerger::~FeedMerger() {
+    stop();
+}
+
+void FeedMerger::start() {
+    if (worker.joinable()) return;
+    stopping = false;
+    worker = std::thread(&FeedMerger::run, this);
+}
+
+void FeedMerger::stop() {
+    stopping.store(true, std::memory_order_release);
+    input.notify();
+    if (worker.joinable()) worker.join();
+    for (Lane& lane : lanes) {
+        lane.ring->close();
+    }
+    runTasks();
+}
+
+bool FeedMerger::push(size_t feed, const MarketEvent& event) {
+    if (!lanes[feed].ring->push(event)) return false;
+    input.notify();
+    return true;
+}
+
+void FeedMerger::post(std::function<void()> task) {
+    if (!worker.joinable()) {
+        task();
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(taskMutex);
+        tasks.push_back(std::move(task));
+        hasTasks.store(true, std::memory_order_release);
+    }
+    input.notify();
+}
+
+FeedMergerStats FeedMerger::stats() const {
+    FeedMergerStats out;
+    out.merged = merged.load(std::memory_order_relaxed);
+    out.outOfOrder = outOfOrder.load(std::memory_order_relaxed);
+    for (const Lane& lane : lanes) {
+        const RingStats ring = lane.ring->stats();
+        out.rings.pushed += ring.pushed;
+        out.rings.popped += ring.popped;
+        out.rings.drops += ring.drops;
+        out.rings.backpressureWaits += ring.backpressureWaits;
+    }
+    return out;
+}
+
+void FeedMerger::runTasks() {
+    if (!hasTasks.load(std::memory_order_acquire)) return;
+    // Tasks run between events, so what was released goes out first.
+    flush();
+    std::vector<std::function<void()>> ready;
+    {
+        std::lock_guard<std::mutex> lock(taskMutex);
+        ready.swap(tasks);
+        hasTasks.store(false, std::memory_order_relaxed);
+    }
+    for (auto& task : ready) task();
+}
+
+void FeedMerger::flush() {
+    if (released.empty()) return;
+    sink(EventSpan(released.data(), released.size()));
+    merged.fetch_add(released.size(), std::memory_order_relaxed);
+    released.clear();
+}
+
+bool FeedMerger::pendingInput(bool orStopping) const {
+    if (orStopping && stopping.load(std::memory_order_acquire)) return true;
+    if (hasTasks.load(std::memory_order_acquire)) return true;
+    for (const Lane& lane : lanes) {
+        if (!lane.hasHead && lane.ring->size() != 0) return true;
+    }
+    return false;
+}
+
+void FeedMerger::run() {
+    placeThisThread("merger", cfg.thread);
+    const auto startedAt = std::chrono::steady_clock::now();
+    for (Lane& lane : lanes) {
+        lane.lastArrival = startedAt;
+    }
+    for (;;) {
+        runTasks();
+
+        const auto now = std::chrono::steady_clock::now();
+        Lane* oldest = nullptr;
+        auto firstHeld = now;
+        for (Lane& lane : lanes) {
+            if (!lane.hasHead && lane.ring->tryPop(lane.head)) {
+                lane.hasHead = true;
+                lane.heldSince = now;
+                lane.lastArrival = now;
+            }
+            if (!lane.hasHead) continue;
+            if (!oldest || lane.head.timestampNs() < oldest->head.timestampNs()) oldest = &lane;
+            if (lane.heldSince < firstHeld) firstHeld = lane.heldSince;
+        }
+
+        if (!oldest) {
+            // Nothing is held and nothing queued is left to release.
+            flush();
+            if (stopping.load(std::memory_order_acquire) && !pendingInput(false)) return;
+            input.waitUntil([this]() { return pendingInput(true); });
+            continue;
+        }
+
+        // An empty feed that sent something within maxHold may still deliver
+        // something older; one idle for longer is taken to have nothing.
+        if (!stopping.load(std::memory_order_relaxed)) {
+            auto releaseAt = now;
+            for (const Lane& lane : lanes) {
+                if (lane.hasHead) continue;
+                const auto quietUntil = lane.lastArrival + cfg.maxHold;
+                if (quietUntil > releaseAt) releaseAt = quietUntil;
+            }
+            if (firstHeld + cfg.maxHold < releaseAt) releaseAt = firstHeld + cfg.maxHold;
+            if (now < releaseAt) {
+                flush();
+                input.waitUntil([this]() { return pendingInput(true); }, releaseAt);
+                continue;
+            }
+        }
+
+        const int64_t timestampNs = oldest->head.timestampNs();
+        if (timestampNs < lastReleasedNs) {
+            outOfOrder.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            lastReleasedNs = timestampNs;
+        }
+        oldest->hasHead = false;
+        released.push_back(oldest->head);
+        if (released.size() >= cfg.batchSize) flush();
+    }
+}
@@ -0,0 +1,282 @@
+#include "feed_session.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+#include <nlohmann/json.hpp>
+
+#include "bar.h"
+#include "bar_store.h"
+#include "feed_decoder.h"
+#include "logger.h"
+#include "session_pool.h"
+#include "symbol_table.h"
+
+using json = nlohmann::json;
+namespace http = boost::beast::http;
+
+namespace {
+    string urlEncode(std::string_view text) {
+        static const char HEX[] = "0123456789ABCDEF";
+        string out;
+        out.reserve(text.size());
+        for (unsigned char ch : text) {
+            if (std::isalnum(ch) || ch == '-' || ch == '_' || ch == '.' || ch == '~' || ch == ':') {
+                out += static_cast<char>(ch);
+            } else {
+                out += '%';
+                out += HEX[ch >> 4];
+                out += HEX[ch & 15];
+            }
+        }
+        return out;
+    }
+}
+
+Backoff::Backoff(const FeedSessionConfig& config)
+    : initial(config.backoffInitial),
+      max(config.backoffMax),
+      multiplier(config.backoffMultiplier),
+      rng(std::random_device{}()) {}
+
+std::chrono::milliseconds Backoff::next() {
+    const double window = std::min(static_cast<double>(max.count()),
+                                   static_cast<double>(initial.count()) * std::pow(multiplier, attempt));
+    if (attempt < 64) ++attempt;
+    std::uniform_real_distribution<double> jitter(window / 2, window);
+    return std::chrono::milliseconds(static_cast<int64_t>(jitter(rng)));
+}
+
+void SubscriptionSet::add(const string& channel, const std::vector<string>& symbols) {
+    std::lock_guard<std::mutex> lock(mutex);
+    channels[channel].insert(symbols.begin(), symbols.end());
+}
+
+void SubscriptionSet::remove(const string& channel, const std::vector<string>& symbols) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = channels.find(channel);
+    if (it == channels.end()) return;
+    for (const auto& symbol : symbols) it->second.erase(symbol);
+    if (it->second.empty()) channels.erase(it);
+}
+
+std::vector<string> SubscriptionSet::symbols(const string& channel) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = channels.find(channel);
+    if (it == channels.end()) return {};
+    return std::vector<string>(it->second.begin(), it->second.end());
+}
+
+bool SubscriptionSet::empty() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return channels.empty();
+}
+
+string SubscriptionSet::subscribeMessage() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (channels.empty()) return string();
+    json message;
+    message["action"] = "subscribe";
+    for (const auto& [channel, symbols] : channels) {
+        message[channel] = symbols;
+    }
+    return message.dump();
+}
+
+GapDetector::GapDetector(std::chrono::nanoseconds interval, size_t maxHeld)
+    : intervalNs(interval.count()), maxHeld(maxHeld) {}
+
+bool GapDetector::onBar(const CompactBar& bar, std::vector<CompactBar>& out, BarGap& gap) {
+    SymbolGap& symbol = symbols[bar.symbolId];
+    if (symbol.lastNs != 0 && bar.timestampNs <= symbol.lastNs) {
+        duplicates.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    if (symbol.pending) {
+        symbol.lastNs = bar.timestampNs;
+        symbol.held.push_back(bar);
+        if (symbol.held.size() < maxHeld) return false;
+
+        // The backfill is taking too long; its bars would now arrive out of
+        // order, so complete() will ignore them.
+        abandoned.fetch_add(1, std::memory_order_relaxed);
+        symbol.pending = false;
+        std::move(symbol.held.begin(), symbol.held.end(), std::back_inserter(out));
+        symbol.held.clear();
+        return false;
+    }
+
+    // Bars sit on interval boundaries; half an interval of slack keeps a
+    // slightly late stamp from counting as a gap.
+    const bool opens = symbol.lastNs != 0 && bar.timestampNs - symbol.lastNs > intervalNs + intervalNs / 2;
+    if (!opens) {
+        symbol.lastNs = bar.timestampNs;
+        out.push_back(bar);
+        return false;
+    }
+
+    gap.symbolId = bar.symbolId;
+    gap.afterNs = symbol.lastNs;
+    gap.beforeNs = bar.timestampNs;
+    gap.intervalNs = intervalNs;
+    gaps.fetch_add(1, std::memory_order_relaxed);
+    missing.fetch_add(gap.missing(), std::memory_order_relaxed);
+
+    symbol.pending = true;
+    symbol.gap = gap;
+    symbol.lastNs = bar.timestampNs;
+    symbol.held.push_back(bar);
+    return true;
+}
+
+void GapDetector::complete(const BarGap& gap, std::vector<CompactBar> bars, std::vector<CompactBar>& out) {
+    auto it = symbols.find(gap.symbolId);
+    if (it == symbols.end() || !it->second.pending || it->second.gap.afterNs != gap.afterNs) return;
+    SymbolGap& symbol = it->second;
+
+    std::sort(bars.begin(), bars.end(),
+              [](const CompactBar& a, const CompactBar& b) { return a.timestampNs < b.timestampNs; });
+    int64_t previous = gap.afterNs;
+    for (const CompactBar& bar : bars) {
+        if (bar.timestampNs <= previous || bar.timestampNs >= gap.beforeNs) continue;
+        out.push_back(bar);
+        previous = bar.timestampNs;
+        filled.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::move(symbol.held.begin(), symbol.held.end(), std::back_inserter(out));
+    symbol.held.clear();
+    symbol.pending = false;
+}
+
+bool GapDetector::pending(uint32_t symbolId) const {
+    auto it = symbols.find(symbolId);
+    return it != symbols.end() && it->second.pending;
+}
+
+void GapDetector::stats(FeedSessionStats& out) const {
+    out.gaps = gaps.load(std::memory_order_relaxed);
+    out.missingBars = missing.load(std::memory_order_relaxed);
+    out.backfilledBars = filled.load(std::memory_order_relaxed);
+    out.duplicateBars = duplicates.load(std::memory_order_relaxed);
+    out.abandonedGaps = abandoned.load(std::memory_order_relaxed);
+}
+
+BarBackfill::BarBackfill(const FeedSessionConfig& config, const string& apiKey, const string& apiSecretKey)
+    : cfg(config), ALPACA_API_KEY(apiKey), ALPACA_API_SECRET_KEY(apiSecretKey) {}
+
+BarBackfill::~BarBackfill() {
+    stop();
+}
+
+void BarBackfill::start(Callback callback) {
+    if (worker.joinable()) return;
+    done = std::move(callback);
+    stopping = false;
+    worker = std::thread(&BarBackfill::run, this);
+}
+
+void BarBackfill::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        queue.clear();
+    }
+    cv.notify_all();
+    if (worker.joinable()) worker.join();
+}
+
+void BarBackfill::request(const BarGap& gap) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(gap);
+    }
+    cv.notify_one();
+}
+
+void BarBackfill::run() {
+    placeThisThread("backfill", cfg.backfillThread);
+    std::unique_lock<std::mutex> lock(mutex);
+    for (;;) {
+        cv.wait(lock, [this]() { return stopping || !queue.empty(); });
+        if (stopping) return;
+        const BarGap gap = queue.front();
+        queue.pop_front();
+        lock.unlock();
+
+        std::vector<CompactBar> bars = fetch(gap);
+        if (done) done(gap, std::move(bars));
+        lock.lock();
+    }
+}
+
+std::vector<CompactBar> BarBackfill::fetch(const BarGap& gap) {
+    std::vector<CompactBar> bars;
+    if (!cfg.barStoreRoot.empty()) fetchStore(gap, bars);
+    if (bars.size() < gap.missing() && !cfg.restHost.empty()) {
+        try {
+            fetchRest(gap, bars);
+        } catch (const std::exception& e) {
+            LOG_WARN("Backfill of {} from {} failed: {}", SymbolTable::get_instance().name(gap.symbolId),
+                     cfg.restHost, e.what());
+        }
+    }
+
+    std::sort(bars.begin(), bars.end(),
+              [](const CompactBar& a, const CompactBar& b) { return a.timestampNs < b.timestampNs; });
+    bars.erase(std::unique(bars.begin(), bars.end(),
+                           [](const CompactBar& a, const CompactBar& b) { return a.timestampNs == b.timestampNs; }),
+               bars.end());
+    return bars;
+}
+
+void BarBackfill::fetchStore(const BarGap& gap, std::vector<CompactBar>& out) const {
+    BarStoreReader reader(cfg.barStoreRoot);
+    const string symbol(SymbolTable::get_instance().name(gap.symbolId));
+    for (const BarSlice& slice : reader.query(symbol, gap.afterNs + 1, gap.beforeNs)) {
+        for (size_t i = 0; i < slice.size(); ++i) {
+            out.push_back(slice.bar(i));
+        }
+    }
+}
+
+void BarBackfill::fetchRest(const BarGap& gap, std::vector<CompactBar>& out) {
+    if (!rest) {
+        // Sessions are opened on demand; gaps are rare enough that nothing
+        // needs to be kept warm.
+        SessionPoolConfig endpoint;
+        endpoint.host = cfg.restHost;
+        endpoint.port = cfg.restPort;
+        endpoint.maxSessions = 1;
+        endpoint.warmSessions = 0;
+        rest = std::make_unique<SessionPool>(endpoint);
+        rest->setCredentials(ALPACA_API_KEY, ALPACA_API_SECRET_KEY);
+    }
+
+    const string symbol(SymbolTable::get_instance().name(gap.symbolId));
+    const string query = cfg.barsTarget + "?symbols=" + urlEncode(symbol) + "&timeframe=" + cfg.barTimeframe +
+                         "&start=" + urlEncode(FeedDecoder::formatTimestamp(gap.afterNs + 1)) +
+                         "&end=" + urlEncode(FeedDecoder::formatTimestamp(gap.beforeNs - 1)) + "&limit=1000";
+    string pageToken;
+    do {
+        http_request req{http::verb::get, pageToken.empty() ? query : query + "&page_token=" + urlEncode(pageToken), 11};
+        http_response res;
+        const unsigned status = rest->send(req, res);
+        if (status != 200) {
+            throw std::runtime_error("HTTP " + std::to_string(status) + ": " + res.body());
+        }
+
+        const json body = json::parse(res.body());
+        if (body.contains("bars") && body["bars"].is_object() && body["bars"].contains(symbol)) {
+            for (json bar : body["bars"][symbol]) {
+                bar["S"] = symbol;
+                out.push_back(Bar(bar).toCompact());
+            }
+        }
+        pageToken = body.contains("next_page_token") && body["next_page_token"].is_string()
+                        ? body["next_page_token"].get<string>()
+                        : string();
+    } while (!pageToken.empty());
+}
@@ -0,0 +1,164 @@
+#include "journal.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+namespace {
+    const char MAGIC[8] = {'H', 'F', 'T', 'J', 'R', 'N', 'L', '\0'};
+    const size_t HEADER_BYTES = 16;
+    const size_t RECORD_HEADER_BYTES = 16;
+
+    size_t padded(size_t n) {
+        return (n + 7) & ~size_t(7);
+    }
+
+    std::runtime_error systemError(const string& what, const string& path) {
+        return std::runtime_error(what + " " + path + ": " + std::strerror(errno));
+    }
+}
+
+JournalWriter::JournalWriter(const string& path, JournalWriterConfig config) : cfg(config) {
+    if (cfg.growBytes < 4096) cfg.growBytes = 4096;
+
+    fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        throw systemError("Cannot create journal", path);
+    }
+
+    grow(HEADER_BYTES);
+    std::memcpy(base, MAGIC, sizeof(MAGIC));
+    const uint32_t version = VERSION;
+    std::memcpy(base + sizeof(MAGIC), &version, sizeof(version));
+    used = HEADER_BYTES;
+}
+
+JournalWriter::~JournalWriter() {
+    close();
+}
+
+void JournalWriter::grow(size_t need) {
+    size_t target = mapped;
+    while (target < need) target += cfg.growBytes;
+
+    // Allocating the blocks up front turns a full disk into an error here
+    // instead of a SIGBUS on some later memcpy.
+    int rc = ::posix_fallocate(fd, 0, static_cast<off_t>(target));
+    if (rc != 0) {
+        errno = rc;
+        throw systemError("Cannot extend journal", "to " + std::to_string(target) + " bytes");
+    }
+
+    void* mapping = base ? ::mremap(base, mapped, target, MREMAP_MAYMOVE)
+                         : ::mmap(nullptr, target, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+        throw systemError("Cannot map journal", "of " + std::to_string(target) + " bytes");
+    }
+    base = static_cast<char*>(mapping);
+    mapped = target;
+    ::madvise(base, mapped, MADV_SEQUENTIAL);
+}
+
+void JournalWriter::append(int64_t receiveNs, std::string_view payload) {
+    if (payload.empty()) return;
+
+    const size_t total = RECORD_HEADER_BYTES + padded(payload.size());
+    // Keep room for the zero length that terminates the journal.
+    if (used + total + sizeof(uint32_t) > mapped) {
+        grow(used + total + sizeof(uint32_t));
+    }
+
+    char* record = base + used;
+    std::memcpy(record + 8, &receiveNs, sizeof(receiveNs));
+    std::memcpy(record + RECORD_HEADER_BYTES, payload.data(), payload.size());
+
+    const uint32_t length = static_cast<uint32_t>(payload.size());
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(record, &length, sizeof(length));
+
+    used += total;
+    ++count;
+}
+
+void JournalWriter::flush() {
+    if (base) ::msync(base, used, MS_ASYNC);
+}
+
+void JournalWriter::close() {
+    if (fd < 0) return;
+    if (base) {
+        ::munmap(base, mapped);
+        base = nullptr;
+    }
+    // If trimming fails the zero-filled tail still ends the journal.
+    int rc = ::ftruncate(fd, static_cast<off_t>(used));
+    (void)rc;
+    ::close(fd);
+    fd = -1;
+}
+
+JournalReader::JournalReader(const string& path) {
+    fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw systemError("Cannot open journal", path);
+    }
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw systemError("Cannot stat journal", path);
+    }
+    size = static_cast<size_t>(st.st_size);
+
+    if (size < HEADER_BYTES) {
+        ::close(fd);
+        throw std::runtime_error("Not a journal: " + path);
+    }
+    void* mapping = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapping == MAP_FAILED) {
+        ::close(fd);
+        throw systemError("Cannot map journal", path);
+    }
+    base = static_cast<const char*>(mapping);
+    ::madvise(const_cast<char*>(base), size, MADV_SEQUENTIAL);
+
+    uint32_t version = 0;
+    std::memcpy(&version, base + sizeof(MAGIC), sizeof(version));
+    if (std::memcmp(base, MAGIC, sizeof(MAGIC)) != 0 || version != JournalWriter::VERSION) {
+        ::munmap(const_cast<char*>(base), size);
+        ::close(fd);
+        throw std::runtime_error("Not a journal (or unsupported version): " + path);
+    }
+    offset = HEADER_BYTES;
+}
+
+JournalReader::~JournalReader() {
+    if (base) ::munmap(const_cast<char*>(base), size);
+    if (fd >= 0) ::close(fd);
+}
+
+bool JournalReader::next(JournalRecord& record) {
+    if (offset + RECORD_HEADER_BYTES > size) return false;
+
+    uint32_t length = 0;
+    std::memcpy(&length, base + offset, sizeof(length));
+    // A zero length ends the journal; a record running past the end was cut
+    // short by a crash.
+    const size_t total = RECORD_HEADER_BYTES + padded(length);
+    if (length == 0 || offset + total > size) return false;
+
+    std::memcpy(&record.receiveNs, base + offset + 8, sizeof(record.receiveNs));
+    record.payload = std::string_view(base + offset + RECORD_HEADER_BYTES, length);
+    offset += total;
+    return true;
+}
+
+void JournalReader::rewind() {
+    offset = HEADER_BYTES;
+}
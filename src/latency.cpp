@@ -0,0 +1,182 @@
+#include "latency.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <vector>
+
+#include "ring_buffer.h"
+
+namespace latency {
+    namespace {
+        constexpr size_t STAGES = static_cast<size_t>(Stage::Count);
+        constexpr size_t RING_CAPACITY = 16384;
+
+        // BusySpin so a push never touches the futex word; nobody waits on
+        // these rings.
+        struct ThreadRing {
+            SpscRing<Sample> ring{RING_CAPACITY, WaitPolicy::BusySpin};
+        };
+
+        struct Registry {
+            std::mutex mutex;
+            // Rings outlive their threads so late samples are still collected.
+            std::vector<std::shared_ptr<ThreadRing>> rings;
+            Histogram histograms[STAGES];
+            uint64_t dropsAtReset = 0;
+        };
+
+        Registry& registry() {
+            static Registry* instance = new Registry();
+            return *instance;
+        }
+
+        ThreadRing& threadRing() {
+            thread_local ThreadRing* ring = nullptr;
+            if (!ring) {
+                auto created = std::make_shared<ThreadRing>();
+                Registry& r = registry();
+                std::lock_guard<std::mutex> lock(r.mutex);
+                r.rings.push_back(created);
+                ring = created.get();
+            }
+            return *ring;
+        }
+
+        // Caller holds the registry lock.
+        uint64_t drain(Registry& r) {
+            const double scale = nsPerTick();
+            Sample batch[256];
+            uint64_t drops = 0;
+            for (const auto& ring : r.rings) {
+                size_t n;
+                while ((n = ring->ring.tryPopBatch(batch, 256)) > 0) {
+                    for (size_t i = 0; i < n; ++i) {
+                        const size_t stage = static_cast<size_t>(batch[i].stage);
+                        if (stage < STAGES) {
+                            r.histograms[stage].record(static_cast<uint64_t>(std::llround(batch[i].ticks * scale)));
+                        }
+                    }
+                }
+                drops += ring->ring.stats().drops;
+            }
+            return drops;
+        }
+    }
+
+    const char* stageName(Stage stage) {
+        switch (stage) {
+        case Stage::Decode: return "decode";
+        case Stage::Strategy: return "strategy";
+        case Stage::Batch: return "batch";
+        case Stage::Serialize: return "serialize";
+        case Stage::Write: return "write";
+        case Stage::Response: return "response";
+        case Stage::EndToEnd: return "end-to-end";
+        case Stage::Count: break;
+        }
+        return "unknown";
+    }
+
+    bool push(const Sample& sample) {
+        return threadRing().ring.tryPush(sample);
+    }
+
+    size_t Histogram::indexOf(uint64_t value) {
+        if (value < SUB_BUCKETS) return static_cast<size_t>(value);
+        const unsigned exponent = 63 - static_cast<unsigned>(__builtin_clzll(value));
+        const size_t sub = static_cast<size_t>(value >> (exponent - SUB_BITS)) - SUB_BUCKETS;
+        return (exponent - SUB_BITS + 1) * SUB_BUCKETS + sub;
+    }
+
+    uint64_t Histogram::highestEquivalent(size_t index) {
+        const size_t group = index / SUB_BUCKETS;
+        const uint64_t sub = index % SUB_BUCKETS;
+        if (group == 0) return sub;
+        const unsigned shift = static_cast<unsigned>(group - 1);
+        return ((SUB_BUCKETS + sub) << shift) + ((uint64_t(1) << shift) - 1);
+    }
+
+    void Histogram::record(uint64_t value, uint64_t count) {
+        if (count == 0) return;
+        counts[indexOf(value)] += count;
+        total += count;
+        lowest = std::min(lowest, value);
+        highest = std::max(highest, value);
+        sum += static_cast<double>(value) * static_cast<double>(count);
+    }
+
+    void Histogram::merge(const Histogram& other) {
+        if (other.total == 0) return;
+        for (size_t i = 0; i < BUCKETS; ++i) counts[i] += other.counts[i];
+        total += other.total;
+        lowest = std::min(lowest, other.lowest);
+        highest = std::max(highest, other.highest);
+        sum += other.sum;
+    }
+
+    void Histogram::reset() {
+        std::fill(std::begin(counts), std::end(counts), 0);
+        total = 0;
+        lowest = UINT64_MAX;
+        highest = 0;
+        sum = 0;
+    }
+
+    uint64_t Histogram::quantile(double q) const {
+        if (total == 0) return 0;
+        q = std::min(std::max(q, 0.0), 1.0);
+        const uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(total))));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKETS; ++i) {
+            seen += counts[i];
+            if (seen >= target) return std::min(highestEquivalent(i), highest);
+        }
+        return highest;
+    }
+
+    Report collect() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+
+        Report report;
+        report.drops = drain(r) - r.dropsAtReset;
+        for (size_t i = 0; i < STAGES; ++i) {
+            const Histogram& h = r.histograms[i];
+            StageSummary& s = report.stages[i];
+            s.count = h.count();
+            s.mean = h.mean();
+            s.min = h.min();
+            s.p50 = h.quantile(0.50);
+            s.p99 = h.quantile(0.99);
+            s.p999 = h.quantile(0.999);
+            s.max = h.max();
+        }
+        return report;
+    }
+
+    void reset() {
+        Registry& r = registry();
+        std::lock_guard<std::mutex> lock(r.mutex);
+        r.dropsAtReset = drain(r);
+        for (Histogram& h : r.histograms) h.reset();
+    }
+
+    string Report::format() const {
+        std::ostringstream out;
+        out << std::left << std::setw(12) << "stage" << std::right
+            << std::setw(10) << "count" << std::setw(12) << "p50 ns" << std::setw(12) << "p99 ns"
+            << std::setw(12) << "p99.9 ns" << std::setw(12) << "max ns" << "\n";
+        for (size_t i = 0; i < STAGES; ++i) {
+            const StageSummary& s = stages[i];
+            out << std::left << std::setw(12) << stageName(static_cast<Stage>(i)) << std::right
+                << std::setw(10) << s.count << std::setw(12) << s.p50 << std::setw(12) << s.p99
+                << std::setw(12) << s.p999 << std::setw(12) << s.max << "\n";
+        }
+        if (drops) out << drops << " samples dropped\n";
+        return out.str();
+    }
+}
@@ -0,0 +1,386 @@
+#include "logger.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "ring_buffer.h"
+
+namespace logging {
+    namespace {
+        // BusySpin so a push never touches the futex word; the writer polls.
+        struct ThreadRing {
+            explicit ThreadRing(size_t capacity) : ring(capacity, WaitPolicy::BusySpin) {}
+            SpscRing<Entry> ring;
+            // Set as the owning thread exits; nothing is pushed after it.
+            std::atomic<bool> exited{false};
+        };
+
+        // The calling thread's ring, marked exited when the thread goes.
+        struct RingHandle {
+            ThreadRing* ring = nullptr;
+
+            ~RingHandle() {
+                if (!ring) return;
+                ring->exited.store(true, std::memory_order_release);
+                // Anything logged later in this thread's teardown gets a
+                // ring of its own.
+                ring = nullptr;
+            }
+        };
+
+        class Writer {
+        public:
+            ThreadRing& registerThread() {
+                std::lock_guard<std::mutex> lock(mutex);
+                rings.push_back(std::make_shared<ThreadRing>(config.threadEntries));
+                startLocked();
+                return *rings.back();
+            }
+
+            void start(const LoggerConfig& next) {
+                std::lock_guard<std::mutex> lock(mutex);
+                config = next;
+                reopen = true;
+                startLocked();
+            }
+
+            void stop() {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (!active) return;
+                running = false;
+                wake.notify_all();
+                flushed.wait(lock, [&] { return !active; });
+            }
+
+            void flush() {
+                std::unique_lock<std::mutex> lock(mutex);
+                if (!active) return;
+                const uint64_t epoch = ++flushRequested;
+                wake.notify_all();
+                flushed.wait(lock, [&] { return flushCompleted >= epoch || !active; });
+            }
+
+            LoggerStats stats() {
+                std::lock_guard<std::mutex> lock(mutex);
+                LoggerStats s;
+                s.written = written.load(std::memory_order_relaxed);
+                s.drops = exitedDrops;
+                for (const auto& ring : rings) s.drops += ring->ring.stats().drops;
+                s.threadRings = rings.size();
+                return s;
+            }
+
+        private:
+            // Caller holds the mutex.
+            void startLocked() {
+                if (active) return;
+                active = true;
+                running = true;
+                anchor();
+                // Detached: stop() waits for it to finish, and the writer is
+                // never destroyed.
+                std::thread(&Writer::run, this).detach();
+                static std::once_flag atExit;
+                std::call_once(atExit, [] { std::atexit([] { logging::stop(); }); });
+            }
+
+            void anchor() {
+                anchorWallNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::system_clock::now().time_since_epoch()).count();
+                anchorTicks = tsc::now();
+            }
+
+            void run() {
+                const double nsPerTick = tsc::nsPerTick();
+                std::vector<Entry> batch;
+                std::vector<std::shared_ptr<ThreadRing>> snapshot;
+                std::vector<ThreadRing*> drained;
+                string line;
+                auto lastAnchor = std::chrono::steady_clock::now();
+
+                for (;;) {
+                    uint64_t epoch;
+                    bool stopping;
+                    bool reopened = false;
+                    {
+                        std::lock_guard<std::mutex> lock(mutex);
+                        epoch = flushRequested;
+                        stopping = !running;
+                        snapshot = rings;
+                        if (reopen) {
+                            openSinks();
+                            reopened = true;
+                        }
+                    }
+                    if (reopened) placeThisThread("logger", sinkConfig.writerThread);
+
+                    batch.clear();
+                    drained.clear();
+                    for (const auto& ring : snapshot) {
+                        // Checked before popping: a ring whose thread had
+                        // already exited is empty for good afterwards.
+                        const bool exited = ring->exited.load(std::memory_order_acquire);
+                        Entry entry;
+                        while (ring->ring.tryPop(entry)) batch.push_back(entry);
+                        if (exited) drained.push_back(ring.get());
+                    }
+                    // Each thread's entries are already in order; this
+                    // interleaves the threads.
+                    std::stable_sort(batch.begin(), batch.end(),
+                                     [](const Entry& a, const Entry& b) { return a.ticks < b.ticks; });
+
+                    for (const Entry& entry : batch) {
+                        const int64_t wallNs = anchorWallNs + static_cast<int64_t>(
+                            (static_cast<double>(entry.ticks) - static_cast<double>(anchorTicks)) * nsPerTick);
+                        line.clear();
+                        appendTimestamp(line, wallNs);
+                        line += levelName(entry.site->level);
+                        line += format(entry);
+                        line += '\n';
+                        emit(entry.site->level, line);
+                    }
+                    written.fetch_add(batch.size(), std::memory_order_relaxed);
+                    if (!batch.empty()) flushSinks();
+
+                    {
+                        std::unique_lock<std::mutex> lock(mutex);
+                        if (!drained.empty()) release(drained);
+                        flushCompleted = epoch;
+                        flushed.notify_all();
+                        if (stopping) {
+                            closeSinks();
+                            reopen = true;
+                            active = false;
+                            flushed.notify_all();
+                            return;
+                        }
+                        if (batch.empty()) {
+                            wake.wait_for(lock, std::chrono::milliseconds(1),
+                                          [&] { return !running || flushRequested != epoch; });
+                        }
+                    }
+
+                    // Keeps wall-clock conversion from drifting on long runs.
+                    const auto now = std::chrono::steady_clock::now();
+                    if (now - lastAnchor > std::chrono::seconds(1)) {
+                        anchor();
+                        lastAnchor = now;
+                    }
+                }
+            }
+
+            // Drops the given rings, whose threads have exited and whose
+            // entries have all been written; the snapshot frees them. Caller
+            // holds the mutex.
+            void release(const std::vector<ThreadRing*>& drained) {
+                for (ThreadRing* ring : drained) exitedDrops += ring->ring.stats().drops;
+                rings.erase(std::remove_if(rings.begin(), rings.end(),
+                                           [&](const std::shared_ptr<ThreadRing>& ring) {
+                                               return std::find(drained.begin(), drained.end(), ring.get()) !=
+                                                      drained.end();
+                                           }),
+                            rings.end());
+            }
+
+            static const char* levelName(LogLevel level) {
+                switch (level) {
+                case LogLevel::Debug: return " DEBUG ";
+                case LogLevel::Info: return " INFO  ";
+                case LogLevel::Warn: return " WARN  ";
+                case LogLevel::Error: return " ERROR ";
+                }
+                return " ?     ";
+            }
+
+            void appendTimestamp(string& out, int64_t wallNs) {
+                const int64_t seconds = wallNs / 1000000000LL;
+                if (seconds != cachedSecond) {
+                    const std::time_t t = static_cast<std::time_t>(seconds);
+                    std::tm tm;
+                    gmtime_r(&t, &tm);
+                    std::strftime(secondText, sizeof(secondText), "%Y-%m-%dT%H:%M:%S", &tm);
+                    cachedSecond = seconds;
+                }
+                char fraction[16];
+                std::snprintf(fraction, sizeof(fraction), ".%06lldZ",
+                              static_cast<long long>(wallNs % 1000000000LL / 1000));
+                out += secondText;
+                out += fraction;
+            }
+
+            // Sinks are only touched by the writer thread (with the mutex
+            // held when reopening).
+            void openSinks() {
+                closeSinks();
+                reopen = false;
+                sinkConfig = config;
+                if (sinkConfig.path.empty()) return;
+
+                file = std::fopen(sinkConfig.path.c_str(), "a");
+                if (!file) {
+                    std::fprintf(stderr, "Cannot open log file %s; logging to the console\n", sinkConfig.path.c_str());
+                    sinkConfig.path.clear();
+                    return;
+                }
+                std::fseek(file, 0, SEEK_END);
+                fileBytes = static_cast<size_t>(std::ftell(file));
+            }
+
+            void closeSinks() {
+                if (file) std::fclose(file);
+                file = nullptr;
+            }
+
+            void rotate() {
+                closeSinks();
+                const string& path = sinkConfig.path;
+                for (unsigned i = sinkConfig.maxFiles; i > 1; --i) {
+                    std::rename((path + "." + std::to_string(i - 1)).c_str(), (path + "." + std::to_string(i)).c_str());
+                }
+                if (sinkConfig.maxFiles > 0) {
+                    std::rename(path.c_str(), (path + ".1").c_str());
+                } else {
+                    std::remove(path.c_str());
+                }
+                file = std::fopen(path.c_str(), "w");
+                fileBytes = 0;
+            }
+
+            void emit(LogLevel level, const string& text) {
+                if (sinkConfig.path.empty()) {
+                    std::fwrite(text.data(), 1, text.size(), level >= LogLevel::Warn ? stderr : stdout);
+                    return;
+                }
+                if (fileBytes > 0 && fileBytes + text.size() > sinkConfig.maxFileBytes) rotate();
+                if (!file) return;
+                std::fwrite(text.data(), 1, text.size(), file);
+                fileBytes += text.size();
+            }
+
+            void flushSinks() {
+                if (file) {
+                    std::fflush(file);
+                } else {
+                    std::fflush(stdout);
+                    std::fflush(stderr);
+                }
+            }
+
+            std::mutex mutex;
+            std::condition_variable wake;
+            std::condition_variable flushed;
+            // The writer thread is alive; running is false once it should exit.
+            bool active = false;
+            bool running = false;
+            bool reopen = true;
+            uint64_t flushRequested = 0;
+            uint64_t flushCompleted = 0;
+            LoggerConfig config;
+            // A ring outlives its thread until the writer has drained it.
+            std::vector<std::shared_ptr<ThreadRing>> rings;
+            // Drops counted by rings that have since been released.
+            uint64_t exitedDrops = 0;
+            std::atomic<uint64_t> written{0};
+
+            // Writer thread only.
+            LoggerConfig sinkConfig;
+            FILE* file = nullptr;
+            size_t fileBytes = 0;
+            std::atomic<int64_t> anchorWallNs{0};
+            std::atomic<uint64_t> anchorTicks{0};
+            int64_t cachedSecond = -1;
+            char secondText[32] = {};
+        };
+
+        // Never destroyed, so threads may log during static destruction.
+        Writer& writer() {
+            static Writer* instance = new Writer();
+            return *instance;
+        }
+
+        template <typename T>
+        T read(const char*& p) {
+            T value;
+            std::memcpy(&value, p, sizeof(T));
+            p += sizeof(T);
+            return value;
+        }
+
+        void appendArg(string& out, const char*& p) {
+            char buffer[32];
+            switch (static_cast<ArgType>(*p++)) {
+            case ArgType::Int:
+                std::snprintf(buffer, sizeof(buffer), "%lld", static_cast<long long>(read<int64_t>(p)));
+                out += buffer;
+                break;
+            case ArgType::Uint:
+                std::snprintf(buffer, sizeof(buffer), "%llu", static_cast<unsigned long long>(read<uint64_t>(p)));
+                out += buffer;
+                break;
+            case ArgType::Double:
+                std::snprintf(buffer, sizeof(buffer), "%g", read<double>(p));
+                out += buffer;
+                break;
+            case ArgType::Bool:
+                out += read<uint8_t>(p) ? "true" : "false";
+                break;
+            case ArgType::Char:
+                out += read<char>(p);
+                break;
+            case ArgType::String: {
+                const size_t length = static_cast<uint8_t>(*p++);
+                out.append(p, length);
+                p += length;
+                break;
+            }
+            }
+        }
+    }
+
+    void start(const LoggerConfig& config) {
+        writer().start(config);
+    }
+
+    void stop() {
+        writer().stop();
+    }
+
+    void flush() {
+        writer().flush();
+    }
+
+    LoggerStats stats() {
+        return writer().stats();
+    }
+
+    bool push(const Entry& entry) {
+        thread_local RingHandle handle;
+        if (!handle.ring) handle.ring = &writer().registerThread();
+        return handle.ring->ring.tryPush(entry);
+    }
+
+    string format(const Entry& entry) {
+        string out;
+        const char* p = entry.payload;
+        const char* end = entry.payload + entry.size;
+        for (const char* f = entry.site->format; *f; ++f) {
+            if (f[0] == '{' && f[1] == '}' && p < end) {
+                appendArg(out, p);
+                ++f;
+            } else {
+                out += *f;
+            }
+        }
+        if (entry.truncated) out += " [truncated]";
+        return out;
+    }
+}
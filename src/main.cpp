@@ -5,6 +5,11 @@
 #include <nlohmann/json.hpp>
 #include "client.h"
 #include "dotenv.h"
+#include "fixed_point.h"
+#include "logger.h"
+#include "sma_crossover.h"
+#include "symbol_registry.h"
+#include "symbol_table.h"
 
 using std::cout;
 using std::cerr;
@@ -15,6 +20,14 @@ namespace {
     std::string API_KEY;
     std::string SECRET_KEY;
     std::vector<std::string> SYMBOLS;
+
+    // Optional .env overrides, e.g. to point at tools/exchange_simulator.
+    std::string envOr(const dotenv::EnvSingleton& env, const std::string& key, const std::string& fallback) {
+        auto value = env.get(key);
+        if (!value) return fallback;
+        if (auto text = std::get_if<std::string>(&*value)) return *text;
+        return fallback;
+    }
 }
 
 std::mutex mtx;
@@ -58,14 +71,101 @@ int main() {
     }
 
     try {
+        // Fixes every symbol's id, scales and trading rules before anything
+        // streams. SYMBOL_METADATA is a saved /v2/assets list, or "alpaca"
+        // to fetch it; without it the default scales apply.
+        SymbolRegistryConfig registry;
+        registry.symbols = SYMBOLS;
+        const std::string metadata = envOr(env, "SYMBOL_METADATA", "");
+        registry.fetchAssets = metadata == "alpaca";
+        if (!registry.fetchAssets) registry.assetsFile = metadata;
+        registry.host = envOr(env, "ORDER_HOST", registry.host);
+        registry.port = envOr(env, "ORDER_PORT", registry.port);
+        registry.defaultMinNotional = std::stod(envOr(env, "SYMBOL_MIN_NOTIONAL", "0"));
+        const size_t described = loadSymbolRegistry(registry, API_KEY, SECRET_KEY);
+        cout << "Registered " << SYMBOLS.size() << " symbols, " << described << " with asset metadata" << endl;
+
         WebClient clientObject(API_KEY, SECRET_KEY);
 
+        // e.g. THREAD_TOPOLOGY=feeds=2:fifo=80;shards=4-7:fifo=70;gateway=3:fifo=60;logger=0;housekeeping=0-1
+        // with those cores isolated (isolcpus=2-7); see ThreadTopology::parse.
+        const ThreadTopology topology = ThreadTopology::parse(envOr(env, "THREAD_TOPOLOGY", ""));
+        clientObject.setThreadTopology(topology);
+
         clientObject.setOnConnect(onConnect);
         clientObject.setOnAuthenticate(onAuthenticate);
         clientObject.setOnSubscribe(onSubscribe);
+        clientObject.setStrategyFactory([]() {
+            return makeStrategyRunner(StrategyEngine<SmaCrossover<10, 30>>(SmaCrossover<10, 30>(0.001)));
+        });
+        clientObject.rebalanceShards(SYMBOLS);
+
+        // Limits of 0 are off.
+        RiskConfig risk;
+        risk.defaults.maxOrderQuantity = std::stod(envOr(env, "RISK_MAX_ORDER_QTY", "0"));
+        risk.defaults.maxOrderNotional = std::stod(envOr(env, "RISK_MAX_ORDER_NOTIONAL", "0"));
+        risk.defaults.maxPosition = std::stod(envOr(env, "RISK_MAX_POSITION", "0"));
+        risk.defaults.priceBandBps = std::stod(envOr(env, "RISK_PRICE_BAND_BPS", "500"));
+        risk.ordersPerSecond = std::stod(envOr(env, "RISK_ORDERS_PER_SECOND", "10"));
+        risk.burst = std::stod(envOr(env, "RISK_BURST", "5"));
+        clientObject.riskGate().configure(risk);
+
+        string uri      = envOr(env, "STREAM_URI", "wss://stream.data.alpaca.markets/v1beta3/crypto/us");
+        string hostname = envOr(env, "STREAM_HOST", "stream.data.alpaca.markets");
+
+        string barStorePath = envOr(env, "BAR_STORE", "");
+        if (!barStorePath.empty()) {
+            auto start = std::chrono::steady_clock::now();
+            size_t bars = clientObject.warmUp(barStorePath, SYMBOLS, std::stoul(envOr(env, "WARMUP_DAYS", "3")));
+            std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+            cout << "Warmed up on " << bars << " stored bars in " << elapsed.count() << " ms." << endl;
+            clientObject.setBarStore(barStorePath);
+        }
 
-        string uri      = "wss://stream.data.alpaca.markets/v1beta3/crypto/us";
-        string hostname = "stream.data.alpaca.markets"; 
+        string logPath = envOr(env, "LOG_PATH", "");
+        if (!logPath.empty() || !topology.logger.empty()) {
+            LoggerConfig logConfig;
+            logConfig.path = logPath;
+            logConfig.writerThread = topology.logger;
+            logging::start(logConfig);
+        }
+
+        // Gaps in the bar stream are filled from the local store, then REST.
+        FeedSessionConfig session;
+        session.barStoreRoot = barStorePath;
+        session.restHost = envOr(env, "BARS_HOST", session.restHost);
+        session.restPort = envOr(env, "BARS_PORT", session.restPort);
+        session.pingInterval = std::chrono::milliseconds(std::stol(envOr(env, "PING_INTERVAL_MS", "5000")));
+        clientObject.setFeedSession(session);
+
+        string capturePath = envOr(env, "CAPTURE_PATH", "");
+        if (!capturePath.empty()) {
+            clientObject.setCapture(capturePath);
+        }
+
+        // Stocks stream on a feed of their own next to crypto, e.g.
+        // wss://stream.data.alpaca.markets/v2/iex (or /v2/sip).
+        string stockUri = envOr(env, "STOCK_STREAM_URI", "");
+        if (!stockUri.empty()) {
+            MarketFeedConfig stocks;
+            stocks.name = "stocks";
+            stocks.uri = stockUri;
+            stocks.hostname = envOr(env, "STOCK_STREAM_HOST", hostname);
+            stocks.assetClass = AssetClass::Stock;
+            stocks.session = session;
+            stocks.session.barsTarget = "/v2/stocks/bars";
+            // Stock minute bars only exist for minutes with trades, so a
+            // missing one is not a gap.
+            stocks.session.barInterval = std::chrono::seconds(0);
+            clientObject.addFeed(stocks);
+        }
+
+        if (env.get("ORDER_HOST")) {
+            SessionPoolConfig orderEndpoint;
+            orderEndpoint.host = envOr(env, "ORDER_HOST", orderEndpoint.host);
+            orderEndpoint.port = envOr(env, "ORDER_PORT", orderEndpoint.port);
+            clientObject.setOrderEndpoint(orderEndpoint);
+        }
 
         clientObject.connect(uri, hostname);
 
@@ -81,21 +181,61 @@ int main() {
             cv.wait(lock, []{ return authenticated_flag; });
         }
 
+        clientObject.warmOrderSessions();
+        clientObject.connectTradeUpdates(envOr(env, "TRADE_UPDATES_URI", "wss://paper-api.alpaca.markets/stream"),
+                                         envOr(env, "TRADE_UPDATES_HOST", "paper-api.alpaca.markets"));
         clientObject.subscribeBars(SYMBOLS);
+        clientObject.subscribeQuotes(SYMBOLS);
+        clientObject.subscribeOrderBooks(SYMBOLS);
 
         {
             std::unique_lock<std::mutex> lock(mtx);
             cv.wait(lock, []{ return subscribed_flag; });
         }
 
+        cout << "Engine threads:\n" << threadReport();
         cout << "Streaming bars. Press Enter to exit..." << endl;
         cin.get();
 
+        clientObject.unsubscribeOrderBooks(SYMBOLS);
+        clientObject.unsubscribeQuotes(SYMBOLS);
         clientObject.unsubscribeBars(SYMBOLS);
         
         clientObject.disconnect();
         clientObject.executeOrders();
 
+        const SymbolTable& table = SymbolTable::get_instance();
+        for (const auto& symbol : SYMBOLS) {
+            const uint32_t id = table.find(symbol);
+            if (id == SymbolTable::INVALID_ID) continue;
+            const Position position = clientObject.orderManager().position(id);
+            cout << "Position " << symbol << ": " << fixed_point::toString(position.quantity, table.sizeDecimals(id))
+                 << " @ " << fixed_point::toString(position.averagePrice, table.priceDecimals(id))
+                 << ", realized " << position.realizedPnl << endl;
+        }
+
+        const RiskStats riskStats = clientObject.riskGate().stats();
+        cout << "Pre-trade risk: " << riskStats.checked << " checked, " << riskStats.passed << " passed";
+        for (size_t i = 1; i < static_cast<size_t>(RiskReject::Count); ++i) {
+            if (riskStats.rejected[i]) cout << ", " << riskStats.rejected[i] << " " << toString(static_cast<RiskReject>(i));
+        }
+        cout << endl;
+
+        const FeedSessionStats feed = clientObject.feedSessionStats();
+        cout << "Feed session: " << feed.connects << " connects, " << feed.reconnects << " reconnects, "
+             << feed.pongTimeouts << " pong timeouts, " << feed.gaps << " gaps, " << feed.backfilledBars << " of "
+             << feed.missingBars << " missing bars backfilled" << endl;
+        if (!stockUri.empty()) {
+            const FeedMergerStats merged = clientObject.feedMergerStats();
+            cout << "Feed merger: " << merged.merged << " events merged, " << merged.outOfOrder << " out of order"
+                 << endl;
+        }
+
+        logging::flush();
+        if (latency::enabled) {
+            cout << "Tick-to-order latency:\n" << latency::collect().format();
+        }
+
     } catch (const std::exception& e) {
         cerr << "Error: " << e.what() << endl;
         return EXIT_FAILURE;
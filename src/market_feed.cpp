@@ -0,0 +1,451 @@
+#include "market_feed.h"
+
+#include <nlohmann/json.hpp>
+
+#include "bar.h"
+#include "latency.h"
+#include "logger.h"
+
+using json = nlohmann::json;
+using websocketpp::lib::bind;
+using websocketpp::lib::placeholders::_1;
+using websocketpp::lib::placeholders::_2;
+typedef websocketpp::lib::error_code error_code;
+
+const char* toString(FeedChannel channel) {
+    switch (channel) {
+    case FeedChannel::Trades: return "trades";
+    case FeedChannel::Quotes: return "quotes";
+    case FeedChannel::Bars: return "bars";
+    case FeedChannel::UpdatedBars: return "updatedBars";
+    case FeedChannel::DailyBars: return "dailyBars";
+    case FeedChannel::OrderBooks: return "orderbooks";
+    }
+    return "unknown";
+}
+
+AssetClass assetClassOf(std::string_view symbol) {
+    return symbol.find('/') != std::string_view::npos ? AssetClass::Crypto : AssetClass::Stock;
+}
+
+MarketFeed::MarketFeed(uint8_t index, const MarketFeedConfig& config, FeedListener& listener, const string& apiKey,
+                       const string& apiSecretKey)
+    : index(index), cfg(config), listener(listener), ALPACA_API_KEY(apiKey), ALPACA_API_SECRET_KEY(apiSecretKey),
+      backoff(config.session) {
+    endpoint.init_asio();
+    endpoint.clear_access_channels(websocketpp::log::alevel::all);
+}
+
+MarketFeed::~MarketFeed() {
+    disconnect();
+    if (thread.joinable()) thread.join();
+    if (backfill) backfill->stop();
+}
+
+void MarketFeed::connect() {
+    if (thread.joinable()) {
+        throw std::runtime_error("Feed " + cfg.name + " is already connected");
+    }
+
+    endpoint.set_message_handler(bind(&MarketFeed::onMessage, this, _1, _2));
+    endpoint.set_open_handler(bind(&MarketFeed::onOpen, this, _1));
+    endpoint.set_close_handler(bind(&MarketFeed::onClose, this, _1));
+    endpoint.set_fail_handler(bind(&MarketFeed::onFail, this, _1));
+    endpoint.set_pong_timeout_handler(bind(&MarketFeed::onPongTimeout, this, _1, _2));
+    endpoint.set_tls_init_handler([](websocketpp::connection_hdl) {
+        auto ctx = websocketpp::lib::make_shared<websocketpp::lib::asio::ssl::context>(
+            websocketpp::lib::asio::ssl::context::tlsv12);
+        ctx->set_options(websocketpp::lib::asio::ssl::context::default_workarounds |
+                         websocketpp::lib::asio::ssl::context::no_sslv2 |
+                         websocketpp::lib::asio::ssl::context::no_sslv3 |
+                         websocketpp::lib::asio::ssl::context::single_dh_use);
+        ctx->set_verify_mode(websocketpp::lib::asio::ssl::verify_none);
+        return ctx;
+    });
+
+    error_code ec;
+    openConnection(ec);
+    if (ec) {
+        throw std::runtime_error("Could not create connection: " + ec.message());
+    }
+
+    if (!cfg.capturePath.empty()) {
+        capture = std::make_unique<JournalWriter>(cfg.capturePath, cfg.capture);
+    }
+    if (cfg.session.barInterval.count() > 0) {
+        gaps = std::make_unique<GapDetector>(cfg.session.barInterval, cfg.session.maxHeldBars);
+        backfill = std::make_unique<BarBackfill>(cfg.session, ALPACA_API_KEY, ALPACA_API_SECRET_KEY);
+        backfill->start([this](const BarGap& gap, std::vector<CompactBar> bars) { onBackfill(gap, std::move(bars)); });
+    }
+
+    closing = false;
+    // Keeps run() going between a close and the reconnect.
+    endpoint.start_perpetual();
+    thread = std::thread([this]() {
+        placeThisThread("feed-" + cfg.name, cfg.thread);
+        endpoint.run();
+    });
+}
+
+void MarketFeed::openConnection(error_code& ec) {
+    endpoint_type::connection_ptr con = endpoint.get_connection(cfg.uri, ec);
+    if (ec) return;
+    if (cfg.session.pingInterval.count() > 0) {
+        con->set_pong_timeout(cfg.session.pongTimeout.count());
+        // A dead peer will not answer the close either.
+        con->set_close_handshake_timeout(cfg.session.pongTimeout.count());
+    }
+    endpoint.connect(con);
+}
+
+void MarketFeed::disconnect() {
+    closing = true;
+    endpoint.stop_perpetual();
+    if (thread.joinable()) {
+        boost::asio::post(endpoint.get_io_service(), [this]() {
+            if (reconnectTimer) reconnectTimer->cancel();
+            if (pingTimer) pingTimer->cancel();
+        });
+    }
+    if (connected.exchange(false)) {
+        error_code ec;
+        endpoint.close(hdl, websocketpp::close::status::normal, "Client disconnecting", ec);
+    }
+}
+
+void MarketFeed::post(std::function<void()> task) {
+    if (thread.joinable()) {
+        boost::asio::post(endpoint.get_io_service(), std::move(task));
+    } else {
+        task();
+    }
+}
+
+FeedSessionStats MarketFeed::stats() const {
+    FeedSessionStats stats;
+    if (gaps) gaps->stats(stats);
+    stats.connects = connects.load(std::memory_order_relaxed);
+    stats.reconnects = reconnects.load(std::memory_order_relaxed);
+    stats.failures = connectFailures.load(std::memory_order_relaxed);
+    stats.pongTimeouts = pongTimeouts.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void MarketFeed::scheduleReconnect() {
+    if (closing) return;
+
+    const std::chrono::milliseconds delay = backoff.next();
+    LOG_WARN("Reconnecting {} feed to {} in {} ms (attempt {}).", cfg.name, cfg.hostname, delay.count(),
+             backoff.attempts());
+    reconnectTimer = endpoint.set_timer(delay.count(), [this](const error_code& ec) {
+        if (ec || closing) return;
+        ++reconnects;
+        error_code connectError;
+        openConnection(connectError);
+        if (connectError) {
+            LOG_ERROR("Could not create connection: {}", connectError.message());
+            scheduleReconnect();
+        }
+    });
+}
+
+void MarketFeed::schedulePing(uint64_t session) {
+    if (cfg.session.pingInterval.count() <= 0) return;
+
+    pingTimer = endpoint.set_timer(cfg.session.pingInterval.count(), [this, session](const error_code& ec) {
+        if (ec || session != sessionId || !connected) return;
+        error_code pingError;
+        endpoint.ping(hdl, "", pingError);
+        if (pingError) {
+            LOG_WARN("Ping failed: {}", pingError.message());
+        }
+        schedulePing(session);
+    });
+}
+
+void MarketFeed::resubscribe() {
+    const string message = subscriptions.subscribeMessage();
+    if (message.empty()) return;
+
+    error_code ec;
+    endpoint.send(hdl, message, websocketpp::frame::opcode::text, ec);
+    if (ec) {
+        LOG_ERROR("Cannot resubscribe: {}", ec.message());
+        return;
+    }
+    LOG_INFO("Resubscribed {} feed: {}", cfg.name, message);
+}
+
+void MarketFeed::authenticate() {
+    if (connected) {
+        json j;
+        j["action"] = "auth";
+        j["key"]    = ALPACA_API_KEY;
+        j["secret"] = ALPACA_API_SECRET_KEY;
+
+        string message = j.dump();
+        endpoint.send(hdl, message, websocketpp::frame::opcode::text);
+        LOG_INFO("Sent authentication message to Alpaca on the {} feed.", cfg.name);
+    } else {
+        LOG_ERROR("Cannot authenticate; {} feed is not connected.", cfg.name);
+    }
+}
+
+void MarketFeed::subscribe(FeedChannel channel, const std::vector<string>& symbols) {
+    sendSubscription(true, channel, symbols);
+}
+
+void MarketFeed::unsubscribe(FeedChannel channel, const std::vector<string>& symbols) {
+    sendSubscription(false, channel, symbols);
+}
+
+bool MarketFeed::carries(std::string_view symbol, FeedChannel channel) const {
+    if (assetClassOf(symbol) != cfg.assetClass) return false;
+    return channel != FeedChannel::OrderBooks || cfg.assetClass == AssetClass::Crypto;
+}
+
+void MarketFeed::sendSubscription(bool subscribe, FeedChannel channel, const std::vector<string>& symbols) {
+    const char* action = subscribe ? "subscribe" : "unsubscribe";
+    const char* name = toString(channel);
+    if (subscribe) {
+        subscriptions.add(name, symbols);
+    } else {
+        subscriptions.remove(name, symbols);
+    }
+    if (!connected) {
+        LOG_WARN("{} feed not connected; the {} {} takes effect once the session is re-established.", cfg.name,
+                 name, action);
+        return;
+    }
+
+    json j;
+    j["action"] = action;
+    j[name]     = symbols;
+
+    string message = j.dump();
+    endpoint.send(hdl, message, websocketpp::frame::opcode::text);
+
+    if (subscribe) {
+        LOG_INFO("Sent subscription message: {}", message);
+        return;
+    }
+
+    for (auto &sym : symbols) {
+        LOG_INFO("Unsubscribed from {} for symbol {}", name, sym);
+    }
+}
+
+void MarketFeed::onOpen(websocketpp::connection_hdl handle) {
+    hdl = handle;
+    connected = true;
+    ++connects;
+    // disconnect() found nothing to close while this session was still
+    // connecting; whichever side takes connected closes it.
+    if (closing) {
+        if (connected.exchange(false)) {
+            error_code ec;
+            endpoint.close(handle, websocketpp::close::status::normal, "Client disconnecting", ec);
+        }
+        return;
+    }
+    schedulePing(++sessionId);
+    LOG_INFO("{} feed connection opened.", cfg.name);
+
+    if (resumeSession) {
+        authenticate();
+        return;
+    }
+    listener.onFeedOpen(*this);
+}
+
+void MarketFeed::onClose(websocketpp::connection_hdl) {
+    connected = false;
+    ++sessionId;
+    LOG_INFO("{} feed connection closed.", cfg.name);
+    scheduleReconnect();
+}
+
+void MarketFeed::onFail(websocketpp::connection_hdl) {
+    ++connectFailures;
+    LOG_ERROR("{} feed connection failed.", cfg.name);
+    scheduleReconnect();
+}
+
+void MarketFeed::onPongTimeout(websocketpp::connection_hdl handle, string) {
+    ++pongTimeouts;
+    LOG_WARN("No pong from {} within {} ms; reconnecting.", cfg.hostname, cfg.session.pongTimeout.count());
+    error_code ec;
+    endpoint.close(handle, websocketpp::close::status::going_away, "Pong timeout", ec);
+}
+
+void MarketFeed::onMessage(websocketpp::connection_hdl, endpoint_type::message_ptr msg) {
+    const uint64_t receiveTicks = latency::now();
+    if (msg->get_opcode() != websocketpp::frame::opcode::text) {
+        LOG_WARN("Received non-text message. (Opcode={}) Ignoring.", static_cast<int>(msg->get_opcode()));
+        return;
+    }
+
+    const std::string& payload = msg->get_payload();
+    if (payload.empty()) {
+        LOG_WARN("Received empty text message. Ignoring.");
+        return;
+    }
+
+    if (capture) {
+        const int64_t receiveNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        capture->append(receiveNs, payload);
+    }
+
+    handleFrame(payload, receiveTicks);
+}
+
+void MarketFeed::handleFrame(std::string_view payload, uint64_t receiveTicks) {
+    // Market data takes the allocation-free path straight to the listener;
+    // control messages and anything the scanner does not recognise fall
+    // through to nlohmann.
+    batch.clear();
+    if (decoder.decode(payload, batch) == DecodeStatus::Ok) {
+        latency::record(latency::Stage::Decode, receiveTicks, latency::now());
+        publishBatch(batch, receiveTicks);
+        return;
+    }
+
+    handleJsonMessage(string(payload));
+}
+
+void MarketFeed::handleJsonMessage(const string& payload) {
+    events.clear();
+    try {
+        auto response = json::parse(payload);
+
+        if (response.is_array()) {
+            for (const auto& elem : response) {
+                if (elem.is_object()) {
+                    if (elem.value("T", "") == "success" && elem.value("msg", "") == "authenticated") {
+                        LOG_INFO("Authentication successful on the {} feed.", cfg.name);
+                        backoff.reset();
+                        resubscribe();
+                        if (resumeSession)
+                            return;
+                        resumeSession = true;
+                        listener.onFeedAuthenticated(*this);
+                        return;
+                    }
+
+                    if(elem.value("T", "") == "subscription") {
+                        LOG_INFO("Subscription successful for symbols: {}", elem.dump());
+                        listener.onFeedSubscribed(*this);
+                        return;
+                    }
+
+                    const string type = elem.value("T", "");
+                    if (type == "b") {
+                        appendBar(Bar(elem).toCompact(), 0);
+                    } else if (type == "u" || type == "d") {
+                        append(MarketEvent::of(Bar(elem).toCompact(),
+                                               type == "u" ? EventType::UpdatedBar : EventType::DailyBar), 0);
+                    } else {
+                        LOG_WARN("Unknown JSON object in array: {}", elem.dump());
+                    }
+                } else {
+                    LOG_WARN("Non-object JSON in array: {}", elem.dump());
+                }
+            }
+            deliver();
+        }
+        else if (response.is_object()) {
+            if (response.value("T", "") == "b") {
+                Bar bar(response);
+                LOG_INFO("Single bar received: symbol={} open={} close={} time={}", bar.S, bar.o, bar.c, bar.t);
+            } else if (response.value("T", "") == "subscription") {
+                LOG_INFO("Subscription successful for symbols: {}", response.dump());
+                listener.onFeedSubscribed(*this);
+            } else {
+                LOG_WARN("Received object: {}", response.dump());
+            }
+        }
+        else {
+            LOG_WARN("Received non-object, non-array JSON: {}", response.dump());
+        }
+    } catch (const std::exception& e) {
+        events.clear();
+        LOG_ERROR("Failed to parse JSON message: {} Payload was: {}", e.what(), payload);
+    }
+}
+
+void MarketFeed::append(MarketEvent event, uint64_t receiveTicks) {
+    event.feed = index;
+    event.receiveTicks = receiveTicks;
+    events.push_back(event);
+}
+
+void MarketFeed::appendBar(const CompactBar& bar, uint64_t receiveTicks) {
+    if (!gaps) {
+        append(MarketEvent::of(bar), receiveTicks);
+        return;
+    }
+
+    BarGap gap;
+    releasedBars.clear();
+    if (gaps->onBar(bar, releasedBars, gap)) {
+        LOG_WARN("Gap of {} {} bars after {}; backfilling.", gap.missing(),
+                 SymbolTable::get_instance().name(gap.symbolId), FeedDecoder::formatTimestamp(gap.afterNs));
+        backfill->request(gap);
+    }
+    for (const CompactBar& ready : releasedBars) {
+        append(MarketEvent::of(ready), ready.timestampNs == bar.timestampNs ? receiveTicks : 0);
+    }
+}
+
+void MarketFeed::publishBatch(const DecodedBatch& decoded, uint64_t receiveTicks) {
+    // Walk the records in the order the frame carried them.
+    size_t bar = 0, updatedBar = 0, dailyBar = 0, trade = 0, quote = 0, level = 0;
+    events.clear();
+    for (EventType type : decoded.order) {
+        switch (type) {
+        case EventType::Bar:
+            appendBar(decoded.bars[bar++], receiveTicks);
+            break;
+        case EventType::UpdatedBar:
+            append(MarketEvent::of(decoded.updatedBars[updatedBar++], EventType::UpdatedBar), receiveTicks);
+            break;
+        case EventType::DailyBar:
+            append(MarketEvent::of(decoded.dailyBars[dailyBar++], EventType::DailyBar), receiveTicks);
+            break;
+        case EventType::Trade:
+            append(MarketEvent::of(decoded.trades[trade++]), receiveTicks);
+            break;
+        case EventType::Quote:
+            append(MarketEvent::of(decoded.quotes[quote++]), receiveTicks);
+            break;
+        case EventType::BookLevel:
+            append(MarketEvent::of(decoded.bookLevels[level++]), receiveTicks);
+            break;
+        }
+    }
+    deliver();
+}
+
+void MarketFeed::onBackfill(const BarGap& gap, std::vector<CompactBar> bars) {
+    // The listener only ever hears from the websocket thread.
+    boost::asio::post(endpoint.get_io_service(), [this, gap, bars = std::move(bars)]() mutable {
+        const size_t found = bars.size();
+        releasedBars.clear();
+        gaps->complete(gap, std::move(bars), releasedBars);
+        LOG_INFO("Backfilled {} of {} missing {} bars.", found, gap.missing(),
+                 SymbolTable::get_instance().name(gap.symbolId));
+        events.clear();
+        for (const CompactBar& ready : releasedBars) {
+            append(MarketEvent::of(ready), 0);
+        }
+        deliver();
+    });
+}
+
+void MarketFeed::deliver() {
+    if (!events.empty()) {
+        listener.onFeedEvents(*this, events.data(), events.size());
+    }
+    events.clear();
+}
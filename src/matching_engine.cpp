@@ -0,0 +1,170 @@
+#include "matching_engine.h"
+
+#include <algorithm>
+
+const char* toString(SimOrderStatus status) {
+    switch (status) {
+    case SimOrderStatus::New: return "new";
+    case SimOrderStatus::PartiallyFilled: return "partially_filled";
+    case SimOrderStatus::Filled: return "filled";
+    case SimOrderStatus::Canceled: return "canceled";
+    case SimOrderStatus::Rejected: return "rejected";
+    }
+    return "unknown";
+}
+
+MatchingEngine::Book& MatchingEngine::book(uint32_t symbolId) {
+    return books[symbolId];
+}
+
+SimOrder& MatchingEngine::store(SimOrder order) {
+    order.id = nextId++;
+    return orders.emplace(order.id, std::move(order)).first->second;
+}
+
+const SimOrder& MatchingEngine::submit(SimOrder incoming, std::vector<SimFill>& fills) {
+    SimOrder& order = store(std::move(incoming));
+    ++counters.orders;
+
+    if (order.quantity <= 0 || (order.type == OrderType::Limit && order.limitPrice <= 0)) {
+        order.status = SimOrderStatus::Rejected;
+        ++counters.rejects;
+        return order;
+    }
+
+    Book& b = book(order.symbolId);
+    match(order, order.side == OrderSide::Buy ? b.asks : b.bids, order.createdNs, fills);
+
+    if (order.remaining() == 0) {
+        order.status = SimOrderStatus::Filled;
+    } else if (order.type == OrderType::Limit && order.timeInForce != TimeInForce::Ioc) {
+        order.status = order.filledQuantity ? SimOrderStatus::PartiallyFilled : SimOrderStatus::New;
+        rest(order, order.side == OrderSide::Buy ? b.bids : b.asks);
+    } else {
+        order.status = SimOrderStatus::Canceled;
+        ++counters.cancels;
+    }
+    return order;
+}
+
+void MatchingEngine::match(SimOrder& taker, Side& opposite, int64_t timestampNs, std::vector<SimFill>& fills) {
+    while (taker.remaining() > 0 && !opposite.levels.empty()) {
+        Level& level = opposite.levels.back();
+        // A buy limit takes asks up to its price, a sell limit bids down to it.
+        if (taker.type == OrderType::Limit && opposite.worse(level.price, taker.limitPrice)) {
+            break;
+        }
+
+        while (taker.remaining() > 0 && !level.queue.empty()) {
+            SimOrder& maker = orders.at(level.queue.front());
+            const int64_t quantity = std::min(taker.remaining(), maker.remaining());
+
+            taker.filledQuantity += quantity;
+            taker.filledNotional += static_cast<double>(level.price) * static_cast<double>(quantity);
+            maker.filledQuantity += quantity;
+            maker.filledNotional += static_cast<double>(level.price) * static_cast<double>(quantity);
+            fills.push_back(SimFill{taker.id, maker.id, taker.symbolId, taker.side, level.price, quantity, timestampNs});
+            ++counters.fills;
+
+            if (maker.remaining() == 0) {
+                maker.status = SimOrderStatus::Filled;
+                level.queue.pop_front();
+            } else {
+                maker.status = SimOrderStatus::PartiallyFilled;
+            }
+        }
+
+        if (level.queue.empty()) {
+            opposite.levels.pop_back();
+        }
+    }
+}
+
+void MatchingEngine::rest(SimOrder& order, Side& side) {
+    auto it = std::upper_bound(side.levels.begin(), side.levels.end(), order.limitPrice,
+                               [&side](int64_t price, const Level& level) { return side.worse(price, level.price); });
+    if (it != side.levels.begin() && (it - 1)->price == order.limitPrice) {
+        (it - 1)->queue.push_back(order.id);
+    } else {
+        side.levels.insert(it, Level{order.limitPrice, {order.id}});
+    }
+}
+
+void MatchingEngine::removeFromBook(const SimOrder& order) {
+    Book& b = book(order.symbolId);
+    Side& side = order.side == OrderSide::Buy ? b.bids : b.asks;
+    for (auto level = side.levels.begin(); level != side.levels.end(); ++level) {
+        if (level->price != order.limitPrice) continue;
+        auto found = std::find(level->queue.begin(), level->queue.end(), order.id);
+        if (found != level->queue.end()) level->queue.erase(found);
+        if (level->queue.empty()) side.levels.erase(level);
+        return;
+    }
+}
+
+bool MatchingEngine::cancel(uint64_t orderId) {
+    auto it = orders.find(orderId);
+    if (it == orders.end()) return false;
+    SimOrder& order = it->second;
+    if (order.status != SimOrderStatus::New && order.status != SimOrderStatus::PartiallyFilled) return false;
+
+    removeFromBook(order);
+    order.status = SimOrderStatus::Canceled;
+    ++counters.cancels;
+    return true;
+}
+
+const SimOrder* MatchingEngine::find(uint64_t orderId) const {
+    auto it = orders.find(orderId);
+    return it == orders.end() ? nullptr : &it->second;
+}
+
+void MatchingEngine::requote(uint32_t symbolId, int64_t bidPrice, int64_t bidSize, int64_t askPrice, int64_t askSize,
+                             int64_t timestampNs, std::vector<SimFill>& fills) {
+    Book& b = book(symbolId);
+
+    // Pull both old quotes first so the new ones never trade with them.
+    for (uint64_t* slot : {&b.quoteBid, &b.quoteAsk}) {
+        if (*slot == 0) continue;
+        auto it = orders.find(*slot);
+        if (it != orders.end()) {
+            if (it->second.remaining() > 0) removeFromBook(it->second);
+            orders.erase(it);
+        }
+        *slot = 0;
+    }
+
+    auto place = [&](uint64_t& slot, OrderSide side, int64_t price, int64_t size) {
+        if (size <= 0 || price <= 0) return;
+
+        SimOrder quote;
+        quote.symbolId = symbolId;
+        quote.side = side;
+        quote.type = OrderType::Limit;
+        quote.limitPrice = price;
+        quote.quantity = size;
+        quote.createdNs = timestampNs;
+        SimOrder& order = store(std::move(quote));
+
+        match(order, side == OrderSide::Buy ? b.asks : b.bids, timestampNs, fills);
+        if (order.remaining() > 0) {
+            rest(order, side == OrderSide::Buy ? b.bids : b.asks);
+            slot = order.id;
+        } else {
+            orders.erase(order.id);
+        }
+    };
+
+    place(b.quoteBid, OrderSide::Buy, bidPrice, bidSize);
+    place(b.quoteAsk, OrderSide::Sell, askPrice, askSize);
+}
+
+int64_t MatchingEngine::bestBid(uint32_t symbolId) const {
+    auto it = books.find(symbolId);
+    return it == books.end() || it->second.bids.levels.empty() ? 0 : it->second.bids.levels.back().price;
+}
+
+int64_t MatchingEngine::bestAsk(uint32_t symbolId) const {
+    auto it = books.find(symbolId);
+    return it == books.end() || it->second.asks.levels.empty() ? 0 : it->second.asks.levels.back().price;
+}
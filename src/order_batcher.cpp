@@ -0,0 +1,146 @@
+#include "order_batcher.h"
+
+#include <algorithm>
+
+#include "fixed_point.h"
+#include "risk.h"
+#include "symbol_table.h"
+
+namespace {
+    // Orders that may share a request: same symbol, type, time in force and
+    // limit price.
+    bool sameGroup(const Order& a, const Order& b) {
+        return a.symbolId == b.symbolId && a.type == b.type && a.time_in_force == b.time_in_force &&
+               a.limit_price == b.limit_price;
+    }
+
+    // The order a group becomes, for the risk checks.
+    OrderIntent mergedIntent(const Order& first, int64_t net) {
+        const SymbolTable& table = SymbolTable::get_instance();
+        OrderIntent intent{};
+        intent.symbolId = first.symbolId;
+        intent.strategyId = first.strategyId;
+        intent.side = net > 0 ? OrderSide::Buy : OrderSide::Sell;
+        intent.type = first.type == "limit" ? OrderType::Limit : OrderType::Market;
+        intent.timeInForce = first.time_in_force == "ioc" ? TimeInForce::Ioc
+                           : first.time_in_force == "day" ? TimeInForce::Day
+                           : TimeInForce::Gtc;
+        intent.quantity = net > 0 ? net : -net;
+        if (intent.type == OrderType::Limit) {
+            fixed_point::parse(first.limit_price, table.priceDecimals(first.symbolId), intent.limitPrice);
+        }
+        return intent;
+    }
+}
+
+bool OrderBatchConfig::coalesces(uint16_t strategyId) const {
+    return allStrategies || std::find(strategies.begin(), strategies.end(), strategyId) != strategies.end();
+}
+
+OrderBatcher::OrderBatcher(const OrderBatchConfig& config) : settings(config) {}
+
+void OrderBatcher::configure(const OrderBatchConfig& config) {
+    settings = config;
+}
+
+size_t OrderBatcher::coalesce(vector<Order>& orders, const RiskGate* risk) {
+    if (orders.empty()) return 0;
+    batches.fetch_add(1, std::memory_order_relaxed);
+    ordersIn.fetch_add(orders.size(), std::memory_order_relaxed);
+
+    const SymbolTable& table = SymbolTable::get_instance();
+    candidates.clear();
+    for (size_t i = 0; i < orders.size(); ++i) {
+        const Order& order = orders[i];
+        if (order.symbolId == UINT32_MAX || !settings.coalesces(order.strategyId)) continue;
+        int64_t quantity;
+        if (!fixed_point::parse(order.qty, table.sizeDecimals(order.symbolId), quantity) || quantity <= 0) continue;
+        candidates.push_back(Candidate{static_cast<uint32_t>(i), order.side == "sell" ? -quantity : quantity});
+    }
+
+    // Groups end up contiguous, each in arrival order. std::sort works in
+    // place, so this does not allocate either.
+    std::sort(candidates.begin(), candidates.end(), [&orders](const Candidate& a, const Candidate& b) {
+        const Order& x = orders[a.index];
+        const Order& y = orders[b.index];
+        if (x.symbolId != y.symbolId) return x.symbolId < y.symbolId;
+        if (x.type != y.type) return x.type < y.type;
+        if (x.time_in_force != y.time_in_force) return x.time_in_force < y.time_in_force;
+        if (x.limit_price != y.limit_price) return x.limit_price < y.limit_price;
+        return a.index < b.index;
+    });
+
+    dropped.assign(orders.size(), 0);
+    size_t removed = 0;
+    for (size_t begin = 0; begin < candidates.size();) {
+        Order& first = orders[candidates[begin].index];
+        size_t end = begin + 1;
+        while (end < candidates.size() && sameGroup(first, orders[candidates[end].index])) ++end;
+        if (end - begin == 1) {
+            begin = end;
+            continue;
+        }
+
+        int64_t net = 0;
+        for (size_t i = begin; i < end; ++i) {
+            net += candidates[i].quantity;
+        }
+        const size_t members = end - begin;
+        if (net != 0 && risk && risk->checkOrder(mergedIntent(first, net)) != RiskReject::None) {
+            overLimit.fetch_add(members, std::memory_order_relaxed);
+            begin = end;
+            continue;
+        }
+
+        uint64_t receiveTicks = first.receiveTicks;
+        uint64_t decisionTicks = first.decisionTicks;
+        for (size_t i = begin; i < end; ++i) {
+            const Order& order = orders[candidates[i].index];
+            if (order.receiveTicks != 0 && (receiveTicks == 0 || order.receiveTicks < receiveTicks)) {
+                receiveTicks = order.receiveTicks;
+            }
+            decisionTicks = std::max(decisionTicks, order.decisionTicks);
+            if (i != begin) dropped[candidates[i].index] = 1;
+        }
+
+        if (net == 0) {
+            dropped[candidates[begin].index] = 1;
+            netted.fetch_add(members, std::memory_order_relaxed);
+            removed += members;
+        } else {
+            char qty[32];
+            char* qtyEnd = fixed_point::toChars(qty, qty + sizeof(qty), net > 0 ? net : -net,
+                                                table.sizeDecimals(first.symbolId));
+            if (qtyEnd) first.qty.assign(qty, qtyEnd);
+            first.side = net > 0 ? "buy" : "sell";
+            first.receiveTicks = receiveTicks;
+            first.decisionTicks = decisionTicks;
+            coalesced.fetch_add(members - 1, std::memory_order_relaxed);
+            removed += members - 1;
+        }
+        begin = end;
+    }
+
+    if (removed != 0) {
+        size_t kept = 0;
+        for (size_t i = 0; i < orders.size(); ++i) {
+            if (dropped[i]) continue;
+            if (kept != i) orders[kept] = std::move(orders[i]);
+            ++kept;
+        }
+        orders.erase(orders.begin() + static_cast<std::ptrdiff_t>(kept), orders.end());
+    }
+    requestsOut.fetch_add(orders.size(), std::memory_order_relaxed);
+    return removed;
+}
+
+OrderBatchStats OrderBatcher::stats() const {
+    OrderBatchStats s;
+    s.batches = batches.load(std::memory_order_relaxed);
+    s.ordersIn = ordersIn.load(std::memory_order_relaxed);
+    s.requestsOut = requestsOut.load(std::memory_order_relaxed);
+    s.coalesced = coalesced.load(std::memory_order_relaxed);
+    s.netted = netted.load(std::memory_order_relaxed);
+    s.overLimit = overLimit.load(std::memory_order_relaxed);
+    return s;
+}
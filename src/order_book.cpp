@@ -0,0 +1,100 @@
+#include "order_book.h"
+
+#include <algorithm>
+
+BookSide::BookSide(bool bids, size_t reserve) : bids(bids) {
+    levels.reserve(reserve);
+}
+
+void BookSide::set(int64_t price, int64_t size) {
+    // Search from the top down: updates cluster around the best price.
+    size_t i = levels.size();
+    while (i > 0 && worse(price, levels[i - 1].price)) {
+        --i;
+        if (levels.size() - i == 8) {
+            i = std::upper_bound(levels.begin(), levels.begin() + i, price, [this](int64_t p, const BookLevel& level) {
+                return worse(p, level.price);
+            }) - levels.begin();
+            break;
+        }
+    }
+    // Every level from i up is better than price; levels[i - 1] is not.
+    if (i > 0 && levels[i - 1].price == price) {
+        if (size == 0) {
+            levels.erase(levels.begin() + (i - 1));
+        } else {
+            levels[i - 1].size = size;
+        }
+        return;
+    }
+    if (size == 0) return;
+    levels.insert(levels.begin() + i, BookLevel{price, size});
+}
+
+size_t BookSide::depth(BookLevel* out, size_t n) const {
+    size_t count = std::min(n, levels.size());
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = levels[levels.size() - 1 - i];
+    }
+    return count;
+}
+
+OrderBook::OrderBook(uint32_t symbolId) : symbolId(symbolId), bidSide(true), askSide(false) {}
+
+void OrderBook::apply(const BookLevelUpdate& update) {
+    if (update.flags & BookLevelUpdate::BOOK_RESET) {
+        clear();
+    }
+    if (update.side == 'b') {
+        bidSide.set(update.price, update.size);
+    } else if (update.side == 'a') {
+        askSide.set(update.price, update.size);
+    }
+    timestampNs = update.timestampNs;
+    ++updates;
+}
+
+void OrderBook::clear() {
+    bidSide.clear();
+    askSide.clear();
+}
+
+int64_t OrderBook::spread() const {
+    const BookLevel* bid = bestBid();
+    const BookLevel* ask = bestAsk();
+    return bid && ask ? ask->price - bid->price : 0;
+}
+
+int64_t OrderBook::mid() const {
+    const BookLevel* bid = bestBid();
+    const BookLevel* ask = bestAsk();
+    return bid && ask ? bid->price + (ask->price - bid->price) / 2 : 0;
+}
+
+const OrderBook* OrderBookSet::apply(const BookLevelUpdate& update) {
+    OrderBook& target = book(update.symbolId);
+    target.apply(update);
+    return (update.flags & BookLevelUpdate::BOOK_END) ? &target : nullptr;
+}
+
+OrderBook& OrderBookSet::book(uint32_t symbolId) {
+    if (symbolId >= books.size()) {
+        books.resize(symbolId + 1);
+    }
+    if (!books[symbolId]) {
+        books[symbolId] = std::make_unique<OrderBook>(symbolId);
+    }
+    return *books[symbolId];
+}
+
+const OrderBook* OrderBookSet::find(uint32_t symbolId) const {
+    return symbolId < books.size() ? books[symbolId].get() : nullptr;
+}
+
+void OrderBookSet::moveSymbol(uint32_t symbolId, OrderBookSet& to) {
+    if (symbolId >= books.size() || !books[symbolId]) return;
+    if (symbolId >= to.books.size()) {
+        to.books.resize(symbolId + 1);
+    }
+    to.books[symbolId] = std::move(books[symbolId]);
+}
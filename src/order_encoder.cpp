@@ -0,0 +1,188 @@
+#include "order_encoder.h"
+
+#include <charconv>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include "fixed_point.h"
+#include "symbol_table.h"
+
+namespace {
+    constexpr std::string_view SYMBOL = "{\"symbol\":\"";
+    constexpr std::string_view QTY = "\",\"qty\":\"";
+    constexpr std::string_view SIDE = "\",\"side\":\"";
+    constexpr std::string_view TYPE = "\",\"type\":\"";
+    constexpr std::string_view TIME_IN_FORCE = "\",\"time_in_force\":\"";
+    constexpr std::string_view LIMIT_PRICE = "\",\"limit_price\":\"";
+    constexpr std::string_view CLIENT_ORDER_ID = "\",\"client_order_id\":\"";
+    constexpr std::string_view END = "\"}";
+
+    class Cursor {
+    public:
+        Cursor(char* first, char* last) : p(first), last(last) {}
+
+        void put(std::string_view text) {
+            if (!p || static_cast<size_t>(last - p) < text.size()) {
+                p = nullptr;
+                return;
+            }
+            std::memcpy(p, text.data(), text.size());
+            p += text.size();
+        }
+
+        void put(uint64_t value) {
+            if (!p) return;
+            auto result = std::to_chars(p, last, value);
+            p = result.ec == std::errc() ? result.ptr : nullptr;
+        }
+
+        char* end() const { return p; }
+
+    private:
+        char* p;
+        char* last;
+    };
+
+    size_t digits(uint64_t value) {
+        size_t n = 1;
+        while (value >= 10) {
+            value /= 10;
+            ++n;
+        }
+        return n;
+    }
+}
+
+OrderEncoder::OrderEncoder(const string& host, const string& apiKey, const string& apiSecretKey,
+                           const string& clientIdPrefix)
+    : prefix(clientIdPrefix) {
+    head = "POST /v2/orders HTTP/1.1\r\n"
+           "Host: " + host + "\r\n"
+           "User-Agent: HFTEngine\r\n"
+           "APCA-API-KEY-ID: " + apiKey + "\r\n"
+           "APCA-API-SECRET-KEY: " + apiSecretKey + "\r\n"
+           "Content-Type: application/json\r\n"
+           "Connection: keep-alive\r\n"
+           "Content-Length: ";
+    if (head.size() > EncodedOrder::CAPACITY / 2) {
+        throw std::runtime_error("Order request headers do not fit the encode buffer");
+    }
+
+    if (prefix.empty()) {
+        const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        prefix = "hft-" + std::to_string(now) + "-";
+    }
+}
+
+string OrderEncoder::clientOrderId(uint64_t id) const {
+    return prefix + std::to_string(id);
+}
+
+OrderIntent roundToRules(const OrderIntent& intent) {
+    const SymbolInfo& info = SymbolTable::get_instance().info(intent.symbolId);
+    OrderIntent rounded = intent;
+    if (info.lotSize > 0) rounded.quantity -= rounded.quantity % info.lotSize;
+    if (info.tickSize > 0 && intent.type == OrderType::Limit) {
+        const int64_t offTick = rounded.limitPrice % info.tickSize;
+        if (offTick != 0) {
+            rounded.limitPrice -= offTick;
+            if (intent.side == OrderSide::Sell) rounded.limitPrice += info.tickSize;
+        }
+    }
+    return rounded;
+}
+
+Order makeOrder(const OrderIntent& requested) {
+    const SymbolTable& table = SymbolTable::get_instance();
+    const OrderIntent intent = roundToRules(requested);
+
+    char qty[32];
+    char* qtyEnd = fixed_point::toChars(qty, qty + sizeof(qty), intent.quantity, table.sizeDecimals(intent.symbolId));
+    if (!qtyEnd) qtyEnd = qty;
+
+    const char* timeInForce = "gtc";
+    if (intent.timeInForce == TimeInForce::Ioc) timeInForce = "ioc";
+    if (intent.timeInForce == TimeInForce::Day) timeInForce = "day";
+
+    Order order(string(table.orderSymbol(intent.symbolId)), string(qty, qtyEnd), intent.side == OrderSide::Buy ? "buy" : "sell",
+                intent.type == OrderType::Limit ? "limit" : "market", timeInForce);
+    order.symbolId = intent.symbolId;
+    order.strategyId = intent.strategyId;
+    if (intent.type == OrderType::Limit) {
+        char price[32];
+        char* priceEnd = fixed_point::toChars(price, price + sizeof(price), intent.limitPrice,
+                                              table.priceDecimals(intent.symbolId));
+        if (priceEnd) order.limit_price.assign(price, priceEnd);
+    }
+    return order;
+}
+
+bool OrderEncoder::encode(const OrderIntent& requested, uint64_t clientOrderId, EncodedOrder& out) const {
+    const SymbolTable& table = SymbolTable::get_instance();
+    const OrderIntent intent = roundToRules(requested);
+
+    char qty[32];
+    char* qtyEnd = fixed_point::toChars(qty, qty + sizeof(qty), intent.quantity, table.sizeDecimals(intent.symbolId));
+    char price[32];
+    char* priceEnd = price;
+    if (intent.type == OrderType::Limit) {
+        priceEnd = fixed_point::toChars(price, price + sizeof(price), intent.limitPrice,
+                                        table.priceDecimals(intent.symbolId));
+    }
+    if (!qtyEnd || !priceEnd) return false;
+
+    std::string_view timeInForce = "gtc";
+    if (intent.timeInForce == TimeInForce::Ioc) timeInForce = "ioc";
+    if (intent.timeInForce == TimeInForce::Day) timeInForce = "day";
+
+    return assemble(table.orderSymbol(intent.symbolId), std::string_view(qty, static_cast<size_t>(qtyEnd - qty)),
+                    intent.side == OrderSide::Buy ? "buy" : "sell",
+                    intent.type == OrderType::Limit ? "limit" : "market", timeInForce,
+                    std::string_view(price, static_cast<size_t>(priceEnd - price)), clientOrderId, out);
+}
+
+bool OrderEncoder::encode(const Order& order, uint64_t clientOrderId, EncodedOrder& out) const {
+    return assemble(order.symbol, order.qty, order.side, order.type, order.time_in_force, order.limit_price,
+                    clientOrderId, out);
+}
+
+bool OrderEncoder::assemble(std::string_view symbol, std::string_view qty, std::string_view side,
+                            std::string_view type, std::string_view timeInForce, std::string_view limitPrice,
+                            uint64_t clientOrderId, EncodedOrder& out) const {
+    size_t bodySize = SYMBOL.size() + symbol.size() + QTY.size() + qty.size() + SIDE.size() + side.size() +
+                      TYPE.size() + type.size() + TIME_IN_FORCE.size() + timeInForce.size() +
+                      CLIENT_ORDER_ID.size() + prefix.size() + digits(clientOrderId) + END.size();
+    if (!limitPrice.empty()) bodySize += LIMIT_PRICE.size() + limitPrice.size();
+
+    Cursor cursor(out.data, out.data + EncodedOrder::CAPACITY);
+    cursor.put(head);
+    cursor.put(static_cast<uint64_t>(bodySize));
+    cursor.put("\r\n\r\n");
+    cursor.put(SYMBOL);
+    cursor.put(symbol);
+    cursor.put(QTY);
+    cursor.put(qty);
+    cursor.put(SIDE);
+    cursor.put(side);
+    cursor.put(TYPE);
+    cursor.put(type);
+    cursor.put(TIME_IN_FORCE);
+    cursor.put(timeInForce);
+    if (!limitPrice.empty()) {
+        cursor.put(LIMIT_PRICE);
+        cursor.put(limitPrice);
+    }
+    cursor.put(CLIENT_ORDER_ID);
+    cursor.put(prefix);
+    cursor.put(clientOrderId);
+    cursor.put(END);
+
+    if (!cursor.end()) {
+        out.size = 0;
+        return false;
+    }
+    out.size = static_cast<size_t>(cursor.end() - out.data);
+    return true;
+}
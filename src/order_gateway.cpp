@@ -0,0 +1,521 @@
+#include "order_gateway.h"
+
+#include <stdexcept>
+
+namespace http = boost::beast::http;
+using tcp = boost::asio::ip::tcp;
+
+// Response bodies live in the connection's arena next to their headers.
+typedef http::basic_string_body<char, std::char_traits<char>, ArenaAllocator<char>> ArenaStringBody;
+
+struct OrderGateway::Connection : std::enable_shared_from_this<OrderGateway::Connection> {
+    enum class State { Disconnected, Connecting, Ready };
+
+    explicit Connection(OrderGateway& gateway) : gateway(gateway), watchdog(gateway.ioc) {
+        // Comfortably more than an order response, so the body does not grow
+        // whenever a longer one comes in.
+        response.body.reserve(4096);
+    }
+
+    size_t load() const { return writing.size() + awaiting.size(); }
+
+    void kick() {
+        if (state == State::Disconnected) {
+            if (!writing.empty()) connect();
+            return;
+        }
+        if (state != State::Ready) return;
+
+        if (!writeActive && !writing.empty()) doWrite();
+        if (!readActive && !awaiting.empty()) doRead();
+    }
+
+    void connect() {
+        state = State::Connecting;
+        // Covers the resolve, the connect and the handshake.
+        armDeadline();
+        stream = std::make_shared<https_stream>(gateway.ioc, gateway.sslCtx);
+        ::SSL_set_tlsext_host_name(stream->native_handle(), gateway.cfg.host.c_str());
+        // Asio has OpenSSL free its record buffers whenever they empty, so
+        // every read and write would allocate them again.
+        ::SSL_clear_mode(stream->native_handle(), SSL_MODE_RELEASE_BUFFERS);
+        if (gateway.resumeSession) ::SSL_set_session(stream->native_handle(), gateway.resumeSession);
+
+        if (gateway.endpoints) {
+            onResolved(*gateway.endpoints, stream);
+            return;
+        }
+
+        auto resolver = std::make_shared<tcp::resolver>(gateway.ioc);
+        resolver->async_resolve(gateway.cfg.host, gateway.cfg.port,
+            [self = shared_from_this(), s = stream, resolver](boost::system::error_code ec,
+                                                             tcp::resolver::results_type results) {
+                if (s != self->stream) return;
+                if (ec) return self->fail(ec);
+                self->gateway.endpoints = results;
+                self->onResolved(results, s);
+            });
+    }
+
+    void onResolved(const tcp::resolver::results_type& results, std::shared_ptr<https_stream> s) {
+        boost::beast::get_lowest_layer(*s).async_connect(results,
+            [self = shared_from_this(), s](boost::system::error_code ec, const tcp::endpoint&) {
+                if (s != self->stream) return;
+                if (ec) {
+                    self->gateway.endpoints.reset();
+                    return self->fail(ec);
+                }
+                boost::beast::get_lowest_layer(*s).socket().set_option(tcp::no_delay(true));
+                s->async_handshake(boost::asio::ssl::stream_base::client,
+                    [self, s](boost::system::error_code ec) {
+                        if (s != self->stream) return;
+                        if (ec) return self->fail(ec);
+                        ++self->gateway.connects;
+                        const bool resumed = ::SSL_session_reused(s->native_handle());
+                        if (resumed) ++self->gateway.resumedHandshakes;
+                        self->freshSession = !resumed;
+                        self->lastUsed = std::chrono::steady_clock::now();
+                        self->state = State::Ready;
+                        self->kick();
+                    });
+            });
+    }
+
+    void doWrite() {
+        writeActive = true;
+        auto onWritten = [self = shared_from_this(), s = stream](boost::system::error_code ec, size_t) {
+            if (s != self->stream) return;
+            self->writeActive = false;
+            if (ec) return self->fail(ec);
+            self->writing.front().writtenTicks = latency::now();
+            self->awaiting.push_back(std::move(self->writing.front()));
+            self->writing.pop_front();
+            self->kick();
+        };
+
+        armDeadline();
+        Pending& next = writing.front();
+        next.started = true;
+        if (next.raw) {
+            boost::asio::async_write(*stream, boost::asio::buffer(next.raw->data, next.raw->size),
+                                     bindHandlerMemory(handlerMemory, std::move(onWritten)));
+        } else {
+            http::async_write(*stream, next.req, bindHandlerMemory(handlerMemory, std::move(onWritten)));
+        }
+    }
+
+    void doRead() {
+        readActive = true;
+        // The previous response is done with; its header fields and body
+        // were the only things in the arena.
+        parser.reset();
+        responseArena.reset();
+        parser.emplace(std::piecewise_construct, std::make_tuple(ArenaAllocator<char>(responseArena)),
+                       std::make_tuple(ArenaAllocator<char>(responseArena)));
+        armDeadline();
+        // Reading into the parser rather than a message skips the per-read
+        // state Beast would otherwise allocate to own one.
+        http::async_read(*stream, buffer, *parser, bindHandlerMemory(handlerMemory,
+            [self = shared_from_this(), s = stream](boost::system::error_code ec, size_t) {
+                if (s != self->stream) return;
+                self->readActive = false;
+                if (ec) return self->fail(ec);
+
+                auto& res = self->parser->get();
+                OrderResult& result = self->response;
+                result.ec = {};
+                result.responseTicks = latency::now();
+                result.status = res.result_int();
+                result.body.assign(res.body().data(), res.body().size());
+                bool keepAlive = res.keep_alive();
+
+                Pending done = std::move(self->awaiting.front());
+                self->awaiting.pop_front();
+                result.writtenTicks = done.writtenTicks;
+                result.sent = true;
+                if (done.heartbeat) ++self->gateway.heartbeats;
+                self->lastUsed = std::chrono::steady_clock::now();
+                self->rememberSession();
+                self->finish(done, result);
+
+                // The server will not answer anything pipelined behind this
+                // response.
+                if (!keepAlive) return self->fail(http::error::end_of_stream);
+                self->kick();
+                self->gateway.dispatch();
+            }));
+    }
+
+    // Moves the connection's deadline ioTimeout out. Every connect, write
+    // and read calls it as it starts, so a request or response outstanding
+    // for ioTimeout with nothing new started on the connection fails it.
+    void armDeadline() {
+        deadline = std::chrono::steady_clock::now() + gateway.cfg.ioTimeout;
+        if (!watching) watch();
+    }
+
+    // One timer polices the connection. Arming only moves the deadline and
+    // the timer waits again when it fires early, so steady I/O neither starts
+    // nor cancels waits the way per-operation stream timeouts would.
+    void watch() {
+        watching = true;
+        watchdog.expires_at(deadline);
+        watchdog.async_wait(bindHandlerMemory(handlerMemory, [self = shared_from_this()](boost::system::error_code ec) {
+            self->watching = false;
+            if (ec || self->gateway.closing) return;
+            if (self->state != State::Connecting && !self->writeActive && !self->readActive) return;
+            if (std::chrono::steady_clock::now() < self->deadline) return self->watch();
+            self->fail(boost::beast::error::timeout);
+        }));
+    }
+
+    // Requests that already went out cannot be retried safely, so they fail;
+    // requests still waiting for a healthy socket go back to the gateway
+    // queue. A failed connect fails everything assigned to the connection so
+    // an unreachable host does not spin on reconnects.
+    void fail(boost::system::error_code ec) {
+        if (state != State::Ready || gateway.closing) {
+            while (!writing.empty()) {
+                awaiting.push_back(std::move(writing.front()));
+                writing.pop_front();
+            }
+        } else if (!writing.empty() && writeActive) {
+            awaiting.push_back(std::move(writing.front()));
+            writing.pop_front();
+        }
+        while (!awaiting.empty()) {
+            OrderResult result;
+            result.ec = ec;
+            Pending done = std::move(awaiting.front());
+            awaiting.pop_front();
+            result.writtenTicks = done.writtenTicks;
+            result.sent = done.started;
+            finish(done, result);
+        }
+        while (!writing.empty()) {
+            if (!writing.back().heartbeat) {
+                --gateway.onWire;
+                gateway.queued.push_front(std::move(writing.back()));
+            }
+            writing.pop_back();
+        }
+        reset();
+        gateway.dispatch();
+    }
+
+    // Heartbeats belong to the connection; everything else to a caller.
+    void finish(Pending& done, const OrderResult& result) {
+        if (done.heartbeat) return;
+        --gateway.onWire;
+        gateway.complete(done, result);
+    }
+
+    // TLS 1.3 tickets arrive after the handshake, so a new session is only
+    // resumable once its first response has been read.
+    void rememberSession() {
+        if (!freshSession) return;
+        freshSession = false;
+        SSL_SESSION* fresh = ::SSL_get1_session(stream->native_handle());
+        if (!fresh) return;
+        if (gateway.resumeSession) ::SSL_SESSION_free(gateway.resumeSession);
+        gateway.resumeSession = fresh;
+    }
+
+    // Runs on every heartbeat tick once the gateway is warm.
+    void maintain(std::chrono::steady_clock::time_point now) {
+        if (state == State::Disconnected) return connect();
+        if (state != State::Ready || load() != 0 || now - lastUsed < gateway.cfg.heartbeatInterval) return;
+
+        Pending heartbeat{gateway.heartbeatRequest(), nullptr};
+        heartbeat.heartbeat = true;
+        writing.push_back(std::move(heartbeat));
+        lastUsed = now;
+        kick();
+    }
+
+    void reset() {
+        if (stream) {
+            boost::system::error_code ignored;
+            boost::beast::get_lowest_layer(*stream).socket().close(ignored);
+        }
+        stream.reset();
+        buffer.clear();
+        writeActive = false;
+        readActive = false;
+        state = State::Disconnected;
+    }
+
+    OrderGateway& gateway;
+    State state = State::Disconnected;
+    std::shared_ptr<https_stream> stream;
+    boost::beast::flat_buffer buffer;
+    MonotonicArena responseArena{4096};
+    std::optional<http::response_parser<ArenaStringBody, ArenaAllocator<char>>> parser;
+    // Handed to completion handlers; reused so its body keeps its capacity.
+    OrderResult response;
+    // Backs the connection's reads, writes and deadline waits, at most one
+    // of each outstanding at a time.
+    HandlerMemory handlerMemory;
+    RingQueue<Pending> writing;
+    RingQueue<Pending> awaiting;
+    bool writeActive = false;
+    bool readActive = false;
+    boost::asio::steady_timer watchdog;
+    std::chrono::steady_clock::time_point deadline;
+    bool watching = false;
+    // A full handshake whose session has not been kept for resumption yet.
+    bool freshSession = false;
+    std::chrono::steady_clock::time_point lastUsed;
+};
+
+OrderGateway::OrderGateway(OrderGatewayConfig config)
+    : cfg(std::move(config)),
+      // Enough buffers for a full wire so steady-state encoding never allocates.
+      buffers(cfg.maxInFlight, cfg.maxInFlight),
+      sslCtx(boost::asio::ssl::context::tlsv12_client),
+      heartbeatTimer(ioc) {
+    sslCtx.set_options(boost::asio::ssl::context::default_workarounds |
+                       boost::asio::ssl::context::no_sslv2 |
+                       boost::asio::ssl::context::no_sslv3);
+    if (cfg.verifyPeer) {
+        sslCtx.set_default_verify_paths();
+        sslCtx.set_verify_mode(boost::asio::ssl::verify_peer);
+    } else {
+        sslCtx.set_verify_mode(boost::asio::ssl::verify_none);
+    }
+    ::SSL_CTX_set_session_cache_mode(sslCtx.native_handle(), SSL_SESS_CACHE_CLIENT);
+
+    if (cfg.connections == 0) cfg.connections = 1;
+    if (cfg.maxInFlight == 0) cfg.maxInFlight = 1;
+    if (cfg.pipelineDepth == 0) cfg.pipelineDepth = (cfg.maxInFlight + cfg.connections - 1) / cfg.connections;
+
+    for (size_t i = 0; i < cfg.connections; ++i) {
+        connections.push_back(std::make_shared<Connection>(*this));
+    }
+    // A burst of up to a full wire is handed off without growing them.
+    inbox.reserve(cfg.maxInFlight);
+    draining.reserve(cfg.maxInFlight);
+}
+
+OrderGateway::~OrderGateway() {
+    stop();
+    if (resumeSession) ::SSL_SESSION_free(resumeSession);
+}
+
+void OrderGateway::setCredentials(const string& apiKey, const string& apiSecretKey, const string& clientIdPrefix) {
+    ALPACA_API_KEY = apiKey;
+    ALPACA_API_SECRET_KEY = apiSecretKey;
+    orderEncoder = std::make_unique<OrderEncoder>(cfg.host, apiKey, apiSecretKey, clientIdPrefix);
+}
+
+OrderEncoder& OrderGateway::encoder() {
+    if (!orderEncoder) throw std::runtime_error("Order gateway has no credentials");
+    return *orderEncoder;
+}
+
+EncodedOrderPtr OrderGateway::orderBuffer() {
+    return buffers.acquire();
+}
+
+void OrderGateway::start() {
+    if (ioThread.joinable()) return;
+
+    work.emplace(boost::asio::make_work_guard(ioc));
+    ioThread = std::thread([this]() {
+        placeThisThread("order-gateway", cfg.ioThread);
+        ioc.run();
+    });
+}
+
+void OrderGateway::stop() {
+    if (!ioThread.joinable()) return;
+
+    boost::asio::post(ioc, [this]() {
+        closing = true;
+        warm = false;
+        heartbeatTimer.cancel();
+        for (auto& connection : connections) {
+            connection->fail(boost::asio::error::operation_aborted);
+            connection->watchdog.cancel();
+        }
+        while (!queued.empty()) {
+            OrderResult result;
+            result.ec = boost::asio::error::operation_aborted;
+            complete(queued.front(), result);
+            queued.pop_front();
+        }
+        work.reset();
+    });
+    ioThread.join();
+    ioc.restart();
+    closing = false;
+}
+
+bool OrderGateway::reserve() {
+    size_t limit = cfg.maxInFlight + cfg.maxQueued;
+    size_t current = accepted.load(std::memory_order_relaxed);
+    do {
+        if (current >= limit) {
+            ++rejected;
+            return false;
+        }
+    } while (!accepted.compare_exchange_weak(current, current + 1, std::memory_order_relaxed));
+
+    ++submitted;
+    return true;
+}
+
+bool OrderGateway::submit(http_request req, completion_handler handler) {
+    if (!reserve()) return false;
+
+    req.set(http::field::host, cfg.host);
+    req.set("APCA-API-KEY-ID", ALPACA_API_KEY);
+    req.set("APCA-API-SECRET-KEY", ALPACA_API_SECRET_KEY);
+    req.keep_alive(true);
+
+    handOff(Pending{std::move(req), std::move(handler)});
+    return true;
+}
+
+bool OrderGateway::submit(EncodedOrderPtr&& order, completion_handler handler) {
+    if (!reserve()) return false;
+
+    Pending pending;
+    pending.handler = std::move(handler);
+    pending.raw = std::move(order);
+    handOff(std::move(pending));
+    return true;
+}
+
+std::future<OrderResult> OrderGateway::submit(http_request req) {
+    auto promise = std::make_shared<std::promise<OrderResult>>();
+    std::future<OrderResult> future = promise->get_future();
+
+    bool ok = submit(std::move(req), [promise](const OrderResult& result) {
+        promise->set_value(result);
+    });
+    if (!ok) {
+        OrderResult result;
+        result.ec = boost::asio::error::would_block;
+        promise->set_value(std::move(result));
+    }
+    return future;
+}
+
+void OrderGateway::warmUp() {
+    boost::asio::post(ioc, [this]() {
+        if (closing || warm) return;
+        warm = true;
+        for (auto& connection : connections) {
+            if (connection->state == Connection::State::Disconnected) connection->connect();
+        }
+        scheduleHeartbeat();
+    });
+}
+
+void OrderGateway::scheduleHeartbeat() {
+    heartbeatTimer.expires_after(cfg.heartbeatInterval / 2);
+    heartbeatTimer.async_wait([this](boost::system::error_code ec) {
+        if (ec || !warm) return;
+        const auto now = std::chrono::steady_clock::now();
+        for (auto& connection : connections) {
+            connection->maintain(now);
+        }
+        scheduleHeartbeat();
+    });
+}
+
+http_request OrderGateway::heartbeatRequest() const {
+    http_request req{http::verb::get, cfg.heartbeatTarget, 11};
+    req.set(http::field::host, cfg.host);
+    req.set("APCA-API-KEY-ID", ALPACA_API_KEY);
+    req.set("APCA-API-SECRET-KEY", ALPACA_API_SECRET_KEY);
+    req.keep_alive(true);
+    return req;
+}
+
+void OrderGateway::awaitCapacity() {
+    std::unique_lock<std::mutex> lock(capacityMutex);
+    capacityCV.wait(lock, [this] { return outstanding() < cfg.maxInFlight + cfg.maxQueued; });
+}
+
+void OrderGateway::drain() {
+    std::unique_lock<std::mutex> lock(capacityMutex);
+    capacityCV.wait(lock, [this] { return outstanding() == 0; });
+}
+
+void OrderGateway::handOff(Pending pending) {
+    std::lock_guard<std::mutex> lock(inboxMutex);
+    inbox.push_back(std::move(pending));
+    if (drainPosted) return;
+    drainPosted = true;
+    boost::asio::post(ioc, bindHandlerMemory(drainMemory, [this]() { drainInbox(); }));
+}
+
+void OrderGateway::drainInbox() {
+    {
+        std::lock_guard<std::mutex> lock(inboxMutex);
+        draining.swap(inbox);
+        drainPosted = false;
+    }
+    for (Pending& pending : draining) {
+        if (closing) {
+            OrderResult result;
+            result.ec = boost::asio::error::operation_aborted;
+            complete(pending, result);
+        } else {
+            queued.push_back(std::move(pending));
+        }
+    }
+    draining.clear();
+    dispatch();
+}
+
+void OrderGateway::dispatch() {
+    if (closing) return;
+
+    while (!queued.empty() && onWire < cfg.maxInFlight) {
+        Connection* target = nullptr;
+        for (auto& connection : connections) {
+            if (connection->load() >= cfg.pipelineDepth) continue;
+            if (!target || connection->load() < target->load()) {
+                target = connection.get();
+            }
+        }
+        if (!target) break;
+
+        target->writing.push_back(std::move(queued.front()));
+        queued.pop_front();
+        ++onWire;
+
+        uint64_t peak = peakInFlight.load(std::memory_order_relaxed);
+        if (onWire > peak) peakInFlight.store(onWire, std::memory_order_relaxed);
+
+        target->kick();
+    }
+}
+
+void OrderGateway::complete(Pending& pending, const OrderResult& result) {
+    if (result.ec) ++failed; else ++completed;
+    if (pending.handler) pending.handler(result);
+    pending.raw.reset();
+
+    {
+        std::lock_guard<std::mutex> lock(capacityMutex);
+        accepted.fetch_sub(1, std::memory_order_relaxed);
+    }
+    capacityCV.notify_all();
+}
+
+OrderGatewayStats OrderGateway::stats() const {
+    OrderGatewayStats s;
+    s.submitted = submitted.load();
+    s.completed = completed.load();
+    s.failed = failed.load();
+    s.rejected = rejected.load();
+    s.peakInFlight = peakInFlight.load();
+    s.connects = connects.load();
+    s.resumedHandshakes = resumedHandshakes.load();
+    s.heartbeats = heartbeats.load();
+    return s;
+}
@@ -0,0 +1,413 @@
+#include "order_manager.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <stdexcept>
+
+#include <nlohmann/json.hpp>
+
+#include "fixed_point.h"
+#include "memory_pool.h"
+#include "symbol_table.h"
+
+// Trade update DOMs live in the thread's arena for the length of one frame.
+using json = nlohmann::basic_json<std::map, std::vector, std::string, bool, std::int64_t, std::uint64_t, double,
+                                  ThreadArenaAllocator>;
+
+namespace {
+    // New < Unconfirmed < Accepted < PartiallyFilled < any terminal state.
+    int rank(OrderStatus status) {
+        switch (status) {
+        case OrderStatus::New: return 0;
+        case OrderStatus::Unconfirmed: return 1;
+        case OrderStatus::Accepted: return 2;
+        case OrderStatus::PartiallyFilled: return 3;
+        default: return 4;
+        }
+    }
+
+    bool statusForEvent(const string& event, OrderStatus& out) {
+        if (event == "new" || event == "pending_new" || event == "accepted") out = OrderStatus::Accepted;
+        else if (event == "partial_fill") out = OrderStatus::PartiallyFilled;
+        else if (event == "fill") out = OrderStatus::Filled;
+        else if (event == "canceled" || event == "expired" || event == "done_for_day") out = OrderStatus::Canceled;
+        else if (event == "rejected") out = OrderStatus::Rejected;
+        else return false;
+        return true;
+    }
+
+    // An order's "status" field; states the engine does not track (pending
+    // cancel, stopped, ...) still mean the exchange has the order.
+    OrderStatus statusForOrder(const string& status) {
+        if (status == "partially_filled") return OrderStatus::PartiallyFilled;
+        if (status == "filled") return OrderStatus::Filled;
+        if (status == "canceled" || status == "expired" || status == "done_for_day" || status == "replaced") {
+            return OrderStatus::Canceled;
+        }
+        if (status == "rejected") return OrderStatus::Rejected;
+        return OrderStatus::Accepted;
+    }
+
+    bool parseFixed(const json& object, const char* key, uint8_t decimals, int64_t& out) {
+        auto it = object.find(key);
+        if (it == object.end()) return false;
+        if (it->is_string()) return fixed_point::parse(it->get_ref<const string&>(), decimals, out);
+        if (it->is_number()) return fixed_point::parse(it->dump(), decimals, out);
+        return false;
+    }
+
+    size_t roundUpPow2(size_t n) {
+        size_t p = 1;
+        while (p < n) p <<= 1;
+        return p;
+    }
+}
+
+const char* toString(OrderStatus status) {
+    switch (status) {
+    case OrderStatus::New: return "new";
+    case OrderStatus::Unconfirmed: return "unconfirmed";
+    case OrderStatus::Accepted: return "accepted";
+    case OrderStatus::PartiallyFilled: return "partially_filled";
+    case OrderStatus::Filled: return "filled";
+    case OrderStatus::Canceled: return "canceled";
+    case OrderStatus::Rejected: return "rejected";
+    }
+    return "unknown";
+}
+
+OrderManager::OrderManager(OrderManagerConfig config)
+    : capacity(config.capacity ? config.capacity : 1),
+      // At most half full, so probe sequences stay short.
+      mask(roundUpPow2(capacity * 2) - 1),
+      prefix(std::move(config.clientIdPrefix)),
+      slots(mask + 1),
+      finished(capacity),
+      positions(new PositionSlot[SymbolTable::CAPACITY]) {
+    if (prefix.empty()) {
+        const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::system_clock::now().time_since_epoch()).count();
+        prefix = "hft-" + std::to_string(now) + "-";
+    }
+}
+
+size_t OrderManager::home(uint64_t clientOrderId) const {
+    return static_cast<size_t>((clientOrderId * 0x9E3779B97F4A7C15ULL) >> 32) & mask;
+}
+
+OrderRecord* OrderManager::lookup(uint64_t clientOrderId) {
+    return const_cast<OrderRecord*>(static_cast<const OrderManager*>(this)->lookup(clientOrderId));
+}
+
+const OrderRecord* OrderManager::lookup(uint64_t clientOrderId) const {
+    if (clientOrderId == 0) return nullptr;
+    for (size_t i = home(clientOrderId);; i = (i + 1) & mask) {
+        if (slots[i].clientOrderId == clientOrderId) return &slots[i];
+        if (slots[i].clientOrderId == 0) return nullptr;
+    }
+}
+
+uint64_t OrderManager::insert(OrderRecord record, int64_t reserved) {
+    std::lock_guard<std::mutex> lock(mutex);
+    const bool tracked = record.symbolId < SymbolTable::CAPACITY;
+    if (count == capacity && !evictFinished()) {
+        if (tracked && reserved != 0) adjustOpen(record.symbolId, record.side, -reserved);
+        return 0;
+    }
+
+    record.clientOrderId = nextId++;
+    record.status = OrderStatus::New;
+    size_t i = home(record.clientOrderId);
+    while (slots[i].clientOrderId != 0) i = (i + 1) & mask;
+    slots[i] = record;
+    ++count;
+    ++openCount;
+    ++counters.opened;
+    if (tracked && record.quantity != reserved) adjustOpen(record.symbolId, record.side, record.quantity - reserved);
+    return record.clientOrderId;
+}
+
+void OrderManager::erase(uint64_t clientOrderId) {
+    size_t hole = home(clientOrderId);
+    while (slots[hole].clientOrderId != clientOrderId) {
+        if (slots[hole].clientOrderId == 0) return;
+        hole = (hole + 1) & mask;
+    }
+
+    // Backward shift: pull later entries of the probe run into the hole
+    // unless that would move them before their home slot.
+    for (size_t next = (hole + 1) & mask; slots[next].clientOrderId != 0; next = (next + 1) & mask) {
+        const size_t want = home(slots[next].clientOrderId);
+        const bool movable = hole <= next ? (want <= hole || want > next) : (want <= hole && want > next);
+        if (movable) {
+            slots[hole] = slots[next];
+            hole = next;
+        }
+    }
+    slots[hole] = OrderRecord();
+    --count;
+}
+
+bool OrderManager::evictFinished() {
+    if (finishedCount == 0) return false;
+    erase(finished[finishedHead]);
+    finishedHead = (finishedHead + 1) % capacity;
+    --finishedCount;
+    ++counters.evicted;
+    return true;
+}
+
+uint64_t OrderManager::open(const OrderIntent& intent) {
+    OrderRecord record;
+    record.symbolId = intent.symbolId;
+    record.side = intent.side;
+    record.type = intent.type;
+    record.timeInForce = intent.timeInForce;
+    record.quantity = intent.quantity;
+    record.limitPrice = intent.limitPrice;
+    return insert(record);
+}
+
+uint64_t OrderManager::open(const Order& order) {
+    const SymbolTable& table = SymbolTable::get_instance();
+    OrderRecord record;
+    record.symbolId = order.symbolId;
+    record.side = order.side == "sell" ? OrderSide::Sell : OrderSide::Buy;
+    record.type = order.type == "limit" ? OrderType::Limit : OrderType::Market;
+    if (order.time_in_force == "ioc") record.timeInForce = TimeInForce::Ioc;
+    else if (order.time_in_force == "day") record.timeInForce = TimeInForce::Day;
+
+    if (order.symbolId < table.size()) {
+        fixed_point::parse(order.qty, table.sizeDecimals(order.symbolId), record.quantity);
+        if (!order.limit_price.empty()) {
+            fixed_point::parse(order.limit_price, table.priceDecimals(order.symbolId), record.limitPrice);
+        }
+    }
+    return insert(record, order.reserved);
+}
+
+void OrderManager::reserve(uint32_t symbolId, OrderSide side, int64_t quantity) {
+    if (symbolId >= SymbolTable::CAPACITY || quantity == 0) return;
+    std::lock_guard<std::mutex> lock(mutex);
+    adjustOpen(symbolId, side, quantity);
+}
+
+void OrderManager::release(uint32_t symbolId, OrderSide side, int64_t quantity) {
+    reserve(symbolId, side, -quantity);
+}
+
+bool OrderManager::apply(uint64_t clientOrderId, OrderStatus status, int64_t filledQuantity, int64_t fillPrice) {
+    std::lock_guard<std::mutex> lock(mutex);
+    ++counters.updates;
+    OrderRecord* record = lookup(clientOrderId);
+    if (!record) {
+        ++counters.unknown;
+        return false;
+    }
+
+    // What the order may still add to the position, before and after.
+    auto unfilled = [](const OrderRecord& order) {
+        return isTerminal(order.status) ? int64_t(0) : std::max<int64_t>(order.quantity - order.filledQuantity, 0);
+    };
+    const int64_t openBefore = unfilled(*record);
+
+    // Fills can only grow; a repeated or reordered update adds nothing.
+    const int64_t delta = filledQuantity - record->filledQuantity;
+    if (filledQuantity >= 0 && delta > 0 && !isTerminal(record->status)) {
+        const double notional = static_cast<double>(record->averagePrice) * static_cast<double>(record->filledQuantity) +
+                                static_cast<double>(fillPrice) * static_cast<double>(delta);
+        record->filledQuantity = filledQuantity;
+        record->averagePrice = std::llround(notional / static_cast<double>(filledQuantity));
+        ++counters.fills;
+        if (record->symbolId < SymbolTable::CAPACITY) fill(record->symbolId, record->side, delta, fillPrice);
+    }
+
+    const bool forward = rank(status) > rank(record->status) ||
+                         (status == OrderStatus::PartiallyFilled && record->status == status);
+    if (forward) {
+        record->status = status;
+        if (isTerminal(status)) {
+            --openCount;
+            finished[(finishedHead + finishedCount) % capacity] = clientOrderId;
+            ++finishedCount;
+        }
+    } else {
+        ++counters.stale;
+    }
+
+    // After the fill, so a reader never sees the quantity in neither place.
+    const int64_t openAfter = unfilled(*record);
+    if (openAfter != openBefore && record->symbolId < SymbolTable::CAPACITY) {
+        adjustOpen(record->symbolId, record->side, openAfter - openBefore);
+    }
+    return forward;
+}
+
+// Average cost: adding to a position moves the entry price, reducing it
+// realizes PnL against it, and crossing zero opens the remainder at the
+// fill price. Every position write holds the manager's mutex.
+void OrderManager::fill(uint32_t symbolId, OrderSide side, int64_t quantity, int64_t price) {
+    const SymbolTable& table = SymbolTable::get_instance();
+    PositionSlot& slot = positions[symbolId];
+    int64_t held = slot.quantity.load(std::memory_order_relaxed);
+    int64_t average = slot.averagePrice.load(std::memory_order_relaxed);
+    double realized = slot.realizedPnl.load(std::memory_order_relaxed);
+
+    const int64_t signedQuantity = side == OrderSide::Buy ? quantity : -quantity;
+    if (held == 0 || (held > 0) == (signedQuantity > 0)) {
+        const double notional = static_cast<double>(average) * static_cast<double>(std::abs(held)) +
+                                static_cast<double>(price) * static_cast<double>(quantity);
+        held += signedQuantity;
+        average = std::llround(notional / static_cast<double>(std::abs(held)));
+    } else {
+        const int64_t closed = std::min(std::abs(held), quantity);
+        const double perUnit = fixed_point::toDouble(price - average, table.priceDecimals(symbolId));
+        const double units = fixed_point::toDouble(closed, table.sizeDecimals(symbolId));
+        realized += (held > 0 ? perUnit : -perUnit) * units;
+        held += signedQuantity;
+        if (held == 0) average = 0;
+        else if ((held > 0) == (signedQuantity > 0)) average = price;
+    }
+
+    const uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.quantity.store(held, std::memory_order_relaxed);
+    slot.averagePrice.store(average, std::memory_order_relaxed);
+    slot.realizedPnl.store(realized, std::memory_order_relaxed);
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+void OrderManager::adjustOpen(uint32_t symbolId, OrderSide side, int64_t delta) {
+    PositionSlot& slot = positions[symbolId];
+    std::atomic<int64_t>& open = side == OrderSide::Buy ? slot.openBuy : slot.openSell;
+
+    const uint64_t sequence = slot.sequence.load(std::memory_order_relaxed);
+    slot.sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    open.store(open.load(std::memory_order_relaxed) + delta, std::memory_order_relaxed);
+    slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+Position OrderManager::position(uint32_t symbolId) const {
+    Position out;
+    if (symbolId >= SymbolTable::CAPACITY) return out;
+    const PositionSlot& slot = positions[symbolId];
+    for (;;) {
+        const uint64_t before = slot.sequence.load(std::memory_order_acquire);
+        if (before & 1) continue;
+        out.quantity = slot.quantity.load(std::memory_order_relaxed);
+        out.averagePrice = slot.averagePrice.load(std::memory_order_relaxed);
+        out.realizedPnl = slot.realizedPnl.load(std::memory_order_relaxed);
+        out.openBuy = slot.openBuy.load(std::memory_order_relaxed);
+        out.openSell = slot.openSell.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (slot.sequence.load(std::memory_order_relaxed) == before) return out;
+    }
+}
+
+bool OrderManager::onTradeUpdate(std::string_view frame) {
+    ArenaScope scope;
+    json message = json::parse(frame.begin(), frame.end(), nullptr, false);
+    if (message.is_discarded() || !message.is_object() || message.value("stream", "") != "trade_updates") {
+        return false;
+    }
+    auto data = message.find("data");
+    if (data == message.end() || !data->is_object()) return false;
+    auto order = data->find("order");
+    if (order == data->end() || !order->is_object()) return false;
+
+    OrderStatus status;
+    if (!statusForEvent(data->value("event", ""), status)) return false;
+
+    const uint64_t id = parseClientOrderId(order->value("client_order_id", ""));
+    if (id == 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        ++counters.updates;
+        ++counters.unknown;
+        return false;
+    }
+
+    uint32_t symbolId = SymbolTable::INVALID_ID;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (const OrderRecord* record = lookup(id)) symbolId = record->symbolId;
+    }
+
+    int64_t filled = -1;
+    int64_t price = 0;
+    const bool filling = status == OrderStatus::PartiallyFilled || status == OrderStatus::Filled;
+    if (filling && symbolId < SymbolTable::get_instance().size()) {
+        const SymbolTable& table = SymbolTable::get_instance();
+        if (!parseFixed(*order, "filled_qty", table.sizeDecimals(symbolId), filled)) filled = -1;
+        if (!parseFixed(*data, "price", table.priceDecimals(symbolId), price)) {
+            parseFixed(*order, "filled_avg_price", table.priceDecimals(symbolId), price);
+        }
+    }
+    return apply(id, status, filled, price);
+}
+
+bool OrderManager::onOrder(std::string_view body) {
+    ArenaScope scope;
+    json order = json::parse(body.begin(), body.end(), nullptr, false);
+    if (order.is_discarded() || !order.is_object()) return false;
+
+    const uint64_t id = parseClientOrderId(order.value("client_order_id", ""));
+    if (id == 0) return false;
+    const OrderStatus status = statusForOrder(order.value("status", ""));
+
+    uint32_t symbolId = SymbolTable::INVALID_ID;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (const OrderRecord* record = lookup(id)) symbolId = record->symbolId;
+    }
+
+    // Fills not seen on the stream arrive at the order's average price.
+    int64_t filled = -1;
+    int64_t price = 0;
+    if (symbolId < SymbolTable::get_instance().size()) {
+        const SymbolTable& table = SymbolTable::get_instance();
+        if (!parseFixed(order, "filled_qty", table.sizeDecimals(symbolId), filled) ||
+            !parseFixed(order, "filled_avg_price", table.priceDecimals(symbolId), price)) {
+            filled = -1;
+        }
+    }
+    return apply(id, status, filled, price);
+}
+
+uint64_t OrderManager::parseClientOrderId(std::string_view text) const {
+    if (text.size() <= prefix.size() || text.compare(0, prefix.size(), prefix) != 0) return 0;
+    text.remove_prefix(prefix.size());
+    uint64_t id = 0;
+    auto result = std::from_chars(text.data(), text.data() + text.size(), id);
+    if (result.ec != std::errc() || result.ptr != text.data() + text.size()) return 0;
+    return id;
+}
+
+bool OrderManager::find(uint64_t clientOrderId, OrderRecord& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const OrderRecord* record = lookup(clientOrderId);
+    if (!record) return false;
+    out = *record;
+    return true;
+}
+
+size_t OrderManager::openOrders() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return openCount;
+}
+
+void OrderManager::unconfirmedOrders(std::vector<uint64_t>& out) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const OrderRecord& record : slots) {
+        if (record.clientOrderId != 0 && record.status == OrderStatus::Unconfirmed) out.push_back(record.clientOrderId);
+    }
+}
+
+OrderManagerStats OrderManager::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return counters;
+}
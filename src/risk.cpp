@@ -0,0 +1,168 @@
+#include "risk.h"
+
+#include <cmath>
+#include <limits>
+
+#include "fixed_point.h"
+#include "symbol_table.h"
+#include "tsc.h"
+
+namespace {
+    constexpr double UNLIMITED = std::numeric_limits<double>::infinity();
+
+    double limitOrUnlimited(double limit) {
+        return limit > 0 ? limit : UNLIMITED;
+    }
+
+    constexpr uint32_t bit(RiskReject reason) {
+        return uint32_t(1) << static_cast<unsigned>(reason);
+    }
+}
+
+const char* toString(RiskReject reason) {
+    switch (reason) {
+    case RiskReject::None: return "none";
+    case RiskReject::KillSwitch: return "kill switch";
+    case RiskReject::NoReference: return "no reference price";
+    case RiskReject::OrderSize: return "order size";
+    case RiskReject::Notional: return "notional";
+    case RiskReject::Position: return "position";
+    case RiskReject::PriceBand: return "price band";
+    case RiskReject::RateLimit: return "rate limit";
+    case RiskReject::Count: break;
+    }
+    return "unknown";
+}
+
+void RiskGate::Bucket::set(double perSecond, double burst, double ticksPerSecond) {
+    const uint64_t spacing = perSecond > 0 ? static_cast<uint64_t>(ticksPerSecond / perSecond) : 0;
+    interval.store(spacing, std::memory_order_relaxed);
+    tolerance.store(static_cast<uint64_t>(static_cast<double>(spacing) * (burst > 1 ? burst - 1 : 0)),
+                    std::memory_order_relaxed);
+    arrival.store(0, std::memory_order_relaxed);
+}
+
+bool RiskGate::Bucket::take(uint64_t now) {
+    const uint64_t spacing = interval.load(std::memory_order_relaxed);
+    if (spacing == 0) return true;
+    const uint64_t slack = tolerance.load(std::memory_order_relaxed);
+    uint64_t current = arrival.load(std::memory_order_relaxed);
+    for (;;) {
+        const uint64_t base = current > now ? current : now;
+        if (base - now > slack) return false;
+        if (arrival.compare_exchange_weak(current, base + spacing, std::memory_order_relaxed)) return true;
+    }
+}
+
+void RiskGate::SymbolRisk::set(const RiskLimits& limits, double ticksPerSecond) {
+    maxQuantity.store(limitOrUnlimited(limits.maxOrderQuantity), std::memory_order_relaxed);
+    maxNotional.store(limitOrUnlimited(limits.maxOrderNotional), std::memory_order_relaxed);
+    maxPosition.store(limitOrUnlimited(limits.maxPosition), std::memory_order_relaxed);
+    band.store(limits.priceBandBps > 0 ? limits.priceBandBps / 10000.0 : UNLIMITED, std::memory_order_relaxed);
+    needsReference.store(limits.maxOrderNotional > 0 || limits.priceBandBps > 0, std::memory_order_relaxed);
+    rate.set(limits.ordersPerSecond, limits.burst, ticksPerSecond);
+}
+
+RiskGate::RiskGate(const RiskConfig& config)
+    : capacity(SymbolTable::CAPACITY),
+      ticksPerSecond(1e9 / tsc::nsPerTick()),
+      symbols(new SymbolRisk[SymbolTable::CAPACITY]) {
+    configure(config);
+}
+
+void RiskGate::configure(const RiskConfig& config) {
+    for (size_t i = 0; i < capacity; ++i) {
+        symbols[i].set(config.defaults, ticksPerSecond);
+    }
+    global.set(config.ordersPerSecond, config.burst, ticksPerSecond);
+}
+
+void RiskGate::setLimits(uint32_t symbolId, const RiskLimits& limits) {
+    if (symbolId < capacity) symbols[symbolId].set(limits, ticksPerSecond);
+}
+
+uint32_t RiskGate::orderFailures(const OrderIntent& intent) const {
+    const SymbolTable& table = SymbolTable::get_instance();
+    const SymbolInfo& info = table.info(intent.symbolId);
+    const SymbolRisk& symbol = symbols[intent.symbolId];
+    const double sizeScale = static_cast<double>(fixed_point::POW10[table.sizeDecimals(intent.symbolId)]);
+    const double priceScale = static_cast<double>(fixed_point::POW10[table.priceDecimals(intent.symbolId)]);
+
+    const int64_t reference = symbol.reference.load(std::memory_order_relaxed);
+    const bool limit = intent.type == OrderType::Limit;
+    const double quantity = static_cast<double>(intent.quantity) / sizeScale;
+    const double price = static_cast<double>(limit ? intent.limitPrice : reference) / priceScale;
+    // The exchange's own minimums; a market order needs the reference price
+    // for its notional.
+    const double minNotional = static_cast<double>(info.minNotional) / priceScale;
+    const bool needsReference = symbol.needsReference.load(std::memory_order_relaxed) || (!limit && minNotional > 0);
+
+    uint32_t failed = 0;
+    failed |= quantity > symbol.maxQuantity.load(std::memory_order_relaxed) || quantity <= 0 ||
+              intent.quantity < info.minQuantity ? bit(RiskReject::OrderSize) : 0;
+    failed |= quantity * price > symbol.maxNotional.load(std::memory_order_relaxed) ||
+              quantity * price < minNotional ? bit(RiskReject::Notional) : 0;
+    failed |= reference <= 0 && needsReference ? bit(RiskReject::NoReference) : 0;
+    return failed;
+}
+
+RiskReject RiskGate::checkOrder(const OrderIntent& intent) const {
+    if (intent.symbolId >= capacity) return RiskReject::OrderSize;
+    const uint32_t failed = orderFailures(intent);
+    return failed ? static_cast<RiskReject>(__builtin_ctz(failed)) : RiskReject::None;
+}
+
+RiskReject RiskGate::check(const OrderIntent& intent, int64_t position, int64_t openBuy, int64_t openSell) {
+    checked.fetch_add(1, std::memory_order_relaxed);
+    if (intent.symbolId >= capacity) {
+        rejected[static_cast<size_t>(RiskReject::OrderSize)].fetch_add(1, std::memory_order_relaxed);
+        return RiskReject::OrderSize;
+    }
+
+    const SymbolTable& table = SymbolTable::get_instance();
+    SymbolRisk& symbol = symbols[intent.symbolId];
+    const double sizeScale = static_cast<double>(fixed_point::POW10[table.sizeDecimals(intent.symbolId)]);
+    const double priceScale = static_cast<double>(fixed_point::POW10[table.priceDecimals(intent.symbolId)]);
+
+    const int64_t reference = symbol.reference.load(std::memory_order_relaxed);
+    const bool limit = intent.type == OrderType::Limit;
+    const double quantity = static_cast<double>(intent.quantity) / sizeScale;
+    const double referencePrice = static_cast<double>(reference) / priceScale;
+    const double price = limit ? static_cast<double>(intent.limitPrice) / priceScale : referencePrice;
+    const bool buy = intent.side == OrderSide::Buy;
+    const double open = static_cast<double>(buy ? openBuy : openSell) / sizeScale;
+    const double signedQuantity = buy ? quantity + open : -(quantity + open);
+    const double resulting = static_cast<double>(position) / sizeScale + signedQuantity;
+    // Market orders have no price of their own to check.
+    const double distance = limit ? std::fabs(price - referencePrice) : 0.0;
+
+    uint32_t failed = orderFailures(intent);
+    failed |= halted.load(std::memory_order_relaxed) ? bit(RiskReject::KillSwitch) : 0;
+    failed |= std::fabs(resulting) > symbol.maxPosition.load(std::memory_order_relaxed) ? bit(RiskReject::Position) : 0;
+    failed |= distance > symbol.band.load(std::memory_order_relaxed) * referencePrice ? bit(RiskReject::PriceBand) : 0;
+
+    RiskReject reason = RiskReject::None;
+    if (failed) {
+        // The lowest set bit is the most fundamental reason.
+        reason = static_cast<RiskReject>(__builtin_ctz(failed));
+    } else {
+        const uint64_t now = tsc::now();
+        if (!symbol.rate.take(now) || !global.take(now)) reason = RiskReject::RateLimit;
+    }
+
+    if (reason == RiskReject::None) return reason;
+    rejected[static_cast<size_t>(reason)].fetch_add(1, std::memory_order_relaxed);
+    return reason;
+}
+
+RiskStats RiskGate::stats() const {
+    RiskStats s;
+    s.checked = checked.load(std::memory_order_relaxed);
+    uint64_t total = 0;
+    for (size_t i = 0; i < static_cast<size_t>(RiskReject::Count); ++i) {
+        s.rejected[i] = rejected[i].load(std::memory_order_relaxed);
+        total += s.rejected[i];
+    }
+    s.passed = s.checked - total;
+    return s;
+}
@@ -0,0 +1,381 @@
+#include "session_pool.h"
+
+#include "logger.h"
+
+namespace http = boost::beast::http;
+
+namespace {
+    bool isIdempotent(http::verb method) {
+        switch (method) {
+        case http::verb::get:
+        case http::verb::head:
+        case http::verb::put:
+        case http::verb::delete_:
+        case http::verb::options:
+            return true;
+        default:
+            return false;
+        }
+    }
+
+    // What an idle keep-alive session the peer already closed looks like
+    // when the next request goes out on it.
+    bool isStaleSession(const boost::system::error_code& ec) {
+        return ec == http::error::end_of_stream || ec == boost::asio::error::eof ||
+               ec == boost::asio::error::connection_reset || ec == boost::asio::ssl::error::stream_truncated;
+    }
+}
+
+DnsCache::DnsCache(boost::asio::io_context& ioc, std::chrono::seconds ttl)
+    : resolver(ioc), ttl(ttl) {}
+
+DnsCache::results_type DnsCache::resolve(const string& host, const string& port) {
+    std::lock_guard<std::mutex> lock(mtx);
+    auto now = std::chrono::steady_clock::now();
+    if (!cached.empty() && host == cachedHost && port == cachedPort && now < expiresAt) {
+        return cached;
+    }
+
+    cached = resolver.resolve(host, port);
+    cachedHost = host;
+    cachedPort = port;
+    expiresAt = now + ttl;
+    return cached;
+}
+
+void DnsCache::invalidate() {
+    std::lock_guard<std::mutex> lock(mtx);
+    cached = results_type();
+}
+
+SessionPool::Lease::Lease(SessionPool* pool, std::unique_ptr<HttpsSession> session)
+    : pool(pool), session(std::move(session)) {}
+
+SessionPool::Lease::Lease(Lease&& other) noexcept
+    : pool(other.pool), session(std::move(other.session)), healthy(other.healthy) {
+    other.pool = nullptr;
+}
+
+SessionPool::Lease::~Lease() {
+    if (pool && session) {
+        pool->release(std::move(session), healthy);
+    }
+}
+
+SessionPool::SessionPool(SessionPoolConfig config)
+    : cfg(std::move(config)),
+      sslCtx(boost::asio::ssl::context::tlsv12_client),
+      dns(ioc, cfg.dnsTtl) {
+    sslCtx.set_options(boost::asio::ssl::context::default_workarounds |
+                       boost::asio::ssl::context::no_sslv2 |
+                       boost::asio::ssl::context::no_sslv3);
+    if (cfg.verifyPeer) {
+        sslCtx.set_default_verify_paths();
+        sslCtx.set_verify_mode(boost::asio::ssl::verify_peer);
+    } else {
+        sslCtx.set_verify_mode(boost::asio::ssl::verify_none);
+    }
+    ::SSL_CTX_set_session_cache_mode(sslCtx.native_handle(), SSL_SESS_CACHE_CLIENT);
+    if (cfg.maxSessions == 0) cfg.maxSessions = 1;
+}
+
+SessionPool::~SessionPool() {
+    stop();
+
+    for (auto& session : idle) {
+        runWithDeadline(*session, [&](auto handler) { session->stream.async_shutdown(std::move(handler)); });
+    }
+    idle.clear();
+
+    if (resumeSession) {
+        ::SSL_SESSION_free(resumeSession);
+    }
+}
+
+void SessionPool::setCredentials(const string& apiKey, const string& apiSecretKey) {
+    ALPACA_API_KEY = apiKey;
+    ALPACA_API_SECRET_KEY = apiSecretKey;
+}
+
+void SessionPool::start() {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    if (maintenanceThread.joinable()) return;
+
+    stopping = false;
+    if (openSessions < cfg.warmSessions) {
+        pendingReconnects += std::min(cfg.warmSessions, cfg.maxSessions) - openSessions;
+        openSessions = std::min(cfg.warmSessions, cfg.maxSessions);
+    }
+    maintenanceThread = std::thread(&SessionPool::maintain, this);
+}
+
+void SessionPool::stop() {
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        stopping = true;
+    }
+    poolCV.notify_all();
+    if (maintenanceThread.joinable()) {
+        maintenanceThread.join();
+    }
+}
+
+template <typename Operation>
+boost::system::error_code SessionPool::runWithDeadline(HttpsSession& session, Operation operation) {
+    boost::system::error_code result = boost::asio::error::would_block;
+    auto& tcp = boost::beast::get_lowest_layer(session.stream);
+    tcp.expires_after(cfg.ioTimeout);
+    operation([&result](boost::system::error_code ec, auto&&...) { result = ec; });
+    session.ioc.restart();
+    session.ioc.run();
+    tcp.expires_never();
+    return result;
+}
+
+std::unique_ptr<HttpsSession> SessionPool::connectSession() {
+    auto session = std::make_unique<HttpsSession>(sslCtx);
+
+    try {
+        auto& tcp = boost::beast::get_lowest_layer(session->stream);
+        const DnsCache::results_type endpoints = dns.resolve(cfg.host, cfg.port);
+        boost::system::error_code ec = runWithDeadline(*session, [&](auto handler) {
+            tcp.async_connect(endpoints, std::move(handler));
+        });
+        if (ec) throw boost::system::system_error(ec);
+        tcp.socket().set_option(boost::asio::ip::tcp::no_delay(true));
+
+        ::SSL_set_tlsext_host_name(session->stream.native_handle(), cfg.host.c_str());
+        {
+            std::lock_guard<std::mutex> lock(resumeMutex);
+            if (resumeSession) {
+                ::SSL_set_session(session->stream.native_handle(), resumeSession);
+            }
+        }
+
+        ec = runWithDeadline(*session, [&](auto handler) {
+            session->stream.async_handshake(boost::asio::ssl::stream_base::client, std::move(handler));
+        });
+        if (ec) throw boost::system::system_error(ec);
+    } catch (const std::exception&) {
+        dns.invalidate();
+        ++failures;
+        throw;
+    }
+
+    ++connects;
+    if (::SSL_session_reused(session->stream.native_handle())) {
+        ++resumedHandshakes;
+    }
+    session->lastUsed = std::chrono::steady_clock::now();
+    return session;
+}
+
+void SessionPool::rememberTlsSession(HttpsSession& session) {
+    // TLS 1.3 tickets arrive after the handshake, so the resumable session is
+    // only available once the first response has been read.
+    SSL* ssl = session.stream.native_handle();
+    if (::SSL_session_reused(ssl) || session.requests != 1) return;
+
+    SSL_SESSION* fresh = ::SSL_get1_session(ssl);
+    if (!fresh) return;
+
+    std::lock_guard<std::mutex> lock(resumeMutex);
+    if (resumeSession) {
+        ::SSL_SESSION_free(resumeSession);
+    }
+    resumeSession = fresh;
+}
+
+SessionPool::Lease SessionPool::acquire() {
+    const auto deadline = std::chrono::steady_clock::now() + cfg.ioTimeout;
+    std::unique_lock<std::mutex> lock(poolMutex);
+    for (;;) {
+        if (!idle.empty()) {
+            std::unique_ptr<HttpsSession> session = std::move(idle.back());
+            idle.pop_back();
+            ++reuses;
+            return Lease(this, std::move(session));
+        }
+
+        if (openSessions < cfg.maxSessions) {
+            ++openSessions;
+            lock.unlock();
+            try {
+                return Lease(this, connectSession());
+            } catch (...) {
+                lock.lock();
+                --openSessions;
+                poolCV.notify_all();
+                throw;
+            }
+        }
+
+        // Every session is leased out; one has ioTimeout to come back.
+        if (poolCV.wait_until(lock, deadline) == std::cv_status::timeout && idle.empty() &&
+            openSessions >= cfg.maxSessions) {
+            throw boost::system::system_error(boost::beast::error::timeout, "no pooled session became free");
+        }
+    }
+}
+
+void SessionPool::release(std::unique_ptr<HttpsSession> session, bool healthy) {
+    session->lastUsed = std::chrono::steady_clock::now();
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (healthy) {
+            idle.push_back(std::move(session));
+        } else {
+            ++failures;
+            if (maintenanceThread.joinable() && !stopping) {
+                ++pendingReconnects;
+            } else {
+                --openSessions;
+            }
+        }
+    }
+    poolCV.notify_all();
+}
+
+unsigned SessionPool::send(http_request& req, http_response& res) {
+    req.set(http::field::host, cfg.host);
+    req.set("APCA-API-KEY-ID", ALPACA_API_KEY);
+    req.set("APCA-API-SECRET-KEY", ALPACA_API_SECRET_KEY);
+    req.keep_alive(true);
+
+    for (int attempt = 0;; ++attempt) {
+        Lease lease = acquire();
+        boost::system::error_code ec = runWithDeadline(*lease, [&](auto handler) {
+            http::async_write(lease->stream, req, std::move(handler));
+        });
+        if (ec) {
+            // A write failure means the peer dropped an idle keep-alive session
+            // before the request went out, so one retry cannot duplicate it.
+            lease.markBroken();
+            if (attempt == 0 && ec != boost::beast::error::timeout) continue;
+            throw boost::system::system_error(ec);
+        }
+
+        http::response_parser<http::string_body> parser;
+        ec = runWithDeadline(*lease, [&](auto handler) {
+            http::async_read(lease->stream, lease->buffer, parser, std::move(handler));
+        });
+        if (ec) {
+            lease.markBroken();
+            // The peer closed a stale session without answering; requests
+            // that are safe to repeat get one more try on another session.
+            if (attempt == 0 && isIdempotent(req.method()) && isStaleSession(ec) && !parser.got_some() &&
+                lease->buffer.size() == 0) {
+                continue;
+            }
+            throw boost::system::system_error(ec);
+        }
+        res = parser.release();
+
+        ++lease->requests;
+        rememberTlsSession(*lease);
+        if (!res.keep_alive()) {
+            lease.markBroken();
+        }
+        return res.result_int();
+    }
+}
+
+bool SessionPool::heartbeat(HttpsSession& session) {
+    http_request req{http::verb::get, cfg.heartbeatTarget, 11};
+    req.set(http::field::host, cfg.host);
+    req.set("APCA-API-KEY-ID", ALPACA_API_KEY);
+    req.set("APCA-API-SECRET-KEY", ALPACA_API_SECRET_KEY);
+    req.keep_alive(true);
+
+    boost::system::error_code ec = runWithDeadline(session, [&](auto handler) {
+        http::async_write(session.stream, req, std::move(handler));
+    });
+    if (ec) return false;
+
+    http_response res;
+    ec = runWithDeadline(session, [&](auto handler) {
+        http::async_read(session.stream, session.buffer, res, std::move(handler));
+    });
+    if (ec || !res.keep_alive()) return false;
+
+    ++heartbeats;
+    ++session.requests;
+    rememberTlsSession(session);
+    session.lastUsed = std::chrono::steady_clock::now();
+    return true;
+}
+
+void SessionPool::maintain() {
+    placeThisThread("order-sessions", cfg.maintenanceThread);
+    auto backoff = std::chrono::milliseconds(100);
+    std::unique_lock<std::mutex> lock(poolMutex);
+
+    while (!stopping) {
+        if (pendingReconnects > 0) {
+            --pendingReconnects;
+            lock.unlock();
+            std::unique_ptr<HttpsSession> session;
+            try {
+                session = connectSession();
+            } catch (const std::exception& e) {
+                LOG_ERROR("Order session reconnect to {} failed: {}", cfg.host, e.what());
+            }
+            lock.lock();
+
+            if (session) {
+                ++reconnects;
+                idle.push_back(std::move(session));
+                backoff = std::chrono::milliseconds(100);
+                poolCV.notify_all();
+            } else {
+                ++pendingReconnects;
+                poolCV.wait_for(lock, backoff, [this] { return stopping; });
+                backoff = std::min(backoff * 2, std::chrono::milliseconds(5000));
+            }
+            continue;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        std::vector<std::unique_ptr<HttpsSession>> stale;
+        for (auto it = idle.begin(); it != idle.end();) {
+            if (now - (*it)->lastUsed >= cfg.heartbeatInterval) {
+                stale.push_back(std::move(*it));
+                it = idle.erase(it);
+            } else {
+                ++it;
+            }
+        }
+
+        if (!stale.empty()) {
+            lock.unlock();
+            std::vector<bool> alive;
+            for (auto& session : stale) {
+                alive.push_back(heartbeat(*session));
+            }
+            lock.lock();
+            for (size_t i = 0; i < stale.size(); ++i) {
+                if (alive[i]) {
+                    idle.push_back(std::move(stale[i]));
+                } else {
+                    ++failures;
+                    ++pendingReconnects;
+                }
+            }
+            poolCV.notify_all();
+            continue;
+        }
+
+        poolCV.wait_for(lock, cfg.heartbeatInterval / 2, [this] { return stopping || pendingReconnects > 0; });
+    }
+}
+
+SessionPoolStats SessionPool::stats() const {
+    SessionPoolStats s;
+    s.connects = connects.load();
+    s.resumedHandshakes = resumedHandshakes.load();
+    s.reuses = reuses.load();
+    s.heartbeats = heartbeats.load();
+    s.reconnects = reconnects.load();
+    s.failures = failures.load();
+    return s;
+}
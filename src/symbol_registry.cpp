@@ -0,0 +1,173 @@
+#include "symbol_registry.h"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include <nlohmann/json.hpp>
+
+#include "fixed_point.h"
+#include "logger.h"
+#include "session_pool.h"
+
+using json = nlohmann::json;
+namespace http = boost::beast::http;
+
+namespace {
+    string withoutSlash(std::string_view name) {
+        string out;
+        out.reserve(name.size());
+        for (char ch : name) {
+            if (ch != '/') out += ch;
+        }
+        return out;
+    }
+
+    // Increments come as strings ("0.000000001") or numbers (1e-09).
+    string text(const json& asset, const char* key) {
+        auto it = asset.find(key);
+        if (it == asset.end()) return string();
+        if (it->is_string()) return it->get<string>();
+        if (it->is_number()) return it->dump();
+        return string();
+    }
+
+    // Decimals needed to hold an increment exactly: "0.01" -> 2, "1e-09" -> 9,
+    // "5" -> 0. False if the increment is not a decimal number.
+    bool decimalsOf(const string& increment, uint8_t& decimals) {
+        const size_t e = increment.find_first_of("eE");
+        const std::string_view mantissa = std::string_view(increment).substr(0, e);
+        const size_t dot = mantissa.find('.');
+        if (mantissa.find_first_of("0123456789") == std::string_view::npos ||
+            mantissa.find_first_not_of("0123456789.") != std::string_view::npos ||
+            (dot != std::string_view::npos && mantissa.find('.', dot + 1) != std::string_view::npos)) {
+            return false;
+        }
+        long places = 0;
+        if (dot != std::string_view::npos) {
+            const size_t last = mantissa.find_last_not_of('0');
+            if (last != std::string_view::npos && last > dot) places = static_cast<long>(last - dot);
+        }
+        if (e != string::npos) {
+            const char* first = increment.data() + e + 1;
+            const char* end = increment.data() + increment.size();
+            if (first != end && *first == '+') ++first;
+            int exponent = 0;
+            const auto parsed = std::from_chars(first, end, exponent);
+            if (parsed.ec != std::errc() || parsed.ptr != end) return false;
+            places -= exponent;
+        }
+        decimals = static_cast<uint8_t>(std::clamp<long>(places, 0, fixed_point::MAX_DECIMALS));
+        return true;
+    }
+
+    int64_t fixed(const string& value, uint8_t decimals) {
+        int64_t out = 0;
+        if (!value.empty()) fixed_point::parse(value, decimals, out);
+        return out;
+    }
+
+    string readFile(const string& path) {
+        std::ifstream in(path);
+        if (!in) {
+            throw std::runtime_error("Cannot open asset list " + path);
+        }
+        std::ostringstream contents;
+        contents << in.rdbuf();
+        return contents.str();
+    }
+
+    string fetchAssets(const SymbolRegistryConfig& config, const string& apiKey, const string& apiSecretKey) {
+        SessionPoolConfig endpoint;
+        endpoint.host = config.host;
+        endpoint.port = config.port;
+        endpoint.maxSessions = 1;
+        endpoint.warmSessions = 0;
+        SessionPool rest(endpoint);
+        rest.setCredentials(apiKey, apiSecretKey);
+
+        http_request req{http::verb::get, config.assetsTarget, 11};
+        http_response res;
+        const unsigned status = rest.send(req, res);
+        if (status != 200) {
+            throw std::runtime_error("Asset list request failed with HTTP " + std::to_string(status) + ": " +
+                                     res.body());
+        }
+        return res.body();
+    }
+}
+
+size_t applyAssets(SymbolTable& table, const string& assetsJson, const vector<string>& symbols,
+                   double defaultMinNotional) {
+    const json assets = json::parse(assetsJson, nullptr, false);
+    if (!assets.is_array()) {
+        throw std::runtime_error("Asset list is not a JSON array");
+    }
+
+    // Crypto assets are listed as "BTC/USD", older lists as "BTCUSD".
+    std::unordered_map<string, uint32_t> wanted;
+    for (const string& symbol : symbols) {
+        wanted.emplace(withoutSlash(symbol), table.intern(symbol));
+    }
+
+    size_t found = 0;
+    for (const json& asset : assets) {
+        if (!asset.is_object()) continue;
+        auto match = wanted.find(withoutSlash(text(asset, "symbol")));
+        if (match == wanted.end()) continue;
+        const uint32_t id = match->second;
+
+        const string tick = text(asset, "price_increment");
+        const string lot = text(asset, "min_trade_increment");
+        uint8_t tickDecimals = 0;
+        uint8_t lotDecimals = 0;
+        if ((!tick.empty() && !decimalsOf(tick, tickDecimals)) || (!lot.empty() && !decimalsOf(lot, lotDecimals))) {
+            LOG_WARN("Invalid asset metadata for {} (price_increment \"{}\", min_trade_increment \"{}\"); "
+                     "using default scales", table.name(id), tick, lot);
+            wanted.erase(match);
+            continue;
+        }
+        // Scales only ever widen to hold the increments exactly: bar vwaps
+        // and quote mids carry more digits than the tick.
+        const uint8_t priceDecimals = std::max(table.priceDecimals(id), tickDecimals);
+        const uint8_t sizeDecimals = std::max(table.sizeDecimals(id), lotDecimals);
+        table.setScale(id, priceDecimals, sizeDecimals);
+
+        SymbolInfo info;
+        info.tickSize = fixed(tick, priceDecimals);
+        info.lotSize = fixed(lot, sizeDecimals);
+        info.minQuantity = fixed(text(asset, "min_order_size"), sizeDecimals);
+        const string minNotional = text(asset, "min_notional");
+        info.minNotional = minNotional.empty() ? fixed_point::fromDouble(defaultMinNotional, priceDecimals)
+                                               : fixed(minNotional, priceDecimals);
+        table.setInfo(id, info);
+
+        wanted.erase(match);
+        ++found;
+    }
+
+    for (const auto& missing : wanted) {
+        LOG_WARN("No asset metadata for {}; using default scales", table.name(missing.second));
+    }
+    return found;
+}
+
+size_t loadSymbolRegistry(const SymbolRegistryConfig& config, const string& apiKey, const string& apiSecretKey,
+                          SymbolTable& table) {
+    for (const string& symbol : config.symbols) {
+        table.intern(symbol);
+    }
+
+    string assets;
+    if (!config.assetsFile.empty()) {
+        assets = readFile(config.assetsFile);
+    } else if (config.fetchAssets) {
+        assets = fetchAssets(config, apiKey, apiSecretKey);
+    } else {
+        return 0;
+    }
+    return applyAssets(table, assets, config.symbols, config.defaultMinNotional);
+}
@@ -0,0 +1,107 @@
+#include "symbol_table.h"
+
+#include <stdexcept>
+
+#include "fixed_point.h"
+
+namespace {
+    uint64_t tagOf(uint64_t hash) {
+        return hash & 0xffffffff00000000ULL;
+    }
+}
+
+SymbolTable::SymbolTable()
+    : slots(new std::atomic<uint64_t>[SLOTS]),
+      names(new std::string[CAPACITY]),
+      orderSymbols(new std::string[CAPACITY]),
+      infos(new SymbolInfo[CAPACITY]),
+      scales(new std::atomic<uint16_t>[CAPACITY]) {
+    for (size_t i = 0; i < SLOTS; ++i) {
+        slots[i].store(EMPTY_SLOT, std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < CAPACITY; ++i) {
+        scales[i].store(DEFAULT_PRICE_DECIMALS << 8 | DEFAULT_SIZE_DECIMALS, std::memory_order_relaxed);
+    }
+}
+
+SymbolTable& SymbolTable::get_instance() {
+    static SymbolTable instance;
+    return instance;
+}
+
+uint64_t SymbolTable::hash(std::string_view name) {
+    uint64_t h = 1469598103934665603ULL;
+    for (char ch : name) {
+        h ^= static_cast<unsigned char>(ch);
+        h *= 1099511628211ULL;
+    }
+    return h;
+}
+
+uint32_t SymbolTable::find(std::string_view name) const {
+    const uint64_t h = hash(name);
+    const uint64_t tag = tagOf(h);
+    for (size_t i = h & (SLOTS - 1);; i = (i + 1) & (SLOTS - 1)) {
+        const uint64_t slot = slots[i].load(std::memory_order_acquire);
+        if (slot == EMPTY_SLOT) return INVALID_ID;
+        if (tagOf(slot) != tag) continue;
+        const uint32_t id = static_cast<uint32_t>(slot);
+        if (names[id] == name) return id;
+    }
+}
+
+uint32_t SymbolTable::intern(std::string_view name) {
+    uint32_t id = find(name);
+    if (id != INVALID_ID) return id;
+
+    std::lock_guard<std::mutex> lock(insertMutex);
+    const uint64_t h = hash(name);
+    size_t i = h & (SLOTS - 1);
+    for (;; i = (i + 1) & (SLOTS - 1)) {
+        const uint64_t slot = slots[i].load(std::memory_order_relaxed);
+        if (slot == EMPTY_SLOT) break;
+        const uint32_t existing = static_cast<uint32_t>(slot);
+        if (tagOf(slot) == tagOf(h) && names[existing] == name) return existing;
+    }
+
+    id = count.load(std::memory_order_relaxed);
+    if (id >= CAPACITY) {
+        throw std::runtime_error("Symbol table is full; cannot intern " + std::string(name));
+    }
+
+    names[id] = std::string(name);
+    std::string& orderSymbol = orderSymbols[id];
+    orderSymbol.reserve(name.size());
+    for (char ch : name) {
+        // Pairs are ordered without the slash, wherever it is ("DOGE/USD");
+        // stock tickers are used as is.
+        if (ch != '/') orderSymbol += ch;
+    }
+    count.store(id + 1, std::memory_order_release);
+    slots[i].store(tagOf(h) | id, std::memory_order_release);
+    return id;
+}
+
+void SymbolTable::setScale(uint32_t id, uint8_t priceDecimals, uint8_t sizeDecimals) {
+    if (id >= CAPACITY || priceDecimals > fixed_point::MAX_DECIMALS || sizeDecimals > fixed_point::MAX_DECIMALS) {
+        throw std::invalid_argument("Invalid symbol scale");
+    }
+    scales[id].store(static_cast<uint16_t>(priceDecimals << 8 | sizeDecimals), std::memory_order_relaxed);
+}
+
+void SymbolTable::setInfo(uint32_t id, const SymbolInfo& info) {
+    if (id >= CAPACITY) {
+        throw std::invalid_argument("Invalid symbol id");
+    }
+    infos[id] = info;
+}
+
+std::string_view SymbolTable::name(uint32_t id) const {
+    if (id >= size()) return std::string_view();
+    return names[id];
+}
+
+std::string_view SymbolTable::orderSymbol(uint32_t id) const {
+    if (id >= size()) return std::string_view();
+    return orderSymbols[id];
+}
@@ -0,0 +1,249 @@
+#include "thread_util.h"
+
+#include <cerrno>
+#include <cstring>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace {
+    // MPOL_LOCAL from <linux/mempolicy.h>; spelled out so libnuma is not
+    // needed for one syscall.
+    constexpr int MPOL_LOCAL_POLICY = 4;
+
+    struct PlacedThread {
+        std::string name;
+        long tid = 0;
+        ThreadPlacement requested;
+        std::vector<int> allowed;
+        int policy = 0;
+        int priority = 0;
+        int node = -1;
+        std::string errors;
+    };
+
+    std::mutex placedMutex;
+    std::vector<PlacedThread>& placedThreads() {
+        static std::vector<PlacedThread> threads;
+        return threads;
+    }
+
+    void appendError(std::string& errors, const char* what, int error) {
+        if (!errors.empty()) errors += "; ";
+        errors += what;
+        errors += ": ";
+        errors += std::strerror(error);
+    }
+
+    void appendCpus(std::ostringstream& out, const std::vector<int>& cpus) {
+        if (cpus.empty()) {
+            out << "any";
+            return;
+        }
+        // Runs of consecutive CPUs print as ranges.
+        for (size_t i = 0; i < cpus.size();) {
+            size_t j = i;
+            while (j + 1 < cpus.size() && cpus[j + 1] == cpus[j] + 1) ++j;
+            if (i > 0) out << ',';
+            out << cpus[i];
+            if (j > i) out << '-' << cpus[j];
+            i = j + 1;
+        }
+    }
+
+    std::vector<int> parseCpus(const std::string& text) {
+        std::vector<int> cpus;
+        std::istringstream in(text);
+        std::string item;
+        while (std::getline(in, item, ',')) {
+            size_t dash = item.find('-');
+            try {
+                size_t used = 0;
+                const std::string head = item.substr(0, dash);
+                int first = std::stoi(head, &used);
+                if (used != head.size() || first < 0) throw std::invalid_argument(item);
+                int last = first;
+                if (dash != std::string::npos) {
+                    const std::string tail = item.substr(dash + 1);
+                    last = std::stoi(tail, &used);
+                    if (used != tail.size() || last < first) throw std::invalid_argument(item);
+                }
+                for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+            } catch (const std::exception&) {
+                throw std::invalid_argument("Invalid CPU list in thread topology: " + text);
+            }
+        }
+        if (cpus.empty()) throw std::invalid_argument("Empty CPU list in thread topology");
+        return cpus;
+    }
+
+    // One placement per CPU for the roles that have a thread per entry.
+    std::vector<ThreadPlacement> perCpu(const ThreadPlacement& placement) {
+        std::vector<ThreadPlacement> placements;
+        for (int cpu : placement.cpus) {
+            ThreadPlacement one = placement;
+            one.cpus = {cpu};
+            placements.push_back(one);
+        }
+        return placements;
+    }
+}
+
+bool placeThisThread(const std::string& name, const ThreadPlacement& placement) {
+    PlacedThread placed;
+    placed.name = name;
+    placed.requested = placement;
+
+#ifdef __linux__
+    placed.tid = static_cast<long>(syscall(SYS_gettid));
+    // Kernel thread names are at most 15 characters.
+    pthread_setname_np(pthread_self(), name.substr(0, 15).c_str());
+
+    if (!placement.cpus.empty()) {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : placement.cpus) {
+            if (cpu >= 0 && cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+        }
+        int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        if (error != 0) appendError(placed.errors, "affinity", error);
+    }
+
+    if (placement.fifoPriority > 0) {
+        sched_param param{};
+        param.sched_priority = placement.fifoPriority;
+        int error = pthread_setschedparam(pthread_self(), SCHED_FIFO, &param);
+        if (error != 0) appendError(placed.errors, "SCHED_FIFO", error);
+    }
+
+    if (placement.numaLocal && syscall(SYS_set_mempolicy, MPOL_LOCAL_POLICY, nullptr, 0) != 0) {
+        appendError(placed.errors, "NUMA policy", errno);
+    }
+
+    cpu_set_t allowed;
+    CPU_ZERO(&allowed);
+    if (pthread_getaffinity_np(pthread_self(), sizeof(allowed), &allowed) == 0) {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &allowed)) placed.allowed.push_back(cpu);
+        }
+    }
+    sched_param param{};
+    pthread_getschedparam(pthread_self(), &placed.policy, &param);
+    placed.priority = param.sched_priority;
+    unsigned cpu = 0, node = 0;
+    if (syscall(SYS_getcpu, &cpu, &node, nullptr) == 0) placed.node = static_cast<int>(node);
+#else
+    if (!placement.empty()) placed.errors = "thread placement is not supported on this platform";
+#endif
+
+    const bool ok = placed.errors.empty();
+    std::lock_guard<std::mutex> lock(placedMutex);
+    // A role placed again (a restarted component) replaces its old line.
+    for (PlacedThread& existing : placedThreads()) {
+        if (existing.name == name) {
+            existing = std::move(placed);
+            return ok;
+        }
+    }
+    placedThreads().push_back(std::move(placed));
+    return ok;
+}
+
+std::string threadReport() {
+    std::ostringstream out;
+    std::lock_guard<std::mutex> lock(placedMutex);
+    for (const PlacedThread& thread : placedThreads()) {
+        out << thread.name << " (tid " << thread.tid << "): cpus ";
+        appendCpus(out, thread.requested.cpus);
+        out << " -> ";
+        appendCpus(out, thread.allowed);
+#ifdef __linux__
+        if (thread.policy == SCHED_FIFO) {
+            out << ", SCHED_FIFO " << thread.priority;
+        } else {
+            out << ", SCHED_OTHER";
+        }
+#endif
+        if (thread.node >= 0) out << ", node " << thread.node << (thread.requested.numaLocal ? " (local)" : "");
+        if (!thread.errors.empty()) out << ", failed: " << thread.errors;
+        out << '\n';
+    }
+    return out.str();
+}
+
+ThreadTopology ThreadTopology::parse(const std::string& spec) {
+    ThreadTopology topology;
+    bool numa = false;
+
+    std::istringstream in(spec);
+    std::string entry;
+    while (std::getline(in, entry, ';')) {
+        if (entry.empty()) continue;
+        if (entry == "numa") {
+            numa = true;
+            continue;
+        }
+        const size_t equals = entry.find('=');
+        if (equals == std::string::npos) {
+            throw std::invalid_argument("Thread topology entry is not role=cpus: " + entry);
+        }
+        const std::string role = entry.substr(0, equals);
+
+        std::istringstream options(entry.substr(equals + 1));
+        std::string option;
+        std::getline(options, option, ':');
+        ThreadPlacement placement;
+        placement.cpus = parseCpus(option);
+        while (std::getline(options, option, ':')) {
+            if (option == "numa") {
+                placement.numaLocal = true;
+            } else if (option.compare(0, 5, "fifo=") == 0) {
+                try {
+                    placement.fifoPriority = std::stoi(option.substr(5));
+                } catch (const std::exception&) {
+                    placement.fifoPriority = -1;
+                }
+                if (placement.fifoPriority < 1 || placement.fifoPriority > 99) {
+                    throw std::invalid_argument("SCHED_FIFO priority must be 1-99: " + entry);
+                }
+            } else {
+                throw std::invalid_argument("Unknown thread topology option: " + option);
+            }
+        }
+
+        if (role == "feeds") {
+            topology.feeds = perCpu(placement);
+        } else if (role == "merger") {
+            topology.merger = placement;
+        } else if (role == "shards") {
+            topology.shards = perCpu(placement);
+        } else if (role == "gateway") {
+            topology.orderGateway = placement;
+        } else if (role == "tradeUpdates") {
+            topology.tradeUpdates = placement;
+        } else if (role == "logger") {
+            topology.logger = placement;
+        } else if (role == "housekeeping") {
+            topology.housekeeping = placement;
+        } else {
+            throw std::invalid_argument("Unknown thread topology role: " + role);
+        }
+    }
+
+    if (numa) {
+        for (ThreadPlacement& placement : topology.feeds) placement.numaLocal = true;
+        for (ThreadPlacement& placement : topology.shards) placement.numaLocal = true;
+        for (ThreadPlacement* placement : {&topology.merger, &topology.orderGateway, &topology.tradeUpdates,
+                                           &topology.logger, &topology.housekeeping}) {
+            placement->numaLocal = true;
+        }
+    }
+    return topology;
+}
@@ -0,0 +1,39 @@
+#include "tls_certificate.h"
+
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+
+#include <memory>
+#include <stdexcept>
+
+void useSelfSignedCertificate(boost::asio::ssl::context& ctx, const std::string& commonName) {
+    std::unique_ptr<EVP_PKEY, decltype(&EVP_PKEY_free)> key(EVP_EC_gen("P-256"), EVP_PKEY_free);
+    if (!key) {
+        throw std::runtime_error("Could not generate TLS key");
+    }
+
+    std::unique_ptr<X509, decltype(&X509_free)> cert(X509_new(), X509_free);
+    if (!cert) {
+        throw std::runtime_error("Could not allocate TLS certificate");
+    }
+
+    X509_set_version(cert.get(), 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(cert.get()), 1);
+    X509_gmtime_adj(X509_getm_notBefore(cert.get()), 0);
+    X509_gmtime_adj(X509_getm_notAfter(cert.get()), 60L * 60 * 24);
+    X509_set_pubkey(cert.get(), key.get());
+
+    X509_NAME* name = X509_get_subject_name(cert.get());
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC,
+                               reinterpret_cast<const unsigned char*>(commonName.c_str()), -1, -1, 0);
+    X509_set_issuer_name(cert.get(), name);
+
+    if (!X509_sign(cert.get(), key.get(), EVP_sha256())) {
+        throw std::runtime_error("Could not sign TLS certificate");
+    }
+
+    if (SSL_CTX_use_certificate(ctx.native_handle(), cert.get()) != 1 ||
+        SSL_CTX_use_PrivateKey(ctx.native_handle(), key.get()) != 1) {
+        throw std::runtime_error("Could not install TLS certificate");
+    }
+}
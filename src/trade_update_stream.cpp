@@ -0,0 +1,113 @@
+#include "trade_update_stream.h"
+
+#include <nlohmann/json.hpp>
+
+#include "logger.h"
+
+using json = nlohmann::json;
+using websocketpp::lib::bind;
+using websocketpp::lib::placeholders::_1;
+using websocketpp::lib::placeholders::_2;
+
+TradeUpdateStream::TradeUpdateStream(OrderManager& manager, const string& apiKey, const string& apiSecretKey)
+    : manager(manager), ALPACA_API_KEY(apiKey), ALPACA_API_SECRET_KEY(apiSecretKey) {
+    endpoint.init_asio();
+    endpoint.clear_access_channels(websocketpp::log::alevel::all);
+    endpoint.clear_error_channels(websocketpp::log::elevel::all);
+}
+
+TradeUpdateStream::~TradeUpdateStream() {
+    disconnect();
+    if (thread.joinable()) thread.join();
+}
+
+void TradeUpdateStream::connect(const string& uri, const string& hostname, const ThreadPlacement& placement) {
+    if (thread.joinable()) {
+        throw std::runtime_error("Trade update stream is already connected");
+    }
+    host = hostname;
+
+    endpoint.set_message_handler(bind(&TradeUpdateStream::onMessage, this, _1, _2));
+    endpoint.set_open_handler(bind(&TradeUpdateStream::onOpen, this, _1));
+    endpoint.set_close_handler(bind(&TradeUpdateStream::onClose, this, _1));
+    endpoint.set_fail_handler(bind(&TradeUpdateStream::onFail, this, _1));
+    endpoint.set_tls_init_handler([](websocketpp::connection_hdl) {
+        auto ctx = websocketpp::lib::make_shared<websocketpp::lib::asio::ssl::context>(
+            websocketpp::lib::asio::ssl::context::tlsv12);
+        ctx->set_options(websocketpp::lib::asio::ssl::context::default_workarounds |
+                         websocketpp::lib::asio::ssl::context::no_sslv2 |
+                         websocketpp::lib::asio::ssl::context::no_sslv3);
+        ctx->set_verify_mode(websocketpp::lib::asio::ssl::verify_none);
+        return ctx;
+    });
+
+    websocketpp::lib::error_code ec;
+    endpoint_type::connection_ptr con = endpoint.get_connection(uri, ec);
+    if (ec) {
+        throw std::runtime_error("Could not create trade update connection: " + ec.message());
+    }
+    endpoint.connect(con);
+    thread = std::thread([this, placement]() {
+        placeThisThread("trade-updates", placement);
+        endpoint.run();
+    });
+}
+
+void TradeUpdateStream::disconnect() {
+    if (connected.exchange(false)) {
+        websocketpp::lib::error_code ec;
+        endpoint.close(hdl, websocketpp::close::status::normal, "Client disconnecting", ec);
+    }
+}
+
+void TradeUpdateStream::onOpen(websocketpp::connection_hdl handle) {
+    hdl = handle;
+    connected = true;
+
+    // Alpaca processes the two in order, so listen need not wait for the
+    // authorization reply.
+    json auth = {{"action", "auth"}, {"key", ALPACA_API_KEY}, {"secret", ALPACA_API_SECRET_KEY}};
+    json listen = {{"action", "listen"}, {"data", {{"streams", {"trade_updates"}}}}};
+    websocketpp::lib::error_code ec;
+    endpoint.send(hdl, auth.dump(), websocketpp::frame::opcode::text, ec);
+    if (!ec) endpoint.send(hdl, listen.dump(), websocketpp::frame::opcode::text, ec);
+    if (ec) {
+        LOG_ERROR("Cannot subscribe to trade updates: {}", ec.message());
+        return;
+    }
+    LOG_INFO("Trade update stream opened on {}.", host);
+}
+
+void TradeUpdateStream::onClose(websocketpp::connection_hdl) {
+    connected = false;
+    isListening = false;
+    LOG_INFO("Trade update stream closed.");
+}
+
+void TradeUpdateStream::onFail(websocketpp::connection_hdl) {
+    connected = false;
+    LOG_ERROR("Trade update stream connection to {} failed.", host);
+}
+
+void TradeUpdateStream::onMessage(websocketpp::connection_hdl, endpoint_type::message_ptr msg) {
+    // Alpaca sends this stream's frames as binary.
+    const string& payload = msg->get_payload();
+    if (manager.onTradeUpdate(payload)) return;
+
+    json message = json::parse(payload, nullptr, false);
+    if (message.is_discarded() || !message.is_object()) {
+        LOG_WARN("Unrecognised trade update frame ({} bytes).", payload.size());
+        return;
+    }
+    const string stream = message.value("stream", "");
+    if (stream == "listening") {
+        isListening = true;
+        LOG_INFO("Listening to trade updates.");
+    } else if (stream == "authorization") {
+        const string status = message.contains("data") ? message["data"].value("status", "") : "";
+        if (status == "authorized") LOG_INFO("Trade update stream authorized.");
+        else LOG_ERROR("Trade update stream authorization failed: {}", status);
+    } else if (stream != "trade_updates") {
+        LOG_WARN("Unexpected trade update frame: {}", payload);
+    }
+}
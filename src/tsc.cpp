@@ -0,0 +1,24 @@
+#include "tsc.h"
+
+#include <thread>
+
+namespace tsc {
+    namespace {
+        double calibrate() {
+            const auto wallStart = std::chrono::steady_clock::now();
+            const uint64_t tickStart = nowOrdered();
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            const auto wallEnd = std::chrono::steady_clock::now();
+            const uint64_t tickEnd = nowOrdered();
+
+            const double ns = static_cast<double>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(wallEnd - wallStart).count());
+            return tickEnd > tickStart ? ns / static_cast<double>(tickEnd - tickStart) : 1.0;
+        }
+    }
+
+    double nsPerTick() {
+        static const double ratio = calibrate();
+        return ratio;
+    }
+}
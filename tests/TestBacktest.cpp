@@ -0,0 +1,192 @@
+#include "TestBacktest.h"
+#include <cppunit/TestAssert.h>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <unistd.h>
+#include "sma_crossover.h"
+#include "symbol_table.h"
+
+namespace {
+    const int64_t MINUTE = 60LL * 1000000000LL;
+    // 2024-01-01T00:00:00Z
+    const int64_t DAY0 = 1704067200LL * 1000000000LL;
+
+    // Emits a preset intent on given bars (counted from 0).
+    class Scripted : public Strategy<Scripted> {
+    public:
+        explicit Scripted(std::map<size_t, OrderIntent> script) : script(std::move(script)) {}
+
+        void onBar(const CompactBar& bar, IntentBuffer& out) {
+            auto it = script.find(seen++);
+            if (it == script.end()) return;
+            OrderIntent intent = it->second;
+            intent.symbolId = bar.symbolId;
+            emit(out, intent);
+        }
+
+    private:
+        std::map<size_t, OrderIntent> script;
+        size_t seen = 0;
+    };
+
+    OrderIntent order(OrderSide side, OrderType type, TimeInForce tif, int64_t quantity, int64_t limit = 0) {
+        OrderIntent intent{};
+        intent.side = side;
+        intent.type = type;
+        intent.timeInForce = tif;
+        intent.quantity = quantity;
+        intent.limitPrice = limit;
+        return intent;
+    }
+
+    // Prices in cents, sizes in whole units.
+    uint32_t testSymbol() {
+        SymbolTable& table = SymbolTable::get_instance();
+        const uint32_t id = table.intern("BT/USD");
+        table.setScale(id, 2, 0);
+        return id;
+    }
+
+    CompactBar makeBar(uint32_t symbolId, int64_t timestampNs, int64_t open, int64_t high, int64_t low, int64_t close) {
+        CompactBar bar{};
+        bar.timestampNs = timestampNs;
+        bar.open = open;
+        bar.high = high;
+        bar.low = low;
+        bar.close = close;
+        bar.volume = 1;
+        bar.vwap = close;
+        bar.symbolId = symbolId;
+        return bar;
+    }
+
+    BacktestResult run(std::map<size_t, OrderIntent> script, const std::vector<CompactBar>& bars,
+                       const BacktestConfig& config) {
+        auto runner = makeStrategyRunner(StrategyEngine<Scripted>(Scripted(std::move(script))));
+        return runBacktest(*runner, bars.data(), bars.size(), config);
+    }
+}
+
+void TestBacktest::testMarketOrdersFillAtNextOpen() {
+    const uint32_t id = testSymbol();
+    std::vector<CompactBar> bars{
+        makeBar(id, DAY0, 10000, 10100, 9900, 10000),
+        makeBar(id, DAY0 + MINUTE, 10050, 10200, 10000, 10150),
+        makeBar(id, DAY0 + 2 * MINUTE, 10200, 10300, 10100, 10250),
+        makeBar(id, DAY0 + 3 * MINUTE, 10300, 10400, 10200, 10300),
+    };
+
+    BacktestConfig config;
+    config.fills.slippageBps = 10;
+    config.fills.feeBps = 5;
+    config.recordFills = true;
+    BacktestResult result = run({{0, order(OrderSide::Buy, OrderType::Market, TimeInForce::Gtc, 2)},
+                                 {2, order(OrderSide::Sell, OrderType::Market, TimeInForce::Gtc, 2)}},
+                                bars, config);
+
+    CPPUNIT_ASSERT_EQUAL(uint64_t(4), result.bars);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), result.intents);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), result.fills);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), result.fillLog.size());
+
+    // Bought at bar 1's open plus 10 bps, sold at bar 3's open minus 10 bps.
+    const double buy = 100.50 * 1.001;
+    const double sell = 103.00 * 0.999;
+    CPPUNIT_ASSERT_EQUAL(DAY0, result.fillLog[0].signalNs);
+    CPPUNIT_ASSERT_EQUAL(DAY0 + MINUTE, result.fillLog[0].timestampNs);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(buy, result.fillLog[0].price, 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(sell, result.fillLog[1].price, 1e-9);
+
+    const double fees = 2 * (buy + sell) * 0.0005;
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(fees, result.fees, 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(2 * (sell - buy), result.realizedPnl, 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.0, result.unrealizedPnl, 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(2 * (sell - buy) - fees, result.netPnl, 1e-9);
+}
+
+void TestBacktest::testLimitOrderLifetimes() {
+    const uint32_t id = testSymbol();
+    std::vector<CompactBar> bars{
+        makeBar(id, DAY0, 10000, 10000, 10000, 10000),
+        makeBar(id, DAY0 + MINUTE, 10000, 10050, 9950, 10000),
+        makeBar(id, DAY0 + 2 * MINUTE, 10000, 10050, 9950, 10000),
+        // Next UTC day: the day order is gone before the low reaches it.
+        makeBar(id, DAY0 + 1440 * MINUTE, 9850, 9900, 9700, 9800),
+    };
+
+    BacktestConfig config;
+    config.fills.feeBps = 0;
+    config.recordFills = true;
+    BacktestResult result = run({{0, order(OrderSide::Buy, OrderType::Limit, TimeInForce::Ioc, 1, 9900)},
+                                 {1, order(OrderSide::Buy, OrderType::Limit, TimeInForce::Day, 1, 9800)},
+                                 {2, order(OrderSide::Buy, OrderType::Limit, TimeInForce::Gtc, 1, 9900)}},
+                                bars, config);
+
+    CPPUNIT_ASSERT_EQUAL(uint64_t(3), result.intents);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), result.fills);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), result.unfilled);
+
+    // The GTC order fills at the gap-down open, better than its limit.
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(98.50, result.fillLog[0].price, 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(98.00 - 98.50, result.unrealizedPnl, 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(0.50, result.maxDrawdown, 1e-9);
+}
+
+void TestBacktest::testParallelRunsMatchSequential() {
+    std::vector<CompactBar> first;
+    std::vector<CompactBar> second;
+    syntheticBars("BT1/USD", 20000, 1, first);
+    syntheticBars("BT2/USD", 20000, 2, second);
+
+    StrategyFactory fast = [] { return makeStrategyRunner(StrategyEngine<SmaCrossover<5, 20>>()); };
+    StrategyFactory slow = [] { return makeStrategyRunner(StrategyEngine<SmaCrossover<10, 60>>()); };
+    std::vector<BacktestJob> jobs{{"fast", fast, &first}, {"fast", fast, &second},
+                                  {"slow", slow, &first}, {"slow", slow, &second}};
+
+    std::vector<BacktestResult> parallel = runBacktests(jobs, BacktestConfig(), 4);
+    CPPUNIT_ASSERT_EQUAL(jobs.size(), parallel.size());
+
+    for (size_t i = 0; i < jobs.size(); ++i) {
+        auto runner = jobs[i].factory();
+        BacktestResult sequential = runBacktest(*runner, jobs[i].bars->data(), jobs[i].bars->size());
+        CPPUNIT_ASSERT_EQUAL(jobs[i].name, parallel[i].name);
+        CPPUNIT_ASSERT(parallel[i].fills > 0);
+        CPPUNIT_ASSERT_EQUAL(sequential.fills, parallel[i].fills);
+        CPPUNIT_ASSERT_EQUAL(sequential.netPnl, parallel[i].netPnl);
+        CPPUNIT_ASSERT_EQUAL(sequential.maxDrawdown, parallel[i].maxDrawdown);
+    }
+}
+
+void TestBacktest::testLoadCsvBars() {
+    const string path = "/tmp/hft_test_backtest_" + std::to_string(::getpid()) + ".csv";
+    {
+        std::ofstream csv(path);
+        csv << "timestamp,open,high,low,close,volume,trade_count,vwap\n"
+            << "1704067200000,100.5,101,100,100.75,12,7,100.6\r\n"
+            << "2024-01-01T00:01:00Z,100.75,101.25,100.5,101,3\n"
+            << "1704067320,101,101,oops,101,1\n"
+            << "\n"
+            << "1704067380000000,101,102,101,102,4\n";
+    }
+
+    std::vector<CompactBar> bars;
+    size_t skipped = 0;
+    const size_t loaded = loadCsvBars(path, "CSV/USD", bars, &skipped);
+    std::remove(path.c_str());
+
+    SymbolTable& table = SymbolTable::get_instance();
+    const uint8_t pd = table.priceDecimals(table.find("CSV/USD"));
+    CPPUNIT_ASSERT_EQUAL(size_t(3), loaded);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), skipped);
+    CPPUNIT_ASSERT_EQUAL(DAY0, bars[0].timestampNs);
+    CPPUNIT_ASSERT_EQUAL(DAY0 + MINUTE, bars[1].timestampNs);
+    CPPUNIT_ASSERT_EQUAL(DAY0 + 3 * MINUTE, bars[2].timestampNs);
+    CPPUNIT_ASSERT_EQUAL(fixed_point::fromDouble(100.75, pd), bars[0].close);
+    CPPUNIT_ASSERT_EQUAL(fixed_point::fromDouble(100.6, pd), bars[0].vwap);
+    CPPUNIT_ASSERT_EQUAL(uint32_t(7), bars[0].tradeCount);
+    // Without a vwap column the close stands in.
+    CPPUNIT_ASSERT_EQUAL(bars[1].close, bars[1].vwap);
+
+    CPPUNIT_ASSERT_THROW(loadCsvBars(path, "CSV/USD", bars), std::runtime_error);
+}
@@ -0,0 +1,23 @@
+#ifndef TESTBACKTEST_H
+#define TESTBACKTEST_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "backtest.h"
+
+class TestBacktest : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestBacktest);
+    CPPUNIT_TEST(testMarketOrdersFillAtNextOpen);
+    CPPUNIT_TEST(testLimitOrderLifetimes);
+    CPPUNIT_TEST(testParallelRunsMatchSequential);
+    CPPUNIT_TEST(testLoadCsvBars);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testMarketOrdersFillAtNextOpen();
+    void testLimitOrderLifetimes();
+    void testParallelRunsMatchSequential();
+    void testLoadCsvBars();
+};
+
+#endif
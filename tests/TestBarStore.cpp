@@ -0,0 +1,165 @@
+#include "TestBarStore.h"
+#include <cppunit/TestAssert.h>
+#include <filesystem>
+#include <unistd.h>
+#include "fixed_point.h"
+#include "indicators.h"
+#include "symbol_table.h"
+
+namespace {
+    const int64_t MINUTE = 60LL * 1000000000LL;
+    // 2024-01-01T00:00:00Z
+    const int64_t DAY0 = 1704067200LL * 1000000000LL;
+
+    CompactBar makeBar(uint32_t symbolId, int64_t timestampNs, int64_t close) {
+        CompactBar bar{};
+        bar.timestampNs = timestampNs;
+        bar.open = close - 1;
+        bar.high = close + 2;
+        bar.low = close - 2;
+        bar.close = close;
+        bar.volume = 10;
+        bar.vwap = close;
+        bar.symbolId = symbolId;
+        bar.tradeCount = 3;
+        return bar;
+    }
+}
+
+void TestBarStore::setUp() {
+    root = "/tmp/hft_test_bar_store_" + std::to_string(::getpid());
+    std::filesystem::remove_all(root);
+}
+
+void TestBarStore::tearDown() {
+    std::filesystem::remove_all(root);
+}
+
+void TestBarStore::testRangeQueryAcrossDays() {
+    const uint32_t id = SymbolTable::get_instance().intern("STORE/USD");
+    {
+        BarStoreWriter writer(root);
+        // Three days of hourly bars, plus a repeat that must be ignored.
+        for (int64_t hour = 0; hour < 72; ++hour) {
+            writer.append(makeBar(id, DAY0 + hour * 60 * MINUTE, 1000 + hour));
+        }
+        writer.append(makeBar(id, DAY0 + 71 * 60 * MINUTE, 5));
+        CPPUNIT_ASSERT_EQUAL(uint64_t(72), writer.stats().written);
+        CPPUNIT_ASSERT_EQUAL(uint64_t(1), writer.stats().late);
+    }
+
+    BarStoreReader reader(root);
+    // From 20:00 on day 0 to 04:00 (exclusive) on day 2.
+    auto slices = reader.query("STORE/USD", DAY0 + 20 * 60 * MINUTE, DAY0 + 52 * 60 * MINUTE);
+    CPPUNIT_ASSERT_EQUAL(size_t(3), slices.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(4), slices[0].size());
+    CPPUNIT_ASSERT_EQUAL(size_t(24), slices[1].size());
+    CPPUNIT_ASSERT_EQUAL(size_t(4), slices[2].size());
+
+    int64_t expected = 1020;
+    for (const BarSlice& slice : slices) {
+        for (size_t i = 0; i < slice.size(); ++i, ++expected) {
+            CPPUNIT_ASSERT_EQUAL(expected, slice.close[i]);
+            CompactBar bar = slice.bar(i);
+            CPPUNIT_ASSERT_EQUAL(DAY0 + (expected - 1000) * 60 * MINUTE, bar.timestampNs);
+            CPPUNIT_ASSERT_EQUAL(expected + 2, bar.high);
+            CPPUNIT_ASSERT_EQUAL(uint32_t(3), bar.tradeCount);
+            CPPUNIT_ASSERT_EQUAL(id, bar.symbolId);
+        }
+    }
+    CPPUNIT_ASSERT_EQUAL(int64_t(1052), expected);
+
+    auto last = reader.lastDays("STORE/USD", 2, DAY0 + 71 * 60 * MINUTE);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), last.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(24), last[1].size());
+    CPPUNIT_ASSERT(reader.query("NONE/USD", 0, DAY0 * 2).empty());
+}
+
+void TestBarStore::testBackgroundWriterAndReopen() {
+    const uint32_t id = SymbolTable::get_instance().intern("LIVE/USD");
+    {
+        BarStoreWriter writer(root);
+        writer.start();
+        for (int64_t i = 0; i < 500; ++i) {
+            CPPUNIT_ASSERT(writer.publish(makeBar(id, DAY0 + i * MINUTE, i)));
+        }
+        writer.stop();
+        CPPUNIT_ASSERT_EQUAL(uint64_t(500), writer.stats().written);
+    }
+
+    // A torn append leaves the close column one value short.
+    const std::string close = root + "/LIVE-USD/20240101/close.col";
+    std::filesystem::resize_file(close, std::filesystem::file_size(close) - 8);
+
+    {
+        BarStoreWriter writer(root);
+        writer.append(makeBar(id, DAY0 + 498 * MINUTE, -1));
+        writer.append(makeBar(id, DAY0 + 600 * MINUTE, 600));
+        CPPUNIT_ASSERT_EQUAL(uint64_t(1), writer.stats().written);
+    }
+
+    BarStoreReader reader(root);
+    auto slices = reader.query("LIVE/USD", DAY0, DAY0 + bar_store::NS_PER_DAY);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), slices.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(500), slices[0].size());
+    CPPUNIT_ASSERT_EQUAL(int64_t(498), slices[0].close[498]);
+    CPPUNIT_ASSERT_EQUAL(int64_t(600), slices[0].close[499]);
+    CPPUNIT_ASSERT_EQUAL(DAY0 + 600 * MINUTE, slices[0].timestampNs(499));
+}
+
+void TestBarStore::testColumnsFeedBatchIndicators() {
+    const uint32_t id = SymbolTable::get_instance().intern("COLS/USD");
+    {
+        BarStoreWriter writer(root);
+        for (int64_t i = 0; i < 100; ++i) {
+            writer.append(makeBar(id, DAY0 + i * MINUTE, 100 + i));
+        }
+    }
+
+    BarStoreReader reader(root);
+    auto slices = reader.query("COLS/USD", DAY0, DAY0 + bar_store::NS_PER_DAY);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), slices.size());
+
+    const BarSlice& slice = slices[0];
+    std::vector<double> sma(slice.size());
+    indicators::batch::sma(slice.close.data(), slice.size(), 10, sma.data());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(104.5, sma[9], 1e-9);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(194.5, sma[99], 1e-9);
+}
+
+void TestBarStore::testScaleChangeKeepsHeaderDecimals() {
+    SymbolTable& table = SymbolTable::get_instance();
+    const uint32_t id = table.intern("SCALE/USD");
+    table.setScale(id, 2, 4);
+
+    // 123.45 with a volume of 0.001, at whatever scale the table has now.
+    auto bar = [&](int64_t minute) {
+        CompactBar out = makeBar(id, DAY0 + minute * MINUTE, fixed_point::fromDouble(123.45, table.priceDecimals(id)));
+        out.volume = fixed_point::fromDouble(0.001, table.sizeDecimals(id));
+        return out;
+    };
+    {
+        BarStoreWriter writer(root);
+        writer.append(bar(0));
+        // Mid-day, with the day's files open.
+        table.setScale(id, 4, 6);
+        writer.append(bar(1));
+    }
+    {
+        // And after reopening them.
+        BarStoreWriter writer(root);
+        writer.append(bar(2));
+    }
+
+    BarStoreReader reader(root);
+    auto slices = reader.query("SCALE/USD", DAY0, DAY0 + bar_store::NS_PER_DAY);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), slices.size());
+    const BarSlice& slice = slices[0];
+    CPPUNIT_ASSERT_EQUAL(size_t(3), slice.size());
+    CPPUNIT_ASSERT_EQUAL(uint8_t(2), slice.priceDecimals);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(4), slice.sizeDecimals);
+    for (size_t i = 0; i < 3; ++i) {
+        CPPUNIT_ASSERT_EQUAL(int64_t(12345), slice.close[i]);
+        CPPUNIT_ASSERT_EQUAL(int64_t(10), slice.volume[i]);
+    }
+}
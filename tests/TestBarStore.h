@@ -0,0 +1,29 @@
+#ifndef TESTBARSTORE_H
+#define TESTBARSTORE_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "bar_store.h"
+
+class TestBarStore : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestBarStore);
+    CPPUNIT_TEST(testRangeQueryAcrossDays);
+    CPPUNIT_TEST(testBackgroundWriterAndReopen);
+    CPPUNIT_TEST(testColumnsFeedBatchIndicators);
+    CPPUNIT_TEST(testScaleChangeKeepsHeaderDecimals);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testRangeQueryAcrossDays();
+    void testBackgroundWriterAndReopen();
+    void testColumnsFeedBatchIndicators();
+    void testScaleChangeKeepsHeaderDecimals();
+
+private:
+    string root;
+};
+
+#endif
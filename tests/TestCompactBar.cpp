@@ -0,0 +1,78 @@
+#include "TestCompactBar.h"
+#include <cppunit/TestAssert.h>
+
+void TestCompactBar::testFixedPointParse() {
+    int64_t value = 0;
+
+    CPPUNIT_ASSERT(fixed_point::parse("64250.5", 8, value));
+    CPPUNIT_ASSERT_EQUAL(int64_t(6425050000000LL), value);
+
+    CPPUNIT_ASSERT(fixed_point::parse("-0.00001234", 8, value));
+    CPPUNIT_ASSERT_EQUAL(int64_t(-1234), value);
+
+    CPPUNIT_ASSERT(fixed_point::parse("1.5e-05", 8, value));
+    CPPUNIT_ASSERT_EQUAL(int64_t(1500), value);
+
+    CPPUNIT_ASSERT(fixed_point::parse("0.123456789", 8, value));
+    CPPUNIT_ASSERT_EQUAL(int64_t(12345679), value);
+
+    CPPUNIT_ASSERT(fixed_point::parse("42", 0, value));
+    CPPUNIT_ASSERT_EQUAL(int64_t(42), value);
+
+    CPPUNIT_ASSERT(!fixed_point::parse("1.2.3", 8, value));
+    CPPUNIT_ASSERT(!fixed_point::parse("99999999999999", 8, value));
+}
+
+void TestCompactBar::testFixedPointRescale() {
+    CPPUNIT_ASSERT_EQUAL(int64_t(123000), fixed_point::rescale(123, 2, 5));
+    CPPUNIT_ASSERT_EQUAL(int64_t(124), fixed_point::rescale(12350, 4, 2));
+    CPPUNIT_ASSERT_EQUAL(int64_t(-124), fixed_point::rescale(-12350, 4, 2));
+}
+
+void TestCompactBar::testRoundTripThroughBar() {
+    Bar bar;
+    bar.T = "b";
+    bar.S = "ETH/USD";
+    bar.o = 3500.25;
+    bar.h = 3510.5;
+    bar.l = 3490.125;
+    bar.c = 3505.0;
+    bar.v = 12.75;
+    bar.t = "2024-03-12T15:04:00Z";
+    bar.n = 17;
+    bar.vw = 3501.5;
+
+    CompactBar compact = bar.toCompact();
+    CPPUNIT_ASSERT(SymbolTable::get_instance().name(compact.symbolId) == "ETH/USD");
+    CPPUNIT_ASSERT_EQUAL(int64_t(350025000000LL), compact.open);
+    CPPUNIT_ASSERT_EQUAL(uint32_t(17), compact.tradeCount);
+
+    Bar back(compact);
+    CPPUNIT_ASSERT(back.S == bar.S);
+    CPPUNIT_ASSERT(back.t == bar.t);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(bar.l, back.l, 1e-12);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(bar.v, back.v, 1e-12);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(bar.vw, back.vw, 1e-12);
+}
+
+void TestCompactBar::testPerSymbolScale() {
+    SymbolTable& symbols = SymbolTable::get_instance();
+    uint32_t id = symbols.intern("SCALE/TEST");
+    symbols.setScale(id, 2, 0);
+
+    Bar bar;
+    bar.S = "SCALE/TEST";
+    bar.t = "2024-03-12T15:04:00.25Z";
+    bar.o = 101.23;
+    bar.v = 300;
+
+    CompactBar compact = bar.toCompact();
+    CPPUNIT_ASSERT_EQUAL(int64_t(10123), compact.open);
+    CPPUNIT_ASSERT_EQUAL(int64_t(300), compact.volume);
+    CPPUNIT_ASSERT(Bar(compact).t == "2024-03-12T15:04:00.25Z");
+
+    CPPUNIT_ASSERT_EQUAL(SymbolTable::DEFAULT_PRICE_DECIMALS, symbols.priceDecimals(SymbolTable::INVALID_ID));
+    CPPUNIT_ASSERT_EQUAL(SymbolTable::DEFAULT_SIZE_DECIMALS, symbols.sizeDecimals(SymbolTable::CAPACITY));
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestCompactBar);
@@ -0,0 +1,25 @@
+#ifndef TESTCOMPACTBAR_H
+#define TESTCOMPACTBAR_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "bar.h"
+#include "fixed_point.h"
+#include "symbol_table.h"
+
+class TestCompactBar : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestCompactBar);
+    CPPUNIT_TEST(testFixedPointParse);
+    CPPUNIT_TEST(testFixedPointRescale);
+    CPPUNIT_TEST(testRoundTripThroughBar);
+    CPPUNIT_TEST(testPerSymbolScale);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testFixedPointParse();
+    void testFixedPointRescale();
+    void testRoundTripThroughBar();
+    void testPerSymbolScale();
+};
+
+#endif
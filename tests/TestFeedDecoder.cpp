@@ -0,0 +1,134 @@
+#include "TestFeedDecoder.h"
+#include <cppunit/TestAssert.h>
+
+void TestFeedDecoder::testDecodeBarArray() {
+    FeedDecoder decoder;
+    DecodedBatch batch;
+
+    std::string frame = "[{\"T\":\"b\",\"S\":\"BTC/USD\",\"o\":64250.5,\"h\":64300,\"l\":64200.25,\"c\":64290.75,"
+                        "\"v\":1.25,\"t\":\"2024-03-12T15:04:00Z\",\"n\":42,\"vw\":64270.1},"
+                        "{\"T\":\"b\",\"S\":\"DOGE/USD\",\"o\":0.15,\"h\":0.16,\"l\":0.14,\"c\":0.155,"
+                        "\"v\":1000,\"t\":\"2024-03-12T15:04:00.5Z\",\"n\":3,\"vw\":0.151}]";
+
+    CPPUNIT_ASSERT(decoder.decode(frame, batch) == DecodeStatus::Ok);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), batch.bars.size());
+
+    const CompactBar& btc = batch.bars[0];
+    CPPUNIT_ASSERT(SymbolTable::get_instance().name(btc.symbolId) == "BTC/USD");
+    CPPUNIT_ASSERT_EQUAL(int64_t(6425050000000LL), btc.open);
+    CPPUNIT_ASSERT_EQUAL(int64_t(6429075000000LL), btc.close);
+    CPPUNIT_ASSERT_EQUAL(int64_t(6427010000000LL), btc.vwap);
+    CPPUNIT_ASSERT_EQUAL(int64_t(125000000LL), btc.volume);
+    CPPUNIT_ASSERT_EQUAL(uint32_t(42), btc.tradeCount);
+    CPPUNIT_ASSERT_EQUAL(int64_t(1710255840000000000LL), btc.timestampNs);
+
+    const CompactBar& doge = batch.bars[1];
+    CPPUNIT_ASSERT(SymbolTable::get_instance().name(doge.symbolId) == "DOGE/USD");
+    CPPUNIT_ASSERT_EQUAL(int64_t(1710255840500000000LL), doge.timestampNs);
+}
+
+void TestFeedDecoder::testDecodeTradesAndQuotes() {
+    FeedDecoder decoder;
+    DecodedBatch batch;
+
+    std::string frame = "[{\"T\":\"t\",\"S\":\"ETH/USD\",\"p\":3500.5,\"s\":0.2,\"t\":\"2024-03-12T15:04:05.123456789Z\",\"i\":991,\"tks\":\"B\"},"
+                        " {\"T\":\"q\",\"S\":\"ETH/USD\",\"bp\":3500.1,\"bs\":1.5,\"ap\":3500.9,\"as\":2,\"t\":\"2024-03-12T15:04:05Z\",\"c\":[\"R\"]}]";
+
+    CPPUNIT_ASSERT(decoder.decode(frame, batch) == DecodeStatus::Ok);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), batch.trades.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), batch.quotes.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(2), batch.order.size());
+    CPPUNIT_ASSERT(batch.order[0] == EventType::Trade);
+    CPPUNIT_ASSERT(batch.order[1] == EventType::Quote);
+
+    CPPUNIT_ASSERT_EQUAL('B', batch.trades[0].takerSide);
+    CPPUNIT_ASSERT_EQUAL(int64_t(991), batch.trades[0].tradeId);
+    CPPUNIT_ASSERT_EQUAL(int64_t(1710255845123456789LL), batch.trades[0].timestampNs);
+    CPPUNIT_ASSERT_EQUAL(int64_t(350090000000LL), batch.quotes[0].askPrice);
+    CPPUNIT_ASSERT_EQUAL(batch.trades[0].symbolId, batch.quotes[0].symbolId);
+}
+
+void TestFeedDecoder::testDecodeUpdatedAndDailyBars() {
+    FeedDecoder decoder;
+    DecodedBatch batch;
+
+    std::string frame = "[{\"T\":\"u\",\"S\":\"AAPL\",\"o\":170.1,\"h\":170.5,\"l\":170,\"c\":170.4,\"v\":1200,"
+                        "\"t\":\"2024-03-12T15:04:00Z\",\"n\":12,\"vw\":170.3},"
+                        "{\"T\":\"d\",\"S\":\"AAPL\",\"o\":169,\"h\":171,\"l\":168.5,\"c\":170.4,\"v\":900000,"
+                        "\"t\":\"2024-03-12T04:00:00Z\",\"n\":8000,\"vw\":170.2},"
+                        "{\"T\":\"b\",\"S\":\"AAPL\",\"o\":170.4,\"h\":170.6,\"l\":170.3,\"c\":170.5,\"v\":800,"
+                        "\"t\":\"2024-03-12T15:05:00Z\",\"n\":9,\"vw\":170.45}]";
+
+    CPPUNIT_ASSERT(decoder.decode(frame, batch) == DecodeStatus::Ok);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), batch.bars.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), batch.updatedBars.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), batch.dailyBars.size());
+    CPPUNIT_ASSERT_EQUAL(int64_t(17040000000LL), batch.updatedBars[0].close);
+    CPPUNIT_ASSERT_EQUAL(uint32_t(8000), batch.dailyBars[0].tradeCount);
+    CPPUNIT_ASSERT_EQUAL(int64_t(17050000000LL), batch.bars[0].close);
+
+    // A malformed element rolls every kind back.
+    CPPUNIT_ASSERT(decoder.decode("[{\"T\":\"u\",\"S\":\"AAPL\",\"c\":1,\"t\":\"2024-03-12T15:04:00Z\"},"
+                                  "{\"T\":\"d\",\"S\":\"AAPL\",\"c\":\"x\"}]", batch) == DecodeStatus::Malformed);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), batch.updatedBars.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), batch.dailyBars.size());
+}
+
+void TestFeedDecoder::testControlMessageFallsBack() {
+    FeedDecoder decoder;
+    DecodedBatch batch;
+
+    CPPUNIT_ASSERT(decoder.decode("[{\"T\":\"success\",\"msg\":\"authenticated\"}]", batch) == DecodeStatus::Fallback);
+    CPPUNIT_ASSERT(decoder.decode("[{\"T\":\"subscription\",\"bars\":[\"BTC/USD\"]}]", batch) == DecodeStatus::Fallback);
+    CPPUNIT_ASSERT(batch.empty());
+}
+
+void TestFeedDecoder::testMalformedFrameRollsBack() {
+    FeedDecoder decoder;
+    DecodedBatch batch;
+
+    std::string frame = "[{\"T\":\"b\",\"S\":\"BTC/USD\",\"o\":1,\"t\":\"2024-03-12T15:04:00Z\"},{\"T\":\"b\",\"S\":";
+    CPPUNIT_ASSERT(decoder.decode(frame, batch) == DecodeStatus::Malformed);
+    CPPUNIT_ASSERT(batch.empty());
+}
+
+void TestFeedDecoder::testSkipsElementWithoutSymbolOrTimestamp() {
+    FeedDecoder decoder;
+    DecodedBatch batch;
+
+    std::string frame = "[{\"T\":\"q\",\"S\":\"BTC/USD\",\"bp\":64000,\"bs\":1,\"ap\":64001,\"as\":1,"
+                        "\"t\":\"yesterday\"},"
+                        "{\"T\":\"b\",\"S\":\"\",\"o\":1,\"t\":\"2024-03-12T15:04:00Z\"},"
+                        "{\"T\":\"t\",\"S\":\"BTC/USD\",\"p\":64000.5,\"s\":0.1},"
+                        "{\"T\":\"t\",\"S\":\"BTC/USD\",\"p\":64001,\"s\":0.2,\"t\":\"2024-03-12T15:04:05Z\",\"i\":7}]";
+
+    CPPUNIT_ASSERT(decoder.decode(frame, batch) == DecodeStatus::Ok);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(3), decoder.skipped());
+    CPPUNIT_ASSERT(batch.bars.empty());
+    CPPUNIT_ASSERT(batch.quotes.empty());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), batch.trades.size());
+    CPPUNIT_ASSERT_EQUAL(size_t(1), batch.order.size());
+    CPPUNIT_ASSERT_EQUAL(int64_t(7), batch.trades[0].tradeId);
+    CPPUNIT_ASSERT(SymbolTable::get_instance().find("") == SymbolTable::INVALID_ID);
+}
+
+void TestFeedDecoder::testUnknownTypeDoesNotInternSymbol() {
+    FeedDecoder decoder;
+    DecodedBatch batch;
+
+    CPPUNIT_ASSERT(decoder.decode("[{\"T\":\"x\",\"S\":\"NOT/A/SYMBOL\",\"t\":\"2024-03-12T15:04:00Z\"}]", batch) ==
+                   DecodeStatus::Fallback);
+    CPPUNIT_ASSERT(batch.empty());
+    CPPUNIT_ASSERT(SymbolTable::get_instance().find("NOT/A/SYMBOL") == SymbolTable::INVALID_ID);
+}
+
+void TestFeedDecoder::testParseTimestamp() {
+    int64_t ns = 0;
+    CPPUNIT_ASSERT(FeedDecoder::parseTimestamp("1970-01-01T00:00:00Z", ns));
+    CPPUNIT_ASSERT_EQUAL(int64_t(0), ns);
+    CPPUNIT_ASSERT(FeedDecoder::parseTimestamp("2024-03-12T16:04:00+01:00", ns));
+    CPPUNIT_ASSERT_EQUAL(int64_t(1710255840000000000LL), ns);
+    CPPUNIT_ASSERT(!FeedDecoder::parseTimestamp("2024-03-12 garbage", ns));
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestFeedDecoder);
@@ -0,0 +1,31 @@
+#ifndef TESTFEEDDECODER_H
+#define TESTFEEDDECODER_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "feed_decoder.h"
+
+class TestFeedDecoder : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestFeedDecoder);
+    CPPUNIT_TEST(testDecodeBarArray);
+    CPPUNIT_TEST(testDecodeTradesAndQuotes);
+    CPPUNIT_TEST(testDecodeUpdatedAndDailyBars);
+    CPPUNIT_TEST(testControlMessageFallsBack);
+    CPPUNIT_TEST(testMalformedFrameRollsBack);
+    CPPUNIT_TEST(testSkipsElementWithoutSymbolOrTimestamp);
+    CPPUNIT_TEST(testUnknownTypeDoesNotInternSymbol);
+    CPPUNIT_TEST(testParseTimestamp);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testDecodeBarArray();
+    void testDecodeTradesAndQuotes();
+    void testDecodeUpdatedAndDailyBars();
+    void testControlMessageFallsBack();
+    void testMalformedFrameRollsBack();
+    void testSkipsElementWithoutSymbolOrTimestamp();
+    void testUnknownTypeDoesNotInternSymbol();
+    void testParseTimestamp();
+};
+
+#endif
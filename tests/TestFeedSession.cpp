@@ -0,0 +1,221 @@
+#include "TestFeedSession.h"
+#include <cppunit/TestAssert.h>
+#include <filesystem>
+#include <thread>
+#include <unistd.h>
+
+#include "bar_store.h"
+#include "exchange_simulator.h"
+#include "symbol_table.h"
+
+namespace {
+    const int64_t MINUTE = 60LL * 1000000000LL;
+    // 2024-01-01T00:00:00Z
+    const int64_t DAY0 = 1704067200LL * 1000000000LL;
+
+    CompactBar makeBar(uint32_t symbolId, int64_t timestampNs, int64_t close) {
+        CompactBar bar{};
+        bar.timestampNs = timestampNs;
+        bar.open = bar.high = bar.low = bar.close = bar.vwap = close;
+        bar.volume = 1;
+        bar.symbolId = symbolId;
+        bar.tradeCount = 1;
+        return bar;
+    }
+
+    std::vector<int64_t> closes(const std::vector<CompactBar>& bars) {
+        std::vector<int64_t> out;
+        for (const CompactBar& bar : bars) out.push_back(bar.close);
+        return out;
+    }
+}
+
+void TestFeedSession::testBackoff() {
+    FeedSessionConfig config;
+    config.backoffInitial = std::chrono::milliseconds(100);
+    config.backoffMax = std::chrono::milliseconds(1000);
+    Backoff backoff(config);
+
+    // Windows of 100, 200, 400, 800, then capped at 1000; each delay falls
+    // in the upper half of its window.
+    const int64_t windows[] = {100, 200, 400, 800, 1000, 1000};
+    for (int64_t window : windows) {
+        const int64_t delay = backoff.next().count();
+        CPPUNIT_ASSERT(delay >= window / 2 && delay <= window);
+    }
+    CPPUNIT_ASSERT_EQUAL(6u, backoff.attempts());
+
+    backoff.reset();
+    CPPUNIT_ASSERT(backoff.next().count() <= 100);
+}
+
+void TestFeedSession::testSubscriptionSet() {
+    SubscriptionSet set;
+    CPPUNIT_ASSERT(set.empty());
+    CPPUNIT_ASSERT(set.subscribeMessage().empty());
+
+    set.add("bars", {"BTC/USD", "ETH/USD"});
+    set.add("quotes", {"BTC/USD"});
+    set.add("bars", {"BTC/USD"});
+    set.remove("bars", {"ETH/USD"});
+    set.remove("trades", {"BTC/USD"});
+    CPPUNIT_ASSERT(set.symbols("bars") == std::vector<string>{"BTC/USD"});
+    CPPUNIT_ASSERT_EQUAL(string(R"({"action":"subscribe","bars":["BTC/USD"],"quotes":["BTC/USD"]})"),
+                         set.subscribeMessage());
+
+    set.remove("quotes", {"BTC/USD"});
+    set.remove("bars", {"BTC/USD"});
+    CPPUNIT_ASSERT(set.empty());
+}
+
+void TestFeedSession::testGapDetector() {
+    const uint32_t id = SymbolTable::get_instance().intern("GAP/USD");
+    const uint32_t other = SymbolTable::get_instance().intern("GAQ/USD");
+    GapDetector detector(std::chrono::seconds(60), 16);
+    std::vector<CompactBar> out;
+    BarGap gap;
+
+    CPPUNIT_ASSERT(!detector.onBar(makeBar(id, DAY0, 1), out, gap));
+    CPPUNIT_ASSERT(!detector.onBar(makeBar(id, DAY0 + MINUTE, 2), out, gap));
+    // A repeat, e.g. resent after a reconnect.
+    CPPUNIT_ASSERT(!detector.onBar(makeBar(id, DAY0 + MINUTE, 2), out, gap));
+    CPPUNIT_ASSERT(closes(out) == std::vector<int64_t>({1, 2}));
+
+    // Minutes 2 to 4 are missing; minute 5 and everything after is held.
+    out.clear();
+    CPPUNIT_ASSERT(detector.onBar(makeBar(id, DAY0 + 5 * MINUTE, 6), out, gap));
+    CPPUNIT_ASSERT_EQUAL(id, gap.symbolId);
+    CPPUNIT_ASSERT_EQUAL(DAY0 + MINUTE, gap.afterNs);
+    CPPUNIT_ASSERT_EQUAL(DAY0 + 5 * MINUTE, gap.beforeNs);
+    CPPUNIT_ASSERT_EQUAL(size_t(3), gap.missing());
+    CPPUNIT_ASSERT(!detector.onBar(makeBar(id, DAY0 + 6 * MINUTE, 7), out, gap));
+    CPPUNIT_ASSERT(out.empty());
+    CPPUNIT_ASSERT(detector.pending(id));
+
+    // Other symbols are not held up.
+    CPPUNIT_ASSERT(!detector.onBar(makeBar(other, DAY0 + 5 * MINUTE, 100), out, gap));
+    CPPUNIT_ASSERT(closes(out) == std::vector<int64_t>({100}));
+
+    // The backfill arrives unsorted, with a bar outside the gap and one of
+    // the missing minutes absent.
+    out.clear();
+    detector.complete(gap,
+                      {makeBar(id, DAY0 + 4 * MINUTE, 5), makeBar(id, DAY0 + 2 * MINUTE, 3),
+                       makeBar(id, DAY0 + 5 * MINUTE, 99)},
+                      out);
+    CPPUNIT_ASSERT(closes(out) == std::vector<int64_t>({3, 5, 6, 7}));
+    CPPUNIT_ASSERT(!detector.pending(id));
+
+    FeedSessionStats stats;
+    detector.stats(stats);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), stats.gaps);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(3), stats.missingBars);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), stats.backfilledBars);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), stats.duplicateBars);
+}
+
+void TestFeedSession::testAbandonedGap() {
+    const uint32_t id = SymbolTable::get_instance().intern("GAR/USD");
+    GapDetector detector(std::chrono::seconds(60), 3);
+    std::vector<CompactBar> out;
+    BarGap gap;
+
+    detector.onBar(makeBar(id, DAY0, 1), out, gap);
+    CPPUNIT_ASSERT(detector.onBar(makeBar(id, DAY0 + 3 * MINUTE, 4), out, gap));
+    const BarGap first = gap;
+    detector.onBar(makeBar(id, DAY0 + 4 * MINUTE, 5), out, gap);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), out.size());
+
+    // The third held bar releases everything without the backfill.
+    detector.onBar(makeBar(id, DAY0 + 5 * MINUTE, 6), out, gap);
+    CPPUNIT_ASSERT(closes(out) == std::vector<int64_t>({1, 4, 5, 6}));
+    CPPUNIT_ASSERT(!detector.pending(id));
+
+    // A late backfill would go out of order, so it is ignored.
+    out.clear();
+    detector.complete(first, {makeBar(id, DAY0 + MINUTE, 2)}, out);
+    CPPUNIT_ASSERT(out.empty());
+
+    FeedSessionStats stats;
+    detector.stats(stats);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), stats.abandonedGaps);
+}
+
+void TestFeedSession::testBackfillFromStore() {
+    const string root = "/tmp/hft_test_feed_session_" + std::to_string(::getpid());
+    std::filesystem::remove_all(root);
+    const uint32_t id = SymbolTable::get_instance().intern("GAS/USD");
+    {
+        BarStoreWriter writer(root);
+        for (int64_t minute = 0; minute < 10; ++minute) {
+            writer.append(makeBar(id, DAY0 + minute * MINUTE, minute));
+        }
+    }
+
+    FeedSessionConfig config;
+    config.barStoreRoot = root;
+    config.restHost.clear();
+    BarBackfill backfill(config, "key", "secret");
+    BarGap gap;
+    gap.symbolId = id;
+    gap.afterNs = DAY0 + 2 * MINUTE;
+    gap.beforeNs = DAY0 + 6 * MINUTE;
+    gap.intervalNs = MINUTE;
+    CPPUNIT_ASSERT(closes(backfill.fetch(gap)) == std::vector<int64_t>({3, 4, 5}));
+
+    // Asynchronously, through the callback.
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<CompactBar> received;
+    bool done = false;
+    backfill.start([&](const BarGap&, std::vector<CompactBar> bars) {
+        std::lock_guard<std::mutex> lock(mutex);
+        received = std::move(bars);
+        done = true;
+        cv.notify_one();
+    });
+    gap.beforeNs = DAY0 + 20 * MINUTE;
+    backfill.request(gap);
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        CPPUNIT_ASSERT(cv.wait_for(lock, std::chrono::seconds(5), [&]() { return done; }));
+    }
+    CPPUNIT_ASSERT(closes(received) == std::vector<int64_t>({3, 4, 5, 6, 7, 8, 9}));
+    backfill.stop();
+    std::filesystem::remove_all(root);
+}
+
+void TestFeedSession::testBackfillFromSimulator() {
+    ExchangeSimulatorConfig simConfig;
+    simConfig.restPort = 0;
+    simConfig.streamPort = 0;
+    simConfig.tickInterval = std::chrono::milliseconds(5);
+    simConfig.barTicks = 1;
+    ExchangeSimulator simulator(simConfig);
+    const int64_t startNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    simulator.start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    FeedSessionConfig config;
+    config.restHost = "127.0.0.1";
+    config.restPort = std::to_string(simulator.restPort());
+    BarBackfill backfill(config, "key", "secret");
+    BarGap gap;
+    gap.symbolId = SymbolTable::get_instance().find("BTC/USD");
+    gap.afterNs = startNs;
+    gap.beforeNs = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    gap.intervalNs = 5000000;
+    const std::vector<CompactBar> bars = backfill.fetch(gap);
+    simulator.stop();
+
+    CPPUNIT_ASSERT(bars.size() >= 10);
+    int64_t previous = gap.afterNs;
+    for (const CompactBar& bar : bars) {
+        CPPUNIT_ASSERT_EQUAL(gap.symbolId, bar.symbolId);
+        CPPUNIT_ASSERT(bar.timestampNs > previous && bar.timestampNs < gap.beforeNs);
+        CPPUNIT_ASSERT(bar.close > 0 && bar.low <= bar.close && bar.close <= bar.high);
+        previous = bar.timestampNs;
+    }
+}
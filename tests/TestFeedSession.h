@@ -0,0 +1,27 @@
+#ifndef TESTFEEDSESSION_H
+#define TESTFEEDSESSION_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "feed_session.h"
+
+class TestFeedSession : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestFeedSession);
+    CPPUNIT_TEST(testBackoff);
+    CPPUNIT_TEST(testSubscriptionSet);
+    CPPUNIT_TEST(testGapDetector);
+    CPPUNIT_TEST(testAbandonedGap);
+    CPPUNIT_TEST(testBackfillFromStore);
+    CPPUNIT_TEST(testBackfillFromSimulator);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testBackoff();
+    void testSubscriptionSet();
+    void testGapDetector();
+    void testAbandonedGap();
+    void testBackfillFromStore();
+    void testBackfillFromSimulator();
+};
+
+#endif
@@ -0,0 +1,135 @@
+#include "TestIndicators.h"
+#include <cppunit/TestAssert.h>
+#include <random>
+
+namespace {
+    const size_t WINDOW = 16;
+    const double EPSILON = 1e-9;
+
+    std::vector<double> randomWalk(size_t n) {
+        std::mt19937_64 rng(42);
+        std::normal_distribution<double> step(0.0, 1.0);
+        std::vector<double> prices(n);
+        double price = 100.0;
+        for (auto& p : prices) {
+            price += step(rng);
+            p = price;
+        }
+        return prices;
+    }
+}
+
+void TestIndicators::testStreamingMatchesNaive() {
+    std::vector<double> prices = randomWalk(1000);
+    indicators::Sma<WINDOW> sma;
+    indicators::RollingVwap<WINDOW> vwap;
+    indicators::RollingMin<WINDOW> low;
+    indicators::RollingMax<WINDOW> high;
+    indicators::RollingVariance<WINDOW> variance;
+
+    for (size_t i = 0; i < prices.size(); ++i) {
+        const double volume = 1.0 + static_cast<double>(i % 7);
+        sma.update(prices[i]);
+        vwap.update(prices[i], volume);
+        low.update(prices[i]);
+        high.update(prices[i]);
+        variance.update(prices[i]);
+
+        const size_t first = i + 1 >= WINDOW ? i + 1 - WINDOW : 0;
+        double sum = 0, notional = 0, traded = 0;
+        double lo = prices[first], hi = prices[first];
+        for (size_t j = first; j <= i; ++j) {
+            sum += prices[j];
+            notional += prices[j] * (1.0 + static_cast<double>(j % 7));
+            traded += 1.0 + static_cast<double>(j % 7);
+            lo = std::min(lo, prices[j]);
+            hi = std::max(hi, prices[j]);
+        }
+        const double count = static_cast<double>(i + 1 - first);
+        const double mean = sum / count;
+        double squares = 0;
+        for (size_t j = first; j <= i; ++j) squares += (prices[j] - mean) * (prices[j] - mean);
+
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(mean, sma.value(), EPSILON);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(notional / traded, vwap.value(), EPSILON);
+        CPPUNIT_ASSERT_EQUAL(lo, low.value());
+        CPPUNIT_ASSERT_EQUAL(hi, high.value());
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(mean, variance.mean(), EPSILON);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(squares / count, variance.variance(), 1e-7);
+        CPPUNIT_ASSERT_EQUAL(i + 1 >= WINDOW, sma.ready());
+    }
+}
+
+void TestIndicators::testWilderIndicators() {
+    indicators::Ema<3> ema;
+    ema.update(1);
+    ema.update(2);
+    ema.update(3);
+    CPPUNIT_ASSERT(ema.ready());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(2.0, ema.value(), EPSILON);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(3.0, ema.update(4), EPSILON);
+
+    indicators::Atr<2> atr;
+    atr.update(10, 8, 9);   // TR 2
+    atr.update(12, 9, 11);  // TR 3
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(2.5, atr.value(), EPSILON);
+    atr.update(11, 10, 10); // TR 1 -> (2.5 + 1) / 2
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1.75, atr.value(), EPSILON);
+    atr.update(15, 14, 14); // gap up, TR = 15 - 10 = 5
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(3.375, atr.value(), EPSILON);
+
+    indicators::Rsi<2> rsi;
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(50.0, rsi.update(10), EPSILON);
+    rsi.update(12);  // +2
+    rsi.update(11);  // -1 -> avg gain 1, avg loss 0.5
+    CPPUNIT_ASSERT(rsi.ready());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(100.0 - 100.0 / 3.0, rsi.value(), EPSILON);
+
+    indicators::Rsi<2> rising;
+    for (double p : {1, 2, 3, 4}) rising.update(p);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(100.0, rising.value(), EPSILON);
+}
+
+void TestIndicators::testBatchMatchesStreaming() {
+    std::vector<double> prices = randomWalk(500);
+    std::vector<int64_t> fixed(prices.size()), volumes(prices.size());
+    for (size_t i = 0; i < prices.size(); ++i) {
+        fixed[i] = static_cast<int64_t>(std::llround(prices[i] * 1e8));
+        volumes[i] = static_cast<int64_t>(1 + i % 5) * 100000000LL;
+    }
+    const size_t n = fixed.size();
+
+    std::vector<double> sma(n), vwap(n), low(n), high(n), z(n);
+    indicators::batch::sma(fixed.data(), n, WINDOW, sma.data(), 1e-8);
+    indicators::batch::rollingVwap(fixed.data(), volumes.data(), n, WINDOW, vwap.data(), 1e-8, 1e-8);
+    indicators::batch::rollingMin(fixed.data(), n, WINDOW, low.data(), 1e-8);
+    indicators::batch::rollingMax(fixed.data(), n, WINDOW, high.data(), 1e-8);
+    indicators::batch::zScore(fixed.data(), n, WINDOW, z.data(), 1e-8);
+
+    indicators::Sma<WINDOW> streamSma;
+    indicators::RollingVwap<WINDOW> streamVwap;
+    indicators::RollingMin<WINDOW> streamLow;
+    indicators::RollingMax<WINDOW> streamHigh;
+    indicators::RollingVariance<WINDOW> streamVariance;
+
+    for (size_t i = 0; i < n; ++i) {
+        const double price = static_cast<double>(fixed[i]) * 1e-8;
+        streamSma.update(price);
+        streamVwap.update(price, static_cast<double>(volumes[i]) * 1e-8);
+        streamLow.update(price);
+        streamHigh.update(price);
+        streamVariance.update(price);
+
+        if (i + 1 < WINDOW) {
+            CPPUNIT_ASSERT(std::isnan(sma[i]) && std::isnan(low[i]) && std::isnan(z[i]));
+            continue;
+        }
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(streamSma.value(), sma[i], 1e-7);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(streamVwap.value(), vwap[i], 1e-7);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(streamLow.value(), low[i], 1e-12);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(streamHigh.value(), high[i], 1e-12);
+        CPPUNIT_ASSERT_DOUBLES_EQUAL(streamVariance.zScore(price), z[i], 1e-5);
+    }
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestIndicators);
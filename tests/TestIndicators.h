@@ -0,0 +1,21 @@
+#ifndef TESTINDICATORS_H
+#define TESTINDICATORS_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "indicators.h"
+
+class TestIndicators : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestIndicators);
+    CPPUNIT_TEST(testStreamingMatchesNaive);
+    CPPUNIT_TEST(testWilderIndicators);
+    CPPUNIT_TEST(testBatchMatchesStreaming);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testStreamingMatchesNaive();
+    void testWilderIndicators();
+    void testBatchMatchesStreaming();
+};
+
+#endif
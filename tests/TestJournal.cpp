@@ -0,0 +1,131 @@
+#include "TestJournal.h"
+#include <cppunit/TestAssert.h>
+#include <cmath>
+#include <cstdio>
+#include <unistd.h>
+#include <vector>
+#include "client.h"
+#include "feed_decoder.h"
+#include "sma_crossover.h"
+
+void TestJournal::setUp() {
+    path = "/tmp/hft_test_journal_" + std::to_string(::getpid()) + ".bin";
+}
+
+void TestJournal::tearDown() {
+    std::remove(path.c_str());
+}
+
+void TestJournal::testRoundTripAcrossGrowth() {
+    std::vector<string> frames;
+    {
+        JournalWriterConfig config;
+        config.growBytes = 4096;
+        JournalWriter writer(path, config);
+        for (int i = 0; i < 2000; ++i) {
+            frames.push_back("frame-" + std::to_string(i) + string(i % 37, 'x'));
+            writer.append(1000 + i, frames.back());
+        }
+        writer.append(5000, "");
+        CPPUNIT_ASSERT_EQUAL(uint64_t(2000), writer.records());
+    }
+
+    JournalReader reader(path);
+    JournalRecord record;
+    for (int pass = 0; pass < 2; ++pass) {
+        size_t i = 0;
+        while (reader.next(record)) {
+            CPPUNIT_ASSERT(i < frames.size());
+            CPPUNIT_ASSERT_EQUAL(int64_t(1000 + i), record.receiveNs);
+            CPPUNIT_ASSERT_EQUAL(frames[i], string(record.payload));
+            ++i;
+        }
+        CPPUNIT_ASSERT_EQUAL(frames.size(), i);
+        reader.rewind();
+    }
+}
+
+void TestJournal::testTornRecordEndsJournal() {
+    {
+        JournalWriter writer(path);
+        writer.append(1, "first");
+        writer.append(2, "second frame");
+    }
+
+    // Chop the last record in half, as a crash mid-append would.
+    FILE* file = std::fopen(path.c_str(), "r+");
+    std::fseek(file, 0, SEEK_END);
+    long size = std::ftell(file);
+    std::fclose(file);
+    CPPUNIT_ASSERT_EQUAL(0, ::truncate(path.c_str(), size - 8));
+
+    JournalReader reader(path);
+    JournalRecord record;
+    CPPUNIT_ASSERT(reader.next(record));
+    CPPUNIT_ASSERT_EQUAL(string("first"), string(record.payload));
+    CPPUNIT_ASSERT(!reader.next(record));
+}
+
+void TestJournal::testScaledReplayPacing() {
+    {
+        JournalWriter writer(path);
+        for (int i = 0; i < 5; ++i) {
+            writer.append(int64_t(i) * 20000000, "tick");
+        }
+    }
+
+    JournalReader reader(path);
+    std::vector<int64_t> seen;
+    ReplayConfig fast;
+    ReplayStats stats = replayJournal(reader, fast, [&](const JournalRecord& r) { seen.push_back(r.receiveNs); });
+    CPPUNIT_ASSERT_EQUAL(uint64_t(5), stats.frames);
+    CPPUNIT_ASSERT_EQUAL(int64_t(80000000), stats.recordedNs);
+    CPPUNIT_ASSERT(stats.elapsedNs < 40000000);
+
+    // 80 ms of recording at 4x takes at least 20 ms.
+    reader.rewind();
+    ReplayConfig scaled;
+    scaled.speed = 4.0;
+    std::vector<int64_t> paced;
+    stats = replayJournal(reader, scaled, [&](const JournalRecord& r) { paced.push_back(r.receiveNs); });
+    CPPUNIT_ASSERT(stats.elapsedNs >= 20000000);
+    CPPUNIT_ASSERT(seen == paced);
+}
+
+void TestJournal::testClientReplayIsDeterministic() {
+    {
+        JournalWriter writer(path);
+        writer.append(1, R"([{"T":"success","msg":"connected"}])");
+        for (int i = 0; i < 400; ++i) {
+            const string symbol = i % 2 ? "BTC/USD" : "ETH/USD";
+            const double close = 100.0 + 10.0 * std::sin(i / 12.0);
+            const string price = std::to_string(close);
+            const int64_t ts = 1700000000000000000LL + int64_t(i) * 60000000000LL;
+            writer.append(ts, "[{\"T\":\"b\",\"S\":\"" + symbol + "\",\"o\":" + price + ",\"h\":" + price +
+                              ",\"l\":" + price + ",\"c\":" + price + ",\"v\":1,\"t\":\"" +
+                              FeedDecoder::formatTimestamp(ts) + "\",\"n\":1,\"vw\":" + price + "}]");
+        }
+    }
+
+    auto run = [this]() {
+        WebClient client;
+        ShardPipelineConfig pipeline;
+        pipeline.shards = 2;
+        client.setMarketDataPipeline(pipeline);
+        client.setStrategyFactory([]() {
+            return makeStrategyRunner(StrategyEngine<SmaCrossover<3, 8>>(SmaCrossover<3, 8>(0.5)));
+        });
+        ReplayStats stats = client.replay(path);
+        CPPUNIT_ASSERT_EQUAL(uint64_t(401), stats.frames);
+
+        std::vector<string> orders;
+        for (const Order& order : client.takeOrders()) {
+            orders.push_back(order.toJSON());
+        }
+        return orders;
+    };
+
+    std::vector<string> first = run();
+    CPPUNIT_ASSERT(!first.empty());
+    CPPUNIT_ASSERT(first == run());
+}
@@ -0,0 +1,29 @@
+#ifndef TESTJOURNAL_H
+#define TESTJOURNAL_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "journal.h"
+
+class TestJournal : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestJournal);
+    CPPUNIT_TEST(testRoundTripAcrossGrowth);
+    CPPUNIT_TEST(testTornRecordEndsJournal);
+    CPPUNIT_TEST(testScaledReplayPacing);
+    CPPUNIT_TEST(testClientReplayIsDeterministic);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void setUp();
+    void tearDown();
+
+    void testRoundTripAcrossGrowth();
+    void testTornRecordEndsJournal();
+    void testScaledReplayPacing();
+    void testClientReplayIsDeterministic();
+
+private:
+    string path;
+};
+
+#endif
@@ -0,0 +1,94 @@
+#include "TestLatency.h"
+#include <cppunit/TestAssert.h>
+#include <memory>
+#include <thread>
+#include <vector>
+
+using latency::Histogram;
+
+void TestLatency::testHistogramBuckets() {
+    // Exact below SUB_BUCKETS, then every value maps into a bucket whose
+    // upper bound is within 1/SUB_BUCKETS above it.
+    for (uint64_t v = 0; v < Histogram::SUB_BUCKETS; ++v) {
+        CPPUNIT_ASSERT_EQUAL(v, Histogram::highestEquivalent(Histogram::indexOf(v)));
+    }
+    for (uint64_t v = Histogram::SUB_BUCKETS; v < (uint64_t(1) << 40); v = v * 3 + 7) {
+        const size_t index = Histogram::indexOf(v);
+        CPPUNIT_ASSERT(index < Histogram::BUCKETS);
+        const uint64_t upper = Histogram::highestEquivalent(index);
+        CPPUNIT_ASSERT(upper >= v);
+        CPPUNIT_ASSERT(upper - v <= v / Histogram::SUB_BUCKETS);
+    }
+    CPPUNIT_ASSERT_EQUAL(Histogram::BUCKETS - 1, Histogram::indexOf(UINT64_MAX));
+    CPPUNIT_ASSERT_EQUAL(UINT64_MAX, Histogram::highestEquivalent(Histogram::BUCKETS - 1));
+}
+
+void TestLatency::testHistogramQuantiles() {
+    auto h = std::make_unique<Histogram>();
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), h->quantile(0.5));
+
+    for (uint64_t v = 1; v <= 100000; ++v) h->record(v);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(100000), h->count());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), h->min());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(100000), h->max());
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(50000.5, h->mean(), 1e-6);
+
+    const double p50 = static_cast<double>(h->quantile(0.50));
+    const double p99 = static_cast<double>(h->quantile(0.99));
+    const double p999 = static_cast<double>(h->quantile(0.999));
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(50000.0, p50, 50000.0 / Histogram::SUB_BUCKETS);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(99000.0, p99, 99000.0 / Histogram::SUB_BUCKETS);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(99900.0, p999, 99900.0 / Histogram::SUB_BUCKETS);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(100000), h->quantile(1.0));
+
+    auto other = std::make_unique<Histogram>();
+    other->record(5000000, 10);
+    h->merge(*other);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(100010), h->count());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(5000000), h->max());
+
+    h->reset();
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), h->count());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), h->max());
+}
+
+void TestLatency::testCollectAcrossThreads() {
+    latency::reset();
+    if (!latency::enabled) {
+        latency::record(latency::Stage::Decode, 1, 2);
+        CPPUNIT_ASSERT_EQUAL(uint64_t(0), latency::collect()[latency::Stage::Decode].count);
+        return;
+    }
+
+    const double nsPerTick = latency::nsPerTick();
+    CPPUNIT_ASSERT(nsPerTick > 0);
+    const uint64_t ticks = static_cast<uint64_t>(1000 / nsPerTick);
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([ticks]() {
+            for (int i = 0; i < 1000; ++i) {
+                latency::record(latency::Stage::Strategy, 100, 100 + ticks);
+            }
+            // Missing and inverted stamps are not samples.
+            latency::record(latency::Stage::Strategy, 0, 100);
+            latency::record(latency::Stage::Strategy, 200, 100);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+
+    // Rings outlive their threads.
+    latency::Report report = latency::collect();
+    const latency::StageSummary& strategy = report[latency::Stage::Strategy];
+    CPPUNIT_ASSERT_EQUAL(uint64_t(4000), strategy.count);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), report.drops);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(1000.0, static_cast<double>(strategy.p50), 20.0);
+    CPPUNIT_ASSERT_EQUAL(strategy.p50, strategy.p999);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), report[latency::Stage::Decode].count);
+    CPPUNIT_ASSERT(report.format().find("strategy") != string::npos);
+
+    // Collecting again keeps the totals; reset clears them.
+    CPPUNIT_ASSERT_EQUAL(uint64_t(4000), latency::collect()[latency::Stage::Strategy].count);
+    latency::reset();
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), latency::collect()[latency::Stage::Strategy].count);
+}
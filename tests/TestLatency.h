@@ -0,0 +1,21 @@
+#ifndef TESTLATENCY_H
+#define TESTLATENCY_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "latency.h"
+
+class TestLatency : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestLatency);
+    CPPUNIT_TEST(testHistogramBuckets);
+    CPPUNIT_TEST(testHistogramQuantiles);
+    CPPUNIT_TEST(testCollectAcrossThreads);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testHistogramBuckets();
+    void testHistogramQuantiles();
+    void testCollectAcrossThreads();
+};
+
+#endif
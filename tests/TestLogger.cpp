@@ -0,0 +1,108 @@
+#include "TestLogger.h"
+#include <cppunit/TestAssert.h>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+    template <typename... Args>
+    string render(const logging::Site& site, const Args&... args) {
+        logging::Entry entry;
+        entry.site = &site;
+        entry.ticks = 0;
+        entry.size = 0;
+        entry.truncated = 0;
+        logging::detail::ArgWriter writer(entry);
+        (writer.put(args), ...);
+        return logging::format(entry);
+    }
+
+    std::vector<string> readLines(const string& path) {
+        std::vector<string> lines;
+        std::ifstream in(path);
+        for (string line; std::getline(in, line);) lines.push_back(line);
+        return lines;
+    }
+}
+
+void TestLogger::testFormatsArguments() {
+    static constexpr logging::Site site{LogLevel::Info, __FILE__, __LINE__, "{} {} {} {} {} {} {} [{}]"};
+    const string symbol = "BTC/USD";
+    CPPUNIT_ASSERT_EQUAL(string("-5 7 1.5 true x BTC/USD lit [{}]"),
+                         render(site, -5, 7u, 1.5, true, 'x', symbol, "lit"));
+
+    static constexpr logging::Site plain{LogLevel::Warn, __FILE__, __LINE__, "no arguments"};
+    CPPUNIT_ASSERT_EQUAL(string("no arguments"), render(plain));
+
+    static constexpr logging::Site text{LogLevel::Info, __FILE__, __LINE__, "{}"};
+    const string big(500, 'a');
+    CPPUNIT_ASSERT_EQUAL(string(logging::Entry::PAYLOAD - 2, 'a') + " [truncated]", render(text, big));
+}
+
+void TestLogger::testCompileTimeLevelFilter() {
+    int evaluated = 0;
+    LOG_DEBUG("never built {}", ++evaluated);
+    CPPUNIT_ASSERT_EQUAL(HFT_LOG_LEVEL > 0 ? 0 : 1, evaluated);
+}
+
+void TestLogger::testRotatesFiles() {
+    const string dir = "/tmp/hft_test_logger_" + std::to_string(::getpid());
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    const string path = dir + "/engine.log";
+
+    LoggerConfig config;
+    config.path = path;
+    config.maxFileBytes = 400;
+    config.maxFiles = 2;
+    logging::start(config);
+    const uint64_t before = logging::stats().written;
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 2; ++t) {
+        threads.emplace_back([t]() {
+            for (int i = 0; i < 25; ++i) LOG_INFO("thread {} line {}", t, i);
+        });
+    }
+    for (auto& thread : threads) thread.join();
+    LOG_ERROR("last {}", "line");
+    logging::flush();
+
+    CPPUNIT_ASSERT_EQUAL(before + 51, logging::stats().written);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), logging::stats().drops);
+    CPPUNIT_ASSERT(std::filesystem::exists(path + ".1"));
+    CPPUNIT_ASSERT(std::filesystem::exists(path + ".2"));
+    CPPUNIT_ASSERT(!std::filesystem::exists(path + ".3"));
+    CPPUNIT_ASSERT(std::filesystem::file_size(path) <= config.maxFileBytes);
+
+    std::vector<string> lines = readLines(path);
+    CPPUNIT_ASSERT(!lines.empty());
+    const string& last = lines.back();
+    CPPUNIT_ASSERT(last.find(" ERROR last line") != string::npos);
+    // 2024-01-01T00:00:00.000000Z
+    CPPUNIT_ASSERT_EQUAL(size_t(27), last.find(' '));
+    CPPUNIT_ASSERT_EQUAL('Z', last[26]);
+
+    logging::start(LoggerConfig());
+    std::filesystem::remove_all(dir);
+}
+
+void TestLogger::testReleasesExitedThreadRings() {
+    LOG_INFO("registers the {} thread", "test");
+    logging::flush();
+    const LoggerStats before = logging::stats();
+
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([t]() { LOG_INFO("short-lived thread {}", t); });
+    }
+    for (auto& thread : threads) thread.join();
+    logging::flush();
+
+    // Each thread's entry was written before its ring went away.
+    const LoggerStats after = logging::stats();
+    CPPUNIT_ASSERT_EQUAL(before.written + 4, after.written);
+    CPPUNIT_ASSERT(after.threadRings <= before.threadRings);
+}
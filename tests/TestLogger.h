@@ -0,0 +1,23 @@
+#ifndef TESTLOGGER_H
+#define TESTLOGGER_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "logger.h"
+
+class TestLogger : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestLogger);
+    CPPUNIT_TEST(testFormatsArguments);
+    CPPUNIT_TEST(testCompileTimeLevelFilter);
+    CPPUNIT_TEST(testRotatesFiles);
+    CPPUNIT_TEST(testReleasesExitedThreadRings);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testFormatsArguments();
+    void testCompileTimeLevelFilter();
+    void testRotatesFiles();
+    void testReleasesExitedThreadRings();
+};
+
+#endif
@@ -0,0 +1,179 @@
+#include "TestMarketFeed.h"
+#include <cppunit/TestAssert.h>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "exchange_simulator.h"
+
+namespace {
+    class Recorder : public FeedListener {
+    public:
+        void onFeedEvents(MarketFeed&, const MarketEvent* events, size_t count) override {
+            received.insert(received.end(), events, events + count);
+        }
+        void onFeedOpen(MarketFeed&) override {}
+        void onFeedAuthenticated(MarketFeed&) override { ++authenticated; }
+        void onFeedSubscribed(MarketFeed&) override {}
+
+        std::vector<MarketEvent> received;
+        int authenticated = 0;
+    };
+
+    MarketEvent tradeAt(uint32_t symbolId, int64_t timestampNs) {
+        return MarketEvent::of(TradeRecord{symbolId, 'B', timestampNs, timestampNs, 1, 1});
+    }
+}
+
+void TestMarketFeed::testFrameBecomesFeedEvents() {
+    Recorder recorder;
+    MarketFeedConfig config;
+    config.name = "stocks";
+    config.assetClass = AssetClass::Stock;
+    config.session.barInterval = std::chrono::seconds(0);
+    MarketFeed feed(3, config, recorder, "key", "secret");
+
+    feed.handleFrame("[{\"T\":\"u\",\"S\":\"MSFT\",\"o\":1,\"h\":1,\"l\":1,\"c\":1,\"v\":1,"
+                     "\"t\":\"2024-03-12T15:04:00Z\",\"n\":1,\"vw\":1},"
+                     "{\"T\":\"t\",\"S\":\"MSFT\",\"p\":400.5,\"s\":10,\"t\":\"2024-03-12T15:04:01Z\",\"i\":7},"
+                     "{\"T\":\"d\",\"S\":\"MSFT\",\"o\":1,\"h\":1,\"l\":1,\"c\":1,\"v\":1,"
+                     "\"t\":\"2024-03-12T04:00:00Z\",\"n\":1,\"vw\":1}]",
+                     42);
+    CPPUNIT_ASSERT_EQUAL(size_t(3), recorder.received.size());
+    // Events keep the frame's element order.
+    CPPUNIT_ASSERT(recorder.received[0].type == EventType::UpdatedBar);
+    CPPUNIT_ASSERT(recorder.received[1].type == EventType::Trade);
+    CPPUNIT_ASSERT(recorder.received[2].type == EventType::DailyBar);
+    for (const MarketEvent& event : recorder.received) {
+        CPPUNIT_ASSERT_EQUAL(uint8_t(3), event.feed);
+        CPPUNIT_ASSERT_EQUAL(uint64_t(42), event.receiveTicks);
+        CPPUNIT_ASSERT(SymbolTable::get_instance().name(event.symbolId()) == "MSFT");
+    }
+    CPPUNIT_ASSERT_EQUAL(int64_t(1710255841000000000LL), recorder.received[1].timestampNs());
+
+    // Control messages take the JSON path.
+    feed.handleFrame("[{\"T\":\"success\",\"msg\":\"authenticated\"}]", 0);
+    CPPUNIT_ASSERT_EQUAL(1, recorder.authenticated);
+    CPPUNIT_ASSERT_EQUAL(size_t(3), recorder.received.size());
+}
+
+void TestMarketFeed::testRouting() {
+    Recorder recorder;
+    MarketFeedConfig crypto;
+    MarketFeedConfig stocks;
+    stocks.assetClass = AssetClass::Stock;
+    MarketFeed cryptoFeed(0, crypto, recorder, "key", "secret");
+    MarketFeed stockFeed(1, stocks, recorder, "key", "secret");
+
+    CPPUNIT_ASSERT(assetClassOf("BTC/USD") == AssetClass::Crypto);
+    CPPUNIT_ASSERT(assetClassOf("AAPL") == AssetClass::Stock);
+    CPPUNIT_ASSERT(cryptoFeed.carries("BTC/USD", FeedChannel::Bars));
+    CPPUNIT_ASSERT(cryptoFeed.carries("BTC/USD", FeedChannel::OrderBooks));
+    CPPUNIT_ASSERT(!cryptoFeed.carries("AAPL", FeedChannel::Trades));
+    CPPUNIT_ASSERT(stockFeed.carries("AAPL", FeedChannel::UpdatedBars));
+    CPPUNIT_ASSERT(!stockFeed.carries("AAPL", FeedChannel::OrderBooks));
+    CPPUNIT_ASSERT_EQUAL(std::string("dailyBars"), std::string(toString(FeedChannel::DailyBars)));
+}
+
+void TestMarketFeed::testDisconnectWhileConnecting() {
+    ExchangeSimulatorConfig simConfig;
+    simConfig.restPort = 0;
+    simConfig.streamPort = 0;
+    ExchangeSimulator simulator(simConfig);
+    simulator.start();
+
+    Recorder recorder;
+    MarketFeedConfig config;
+    config.uri = "wss://127.0.0.1:" + std::to_string(simulator.streamPort()) + "/v1beta3/crypto/us";
+    config.hostname = "127.0.0.1";
+    config.session.barInterval = std::chrono::seconds(0);
+    const auto started = std::chrono::steady_clock::now();
+    {
+        // The handshake is still under way when disconnect() runs, so the
+        // session opens afterwards and has to be closed right there for the
+        // destructor's join to return.
+        MarketFeed feed(0, config, recorder, "key", "secret");
+        feed.connect();
+        feed.disconnect();
+    }
+    CPPUNIT_ASSERT(std::chrono::steady_clock::now() - started < std::chrono::seconds(5));
+    simulator.stop();
+}
+
+void TestMarketFeed::testMergeInTimestampOrder() {
+    std::mutex mutex;
+    std::vector<MarketEvent> merged;
+    FeedMergerConfig config;
+    // Long enough that neither feed is ever given up on while the other
+    // still has events queued.
+    config.maxHold = std::chrono::seconds(5);
+    FeedMerger merger(2, config, [&](EventSpan events) {
+        std::lock_guard<std::mutex> lock(mutex);
+        merged.insert(merged.end(), events.begin(), events.end());
+    });
+    merger.start();
+
+    // Each feed is in order on its own; together they interleave.
+    std::thread even([&]() {
+        for (int64_t i = 0; i < 2000; i += 2) merger.push(0, tradeAt(1, i));
+    });
+    std::thread odd([&]() {
+        for (int64_t i = 1; i < 2000; i += 2) merger.push(1, tradeAt(2, i));
+    });
+    even.join();
+    odd.join();
+    merger.stop();
+
+    CPPUNIT_ASSERT_EQUAL(size_t(2000), merged.size());
+    for (size_t i = 1; i < merged.size(); ++i) {
+        CPPUNIT_ASSERT(merged[i - 1].timestampNs() <= merged[i].timestampNs());
+    }
+    const FeedMergerStats stats = merger.stats();
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2000), stats.merged);
+}
+
+void TestMarketFeed::testQuietFeedIsNotWaitedFor() {
+    std::mutex mutex;
+    std::vector<MarketEvent> merged;
+    FeedMergerConfig config;
+    config.maxHold = std::chrono::milliseconds(1);
+    FeedMerger merger(2, config, [&](EventSpan events) {
+        std::lock_guard<std::mutex> lock(mutex);
+        merged.insert(merged.end(), events.begin(), events.end());
+    });
+    merger.start();
+
+    merger.push(0, tradeAt(1, 100));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        CPPUNIT_ASSERT_EQUAL(size_t(1), merged.size());
+    }
+
+    // An older event arriving after the hold goes out behind and is counted.
+    merger.push(1, tradeAt(2, 50));
+    merger.stop();
+    CPPUNIT_ASSERT_EQUAL(size_t(2), merged.size());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), merger.stats().outOfOrder);
+}
+
+void TestMarketFeed::testIdleFeedDoesNotHoldBackTheOther() {
+    FeedMergerConfig config;
+    config.maxHold = std::chrono::milliseconds(2);
+    FeedMerger merger(2, config, [](EventSpan) {});
+    merger.start();
+
+    // Feed 1 never sends. Holding each event of feed 0 for maxHold would
+    // take 40s; only the first few should wait until feed 1 counts as idle.
+    const uint64_t count = 20000;
+    const auto started = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < count; ++i) merger.push(0, tradeAt(1, int64_t(i)));
+    while (merger.stats().merged < count && std::chrono::steady_clock::now() - started < std::chrono::seconds(5)) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - started;
+    merger.stop();
+
+    CPPUNIT_ASSERT_EQUAL(count, merger.stats().merged);
+    CPPUNIT_ASSERT(elapsed < std::chrono::seconds(1));
+}
@@ -0,0 +1,28 @@
+#ifndef TESTMARKETFEED_H
+#define TESTMARKETFEED_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "feed_merger.h"
+#include "market_feed.h"
+
+class TestMarketFeed : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestMarketFeed);
+    CPPUNIT_TEST(testFrameBecomesFeedEvents);
+    CPPUNIT_TEST(testRouting);
+    CPPUNIT_TEST(testDisconnectWhileConnecting);
+    CPPUNIT_TEST(testMergeInTimestampOrder);
+    CPPUNIT_TEST(testQuietFeedIsNotWaitedFor);
+    CPPUNIT_TEST(testIdleFeedDoesNotHoldBackTheOther);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testFrameBecomesFeedEvents();
+    void testRouting();
+    void testDisconnectWhileConnecting();
+    void testMergeInTimestampOrder();
+    void testQuietFeedIsNotWaitedFor();
+    void testIdleFeedDoesNotHoldBackTheOther();
+};
+
+#endif
@@ -0,0 +1,153 @@
+#include "TestMatchingEngine.h"
+#include <cppunit/TestAssert.h>
+#include <nlohmann/json.hpp>
+#include "exchange_simulator.h"
+#include "session_pool.h"
+
+namespace {
+    SimOrder limit(OrderSide side, int64_t price, int64_t quantity, TimeInForce tif = TimeInForce::Gtc) {
+        SimOrder order;
+        order.owner = 1;
+        order.symbolId = 0;
+        order.side = side;
+        order.type = OrderType::Limit;
+        order.timeInForce = tif;
+        order.limitPrice = price;
+        order.quantity = quantity;
+        return order;
+    }
+
+    SimOrder market(OrderSide side, int64_t quantity) {
+        SimOrder order = limit(side, 0, quantity);
+        order.type = OrderType::Market;
+        return order;
+    }
+}
+
+void TestMatchingEngine::testPriceTimePriority() {
+    MatchingEngine engine;
+    std::vector<SimFill> fills;
+
+    const uint64_t first = engine.submit(limit(OrderSide::Sell, 101, 5), fills).id;
+    const uint64_t second = engine.submit(limit(OrderSide::Sell, 101, 5), fills).id;
+    const uint64_t better = engine.submit(limit(OrderSide::Sell, 100, 5), fills).id;
+    CPPUNIT_ASSERT(fills.empty());
+    CPPUNIT_ASSERT_EQUAL(int64_t(100), engine.bestAsk(0));
+
+    const SimOrder& taker = engine.submit(limit(OrderSide::Buy, 101, 12), fills);
+    CPPUNIT_ASSERT_EQUAL(size_t(3), fills.size());
+    CPPUNIT_ASSERT_EQUAL(better, fills[0].makerId);
+    CPPUNIT_ASSERT_EQUAL(int64_t(100), fills[0].price);
+    CPPUNIT_ASSERT_EQUAL(first, fills[1].makerId);
+    CPPUNIT_ASSERT_EQUAL(int64_t(5), fills[1].quantity);
+    CPPUNIT_ASSERT_EQUAL(second, fills[2].makerId);
+    CPPUNIT_ASSERT_EQUAL(int64_t(2), fills[2].quantity);
+    CPPUNIT_ASSERT(taker.status == SimOrderStatus::Filled);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL((5 * 100 + 7 * 101) / 12.0, taker.averagePrice(), 1e-9);
+
+    CPPUNIT_ASSERT(engine.find(second)->status == SimOrderStatus::PartiallyFilled);
+    CPPUNIT_ASSERT_EQUAL(int64_t(101), engine.bestAsk(0));
+    CPPUNIT_ASSERT(engine.cancel(second));
+    CPPUNIT_ASSERT(!engine.cancel(second));
+    CPPUNIT_ASSERT_EQUAL(int64_t(0), engine.bestAsk(0));
+}
+
+void TestMatchingEngine::testIocRemainderIsCanceled() {
+    MatchingEngine engine;
+    std::vector<SimFill> fills;
+
+    engine.submit(limit(OrderSide::Buy, 99, 3), fills);
+    engine.submit(limit(OrderSide::Buy, 98, 3), fills);
+
+    // Limit 99 must not reach the 98 level.
+    const SimOrder& ioc = engine.submit(limit(OrderSide::Sell, 99, 10, TimeInForce::Ioc), fills);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), fills.size());
+    CPPUNIT_ASSERT_EQUAL(int64_t(3), ioc.filledQuantity);
+    CPPUNIT_ASSERT(ioc.status == SimOrderStatus::Canceled);
+    CPPUNIT_ASSERT_EQUAL(int64_t(98), engine.bestBid(0));
+    CPPUNIT_ASSERT_EQUAL(int64_t(0), engine.bestAsk(0));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), engine.stats().cancels);
+}
+
+void TestMatchingEngine::testMarketOrderSweepsLevels() {
+    MatchingEngine engine;
+    std::vector<SimFill> fills;
+
+    engine.submit(limit(OrderSide::Sell, 100, 2), fills);
+    engine.submit(limit(OrderSide::Sell, 102, 2), fills);
+
+    const SimOrder& sweep = engine.submit(market(OrderSide::Buy, 5), fills);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), fills.size());
+    CPPUNIT_ASSERT_EQUAL(int64_t(4), sweep.filledQuantity);
+    CPPUNIT_ASSERT(sweep.status == SimOrderStatus::Canceled);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(101.0, sweep.averagePrice(), 1e-9);
+
+    SimOrder empty = market(OrderSide::Sell, 0);
+    CPPUNIT_ASSERT(engine.submit(empty, fills).status == SimOrderStatus::Rejected);
+}
+
+void TestMatchingEngine::testRequoteFillsRestingOrders() {
+    MatchingEngine engine;
+    std::vector<SimFill> fills;
+
+    engine.requote(0, 99, 10, 101, 10, 0, fills);
+    const uint64_t resting = engine.submit(limit(OrderSide::Buy, 100, 4), fills).id;
+    CPPUNIT_ASSERT(fills.empty());
+    CPPUNIT_ASSERT_EQUAL(int64_t(100), engine.bestBid(0));
+
+    // The market moves down through the resting bid.
+    engine.requote(0, 97, 10, 99, 10, 1, fills);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), fills.size());
+    CPPUNIT_ASSERT_EQUAL(resting, fills[0].makerId);
+    CPPUNIT_ASSERT_EQUAL(int64_t(100), fills[0].price);
+    CPPUNIT_ASSERT(engine.find(resting)->status == SimOrderStatus::Filled);
+    CPPUNIT_ASSERT_EQUAL(int64_t(97), engine.bestBid(0));
+    CPPUNIT_ASSERT_EQUAL(int64_t(99), engine.bestAsk(0));
+
+    // Replacing quotes is not counted as client cancels.
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), engine.stats().cancels);
+}
+
+void TestMatchingEngine::testSimulatorOrderRoundTrip() {
+    ExchangeSimulatorConfig config;
+    config.restPort = 0;
+    config.streamPort = 0;
+    config.apiKey = "key";
+    config.apiSecret = "secret";
+    config.tickInterval = std::chrono::milliseconds(10);
+
+    ExchangeSimulator simulator(config);
+    simulator.start();
+
+    SessionPoolConfig endpoint;
+    endpoint.host = "127.0.0.1";
+    endpoint.port = std::to_string(simulator.restPort());
+    endpoint.warmSessions = 1;
+    SessionPool pool(endpoint);
+    pool.setCredentials("key", "secret");
+
+    namespace http = boost::beast::http;
+    http_request req{http::verb::post, "/v2/orders", 11};
+    req.set(http::field::content_type, "application/json");
+    req.body() = R"({"symbol":"BTCUSD","qty":"0.5","side":"buy","type":"market","time_in_force":"ioc"})";
+    req.prepare_payload();
+    http_response res;
+    CPPUNIT_ASSERT_EQUAL(200u, pool.send(req, res));
+
+    nlohmann::json order = nlohmann::json::parse(res.body());
+    CPPUNIT_ASSERT_EQUAL(string("filled"), order["status"].get<string>());
+    CPPUNIT_ASSERT_EQUAL(string("0.5"), order["filled_qty"].get<string>());
+
+    http_request lookup{http::verb::get, "/v2/orders/" + order["id"].get<string>(), 11};
+    http_response found;
+    CPPUNIT_ASSERT_EQUAL(200u, pool.send(lookup, found));
+
+    pool.setCredentials("key", "wrong");
+    http_request rejected{http::verb::get, "/v2/clock", 11};
+    http_response unauthorized;
+    CPPUNIT_ASSERT_EQUAL(401u, pool.send(rejected, unauthorized));
+
+    pool.stop();
+    simulator.stop();
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), simulator.engineStats().fills);
+}
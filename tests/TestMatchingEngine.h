@@ -0,0 +1,25 @@
+#ifndef TESTMATCHINGENGINE_H
+#define TESTMATCHINGENGINE_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "matching_engine.h"
+
+class TestMatchingEngine : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestMatchingEngine);
+    CPPUNIT_TEST(testPriceTimePriority);
+    CPPUNIT_TEST(testIocRemainderIsCanceled);
+    CPPUNIT_TEST(testMarketOrderSweepsLevels);
+    CPPUNIT_TEST(testRequoteFillsRestingOrders);
+    CPPUNIT_TEST(testSimulatorOrderRoundTrip);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testPriceTimePriority();
+    void testIocRemainderIsCanceled();
+    void testMarketOrderSweepsLevels();
+    void testRequoteFillsRestingOrders();
+    void testSimulatorOrderRoundTrip();
+};
+
+#endif
@@ -0,0 +1,271 @@
+#include "TestMemoryPool.h"
+#include <cppunit/TestAssert.h>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <link.h>
+#include <string>
+#include <sys/prctl.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+#include "client.h"
+#include "exchange_simulator.h"
+#include "feed_decoder.h"
+#include "journal.h"
+#include "sma_crossover.h"
+
+// Counts every malloc family call the engine's threads make while counting
+// is on: the calling thread's, and those of the threads named like the
+// pipeline shards and the order gateway. Interposing malloc itself (glibc)
+// catches the allocations of the libraries underneath too, not just
+// operator new. OpenSSL's are counted apart: they all come from libcrypto's
+// CRYPTO_malloc, and some of them are per record whatever the caller does.
+namespace {
+    std::atomic<bool> countAllocations{false};
+    std::atomic<size_t> callerAllocations{0};
+    std::atomic<size_t> shardAllocations{0};
+    std::atomic<size_t> gatewayAllocations{0};
+    std::atomic<size_t> opensslAllocations{0};
+    thread_local bool callerThread = false;
+    uintptr_t libcryptoBegin = 0;
+    uintptr_t libcryptoEnd = 0;
+
+    void findLibcrypto() {
+        ::dl_iterate_phdr([](dl_phdr_info* info, size_t, void*) {
+            if (!std::strstr(info->dlpi_name, "libcrypto")) return 0;
+            for (int i = 0; i < info->dlpi_phnum; ++i) {
+                const ElfW(Phdr)& segment = info->dlpi_phdr[i];
+                if (segment.p_type != PT_LOAD || !(segment.p_flags & PF_X)) continue;
+                libcryptoBegin = info->dlpi_addr + segment.p_vaddr;
+                libcryptoEnd = libcryptoBegin + segment.p_memsz;
+            }
+            return 1;
+        }, nullptr);
+    }
+
+    void countAllocation(const void* from) {
+        if (!countAllocations.load(std::memory_order_relaxed)) return;
+        if (callerThread) {
+            callerAllocations.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        char name[16] = {};
+        ::prctl(PR_GET_NAME, name);
+        if (std::strncmp(name, "shard-", 6) == 0) {
+            shardAllocations.fetch_add(1, std::memory_order_relaxed);
+        } else if (std::strcmp(name, "order-gateway") == 0) {
+            const uintptr_t address = reinterpret_cast<uintptr_t>(from);
+            if (address >= libcryptoBegin && address < libcryptoEnd) {
+                opensslAllocations.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                gatewayAllocations.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+extern "C" {
+    void* __libc_malloc(size_t size);
+    void* __libc_calloc(size_t count, size_t size);
+    void* __libc_realloc(void* p, size_t size);
+    void* __libc_memalign(size_t alignment, size_t size);
+
+    void* malloc(size_t size) {
+        countAllocation(__builtin_return_address(0));
+        return __libc_malloc(size);
+    }
+    void* calloc(size_t count, size_t size) {
+        countAllocation(__builtin_return_address(0));
+        return __libc_calloc(count, size);
+    }
+    void* realloc(void* p, size_t size) {
+        countAllocation(__builtin_return_address(0));
+        return __libc_realloc(p, size);
+    }
+    void* memalign(size_t alignment, size_t size) {
+        countAllocation(__builtin_return_address(0));
+        return __libc_memalign(alignment, size);
+    }
+    void* aligned_alloc(size_t alignment, size_t size) {
+        countAllocation(__builtin_return_address(0));
+        return __libc_memalign(alignment, size);
+    }
+    int posix_memalign(void** out, size_t alignment, size_t size) {
+        countAllocation(__builtin_return_address(0));
+        void* p = __libc_memalign(alignment, size);
+        if (!p) return ENOMEM;
+        *out = p;
+        return 0;
+    }
+}
+
+namespace {
+    struct AllocationCounts {
+        size_t caller = 0;
+        size_t shards = 0;
+        size_t gateway = 0;
+        size_t openssl = 0;
+    };
+
+    struct AllocationCounter {
+        AllocationCounter() {
+            callerAllocations = 0;
+            shardAllocations = 0;
+            gatewayAllocations = 0;
+            opensslAllocations = 0;
+            callerThread = true;
+            countAllocations = true;
+        }
+        ~AllocationCounter() {
+            countAllocations = false;
+            callerThread = false;
+        }
+        AllocationCounts counts() const {
+            return AllocationCounts{callerAllocations.load(), shardAllocations.load(), gatewayAllocations.load(),
+                                    opensslAllocations.load()};
+        }
+    };
+
+    // Bars whose closes make the 2/4 crossover flip every few bars, so about
+    // one in three turns into an order.
+    void writeBars(const string& path, int64_t startNs, int count) {
+        JournalWriter writer(path);
+        const char* closes[] = {"100", "100", "300", "300", "100", "100"};
+        for (int i = 0; i < count; ++i) {
+            const string close = closes[i % 6];
+            const int64_t ts = startNs + int64_t(i) * 60000000000LL;
+            writer.append(ts, "[{\"T\":\"b\",\"S\":\"BTC/USD\",\"o\":" + close + ",\"h\":" + close +
+                                  ",\"l\":" + close + ",\"c\":" + close + ",\"v\":1,\"t\":\"" +
+                                  FeedDecoder::formatTimestamp(ts) + "\",\"n\":1,\"vw\":" + close + "}]");
+        }
+    }
+}
+
+void TestMemoryPool::testArenaReusesBlocks() {
+    MonotonicArena arena(256);
+    for (int round = 0; round < 3; ++round) {
+        for (int i = 0; i < 10; ++i) {
+            void* p = arena.allocate(100, 16);
+            CPPUNIT_ASSERT(p != nullptr);
+            CPPUNIT_ASSERT_EQUAL(size_t(0), reinterpret_cast<uintptr_t>(p) % 16);
+        }
+        arena.reset();
+    }
+    // Grown in the first round only.
+    const MemoryPoolStats stats = arena.stats();
+    CPPUNIT_ASSERT_EQUAL(uint64_t(5), stats.growths);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), stats.inUse);
+    CPPUNIT_ASSERT_EQUAL(size_t(1000), stats.highWater);
+
+    // Oversized requests get a block of their own.
+    CPPUNIT_ASSERT(arena.allocate(4096) != nullptr);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(6), arena.stats().growths);
+}
+
+void TestMemoryPool::testArenaScopesNest() {
+    MonotonicArena arena(1024);
+    std::vector<int, ArenaAllocator<int>> outer{ArenaAllocator<int>(arena)};
+    outer.assign(16, 7);
+    const size_t before = arena.stats().inUse;
+    {
+        ArenaScope scope(arena);
+        std::vector<int, ArenaAllocator<int>> inner{ArenaAllocator<int>(arena)};
+        inner.assign(64, 1);
+        CPPUNIT_ASSERT(arena.stats().inUse > before);
+    }
+    CPPUNIT_ASSERT_EQUAL(before, arena.stats().inUse);
+    CPPUNIT_ASSERT_EQUAL(7, outer[15]);
+}
+
+void TestMemoryPool::testSlabPoolRecycles() {
+    SlabPool<std::string> pool(2);
+    std::string* first;
+    {
+        SlabPool<std::string>::Ptr a = pool.acquire();
+        a->assign(100, 'x');
+        first = a.get();
+        SlabPool<std::string>::Ptr b = pool.acquire();
+        SlabPool<std::string>::Ptr c = pool.acquire();
+        CPPUNIT_ASSERT_EQUAL(size_t(3), pool.stats().inUse);
+        CPPUNIT_ASSERT_EQUAL(size_t(4), pool.stats().capacity);
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(0), pool.stats().inUse);
+    CPPUNIT_ASSERT_EQUAL(size_t(3), pool.stats().highWater);
+
+    // Objects come back as they were left, capacity and all.
+    SlabPool<std::string>::Ptr again = pool.acquire();
+    CPPUNIT_ASSERT(again.get() == first);
+    CPPUNIT_ASSERT(again->capacity() >= 100);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), pool.stats().growths);
+}
+
+void TestMemoryPool::testTickToOrderDoesNotAllocate() {
+    ExchangeSimulatorConfig simConfig;
+    simConfig.restPort = 0;
+    simConfig.streamPort = 0;
+    ExchangeSimulator simulator(simConfig);
+    simulator.start();
+
+    // The live path minus the socket: replay decodes frames on this thread
+    // as a feed would, the pipeline shards run the strategy and stage the
+    // orders, and executeOrders encodes them and sends them through the
+    // gateway to the simulator.
+    WebClient client;
+    SessionPoolConfig endpoint;
+    endpoint.host = "127.0.0.1";
+    endpoint.port = std::to_string(simulator.restPort());
+    client.setOrderEndpoint(endpoint);
+    ShardPipelineConfig pipeline;
+    pipeline.shards = 2;
+    client.setMarketDataPipeline(pipeline);
+    client.setStrategyFactory([]() {
+        return makeStrategyRunner(StrategyEngine<SmaCrossover<2, 4>>(SmaCrossover<2, 4>(0.5)));
+    });
+    client.warmOrderSessions();
+
+    const string base = "/tmp/hft_test_tick_to_order_" + std::to_string(::getpid());
+    int64_t startNs = 1710255840000000000LL;
+    auto run = [&](int bars) {
+        const string path = base + "." + std::to_string(bars);
+        writeBars(path, startNs, bars);
+        startNs += int64_t(bars) * 60000000000LL;
+
+        const uint64_t opened = client.orderManager().stats().opened;
+        AllocationCounts counts;
+        {
+            AllocationCounter counter;
+            client.replay(path);
+            client.executeOrders();
+            counts = counter.counts();
+        }
+        std::remove(path.c_str());
+        return std::make_pair(counts, client.orderManager().stats().opened - opened);
+    };
+
+    findLibcrypto();
+    CPPUNIT_ASSERT(libcryptoBegin != 0);
+
+    // Warm-up: symbol state, pools, vectors and connections reach their
+    // steady size.
+    run(600);
+    run(600);
+
+    // Opening the journal and the replay's feed cost the same however many
+    // ticks follow, so anything the ticks themselves allocate shows up as a
+    // difference.
+    const auto few = run(60);
+    const auto many = run(600);
+    CPPUNIT_ASSERT(many.second > few.second);
+    CPPUNIT_ASSERT_EQUAL(few.first.caller, many.first.caller);
+    CPPUNIT_ASSERT_EQUAL(few.first.shards, many.first.shards);
+    CPPUNIT_ASSERT_EQUAL(few.first.gateway, many.first.gateway);
+    // OpenSSL 3.0 sets up each record it writes with packet state from the
+    // heap: two allocations per order, and nothing the gateway can avoid.
+    CPPUNIT_ASSERT(many.first.openssl - few.first.openssl <= 2 * (many.second - few.second));
+
+    simulator.stop();
+}
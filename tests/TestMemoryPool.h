@@ -0,0 +1,23 @@
+#ifndef TESTMEMORYPOOL_H
+#define TESTMEMORYPOOL_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "memory_pool.h"
+
+class TestMemoryPool : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestMemoryPool);
+    CPPUNIT_TEST(testArenaReusesBlocks);
+    CPPUNIT_TEST(testArenaScopesNest);
+    CPPUNIT_TEST(testSlabPoolRecycles);
+    CPPUNIT_TEST(testTickToOrderDoesNotAllocate);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testArenaReusesBlocks();
+    void testArenaScopesNest();
+    void testSlabPoolRecycles();
+    void testTickToOrderDoesNotAllocate();
+};
+
+#endif
@@ -0,0 +1,180 @@
+#include "TestOrderBatcher.h"
+#include <cppunit/TestAssert.h>
+
+#include "order_encoder.h"
+#include "risk.h"
+#include "symbol_table.h"
+
+namespace {
+    // Prices with 2 decimals, sizes with 3: 1.5 is 1500.
+    uint32_t symbol(const char* name) {
+        SymbolTable& table = SymbolTable::get_instance();
+        const uint32_t id = table.intern(name);
+        table.setScale(id, 2, 3);
+        return id;
+    }
+
+    Order order(uint32_t symbolId, uint16_t strategyId, OrderSide side, int64_t quantity, int64_t limitPrice = 0) {
+        OrderIntent intent{};
+        intent.symbolId = symbolId;
+        intent.strategyId = strategyId;
+        intent.side = side;
+        intent.type = limitPrice ? OrderType::Limit : OrderType::Market;
+        intent.timeInForce = TimeInForce::Gtc;
+        intent.quantity = quantity;
+        intent.limitPrice = limitPrice;
+        return makeOrder(intent);
+    }
+
+    OrderBatchConfig coalescing(uint16_t strategyId) {
+        OrderBatchConfig config;
+        config.strategies.push_back(strategyId);
+        return config;
+    }
+}
+
+void TestOrderBatcher::testSameSideOrdersCoalesce() {
+    const uint32_t btc = symbol("OBA/USD");
+    const uint32_t eth = symbol("OBB/USD");
+    OrderBatcher batcher(coalescing(0));
+
+    vector<Order> orders;
+    orders.push_back(order(btc, 0, OrderSide::Buy, 1000));
+    orders.push_back(order(eth, 0, OrderSide::Sell, 250));
+    orders.push_back(order(btc, 0, OrderSide::Buy, 500));
+    orders.push_back(order(btc, 0, OrderSide::Buy, 1));
+    orders[0].receiveTicks = 300;
+    orders[0].decisionTicks = 310;
+    orders[2].receiveTicks = 100;
+    orders[2].decisionTicks = 400;
+
+    CPPUNIT_ASSERT_EQUAL(size_t(2), batcher.coalesce(orders));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), orders.size());
+    // The group's order keeps the place of its first one.
+    CPPUNIT_ASSERT_EQUAL(string("OBAUSD"), orders[0].symbol);
+    CPPUNIT_ASSERT_EQUAL(string("buy"), orders[0].side);
+    CPPUNIT_ASSERT_EQUAL(string("1.501"), orders[0].qty);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(100), orders[0].receiveTicks);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(400), orders[0].decisionTicks);
+    CPPUNIT_ASSERT_EQUAL(string("OBBUSD"), orders[1].symbol);
+    CPPUNIT_ASSERT_EQUAL(string("0.25"), orders[1].qty);
+
+    const OrderBatchStats stats = batcher.stats();
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), stats.batches);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(4), stats.ordersIn);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), stats.requestsOut);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), stats.coalesced);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), stats.requestsSaved());
+}
+
+void TestOrderBatcher::testOpposingOrdersNet() {
+    const uint32_t id = symbol("OBC/USD");
+    OrderBatcher batcher(coalescing(0));
+
+    vector<Order> orders;
+    orders.push_back(order(id, 0, OrderSide::Buy, 1000));
+    orders.push_back(order(id, 0, OrderSide::Sell, 3000));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), batcher.coalesce(orders));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), orders.size());
+    CPPUNIT_ASSERT_EQUAL(string("sell"), orders[0].side);
+    CPPUNIT_ASSERT_EQUAL(string("2"), orders[0].qty);
+
+    // Exactly opposite: nothing left to send.
+    orders.clear();
+    orders.push_back(order(id, 0, OrderSide::Buy, 1000));
+    orders.push_back(order(id, 0, OrderSide::Sell, 400));
+    orders.push_back(order(id, 0, OrderSide::Sell, 600));
+    CPPUNIT_ASSERT_EQUAL(size_t(3), batcher.coalesce(orders));
+    CPPUNIT_ASSERT(orders.empty());
+
+    const OrderBatchStats stats = batcher.stats();
+    CPPUNIT_ASSERT_EQUAL(uint64_t(3), stats.netted);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), stats.coalesced);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(4), stats.requestsSaved());
+}
+
+void TestOrderBatcher::testOnlyConfiguredStrategiesCoalesce() {
+    const uint32_t id = symbol("OBD/USD");
+    OrderBatcher batcher(coalescing(1));
+
+    vector<Order> orders;
+    orders.push_back(order(id, 0, OrderSide::Buy, 1000));
+    orders.push_back(order(id, 1, OrderSide::Buy, 1000));
+    orders.push_back(order(id, 0, OrderSide::Buy, 1000));
+    orders.push_back(order(id, 1, OrderSide::Buy, 2000));
+    Order manual("OBDUSD", "1", "buy", "market", "gtc");
+    orders.push_back(manual);
+
+    CPPUNIT_ASSERT_EQUAL(size_t(1), batcher.coalesce(orders));
+    CPPUNIT_ASSERT_EQUAL(size_t(4), orders.size());
+    CPPUNIT_ASSERT_EQUAL(uint16_t(0), orders[0].strategyId);
+    CPPUNIT_ASSERT_EQUAL(string("1"), orders[0].qty);
+    CPPUNIT_ASSERT_EQUAL(uint16_t(1), orders[1].strategyId);
+    CPPUNIT_ASSERT_EQUAL(string("3"), orders[1].qty);
+    CPPUNIT_ASSERT_EQUAL(uint16_t(0), orders[2].strategyId);
+    CPPUNIT_ASSERT_EQUAL(UINT32_MAX, orders[3].symbolId);
+
+    OrderBatchConfig all;
+    all.allStrategies = true;
+    batcher.configure(all);
+    CPPUNIT_ASSERT(all.enabled());
+    CPPUNIT_ASSERT(!OrderBatchConfig().enabled());
+    CPPUNIT_ASSERT_EQUAL(size_t(2), batcher.coalesce(orders));
+    CPPUNIT_ASSERT_EQUAL(string("5"), orders[0].qty);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), orders.size());
+}
+
+void TestOrderBatcher::testGroupsKeepTypeAndPrice() {
+    const uint32_t id = symbol("OBE/USD");
+    OrderBatcher batcher(coalescing(0));
+
+    vector<Order> orders;
+    orders.push_back(order(id, 0, OrderSide::Buy, 1000, 10000));
+    orders.push_back(order(id, 0, OrderSide::Buy, 1000, 10100));
+    orders.push_back(order(id, 0, OrderSide::Buy, 1000));
+    orders.push_back(order(id, 0, OrderSide::Sell, 500, 10000));
+
+    CPPUNIT_ASSERT_EQUAL(size_t(1), batcher.coalesce(orders));
+    CPPUNIT_ASSERT_EQUAL(size_t(3), orders.size());
+    CPPUNIT_ASSERT_EQUAL(string("100"), orders[0].limit_price);
+    CPPUNIT_ASSERT_EQUAL(string("0.5"), orders[0].qty);
+    CPPUNIT_ASSERT_EQUAL(string("101"), orders[1].limit_price);
+    CPPUNIT_ASSERT_EQUAL(string("1"), orders[1].qty);
+    CPPUNIT_ASSERT_EQUAL(string("market"), orders[2].type);
+}
+
+void TestOrderBatcher::testMergedOrdersKeepRiskLimits() {
+    const uint32_t id = symbol("OBF/USD");
+    RiskConfig config;
+    config.defaults.maxOrderQuantity = 1;
+    RiskGate gate(config);
+    OrderBatcher batcher(coalescing(0));
+
+    // Ten orders at the size limit would make one of ten times the size.
+    vector<Order> orders;
+    for (int i = 0; i < 10; ++i) {
+        orders.push_back(order(id, 0, OrderSide::Buy, 1000));
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(0), batcher.coalesce(orders, &gate));
+    CPPUNIT_ASSERT_EQUAL(size_t(10), orders.size());
+    CPPUNIT_ASSERT_EQUAL(string("1"), orders[9].qty);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(10), batcher.stats().overLimit);
+
+    // Netting keeps the merged order within the limit, so it goes out.
+    orders.clear();
+    orders.push_back(order(id, 0, OrderSide::Buy, 1000));
+    orders.push_back(order(id, 0, OrderSide::Sell, 400));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), batcher.coalesce(orders, &gate));
+    CPPUNIT_ASSERT_EQUAL(string("0.6"), orders[0].qty);
+
+    // Notional at the limit price: 2 x 100.00 each, 400.00 together.
+    config.defaults.maxOrderQuantity = 0;
+    config.defaults.maxOrderNotional = 300;
+    gate.configure(config);
+    gate.observe(id, 10000);
+    orders.clear();
+    orders.push_back(order(id, 0, OrderSide::Buy, 2000, 10000));
+    orders.push_back(order(id, 0, OrderSide::Buy, 2000, 10000));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), batcher.coalesce(orders, &gate));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), orders.size());
+}
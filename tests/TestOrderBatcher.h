@@ -0,0 +1,25 @@
+#ifndef TESTORDERBATCHER_H
+#define TESTORDERBATCHER_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "order_batcher.h"
+
+class TestOrderBatcher : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestOrderBatcher);
+    CPPUNIT_TEST(testSameSideOrdersCoalesce);
+    CPPUNIT_TEST(testOpposingOrdersNet);
+    CPPUNIT_TEST(testOnlyConfiguredStrategiesCoalesce);
+    CPPUNIT_TEST(testGroupsKeepTypeAndPrice);
+    CPPUNIT_TEST(testMergedOrdersKeepRiskLimits);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testSameSideOrdersCoalesce();
+    void testOpposingOrdersNet();
+    void testOnlyConfiguredStrategiesCoalesce();
+    void testGroupsKeepTypeAndPrice();
+    void testMergedOrdersKeepRiskLimits();
+};
+
+#endif
@@ -0,0 +1,122 @@
+#include "TestOrderBook.h"
+#include <cppunit/TestAssert.h>
+#include <map>
+#include <random>
+
+namespace {
+    BookLevelUpdate level(uint32_t symbolId, char side, int64_t price, int64_t size, uint8_t flags = 0) {
+        return BookLevelUpdate{symbolId, side, flags, 0, price, size};
+    }
+}
+
+void TestOrderBook::testLevelsStaySorted() {
+    BookSide bids(true);
+    BookSide asks(false);
+    std::map<int64_t, int64_t> bidModel, askModel;
+
+    std::mt19937 rng(3);
+    std::uniform_int_distribution<int64_t> price(1, 200);
+    std::uniform_int_distribution<int64_t> size(0, 3);
+    for (int i = 0; i < 20000; ++i) {
+        int64_t p = price(rng), s = size(rng);
+        BookSide& side = i % 2 ? bids : asks;
+        auto& model = i % 2 ? bidModel : askModel;
+        side.set(p, s);
+        if (s == 0) model.erase(p); else model[p] = s;
+    }
+
+    CPPUNIT_ASSERT_EQUAL(bidModel.size(), bids.size());
+    size_t i = 0;
+    for (auto it = bidModel.rbegin(); it != bidModel.rend(); ++it, ++i) {
+        CPPUNIT_ASSERT_EQUAL(it->first, bids.level(i).price);
+        CPPUNIT_ASSERT_EQUAL(it->second, bids.level(i).size);
+    }
+
+    CPPUNIT_ASSERT_EQUAL(askModel.size(), asks.size());
+    i = 0;
+    for (auto it = askModel.begin(); it != askModel.end(); ++it, ++i) {
+        CPPUNIT_ASSERT_EQUAL(it->first, asks.level(i).price);
+        CPPUNIT_ASSERT_EQUAL(it->second, asks.level(i).size);
+    }
+}
+
+void TestOrderBook::testSnapshotAndDeltas() {
+    OrderBookSet books;
+    CPPUNIT_ASSERT(books.apply(level(1, 'b', 100, 5, BookLevelUpdate::BOOK_RESET)) == nullptr);
+    books.apply(level(1, 'b', 99, 7));
+    books.apply(level(1, 'a', 102, 3));
+    const OrderBook* book = books.apply(level(1, 'a', 103, 4, BookLevelUpdate::BOOK_END));
+    CPPUNIT_ASSERT(book != nullptr);
+
+    CPPUNIT_ASSERT_EQUAL(int64_t(100), book->bestBid()->price);
+    CPPUNIT_ASSERT_EQUAL(int64_t(102), book->bestAsk()->price);
+    CPPUNIT_ASSERT_EQUAL(int64_t(2), book->spread());
+    CPPUNIT_ASSERT_EQUAL(int64_t(101), book->mid());
+
+    // Delta: the best bid is pulled and a better ask arrives.
+    books.apply(level(1, 'b', 100, 0));
+    books.apply(level(1, 'a', 101, 1, BookLevelUpdate::BOOK_END));
+    CPPUNIT_ASSERT_EQUAL(int64_t(99), book->bestBid()->price);
+    CPPUNIT_ASSERT_EQUAL(int64_t(101), book->bestAsk()->price);
+
+    BookLevel depth[5];
+    CPPUNIT_ASSERT_EQUAL(size_t(3), book->asks().depth(depth, 5));
+    CPPUNIT_ASSERT_EQUAL(int64_t(101), depth[0].price);
+    CPPUNIT_ASSERT_EQUAL(int64_t(103), depth[2].price);
+
+    // A new snapshot replaces everything.
+    books.apply(level(1, 'a', 110, 2, BookLevelUpdate::BOOK_RESET | BookLevelUpdate::BOOK_END));
+    CPPUNIT_ASSERT(book->bestBid() == nullptr);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), book->asks().size());
+    CPPUNIT_ASSERT_EQUAL(int64_t(0), book->spread());
+}
+
+void TestOrderBook::testDecodeOrderBookMessage() {
+    SymbolTable& table = SymbolTable::get_instance();
+    uint32_t id = table.intern("BOOK/USD");
+    table.setScale(id, 2, 4);
+
+    FeedDecoder decoder(table);
+    DecodedBatch batch;
+    const std::string frame =
+        "[{\"T\":\"o\",\"S\":\"BOOK/USD\",\"t\":\"2024-03-12T15:04:05.5Z\","
+        "\"b\":[{\"p\":64000.5,\"s\":0.25},{\"p\":63999,\"s\":1}],\"a\":[{\"p\":64001,\"s\":0.5}],\"r\":true},"
+        "{\"T\":\"o\",\"S\":\"BOOK/USD\",\"t\":\"2024-03-12T15:04:06Z\",\"b\":[],\"a\":[{\"p\":64001,\"s\":0}]}]";
+
+    CPPUNIT_ASSERT(decoder.decode(frame, batch) == DecodeStatus::Ok);
+    CPPUNIT_ASSERT_EQUAL(size_t(4), batch.bookLevels.size());
+
+    const BookLevelUpdate& first = batch.bookLevels[0];
+    CPPUNIT_ASSERT_EQUAL(id, first.symbolId);
+    CPPUNIT_ASSERT_EQUAL('b', first.side);
+    CPPUNIT_ASSERT_EQUAL(int64_t(6400050), first.price);
+    CPPUNIT_ASSERT_EQUAL(int64_t(2500), first.size);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(BookLevelUpdate::BOOK_RESET), first.flags);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(BookLevelUpdate::BOOK_END), batch.bookLevels[2].flags);
+    CPPUNIT_ASSERT_EQUAL('a', batch.bookLevels[3].side);
+    CPPUNIT_ASSERT_EQUAL(uint8_t(BookLevelUpdate::BOOK_END), batch.bookLevels[3].flags);
+
+    OrderBookSet books;
+    for (const auto& update : batch.bookLevels) books.apply(update);
+    const OrderBook* book = books.find(id);
+    CPPUNIT_ASSERT(book != nullptr);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), book->bids().size());
+    CPPUNIT_ASSERT(book->bestAsk() == nullptr);
+
+    // A truncated level rolls the whole frame back.
+    batch.clear();
+    CPPUNIT_ASSERT(decoder.decode("{\"T\":\"o\",\"S\":\"BOOK/USD\",\"t\":\"2024-03-12T15:04:06Z\",\"b\":[{\"s\":1}]}", batch) == DecodeStatus::Malformed);
+    CPPUNIT_ASSERT(batch.bookLevels.empty());
+}
+
+void TestOrderBook::testMoveSymbol() {
+    OrderBookSet from, to;
+    from.apply(level(7, 'b', 50, 1, BookLevelUpdate::BOOK_END));
+    from.moveSymbol(7, to);
+
+    CPPUNIT_ASSERT(from.find(7) == nullptr);
+    CPPUNIT_ASSERT(to.find(7) != nullptr);
+    CPPUNIT_ASSERT_EQUAL(int64_t(50), to.find(7)->bestBid()->price);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestOrderBook);
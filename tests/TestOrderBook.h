@@ -0,0 +1,24 @@
+#ifndef TESTORDERBOOK_H
+#define TESTORDERBOOK_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "feed_decoder.h"
+#include "order_book.h"
+
+class TestOrderBook : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestOrderBook);
+    CPPUNIT_TEST(testLevelsStaySorted);
+    CPPUNIT_TEST(testSnapshotAndDeltas);
+    CPPUNIT_TEST(testDecodeOrderBookMessage);
+    CPPUNIT_TEST(testMoveSymbol);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testLevelsStaySorted();
+    void testSnapshotAndDeltas();
+    void testDecodeOrderBookMessage();
+    void testMoveSymbol();
+};
+
+#endif
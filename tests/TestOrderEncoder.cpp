@@ -0,0 +1,143 @@
+#include "TestOrderEncoder.h"
+#include <cppunit/TestAssert.h>
+#include <boost/beast/core.hpp>
+#include <boost/beast/http.hpp>
+#include <nlohmann/json.hpp>
+
+#include "fixed_point.h"
+#include "symbol_table.h"
+
+namespace http = boost::beast::http;
+
+namespace {
+    // Parses the encoded bytes the way the exchange would.
+    http::request<http::string_body> parse(const EncodedOrder& encoded) {
+        http::request_parser<http::string_body> parser;
+        boost::beast::error_code ec;
+        // put() stops after the header, so feed it until the body is in.
+        size_t used = 0;
+        while (!parser.is_done() && used < encoded.size) {
+            used += parser.put(boost::asio::buffer(encoded.data + used, encoded.size - used), ec);
+            CPPUNIT_ASSERT(!ec);
+        }
+        CPPUNIT_ASSERT(parser.is_done());
+        CPPUNIT_ASSERT_EQUAL(encoded.size, used);
+        return parser.release();
+    }
+
+    OrderEncoder makeEncoder() {
+        return OrderEncoder("paper-api.alpaca.markets", "KEY", "SECRET", "test-");
+    }
+}
+
+void TestOrderEncoder::testEncodesIntent() {
+    SymbolTable& table = SymbolTable::get_instance();
+    const uint32_t symbolId = table.intern("ENC/USD");
+
+    OrderIntent intent{};
+    intent.symbolId = symbolId;
+    intent.side = OrderSide::Sell;
+    intent.type = OrderType::Limit;
+    intent.timeInForce = TimeInForce::Ioc;
+    intent.quantity = fixed_point::fromDouble(0.0125, table.sizeDecimals(symbolId));
+    intent.limitPrice = fixed_point::fromDouble(64000.5, table.priceDecimals(symbolId));
+
+    OrderEncoder encoder = makeEncoder();
+    EncodedOrder encoded;
+    CPPUNIT_ASSERT(encoder.encode(intent, 42, encoded));
+
+    auto req = parse(encoded);
+    CPPUNIT_ASSERT(req.method() == http::verb::post);
+    CPPUNIT_ASSERT_EQUAL(string("/v2/orders"), string(req.target()));
+    CPPUNIT_ASSERT_EQUAL(string("paper-api.alpaca.markets"), string(req[http::field::host]));
+    CPPUNIT_ASSERT_EQUAL(string("KEY"), string(req["APCA-API-KEY-ID"]));
+    CPPUNIT_ASSERT_EQUAL(string("SECRET"), string(req["APCA-API-SECRET-KEY"]));
+    CPPUNIT_ASSERT_EQUAL(string("application/json"), string(req[http::field::content_type]));
+    CPPUNIT_ASSERT(req.keep_alive());
+
+    auto body = nlohmann::json::parse(req.body());
+    CPPUNIT_ASSERT_EQUAL(string("ENCUSD"), body["symbol"].get<string>());
+    CPPUNIT_ASSERT_EQUAL(string("0.0125"), body["qty"].get<string>());
+    CPPUNIT_ASSERT_EQUAL(string("sell"), body["side"].get<string>());
+    CPPUNIT_ASSERT_EQUAL(string("limit"), body["type"].get<string>());
+    CPPUNIT_ASSERT_EQUAL(string("ioc"), body["time_in_force"].get<string>());
+    CPPUNIT_ASSERT_EQUAL(string("64000.5"), body["limit_price"].get<string>());
+    CPPUNIT_ASSERT_EQUAL(string("test-42"), body["client_order_id"].get<string>());
+    CPPUNIT_ASSERT_EQUAL(encoder.clientOrderId(42), body["client_order_id"].get<string>());
+}
+
+void TestOrderEncoder::testEncodesOrder() {
+    Order order("ETHUSD", "2", "buy", "market", "gtc");
+    OrderEncoder encoder = makeEncoder();
+    EncodedOrder encoded;
+    CPPUNIT_ASSERT(encoder.encode(order, 7, encoded));
+
+    auto body = nlohmann::json::parse(parse(encoded).body());
+    CPPUNIT_ASSERT_EQUAL(string("ETHUSD"), body["symbol"].get<string>());
+    CPPUNIT_ASSERT_EQUAL(string("2"), body["qty"].get<string>());
+    CPPUNIT_ASSERT_EQUAL(string("market"), body["type"].get<string>());
+    CPPUNIT_ASSERT(!body.contains("limit_price"));
+    CPPUNIT_ASSERT_EQUAL(string("test-7"), body["client_order_id"].get<string>());
+
+    // Ids are handed out in sequence.
+    const uint64_t first = encoder.nextClientOrderId();
+    CPPUNIT_ASSERT_EQUAL(first + 1, encoder.nextClientOrderId());
+}
+
+void TestOrderEncoder::testFixedPointToChars() {
+    const int64_t values[] = {0, 1, -1, 100000000, 123456789, -123456789, 50, INT64_MAX, INT64_MIN + 1};
+    char buffer[32];
+    for (uint8_t decimals : {uint8_t(0), uint8_t(2), uint8_t(8)}) {
+        for (int64_t value : values) {
+            char* end = fixed_point::toChars(buffer, buffer + sizeof(buffer), value, decimals);
+            CPPUNIT_ASSERT(end != nullptr);
+            CPPUNIT_ASSERT_EQUAL(fixed_point::toString(value, decimals), string(buffer, end));
+        }
+    }
+    CPPUNIT_ASSERT(fixed_point::toChars(buffer, buffer + 3, 123456789, 8) == nullptr);
+}
+
+void TestOrderEncoder::testRejectsOversizedOrder() {
+    Order order(string(EncodedOrder::CAPACITY, 'X'), "1", "buy", "market", "gtc");
+    OrderEncoder encoder = makeEncoder();
+    EncodedOrder encoded;
+    CPPUNIT_ASSERT(!encoder.encode(order, 1, encoded));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), encoded.size);
+}
+
+void TestOrderEncoder::testRoundsToSymbolRules() {
+    SymbolTable& table = SymbolTable::get_instance();
+    const uint32_t symbolId = table.intern("ENR/USD");
+    table.setScale(symbolId, 2, 3);
+    SymbolInfo info;
+    info.tickSize = 5;
+    info.lotSize = 10;
+    table.setInfo(symbolId, info);
+
+    OrderIntent intent{};
+    intent.symbolId = symbolId;
+    intent.side = OrderSide::Buy;
+    intent.type = OrderType::Limit;
+    intent.timeInForce = TimeInForce::Gtc;
+    intent.quantity = 1237;
+    intent.limitPrice = 10003;
+
+    // Quantities go down to a lot; buys round down to a tick, sells up.
+    Order buy = makeOrder(intent);
+    CPPUNIT_ASSERT_EQUAL(string("1.23"), buy.qty);
+    CPPUNIT_ASSERT_EQUAL(string("100"), buy.limit_price);
+    intent.side = OrderSide::Sell;
+    Order sell = makeOrder(intent);
+    CPPUNIT_ASSERT_EQUAL(string("100.05"), sell.limit_price);
+    intent.limitPrice = 10010;
+    CPPUNIT_ASSERT_EQUAL(int64_t(10010), roundToRules(intent).limitPrice);
+
+    // The encoder sends the same rounded order.
+    intent.limitPrice = 10003;
+    OrderEncoder encoder = makeEncoder();
+    EncodedOrder encoded;
+    CPPUNIT_ASSERT(encoder.encode(intent, 1, encoded));
+    auto body = nlohmann::json::parse(parse(encoded).body());
+    CPPUNIT_ASSERT_EQUAL(string("1.23"), body["qty"].get<string>());
+    CPPUNIT_ASSERT_EQUAL(string("100.05"), body["limit_price"].get<string>());
+}
@@ -0,0 +1,25 @@
+#ifndef TESTORDERENCODER_H
+#define TESTORDERENCODER_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "order_encoder.h"
+
+class TestOrderEncoder : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestOrderEncoder);
+    CPPUNIT_TEST(testEncodesIntent);
+    CPPUNIT_TEST(testEncodesOrder);
+    CPPUNIT_TEST(testFixedPointToChars);
+    CPPUNIT_TEST(testRejectsOversizedOrder);
+    CPPUNIT_TEST(testRoundsToSymbolRules);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testEncodesIntent();
+    void testEncodesOrder();
+    void testFixedPointToChars();
+    void testRejectsOversizedOrder();
+    void testRoundsToSymbolRules();
+};
+
+#endif
@@ -0,0 +1,185 @@
+#include "TestOrderGateway.h"
+#include <cppunit/TestAssert.h>
+#include <cstring>
+
+#include "exchange_simulator.h"
+
+namespace {
+    EncodedOrderPtr clockRequest(OrderGateway& gateway, bool keepAlive) {
+        const string text = string("GET /v2/clock HTTP/1.1\r\nHost: 127.0.0.1\r\nConnection: ") +
+                            (keepAlive ? "keep-alive" : "close") + "\r\n\r\n";
+        EncodedOrderPtr order = gateway.orderBuffer();
+        std::memcpy(order->data, text.data(), text.size());
+        order->size = text.size();
+        return order;
+    }
+}
+
+void TestOrderGateway::testCloseMidPipelineCompletesEverything() {
+    ExchangeSimulatorConfig simConfig;
+    simConfig.restPort = 0;
+    simConfig.streamPort = 0;
+    ExchangeSimulator simulator(simConfig);
+    simulator.start();
+
+    OrderGatewayConfig config;
+    config.host = "127.0.0.1";
+    config.port = std::to_string(simulator.restPort());
+    config.connections = 1;
+    config.pipelineDepth = 4;
+    OrderGateway gateway(config);
+    gateway.start();
+
+    // The first response closes the connection while the others are queued
+    // behind it on the same socket.
+    std::atomic<int> finished{0};
+    std::atomic<int> succeeded{0};
+    auto handler = [&](const OrderResult& result) {
+        if (result.ok()) ++succeeded;
+        ++finished;
+    };
+    CPPUNIT_ASSERT(gateway.submit(clockRequest(gateway, false), handler));
+    for (int i = 0; i < 3; ++i) {
+        CPPUNIT_ASSERT(gateway.submit(clockRequest(gateway, true), handler));
+    }
+
+    const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (gateway.outstanding() != 0 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(0), gateway.outstanding());
+    gateway.drain();
+    CPPUNIT_ASSERT_EQUAL(4, finished.load());
+    CPPUNIT_ASSERT(succeeded.load() >= 1);
+
+    const OrderGatewayStats stats = gateway.stats();
+    CPPUNIT_ASSERT_EQUAL(uint64_t(4), stats.completed + stats.failed);
+
+    gateway.stop();
+    simulator.stop();
+}
+
+void TestOrderGateway::testDefaultDepthReachesMaxInFlight() {
+    OrderGatewayConfig config;
+    const OrderGateway defaults(config);
+    CPPUNIT_ASSERT(defaults.config().connections * defaults.config().pipelineDepth >= config.maxInFlight);
+
+    config.connections = 3;
+    config.maxInFlight = 10;
+    const OrderGateway uneven(config);
+    CPPUNIT_ASSERT_EQUAL(size_t(4), uneven.config().pipelineDepth);
+
+    config.pipelineDepth = 2;
+    const OrderGateway shallow(config);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), shallow.config().pipelineDepth);
+}
+
+void TestOrderGateway::testUnreachableHostIsNotSent() {
+    // A port that was free a moment ago; nothing listens on it.
+    boost::asio::io_context ioc;
+    boost::asio::ip::tcp::acceptor probe(ioc, {boost::asio::ip::make_address("127.0.0.1"), 0});
+    const unsigned short port = probe.local_endpoint().port();
+    probe.close();
+
+    OrderGatewayConfig config;
+    config.host = "127.0.0.1";
+    config.port = std::to_string(port);
+    config.connections = 1;
+    OrderGateway gateway(config);
+    gateway.start();
+
+    OrderResult result;
+    std::atomic<bool> finished{false};
+    CPPUNIT_ASSERT(gateway.submit(clockRequest(gateway, true), [&](const OrderResult& done) {
+        result = done;
+        finished = true;
+    }));
+    gateway.drain();
+
+    CPPUNIT_ASSERT(finished.load());
+    CPPUNIT_ASSERT(result.ec);
+    CPPUNIT_ASSERT(!result.sent);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), result.writtenTicks);
+
+    gateway.stop();
+}
+
+void TestOrderGateway::testSilentExchangeTimesOut() {
+    auto sendOne = [](const string& port) {
+        OrderGatewayConfig config;
+        config.host = "127.0.0.1";
+        config.port = port;
+        config.connections = 1;
+        config.ioTimeout = std::chrono::milliseconds(200);
+        OrderGateway gateway(config);
+        gateway.start();
+
+        OrderResult result;
+        CPPUNIT_ASSERT(gateway.submit(clockRequest(gateway, true), [&](const OrderResult& done) { result = done; }));
+        gateway.drain();
+        gateway.stop();
+        return result;
+    };
+
+    // Accepts connections in the kernel but never answers the handshake.
+    boost::asio::io_context ioc;
+    boost::asio::ip::tcp::acceptor silent(ioc, {boost::asio::ip::make_address("127.0.0.1"), 0});
+    const OrderResult handshake = sendOne(std::to_string(silent.local_endpoint().port()));
+    CPPUNIT_ASSERT(handshake.ec == boost::beast::error::timeout);
+    CPPUNIT_ASSERT(!handshake.sent);
+
+    // Reads the request but answers long after the deadline.
+    ExchangeSimulatorConfig simConfig;
+    simConfig.restPort = 0;
+    simConfig.streamPort = 0;
+    simConfig.orderLatency.base = std::chrono::seconds(2);
+    ExchangeSimulator simulator(simConfig);
+    simulator.start();
+    const OrderResult response = sendOne(std::to_string(simulator.restPort()));
+    CPPUNIT_ASSERT(response.ec == boost::beast::error::timeout);
+    CPPUNIT_ASSERT(response.sent);
+    CPPUNIT_ASSERT(response.writtenTicks != 0);
+    simulator.stop();
+}
+
+void TestOrderGateway::testWarmUpKeepsConnectionsOpen() {
+    ExchangeSimulatorConfig simConfig;
+    simConfig.restPort = 0;
+    simConfig.streamPort = 0;
+    ExchangeSimulator simulator(simConfig);
+    simulator.start();
+
+    OrderGatewayConfig config;
+    config.host = "127.0.0.1";
+    config.port = std::to_string(simulator.restPort());
+    config.connections = 2;
+    config.heartbeatInterval = std::chrono::milliseconds(50);
+    OrderGateway gateway(config);
+    gateway.start();
+    gateway.warmUp();
+
+    auto waitFor = [&](auto done) {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+        while (!done(gateway.stats()) && std::chrono::steady_clock::now() < deadline) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        return done(gateway.stats());
+    };
+
+    // Both connections are up before any order, and idle ones heartbeat.
+    CPPUNIT_ASSERT(waitFor([](const OrderGatewayStats& s) { return s.connects == 2; }));
+    CPPUNIT_ASSERT(waitFor([](const OrderGatewayStats& s) { return s.heartbeats >= 2; }));
+    CPPUNIT_ASSERT_EQUAL(size_t(0), gateway.outstanding());
+
+    // A connection the server closes comes back on the next tick and
+    // resumes the TLS session.
+    std::atomic<bool> finished{false};
+    CPPUNIT_ASSERT(gateway.submit(clockRequest(gateway, false), [&](const OrderResult&) { finished = true; }));
+    gateway.drain();
+    CPPUNIT_ASSERT(finished.load());
+    CPPUNIT_ASSERT(waitFor([](const OrderGatewayStats& s) { return s.connects >= 3; }));
+    CPPUNIT_ASSERT(gateway.stats().resumedHandshakes >= 1);
+
+    gateway.stop();
+    simulator.stop();
+}
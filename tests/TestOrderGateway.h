@@ -0,0 +1,25 @@
+#ifndef TESTORDERGATEWAY_H
+#define TESTORDERGATEWAY_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "order_gateway.h"
+
+class TestOrderGateway : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestOrderGateway);
+    CPPUNIT_TEST(testCloseMidPipelineCompletesEverything);
+    CPPUNIT_TEST(testDefaultDepthReachesMaxInFlight);
+    CPPUNIT_TEST(testUnreachableHostIsNotSent);
+    CPPUNIT_TEST(testSilentExchangeTimesOut);
+    CPPUNIT_TEST(testWarmUpKeepsConnectionsOpen);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testCloseMidPipelineCompletesEverything();
+    void testDefaultDepthReachesMaxInFlight();
+    void testUnreachableHostIsNotSent();
+    void testSilentExchangeTimesOut();
+    void testWarmUpKeepsConnectionsOpen();
+};
+
+#endif
@@ -0,0 +1,351 @@
+#include "TestOrderManager.h"
+#include <cppunit/TestAssert.h>
+#include <boost/beast/core.hpp>
+#include <boost/beast/ssl.hpp>
+#include <boost/beast/websocket.hpp>
+#include <boost/beast/websocket/ssl.hpp>
+#include <nlohmann/json.hpp>
+#include <random>
+#include <unordered_set>
+
+#include "client.h"
+#include "exchange_simulator.h"
+#include "fixed_point.h"
+#include "session_pool.h"
+#include "symbol_table.h"
+
+namespace {
+    OrderIntent intent(uint32_t symbolId, OrderSide side, int64_t quantity) {
+        OrderIntent out{};
+        out.symbolId = symbolId;
+        out.side = side;
+        out.type = OrderType::Market;
+        out.timeInForce = TimeInForce::Ioc;
+        out.quantity = quantity;
+        return out;
+    }
+
+    string update(const OrderManager& manager, uint64_t id, const string& event, const string& filledQty,
+                  const string& price) {
+        nlohmann::json data = {
+            {"event", event},
+            {"order", {{"client_order_id", manager.clientOrderId(id)}, {"filled_qty", filledQty}}}
+        };
+        if (!price.empty()) data["price"] = price;
+        return nlohmann::json{{"stream", "trade_updates"}, {"data", data}}.dump();
+    }
+}
+
+void TestOrderManager::testLifecycle() {
+    const uint32_t symbolId = SymbolTable::get_instance().intern("OMA/USD");
+    OrderManager manager;
+
+    const uint64_t id = manager.open(intent(symbolId, OrderSide::Buy, 300));
+    CPPUNIT_ASSERT(id != 0);
+    CPPUNIT_ASSERT(manager.open(intent(symbolId, OrderSide::Buy, 1)) > id);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), manager.openOrders());
+
+    OrderRecord record;
+    CPPUNIT_ASSERT(manager.find(id, record));
+    CPPUNIT_ASSERT(record.status == OrderStatus::New);
+
+    CPPUNIT_ASSERT(manager.apply(id, OrderStatus::Accepted));
+    CPPUNIT_ASSERT(manager.apply(id, OrderStatus::PartiallyFilled, 100, 10));
+    CPPUNIT_ASSERT(manager.apply(id, OrderStatus::PartiallyFilled, 200, 13));
+    CPPUNIT_ASSERT(manager.apply(id, OrderStatus::Filled, 300, 13));
+    // Late acknowledgement after the fill.
+    CPPUNIT_ASSERT(!manager.apply(id, OrderStatus::Accepted));
+
+    CPPUNIT_ASSERT(manager.find(id, record));
+    CPPUNIT_ASSERT(record.status == OrderStatus::Filled);
+    CPPUNIT_ASSERT_EQUAL(int64_t(300), record.filledQuantity);
+    CPPUNIT_ASSERT_EQUAL(int64_t(12), record.averagePrice);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), manager.openOrders());
+    CPPUNIT_ASSERT_EQUAL(int64_t(300), manager.position(symbolId).quantity);
+
+    CPPUNIT_ASSERT(!manager.apply(999, OrderStatus::Filled, 1, 1));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), manager.stats().unknown);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), manager.stats().stale);
+}
+
+void TestOrderManager::testPositionAverageCost() {
+    SymbolTable& table = SymbolTable::get_instance();
+    const uint32_t symbolId = table.intern("OMB/USD");
+    table.setScale(symbolId, 2, 0);
+    OrderManager manager;
+
+    auto trade = [&](OrderSide side, int64_t quantity, int64_t price) {
+        uint64_t id = manager.open(intent(symbolId, side, quantity));
+        CPPUNIT_ASSERT(manager.apply(id, OrderStatus::Filled, quantity, price));
+    };
+
+    trade(OrderSide::Buy, 1, 10000);
+    trade(OrderSide::Buy, 1, 11000);
+    Position position = manager.position(symbolId);
+    CPPUNIT_ASSERT_EQUAL(int64_t(2), position.quantity);
+    CPPUNIT_ASSERT_EQUAL(int64_t(10500), position.averagePrice);
+
+    // Closes both at 120 (15 each over the average) and goes short one.
+    trade(OrderSide::Sell, 3, 12000);
+    position = manager.position(symbolId);
+    CPPUNIT_ASSERT_EQUAL(int64_t(-1), position.quantity);
+    CPPUNIT_ASSERT_EQUAL(int64_t(12000), position.averagePrice);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(30.0, position.realizedPnl, 1e-9);
+
+    trade(OrderSide::Buy, 1, 11000);
+    position = manager.position(symbolId);
+    CPPUNIT_ASSERT_EQUAL(int64_t(0), position.quantity);
+    CPPUNIT_ASSERT_DOUBLES_EQUAL(40.0, position.realizedPnl, 1e-9);
+}
+
+void TestOrderManager::testOpenQuantity() {
+    const uint32_t symbolId = SymbolTable::get_instance().intern("OMO/USD");
+    OrderManager manager;
+
+    const uint64_t buy = manager.open(intent(symbolId, OrderSide::Buy, 300));
+    const uint64_t sell = manager.open(intent(symbolId, OrderSide::Sell, 50));
+    CPPUNIT_ASSERT_EQUAL(int64_t(300), manager.position(symbolId).openBuy);
+    CPPUNIT_ASSERT_EQUAL(int64_t(50), manager.position(symbolId).openSell);
+
+    // Fills move quantity from open into the position.
+    CPPUNIT_ASSERT(manager.apply(buy, OrderStatus::PartiallyFilled, 100, 10));
+    Position held = manager.position(symbolId);
+    CPPUNIT_ASSERT_EQUAL(int64_t(100), held.quantity);
+    CPPUNIT_ASSERT_EQUAL(int64_t(200), held.openBuy);
+
+    // Finished orders leave nothing open, whatever was not filled.
+    CPPUNIT_ASSERT(manager.apply(buy, OrderStatus::Canceled));
+    CPPUNIT_ASSERT(manager.apply(sell, OrderStatus::Rejected));
+    held = manager.position(symbolId);
+    CPPUNIT_ASSERT_EQUAL(int64_t(0), held.openBuy);
+    CPPUNIT_ASSERT_EQUAL(int64_t(0), held.openSell);
+    CPPUNIT_ASSERT_EQUAL(int64_t(100), held.quantity);
+}
+
+void TestOrderManager::testReservedQuantity() {
+    SymbolTable& table = SymbolTable::get_instance();
+    const uint32_t symbolId = table.intern("OMR/USD");
+    table.setScale(symbolId, 2, 0);
+    OrderManagerConfig config;
+    config.capacity = 1;
+    OrderManager manager(config);
+
+    Order order("OMR/USD", "4", "buy", "market", "gtc");
+    order.symbolId = symbolId;
+    manager.reserve(symbolId, OrderSide::Buy, 4);
+    order.reserved = 4;
+    CPPUNIT_ASSERT_EQUAL(int64_t(4), manager.position(symbolId).openBuy);
+
+    // Opening takes the reservation over instead of adding to it.
+    const uint64_t id = manager.open(order);
+    CPPUNIT_ASSERT(id != 0);
+    CPPUNIT_ASSERT_EQUAL(int64_t(4), manager.position(symbolId).openBuy);
+
+    // An order the full table cannot take gives its reservation back.
+    manager.reserve(symbolId, OrderSide::Buy, 4);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), manager.open(order));
+    CPPUNIT_ASSERT_EQUAL(int64_t(4), manager.position(symbolId).openBuy);
+
+    manager.reserve(symbolId, OrderSide::Sell, 2);
+    manager.release(symbolId, OrderSide::Sell, 2);
+    CPPUNIT_ASSERT(manager.apply(id, OrderStatus::Canceled));
+    CPPUNIT_ASSERT_EQUAL(int64_t(0), manager.position(symbolId).openBuy);
+    CPPUNIT_ASSERT_EQUAL(int64_t(0), manager.position(symbolId).openSell);
+}
+
+void TestOrderManager::testTradeUpdateFrames() {
+    SymbolTable& table = SymbolTable::get_instance();
+    const uint32_t symbolId = table.intern("OMC/USD");
+    OrderManagerConfig config;
+    config.clientIdPrefix = "test-";
+    OrderManager manager(config);
+
+    const uint64_t id = manager.open(intent(symbolId, OrderSide::Sell, fixed_point::fromDouble(2, 8)));
+    CPPUNIT_ASSERT_EQUAL(string("test-1"), manager.clientOrderId(id));
+    CPPUNIT_ASSERT_EQUAL(id, manager.parseClientOrderId("test-1"));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), manager.parseClientOrderId("other-1"));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), manager.parseClientOrderId("test-1x"));
+
+    CPPUNIT_ASSERT(!manager.onTradeUpdate(R"({"stream":"authorization","data":{"status":"authorized"}})"));
+    CPPUNIT_ASSERT(!manager.onTradeUpdate(R"({"stream":"listening","data":{"streams":["trade_updates"]}})"));
+    CPPUNIT_ASSERT(!manager.onTradeUpdate("not json"));
+
+    CPPUNIT_ASSERT(manager.onTradeUpdate(update(manager, id, "new", "0", "")));
+    CPPUNIT_ASSERT(manager.onTradeUpdate(update(manager, id, "partial_fill", "0.5", "100.5")));
+    // Delivered twice; the cumulative quantity keeps it from counting again.
+    manager.onTradeUpdate(update(manager, id, "partial_fill", "0.5", "100.5"));
+    CPPUNIT_ASSERT_EQUAL(int64_t(fixed_point::fromDouble(-0.5, 8)), manager.position(symbolId).quantity);
+
+    CPPUNIT_ASSERT(manager.onTradeUpdate(update(manager, id, "canceled", "0.5", "")));
+    OrderRecord record;
+    CPPUNIT_ASSERT(manager.find(id, record));
+    CPPUNIT_ASSERT(record.status == OrderStatus::Canceled);
+    CPPUNIT_ASSERT_EQUAL(fixed_point::fromDouble(100.5, 8), record.averagePrice);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), manager.stats().fills);
+
+    OrderManagerConfig otherConfig;
+    otherConfig.clientIdPrefix = "other-";
+    OrderManager other(otherConfig);
+    CPPUNIT_ASSERT(!manager.onTradeUpdate(update(other, 1, "fill", "1", "1")));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), manager.stats().unknown);
+}
+
+void TestOrderManager::testEvictsFinishedOrders() {
+    const uint32_t symbolId = SymbolTable::get_instance().intern("OMD/USD");
+    OrderManagerConfig config;
+    config.capacity = 64;
+    OrderManager manager(config);
+
+    // Churn through many times the capacity with orders finishing in random
+    // order; every live order must stay reachable through the probing.
+    std::mt19937 rng(7);
+    std::vector<uint64_t> live;
+    std::unordered_set<uint64_t> finished;
+    for (int round = 0; round < 5000; ++round) {
+        if (live.size() < 48 && rng() % 3 != 0) {
+            uint64_t id = manager.open(intent(symbolId, OrderSide::Buy, 1));
+            CPPUNIT_ASSERT(id != 0);
+            live.push_back(id);
+        } else if (!live.empty()) {
+            size_t pick = rng() % live.size();
+            CPPUNIT_ASSERT(manager.apply(live[pick], OrderStatus::Canceled));
+            finished.insert(live[pick]);
+            live.erase(live.begin() + static_cast<std::ptrdiff_t>(pick));
+        }
+    }
+    OrderRecord record;
+    for (uint64_t id : live) {
+        CPPUNIT_ASSERT(manager.find(id, record));
+        CPPUNIT_ASSERT(record.status == OrderStatus::New);
+    }
+    CPPUNIT_ASSERT_EQUAL(live.size(), manager.openOrders());
+    CPPUNIT_ASSERT(manager.stats().evicted > 0);
+
+    // A table full of open orders refuses new ones.
+    OrderManagerConfig tiny;
+    tiny.capacity = 2;
+    OrderManager full(tiny);
+    const uint64_t first = full.open(intent(symbolId, OrderSide::Buy, 1));
+    CPPUNIT_ASSERT(full.open(intent(symbolId, OrderSide::Buy, 1)) != 0);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(0), full.open(intent(symbolId, OrderSide::Buy, 1)));
+    full.apply(first, OrderStatus::Rejected);
+    CPPUNIT_ASSERT(full.open(intent(symbolId, OrderSide::Buy, 1)) != 0);
+    CPPUNIT_ASSERT(!full.find(first, record));
+}
+
+void TestOrderManager::testSimulatorTradeUpdates() {
+    namespace http = boost::beast::http;
+    namespace websocket = boost::beast::websocket;
+
+    ExchangeSimulatorConfig config;
+    config.restPort = 0;
+    config.streamPort = 0;
+    config.tickInterval = std::chrono::milliseconds(10);
+    ExchangeSimulator simulator(config);
+    simulator.start();
+
+    boost::asio::io_context ioc;
+    boost::asio::ssl::context tls(boost::asio::ssl::context::tlsv12_client);
+    tls.set_verify_mode(boost::asio::ssl::verify_none);
+    websocket::stream<boost::beast::ssl_stream<boost::beast::tcp_stream>> ws(ioc, tls);
+    boost::asio::ip::tcp::resolver resolver(ioc);
+    boost::beast::get_lowest_layer(ws).connect(resolver.resolve("127.0.0.1", std::to_string(simulator.streamPort())));
+    ws.next_layer().handshake(boost::asio::ssl::stream_base::client);
+    ws.handshake("127.0.0.1", "/stream");
+    ws.write(boost::asio::buffer(string(R"({"action":"auth","key":"k","secret":"s"})")));
+    ws.write(boost::asio::buffer(string(R"({"action":"listen","data":{"streams":["trade_updates"]}})")));
+
+    boost::beast::flat_buffer buffer;
+    auto next = [&]() {
+        buffer.clear();
+        ws.read(buffer);
+        return boost::beast::buffers_to_string(buffer.data());
+    };
+    CPPUNIT_ASSERT(next().find("authorized") != string::npos);
+    CPPUNIT_ASSERT(next().find("\"listening\"") != string::npos);
+
+    const uint32_t symbolId = SymbolTable::get_instance().find("BTC/USD");
+    OrderManager manager;
+    const uint64_t id = manager.open(intent(symbolId, OrderSide::Buy, fixed_point::fromDouble(0.5, 8)));
+
+    SessionPoolConfig endpoint;
+    endpoint.host = "127.0.0.1";
+    endpoint.port = std::to_string(simulator.restPort());
+    endpoint.warmSessions = 1;
+    SessionPool pool(endpoint);
+    http_request req{http::verb::post, "/v2/orders", 11};
+    req.set(http::field::content_type, "application/json");
+    req.body() = R"({"symbol":"BTCUSD","qty":"0.5","side":"buy","type":"market","time_in_force":"ioc","client_order_id":")" +
+                 manager.clientOrderId(id) + "\"}";
+    req.prepare_payload();
+    http_response res;
+    CPPUNIT_ASSERT_EQUAL(200u, pool.send(req, res));
+
+    OrderRecord record;
+    for (int i = 0; i < 10 && !(manager.find(id, record) && record.status == OrderStatus::Filled); ++i) {
+        manager.onTradeUpdate(next());
+    }
+    CPPUNIT_ASSERT(record.status == OrderStatus::Filled);
+    CPPUNIT_ASSERT_EQUAL(fixed_point::fromDouble(0.5, 8), record.filledQuantity);
+    CPPUNIT_ASSERT_EQUAL(fixed_point::fromDouble(0.5, 8), manager.position(symbolId).quantity);
+    CPPUNIT_ASSERT(manager.position(symbolId).averagePrice > 0);
+
+    boost::beast::get_lowest_layer(ws).close();
+    pool.stop();
+    simulator.stop();
+}
+
+void TestOrderManager::testReconcileUnconfirmedOrders() {
+    namespace http = boost::beast::http;
+    ExchangeSimulatorConfig config;
+    config.restPort = 0;
+    config.streamPort = 0;
+    ExchangeSimulator simulator(config);
+    simulator.start();
+
+    SessionPoolConfig endpoint;
+    endpoint.host = "127.0.0.1";
+    endpoint.port = std::to_string(simulator.restPort());
+    endpoint.warmSessions = 1;
+    WebClient client;
+    client.setOrderEndpoint(endpoint);
+    OrderManager& manager = client.orderManager();
+
+    // Both requests were written before their connections failed; only the
+    // first one reached the exchange.
+    const uint32_t symbolId = SymbolTable::get_instance().find("BTC/USD");
+    const uint64_t placed = manager.open(intent(symbolId, OrderSide::Buy, fixed_point::fromDouble(0.5, 8)));
+    const uint64_t lost = manager.open(intent(symbolId, OrderSide::Sell, fixed_point::fromDouble(0.25, 8)));
+    CPPUNIT_ASSERT(manager.apply(placed, OrderStatus::Unconfirmed));
+    CPPUNIT_ASSERT(manager.apply(lost, OrderStatus::Unconfirmed));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), manager.openOrders());
+
+    SessionPool pool(endpoint);
+    http_request req{http::verb::post, "/v2/orders", 11};
+    req.set(http::field::content_type, "application/json");
+    req.body() = R"({"symbol":"BTCUSD","qty":"0.5","side":"buy","type":"market","time_in_force":"ioc","client_order_id":")" +
+                 manager.clientOrderId(placed) + "\"}";
+    req.prepare_payload();
+    http_response res;
+    CPPUNIT_ASSERT_EQUAL(200u, pool.send(req, res));
+
+    CPPUNIT_ASSERT_EQUAL(size_t(2), client.reconcileOrders());
+
+    OrderRecord record;
+    CPPUNIT_ASSERT(manager.find(placed, record));
+    CPPUNIT_ASSERT(record.status == OrderStatus::Filled);
+    CPPUNIT_ASSERT_EQUAL(fixed_point::fromDouble(0.5, 8), record.filledQuantity);
+    CPPUNIT_ASSERT(manager.find(lost, record));
+    CPPUNIT_ASSERT(record.status == OrderStatus::Rejected);
+
+    const Position position = manager.position(symbolId);
+    CPPUNIT_ASSERT_EQUAL(fixed_point::fromDouble(0.5, 8), position.quantity);
+    CPPUNIT_ASSERT_EQUAL(int64_t(0), position.openBuy);
+    CPPUNIT_ASSERT_EQUAL(int64_t(0), position.openSell);
+    CPPUNIT_ASSERT_EQUAL(size_t(0), manager.openOrders());
+    // Nothing left to settle.
+    CPPUNIT_ASSERT_EQUAL(size_t(0), client.reconcileOrders());
+
+    pool.stop();
+    simulator.stop();
+}
@@ -0,0 +1,31 @@
+#ifndef TESTORDERMANAGER_H
+#define TESTORDERMANAGER_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "order_manager.h"
+
+class TestOrderManager : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestOrderManager);
+    CPPUNIT_TEST(testLifecycle);
+    CPPUNIT_TEST(testPositionAverageCost);
+    CPPUNIT_TEST(testOpenQuantity);
+    CPPUNIT_TEST(testReservedQuantity);
+    CPPUNIT_TEST(testTradeUpdateFrames);
+    CPPUNIT_TEST(testEvictsFinishedOrders);
+    CPPUNIT_TEST(testSimulatorTradeUpdates);
+    CPPUNIT_TEST(testReconcileUnconfirmedOrders);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testLifecycle();
+    void testPositionAverageCost();
+    void testOpenQuantity();
+    void testReservedQuantity();
+    void testTradeUpdateFrames();
+    void testEvictsFinishedOrders();
+    void testSimulatorTradeUpdates();
+    void testReconcileUnconfirmedOrders();
+};
+
+#endif
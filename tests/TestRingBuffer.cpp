@@ -0,0 +1,93 @@
+#include "TestRingBuffer.h"
+#include <cppunit/TestAssert.h>
+#include <vector>
+
+void TestRingBuffer::testSpscPreservesOrder() {
+    const uint64_t count = 200000;
+
+    for (WaitPolicy policy : {WaitPolicy::BusySpin, WaitPolicy::Yield, WaitPolicy::Block}) {
+        SpscRing<uint64_t> ring(1024, policy);
+        bool ordered = true;
+
+        std::thread consumer([&]() {
+            uint64_t expected = 0;
+            uint64_t value;
+            while (ring.pop(value)) {
+                if (value != expected++) ordered = false;
+            }
+            if (expected != count) ordered = false;
+        });
+
+        for (uint64_t i = 0; i < count; ++i) {
+            ring.push(i);
+        }
+        ring.close();
+        consumer.join();
+
+        CPPUNIT_ASSERT_MESSAGE("Items must arrive in publish order", ordered);
+        CPPUNIT_ASSERT_EQUAL(count, ring.stats().popped);
+        CPPUNIT_ASSERT_EQUAL(uint64_t(0), ring.stats().drops);
+    }
+}
+
+void TestRingBuffer::testSpscCountsDrops() {
+    SpscRing<int> ring(4);
+
+    for (int i = 0; i < 4; ++i) {
+        CPPUNIT_ASSERT(ring.tryPush(i));
+    }
+    CPPUNIT_ASSERT(!ring.tryPush(4));
+    CPPUNIT_ASSERT(!ring.tryPush(5));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), ring.stats().drops);
+
+    int batch[8];
+    CPPUNIT_ASSERT_EQUAL(size_t(4), ring.tryPopBatch(batch, 8));
+    CPPUNIT_ASSERT_EQUAL(3, batch[3]);
+    CPPUNIT_ASSERT(ring.tryPush(6));
+}
+
+void TestRingBuffer::testSpscCloseWakesConsumer() {
+    SpscRing<int> ring(16, WaitPolicy::Block);
+    bool returned = false;
+
+    std::thread consumer([&]() {
+        int value;
+        returned = !ring.pop(value);
+    });
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    ring.close();
+    consumer.join();
+
+    CPPUNIT_ASSERT_MESSAGE("pop() must return false once the ring is closed and empty", returned);
+}
+
+void TestRingBuffer::testMpscDeliversEveryItem() {
+    const int producers = 4;
+    const uint64_t perProducer = 50000;
+    MpscRing<uint64_t> ring(256, WaitPolicy::Yield);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&ring, p, perProducer]() {
+            for (uint64_t i = 0; i < perProducer; ++i) {
+                ring.push(static_cast<uint64_t>(p) << 32 | i);
+            }
+        });
+    }
+
+    std::vector<uint64_t> next(producers, 0);
+    bool ordered = true;
+    uint64_t value;
+    for (uint64_t received = 0; received < producers * perProducer; ++received) {
+        ring.pop(value);
+        uint64_t producer = value >> 32;
+        if ((value & 0xffffffffULL) != next[producer]++) ordered = false;
+    }
+    for (auto& t : threads) t.join();
+
+    CPPUNIT_ASSERT_MESSAGE("Each producer's items must stay in order", ordered);
+    CPPUNIT_ASSERT_EQUAL(producers * perProducer, ring.stats().popped);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestRingBuffer);
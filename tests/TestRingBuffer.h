@@ -0,0 +1,24 @@
+#ifndef TESTRINGBUFFER_H
+#define TESTRINGBUFFER_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include <thread>
+#include "ring_buffer.h"
+
+class TestRingBuffer : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestRingBuffer);
+    CPPUNIT_TEST(testSpscPreservesOrder);
+    CPPUNIT_TEST(testSpscCountsDrops);
+    CPPUNIT_TEST(testSpscCloseWakesConsumer);
+    CPPUNIT_TEST(testMpscDeliversEveryItem);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testSpscPreservesOrder();
+    void testSpscCountsDrops();
+    void testSpscCloseWakesConsumer();
+    void testMpscDeliversEveryItem();
+};
+
+#endif
@@ -0,0 +1,178 @@
+#include "TestRisk.h"
+#include <cppunit/TestAssert.h>
+
+#include "client.h"
+#include "symbol_table.h"
+
+namespace {
+    // Prices with 2 decimals, sizes with 0: 100.00 is 10000.
+    uint32_t symbol(const char* name) {
+        SymbolTable& table = SymbolTable::get_instance();
+        const uint32_t id = table.intern(name);
+        table.setScale(id, 2, 0);
+        return id;
+    }
+
+    OrderIntent order(uint32_t symbolId, OrderSide side, int64_t quantity, int64_t limitPrice = 0) {
+        OrderIntent intent{};
+        intent.symbolId = symbolId;
+        intent.side = side;
+        intent.type = limitPrice ? OrderType::Limit : OrderType::Market;
+        intent.timeInForce = TimeInForce::Gtc;
+        intent.quantity = quantity;
+        intent.limitPrice = limitPrice;
+        return intent;
+    }
+}
+
+void TestRisk::testStaticLimits() {
+    const uint32_t id = symbol("RSA/USD");
+    RiskConfig config;
+    config.defaults.maxOrderQuantity = 10;
+    config.defaults.maxOrderNotional = 1500;
+    config.defaults.maxPosition = 20;
+    RiskGate gate(config);
+
+    // Notional needs a price to check against.
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Buy, 1), 0) == RiskReject::NoReference);
+    gate.observe(id, 10000);
+
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Buy, 10), 0) == RiskReject::None);
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Buy, 11), 0) == RiskReject::OrderSize);
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Buy, 0), 0) == RiskReject::OrderSize);
+    // 10 at 200.00 is 2000 notional.
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Buy, 10, 20000), 0) == RiskReject::Notional);
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Buy, 5, 10000), 16) == RiskReject::Position);
+    // Selling out of a long reduces the position, so it passes.
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Sell, 5, 10000), 16) == RiskReject::None);
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Sell, 5, 10000), -16) == RiskReject::Position);
+
+    // A symbol with its own, looser limits.
+    RiskLimits loose;
+    loose.maxOrderQuantity = 100;
+    gate.setLimits(id, loose);
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Buy, 50), 0) == RiskReject::None);
+
+    RiskStats stats = gate.stats();
+    CPPUNIT_ASSERT_EQUAL(uint64_t(9), stats.checked);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(3), stats.passed);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), stats[RiskReject::NoReference]);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), stats[RiskReject::OrderSize]);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), stats[RiskReject::Notional]);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), stats[RiskReject::Position]);
+}
+
+void TestRisk::testOpenOrdersCountTowardPosition() {
+    const uint32_t id = symbol("RSF/USD");
+    RiskConfig config;
+    config.defaults.maxPosition = 20;
+    RiskGate gate(config);
+
+    // 10 held and 6 more on open buys: another 5 could reach 21.
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Buy, 5, 10000), 10, 6, 0) == RiskReject::Position);
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Buy, 4, 10000), 10, 6, 0) == RiskReject::None);
+    // Open sells only count against more selling.
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Buy, 4, 10000), 10, 6, 30) == RiskReject::None);
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Sell, 5, 10000), -10, 0, 6) == RiskReject::Position);
+}
+
+void TestRisk::testStagedOrdersCountTowardPosition() {
+    const uint32_t id = symbol("RSG/USD");
+    WebClient client;
+    RiskConfig config;
+    config.defaults.maxPosition = 3;
+    client.riskGate().configure(config);
+
+    // Nothing is sent yet, so only the reservations stop the fourth.
+    for (int i = 0; i < 5; ++i) {
+        client.createOrder(order(id, OrderSide::Buy, 1));
+    }
+    CPPUNIT_ASSERT_EQUAL(int64_t(3), client.orderManager().position(id).openBuy);
+    client.createOrder(order(id, OrderSide::Sell, 2));
+    CPPUNIT_ASSERT_EQUAL(int64_t(2), client.orderManager().position(id).openSell);
+
+    // Orders taken out are not going to be sent and give their hold back.
+    CPPUNIT_ASSERT_EQUAL(size_t(4), client.takeOrders().size());
+    CPPUNIT_ASSERT_EQUAL(int64_t(0), client.orderManager().position(id).openBuy);
+    CPPUNIT_ASSERT_EQUAL(int64_t(0), client.orderManager().position(id).openSell);
+    client.createOrder(order(id, OrderSide::Buy, 3));
+    CPPUNIT_ASSERT_EQUAL(size_t(1), client.takeOrders().size());
+}
+
+void TestRisk::testPriceBand() {
+    const uint32_t id = symbol("RSB/USD");
+    RiskConfig config;
+    config.defaults.priceBandBps = 100;
+    RiskGate gate(config);
+    gate.observe(id, 10000);
+
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Buy, 1, 10100), 0) == RiskReject::None);
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Buy, 1, 10101), 0) == RiskReject::PriceBand);
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Sell, 1, 9899), 0) == RiskReject::PriceBand);
+    // Market orders have no price of their own.
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Sell, 1), 0) == RiskReject::None);
+
+    gate.observe(id, 20000);
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Buy, 1, 20150), 0) == RiskReject::None);
+}
+
+void TestRisk::testRateLimit() {
+    const uint32_t id = symbol("RSC/USD");
+    const uint32_t other = symbol("RSD/USD");
+    RiskConfig config;
+    // Slow enough that no token comes back during the test.
+    config.defaults.ordersPerSecond = 0.01;
+    config.defaults.burst = 3;
+    config.ordersPerSecond = 0.01;
+    config.burst = 4;
+    RiskGate gate(config);
+
+    for (int i = 0; i < 3; ++i) {
+        CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Buy, 1), 0) == RiskReject::None);
+    }
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Buy, 1), 0) == RiskReject::RateLimit);
+    // The other symbol has its own bucket but shares the global one.
+    CPPUNIT_ASSERT(gate.check(order(other, OrderSide::Buy, 1), 0) == RiskReject::None);
+    CPPUNIT_ASSERT(gate.check(order(other, OrderSide::Buy, 1), 0) == RiskReject::RateLimit);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), gate.stats()[RiskReject::RateLimit]);
+
+    // Rejected orders do not use up tokens.
+    RiskConfig sized = config;
+    sized.defaults.maxOrderQuantity = 5;
+    gate.configure(sized);
+    for (int i = 0; i < 10; ++i) gate.check(order(id, OrderSide::Buy, 6), 0);
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Buy, 1), 0) == RiskReject::None);
+}
+
+void TestRisk::testKillSwitch() {
+    const uint32_t id = symbol("RSE/USD");
+    RiskGate gate;
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Buy, 1), 0) == RiskReject::None);
+    gate.halt();
+    CPPUNIT_ASSERT(gate.isHalted());
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Buy, 1), 0) == RiskReject::KillSwitch);
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Sell, 0), 0) == RiskReject::KillSwitch);
+    gate.resume();
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Buy, 1), 0) == RiskReject::None);
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), gate.stats()[RiskReject::KillSwitch]);
+}
+
+void TestRisk::testSymbolMinimums() {
+    const uint32_t id = symbol("RSE/USD");
+    SymbolInfo info;
+    info.minQuantity = 2;
+    // 10.00 in quote currency.
+    info.minNotional = 1000;
+    SymbolTable::get_instance().setInfo(id, info);
+    RiskGate gate;
+
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Buy, 1, 10000), 0) == RiskReject::OrderSize);
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Buy, 2, 10000), 0) == RiskReject::None);
+    // 2 at 4.00 is 8.00 notional.
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Buy, 2, 400), 0) == RiskReject::Notional);
+    // A market order's notional needs the reference price.
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Sell, 2), 0) == RiskReject::NoReference);
+    gate.observe(id, 400);
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Sell, 2), 0) == RiskReject::Notional);
+    CPPUNIT_ASSERT(gate.check(order(id, OrderSide::Sell, 3), 0) == RiskReject::None);
+}
@@ -0,0 +1,29 @@
+#ifndef TESTRISK_H
+#define TESTRISK_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "risk.h"
+
+class TestRisk : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestRisk);
+    CPPUNIT_TEST(testStaticLimits);
+    CPPUNIT_TEST(testOpenOrdersCountTowardPosition);
+    CPPUNIT_TEST(testStagedOrdersCountTowardPosition);
+    CPPUNIT_TEST(testPriceBand);
+    CPPUNIT_TEST(testRateLimit);
+    CPPUNIT_TEST(testKillSwitch);
+    CPPUNIT_TEST(testSymbolMinimums);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testStaticLimits();
+    void testOpenOrdersCountTowardPosition();
+    void testStagedOrdersCountTowardPosition();
+    void testPriceBand();
+    void testRateLimit();
+    void testKillSwitch();
+    void testSymbolMinimums();
+};
+
+#endif
@@ -0,0 +1,121 @@
+#include "TestSessionPool.h"
+#include <cppunit/TestAssert.h>
+#include <functional>
+
+#include "tls_certificate.h"
+
+namespace {
+    namespace http = boost::beast::http;
+    using tcp = boost::asio::ip::tcp;
+    typedef boost::asio::ssl::stream<tcp::socket> server_stream;
+
+    // Accepts one TLS connection per handler on an ephemeral port and hands
+    // it to that handler, on a thread of its own.
+    class TlsServer {
+    public:
+        typedef std::function<void(server_stream&)> handler_type;
+
+        explicit TlsServer(std::vector<handler_type> handlers)
+            : ctx(boost::asio::ssl::context::tls_server),
+              acceptor(ioc, tcp::endpoint(boost::asio::ip::make_address("127.0.0.1"), 0)) {
+            useSelfSignedCertificate(ctx, "localhost");
+            thread = std::thread([this, handlers = std::move(handlers)]() {
+                try {
+                    for (const handler_type& handler : handlers) {
+                        server_stream stream(ioc, ctx);
+                        acceptor.accept(stream.next_layer());
+                        stream.handshake(boost::asio::ssl::stream_base::server);
+                        handler(stream);
+                    }
+                } catch (const std::exception&) {
+                }
+            });
+        }
+
+        ~TlsServer() { thread.join(); }
+
+        string port() const { return std::to_string(acceptor.local_endpoint().port()); }
+
+    private:
+        boost::asio::io_context ioc;
+        boost::asio::ssl::context ctx;
+        tcp::acceptor acceptor;
+        std::thread thread;
+    };
+
+    void answer(server_stream& stream) {
+        boost::beast::flat_buffer buffer;
+        http::request<http::string_body> req;
+        http::read(stream, buffer, req);
+        http::response<http::string_body> res{http::status::ok, 11};
+        res.keep_alive(true);
+        res.body() = "{}";
+        res.prepare_payload();
+        http::write(stream, res);
+    }
+
+    SessionPoolConfig localPool(const TlsServer& server) {
+        SessionPoolConfig config;
+        config.host = "127.0.0.1";
+        config.port = server.port();
+        config.warmSessions = 0;
+        return config;
+    }
+}
+
+void TestSessionPool::testStaleSessionIsRetried() {
+    // The first session is answered once and then dropped while idle, the
+    // way a server times out keep-alive connections.
+    TlsServer server({
+        [](server_stream& stream) { answer(stream); },
+        [](server_stream& stream) { answer(stream); },
+    });
+    SessionPool pool(localPool(server));
+
+    http_request first{http::verb::get, "/v2/clock", 11};
+    http_response res;
+    CPPUNIT_ASSERT_EQUAL(200u, pool.send(first, res));
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+
+    http_request second{http::verb::get, "/v2/clock", 11};
+    CPPUNIT_ASSERT_EQUAL(200u, pool.send(second, res));
+    CPPUNIT_ASSERT_EQUAL(uint64_t(2), pool.stats().connects);
+}
+
+void TestSessionPool::testUnresponsivePeerTimesOut() {
+    TlsServer server({
+        [](server_stream& stream) {
+            boost::beast::flat_buffer buffer;
+            http::request<http::string_body> req;
+            http::read(stream, buffer, req);
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+        },
+    });
+    SessionPoolConfig config = localPool(server);
+    config.ioTimeout = std::chrono::milliseconds(100);
+    SessionPool pool(config);
+
+    http_request req{http::verb::get, "/v2/clock", 11};
+    http_response res;
+    const auto started = std::chrono::steady_clock::now();
+    CPPUNIT_ASSERT_THROW(pool.send(req, res), boost::system::system_error);
+    CPPUNIT_ASSERT(std::chrono::steady_clock::now() - started < std::chrono::milliseconds(900));
+}
+
+void TestSessionPool::testExhaustedPoolTimesOut() {
+    TlsServer server({
+        [](server_stream&) { std::this_thread::sleep_for(std::chrono::milliseconds(500)); },
+    });
+    SessionPoolConfig config = localPool(server);
+    config.maxSessions = 1;
+    config.ioTimeout = std::chrono::milliseconds(100);
+    SessionPool pool(config);
+
+    // The only session stays leased, so the second caller gives up.
+    SessionPool::Lease held = pool.acquire();
+    const auto started = std::chrono::steady_clock::now();
+    CPPUNIT_ASSERT_THROW(pool.acquire(), boost::system::system_error);
+    const auto waited = std::chrono::steady_clock::now() - started;
+    CPPUNIT_ASSERT(waited >= std::chrono::milliseconds(100));
+    CPPUNIT_ASSERT(waited < std::chrono::milliseconds(400));
+}
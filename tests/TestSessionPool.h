@@ -0,0 +1,21 @@
+#ifndef TESTSESSIONPOOL_H
+#define TESTSESSIONPOOL_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "session_pool.h"
+
+class TestSessionPool : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestSessionPool);
+    CPPUNIT_TEST(testStaleSessionIsRetried);
+    CPPUNIT_TEST(testUnresponsivePeerTimesOut);
+    CPPUNIT_TEST(testExhaustedPoolTimesOut);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testStaleSessionIsRetried();
+    void testUnresponsivePeerTimesOut();
+    void testExhaustedPoolTimesOut();
+};
+
+#endif
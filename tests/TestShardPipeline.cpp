@@ -0,0 +1,122 @@
+#include "TestShardPipeline.h"
+#include <cppunit/TestAssert.h>
+#include <unordered_map>
+
+namespace {
+    struct RecordingShard {
+        explicit RecordingShard(size_t index) : index(index) {}
+
+        void onBatch(const CompactBar* bars, size_t count) {
+            for (size_t i = 0; i < count; ++i) {
+                int64_t& last = lastTimestamp[bars[i].symbolId];
+                if (bars[i].timestampNs <= last) outOfOrder = true;
+                last = bars[i].timestampNs;
+                ++seen[bars[i].symbolId];
+            }
+        }
+
+        void moveSymbol(uint32_t symbolId, RecordingShard& to) {
+            to.lastTimestamp[symbolId] = lastTimestamp[symbolId];
+            to.seen[symbolId] = seen[symbolId];
+            lastTimestamp.erase(symbolId);
+            seen.erase(symbolId);
+        }
+
+        size_t index;
+        bool outOfOrder = false;
+        std::unordered_map<uint32_t, int64_t> lastTimestamp;
+        std::unordered_map<uint32_t, uint64_t> seen;
+    };
+
+    CompactBar makeBar(uint32_t symbolId, int64_t timestampNs) {
+        CompactBar bar{};
+        bar.symbolId = symbolId;
+        bar.timestampNs = timestampNs;
+        return bar;
+    }
+}
+
+void TestShardPipeline::testSymbolsStayOnOneShardInOrder() {
+    ShardPipelineConfig config;
+    config.shards = 3;
+    config.ringCapacity = 64;
+    ShardPipeline<RecordingShard> pipeline(config, [](size_t i) { return std::make_unique<RecordingShard>(i); });
+    pipeline.start();
+
+    const uint32_t symbols = 16;
+    const int64_t barsPerSymbol = 2000;
+    for (int64_t t = 1; t <= barsPerSymbol; ++t) {
+        for (uint32_t id = 0; id < symbols; ++id) {
+            pipeline.publish(makeBar(id, t));
+        }
+    }
+    pipeline.quiesce();
+
+    for (size_t s = 0; s < pipeline.shardCount(); ++s) {
+        RecordingShard& shard = pipeline.shard(s);
+        CPPUNIT_ASSERT_MESSAGE("Bars of a symbol must arrive in order", !shard.outOfOrder);
+        for (auto& entry : shard.seen) {
+            CPPUNIT_ASSERT_EQUAL(s, pipeline.shardOf(entry.first));
+            CPPUNIT_ASSERT_EQUAL(uint64_t(barsPerSymbol), entry.second);
+        }
+    }
+    pipeline.stop();
+}
+
+void TestShardPipeline::testRebalanceMovesSymbolState() {
+    ShardPipelineConfig config;
+    config.shards = 2;
+    ShardPipeline<RecordingShard> pipeline(config, [](size_t i) { return std::make_unique<RecordingShard>(i); });
+    pipeline.start();
+
+    // Symbols 0, 2, 4 and 6 all start on shard 0.
+    std::vector<uint32_t> ids = {0, 2, 4, 6};
+    for (uint32_t id : ids) {
+        pipeline.publish(makeBar(id, 1));
+    }
+
+    pipeline.rebalance(ids, {10, 1, 1, 10});
+    CPPUNIT_ASSERT(pipeline.shardOf(0) != pipeline.shardOf(6));
+    CPPUNIT_ASSERT(pipeline.shardOf(2) != pipeline.shardOf(4));
+
+    for (uint32_t id : ids) {
+        pipeline.publish(makeBar(id, 2));
+    }
+    pipeline.quiesce();
+
+    for (uint32_t id : ids) {
+        RecordingShard& owner = pipeline.shard(pipeline.shardOf(id));
+        CPPUNIT_ASSERT_EQUAL(uint64_t(2), owner.seen[id]);
+        CPPUNIT_ASSERT_EQUAL(int64_t(2), owner.lastTimestamp[id]);
+    }
+    CPPUNIT_ASSERT(!pipeline.shard(0).outOfOrder && !pipeline.shard(1).outOfOrder);
+}
+
+void TestShardPipeline::testBatchPublishKeepsOrder() {
+    ShardPipelineConfig config;
+    config.shards = 3;
+    // Smaller than a frame, so a quiet push has to wake a shard to get space.
+    config.ringCapacity = 8;
+    ShardPipeline<RecordingShard> pipeline(config, [](size_t i) { return std::make_unique<RecordingShard>(i); });
+    pipeline.start();
+
+    const uint32_t symbols = 16;
+    const int64_t frames = 500;
+    CompactBar frame[symbols];
+    for (int64_t t = 1; t <= frames; ++t) {
+        for (uint32_t id = 0; id < symbols; ++id) frame[id] = makeBar(id, t);
+        CPPUNIT_ASSERT_EQUAL(size_t(symbols), pipeline.publish(frame, symbols));
+    }
+    pipeline.quiesce();
+
+    for (size_t s = 0; s < pipeline.shardCount(); ++s) {
+        RecordingShard& shard = pipeline.shard(s);
+        CPPUNIT_ASSERT(!shard.outOfOrder);
+        for (auto& entry : shard.seen) {
+            CPPUNIT_ASSERT_EQUAL(uint64_t(frames), entry.second);
+        }
+    }
+    pipeline.stop();
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestShardPipeline);
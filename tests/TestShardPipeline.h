@@ -0,0 +1,21 @@
+#ifndef TESTSHARDPIPELINE_H
+#define TESTSHARDPIPELINE_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "shard_pipeline.h"
+
+class TestShardPipeline : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestShardPipeline);
+    CPPUNIT_TEST(testSymbolsStayOnOneShardInOrder);
+    CPPUNIT_TEST(testRebalanceMovesSymbolState);
+    CPPUNIT_TEST(testBatchPublishKeepsOrder);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testSymbolsStayOnOneShardInOrder();
+    void testRebalanceMovesSymbolState();
+    void testBatchPublishKeepsOrder();
+};
+
+#endif
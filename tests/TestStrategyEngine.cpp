@@ -0,0 +1,231 @@
+#include "TestStrategyEngine.h"
+#include <cppunit/TestAssert.h>
+
+namespace {
+    CompactBar makeBar(uint32_t symbolId, int64_t close) {
+        CompactBar bar{};
+        bar.symbolId = symbolId;
+        bar.open = bar.high = bar.low = bar.close = close;
+        return bar;
+    }
+
+    // Counts every callback and sells on each trade.
+    class CountingStrategy : public Strategy<CountingStrategy> {
+    public:
+        void onBar(const CompactBar&, IntentBuffer&) { ++bars; }
+        void onQuote(const QuoteRecord&, IntentBuffer&) { ++quotes; }
+
+        void onTrade(const TradeRecord& trade, IntentBuffer& out) {
+            ++trades;
+            OrderIntent intent{};
+            intent.symbolId = trade.symbolId;
+            intent.side = OrderSide::Sell;
+            intent.type = OrderType::Limit;
+            intent.quantity = trade.size;
+            intent.limitPrice = trade.price;
+            emit(out, intent);
+        }
+
+        void onBook(const OrderBook& book, IntentBuffer&) {
+            ++books;
+            lastSpread = book.spread();
+        }
+
+        int bars = 0;
+        int trades = 0;
+        int quotes = 0;
+        int books = 0;
+        int64_t lastSpread = 0;
+    };
+
+    // Takes whole batches; buys the symbol with the highest close in each.
+    class BatchStrategy : public Strategy<BatchStrategy> {
+    public:
+        void onBar(const CompactBar&, IntentBuffer&) { ++perEventCalls; }
+
+        void onBatch(EventSpan events, const OrderBookSet& books, IntentBuffer& out) {
+            ++batches;
+            eventsSeen += events.size();
+            const CompactBar* best = nullptr;
+            for (const MarketEvent& event : events) {
+                if (event.type == EventType::Bar && (!best || event.bar.close > best->close)) best = &event.bar;
+                if (event.type == EventType::BookLevel) {
+                    if (const OrderBook* book = books.find(event.level.symbolId)) lastSpread = book->spread();
+                }
+            }
+            if (!best) return;
+            OrderIntent intent{};
+            intent.symbolId = best->symbolId;
+            intent.side = OrderSide::Buy;
+            intent.type = OrderType::Market;
+            intent.quantity = 1;
+            emit(out, intent);
+        }
+
+        int batches = 0;
+        size_t eventsSeen = 0;
+        int perEventCalls = 0;
+        int64_t lastSpread = 0;
+    };
+}
+
+void TestStrategyEngine::testSmaCrossoverSignals() {
+    SymbolTable& table = SymbolTable::get_instance();
+    uint32_t id = table.intern("SMA/USD");
+    table.setScale(id, 2, 4);
+
+    SmaCrossover<2, 4> sma(0.5);
+    IntentBuffer out;
+
+    // Falling prices establish the bearish regime without signalling.
+    for (int64_t close : {1000, 900, 800, 700, 600}) {
+        sma.onBar(makeBar(id, close), out);
+    }
+    CPPUNIT_ASSERT(out.empty());
+    CPPUNIT_ASSERT(sma.fastAverage(id) < sma.slowAverage(id));
+
+    // A rally pulls the fast average above the slow one: one buy.
+    for (int64_t close : {900, 1200}) {
+        sma.onBar(makeBar(id, close), out);
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(1), out.size());
+    CPPUNIT_ASSERT(out[0].side == OrderSide::Buy);
+    CPPUNIT_ASSERT(out[0].type == OrderType::Market);
+    CPPUNIT_ASSERT_EQUAL(id, out[0].symbolId);
+    CPPUNIT_ASSERT_EQUAL(int64_t(5000), out[0].quantity);
+
+    // And a sell-off crosses it back under.
+    for (int64_t close : {500, 300}) {
+        sma.onBar(makeBar(id, close), out);
+    }
+    CPPUNIT_ASSERT_EQUAL(size_t(2), out.size());
+    CPPUNIT_ASSERT(out[1].side == OrderSide::Sell);
+}
+
+void TestStrategyEngine::testStrategiesRunSideBySide() {
+    StrategyEngine<CountingStrategy, SmaCrossover<2, 4>, CountingStrategy> engine;
+    IntentBuffer out;
+
+    engine.onBar(makeBar(1, 100), out);
+    engine.onQuote(QuoteRecord{}, out);
+
+    TradeRecord trade{};
+    trade.symbolId = 1;
+    trade.price = 12345;
+    trade.size = 10;
+    engine.onTrade(trade, out);
+
+    CPPUNIT_ASSERT_EQUAL(1, engine.get<0>().bars);
+    CPPUNIT_ASSERT_EQUAL(1, engine.get<2>().bars);
+    CPPUNIT_ASSERT_EQUAL(1, engine.get<0>().quotes);
+
+    // Both counting strategies reacted, each tagged with its slot.
+    CPPUNIT_ASSERT_EQUAL(size_t(2), out.size());
+    CPPUNIT_ASSERT_EQUAL(uint16_t(0), out[0].strategyId);
+    CPPUNIT_ASSERT_EQUAL(uint16_t(2), out[1].strategyId);
+    CPPUNIT_ASSERT_EQUAL(int64_t(12345), out[1].limitPrice);
+}
+
+void TestStrategyEngine::testIntentBufferIsBounded() {
+    IntentBuffer out(2);
+    OrderIntent intent{};
+
+    CPPUNIT_ASSERT(out.push(intent));
+    CPPUNIT_ASSERT(out.push(intent));
+    CPPUNIT_ASSERT(!out.push(intent));
+    CPPUNIT_ASSERT_EQUAL(size_t(2), out.size());
+    CPPUNIT_ASSERT_EQUAL(uint64_t(1), out.drops());
+
+    out.clear();
+    CPPUNIT_ASSERT(out.empty());
+    CPPUNIT_ASSERT_EQUAL(size_t(2), out.capacity());
+}
+
+void TestStrategyEngine::testRunnerMovesSymbolState() {
+    typedef StrategyEngine<SmaCrossover<2, 4>> Engine;
+    std::unique_ptr<StrategyRunner> from = makeStrategyRunner(Engine());
+    std::unique_ptr<StrategyRunner> to = makeStrategyRunner(Engine());
+    IntentBuffer out;
+
+    const CompactBar warmup[] = {makeBar(3, 1000), makeBar(3, 900), makeBar(3, 800), makeBar(3, 700)};
+    from->onBars(warmup, 4, out);
+    from->moveSymbol(3, *to);
+
+    // The destination continues from the moved window and signals the cross.
+    const CompactBar rally[] = {makeBar(3, 900), makeBar(3, 1200)};
+    to->onBars(rally, 2, out);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), out.size());
+    CPPUNIT_ASSERT(out[0].side == OrderSide::Buy);
+
+    auto& source = static_cast<EngineRunner<Engine>&>(*from).engine.get<0>();
+    CPPUNIT_ASSERT_EQUAL(int64_t(0), source.slowAverage(3));
+}
+
+void TestStrategyEngine::testEventsDriveBookCallbacks() {
+    StrategyEngine<CountingStrategy> engine;
+    OrderBookSet books;
+    IntentBuffer out;
+
+    const MarketEvent events[] = {
+        MarketEvent::of(makeBar(4, 100)),
+        MarketEvent::of(BookLevelUpdate{4, 'b', BookLevelUpdate::BOOK_RESET, 0, 99, 1}),
+        MarketEvent::of(BookLevelUpdate{4, 'a', BookLevelUpdate::BOOK_END, 0, 102, 1}),
+        MarketEvent::of(QuoteRecord{4, 0, 99, 1, 102, 1}),
+        MarketEvent::of(BookLevelUpdate{4, 'a', BookLevelUpdate::BOOK_END, 0, 101, 1}),
+    };
+    engine.onEvents(events, 5, books, out);
+
+    CountingStrategy& counting = engine.get<0>();
+    CPPUNIT_ASSERT_EQUAL(1, counting.bars);
+    CPPUNIT_ASSERT_EQUAL(1, counting.quotes);
+    // One callback per completed book message, each seeing its own state.
+    CPPUNIT_ASSERT_EQUAL(2, counting.books);
+    CPPUNIT_ASSERT_EQUAL(int64_t(2), counting.lastSpread);
+}
+
+void TestStrategyEngine::testBatchStrategiesGetWholeBatches() {
+    static_assert(handlesBatches<BatchStrategy>, "BatchStrategy hides onBatch");
+    static_assert(!handlesBatches<CountingStrategy>, "CountingStrategy takes events one by one");
+
+    StrategyEngine<CountingStrategy, BatchStrategy> engine;
+    OrderBookSet books;
+    IntentBuffer out;
+
+    const MarketEvent events[] = {
+        MarketEvent::of(makeBar(5, 100)),
+        MarketEvent::of(makeBar(6, 300)),
+        MarketEvent::of(BookLevelUpdate{5, 'b', BookLevelUpdate::BOOK_RESET, 0, 99, 1}),
+        MarketEvent::of(BookLevelUpdate{5, 'a', BookLevelUpdate::BOOK_END, 0, 103, 1}),
+        MarketEvent::of(makeBar(7, 200)),
+    };
+    engine.onEvents(events, 5, books, out);
+
+    // The per-event strategy is unaffected by its neighbour.
+    CPPUNIT_ASSERT_EQUAL(3, engine.get<0>().bars);
+    CPPUNIT_ASSERT_EQUAL(1, engine.get<0>().books);
+
+    BatchStrategy& batch = engine.get<1>();
+    CPPUNIT_ASSERT_EQUAL(1, batch.batches);
+    CPPUNIT_ASSERT_EQUAL(size_t(5), batch.eventsSeen);
+    CPPUNIT_ASSERT_EQUAL(0, batch.perEventCalls);
+    CPPUNIT_ASSERT_EQUAL(int64_t(4), batch.lastSpread);
+    CPPUNIT_ASSERT_EQUAL(size_t(1), out.size());
+    CPPUNIT_ASSERT_EQUAL(uint32_t(6), out[0].symbolId);
+    CPPUNIT_ASSERT_EQUAL(uint16_t(1), out[0].strategyId);
+
+    // Single events reach it as batches of one.
+    out.clear();
+    engine.onBar(makeBar(8, 50), out);
+    CPPUNIT_ASSERT_EQUAL(2, batch.batches);
+    CPPUNIT_ASSERT_EQUAL(4, engine.get<0>().bars);
+    CPPUNIT_ASSERT_EQUAL(uint32_t(8), out[0].symbolId);
+
+    // Book levels are still applied when only batch strategies run.
+    StrategyEngine<BatchStrategy> batchOnly;
+    OrderBookSet batchBooks;
+    batchOnly.onEvents(events, 5, batchBooks, out);
+    CPPUNIT_ASSERT(batchBooks.find(5) != nullptr);
+    CPPUNIT_ASSERT_EQUAL(int64_t(4), batchOnly.get<0>().lastSpread);
+}
+
+CPPUNIT_TEST_SUITE_REGISTRATION(TestStrategyEngine);
@@ -0,0 +1,28 @@
+#ifndef TESTSTRATEGYENGINE_H
+#define TESTSTRATEGYENGINE_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "sma_crossover.h"
+#include "strategy.h"
+
+class TestStrategyEngine : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestStrategyEngine);
+    CPPUNIT_TEST(testSmaCrossoverSignals);
+    CPPUNIT_TEST(testStrategiesRunSideBySide);
+    CPPUNIT_TEST(testIntentBufferIsBounded);
+    CPPUNIT_TEST(testRunnerMovesSymbolState);
+    CPPUNIT_TEST(testEventsDriveBookCallbacks);
+    CPPUNIT_TEST(testBatchStrategiesGetWholeBatches);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testSmaCrossoverSignals();
+    void testStrategiesRunSideBySide();
+    void testIntentBufferIsBounded();
+    void testRunnerMovesSymbolState();
+    void testEventsDriveBookCallbacks();
+    void testBatchStrategiesGetWholeBatches();
+};
+
+#endif
@@ -0,0 +1,108 @@
+#include "TestSymbolRegistry.h"
+#include <cppunit/TestAssert.h>
+
+#include <cstdio>
+#include <fstream>
+
+#include "order_encoder.h"
+
+void TestSymbolRegistry::testOrderSymbols() {
+    SymbolTable& table = SymbolTable::get_instance();
+    // The slash is not always at index 3.
+    const uint32_t doge = table.intern("SRDOGE/USD");
+    const uint32_t stock = table.intern("SRAAPL");
+    CPPUNIT_ASSERT(table.orderSymbol(doge) == "SRDOGEUSD");
+    CPPUNIT_ASSERT(table.orderSymbol(stock) == "SRAAPL");
+    CPPUNIT_ASSERT(table.orderSymbol(SymbolTable::INVALID_ID).empty());
+
+    OrderIntent intent{};
+    intent.symbolId = doge;
+    intent.side = OrderSide::Buy;
+    intent.type = OrderType::Market;
+    intent.timeInForce = TimeInForce::Gtc;
+    intent.quantity = 100000000;
+    CPPUNIT_ASSERT_EQUAL(string("SRDOGEUSD"), makeOrder(intent).symbol);
+}
+
+void TestSymbolRegistry::testLookupsFromPayloadBytes() {
+    SymbolTable& table = SymbolTable::get_instance();
+    vector<uint32_t> ids;
+    char name[16];
+    for (int i = 0; i < 500; ++i) {
+        std::snprintf(name, sizeof(name), "SRL%03d/USD", i);
+        ids.push_back(table.intern(name));
+    }
+    // A name inside a larger frame, looked up without copying it out.
+    const std::string frame = "[{\"T\":\"b\",\"S\":\"SRL123/USD\",\"o\":1}]";
+    CPPUNIT_ASSERT_EQUAL(ids[123], table.find(std::string_view(frame).substr(15, 10)));
+    for (int i = 0; i < 500; ++i) {
+        std::snprintf(name, sizeof(name), "SRL%03d/USD", i);
+        CPPUNIT_ASSERT_EQUAL(ids[i], table.find(name));
+        CPPUNIT_ASSERT_EQUAL(ids[i], table.intern(name));
+    }
+    CPPUNIT_ASSERT_EQUAL(SymbolTable::INVALID_ID, table.find("SRL500/USD"));
+}
+
+void TestSymbolRegistry::testAssetsSetScalesAndRules() {
+    SymbolTable& table = SymbolTable::get_instance();
+    const string assets = R"([
+        {"symbol":"SRBTC/USD","class":"crypto","min_order_size":"0.0001","min_trade_increment":"0.000000001",
+         "price_increment":"1"},
+        {"symbol":"SRETHUSD","class":"crypto","min_order_size":0.001,"min_trade_increment":1e-09,
+         "price_increment":0.1,"min_notional":"10"},
+        {"symbol":"SRNOTWANTED","class":"us_equity"},
+        {"symbol":"SRBAD/USD","class":"crypto","min_trade_increment":"1e-x","price_increment":"0.01"}
+    ])";
+    const size_t found =
+        applyAssets(table, assets, {"SRBTC/USD", "SRETH/USD", "SRMISSING/USD", "SRBAD/USD"}, 1.0);
+    CPPUNIT_ASSERT_EQUAL(size_t(2), found);
+
+    const uint32_t btc = table.find("SRBTC/USD");
+    // Widened to hold the 1e-9 lot; prices keep their finer default.
+    CPPUNIT_ASSERT_EQUAL(SymbolTable::DEFAULT_PRICE_DECIMALS, table.priceDecimals(btc));
+    CPPUNIT_ASSERT_EQUAL(uint8_t(9), table.sizeDecimals(btc));
+    const SymbolInfo& btcInfo = table.info(btc);
+    CPPUNIT_ASSERT_EQUAL(int64_t(100000000), btcInfo.tickSize);
+    CPPUNIT_ASSERT_EQUAL(int64_t(1), btcInfo.lotSize);
+    CPPUNIT_ASSERT_EQUAL(int64_t(100000), btcInfo.minQuantity);
+    CPPUNIT_ASSERT_EQUAL(int64_t(100000000), btcInfo.minNotional);
+
+    // Matched without the slash, from numeric fields.
+    const uint32_t eth = table.find("SRETH/USD");
+    const SymbolInfo& ethInfo = table.info(eth);
+    CPPUNIT_ASSERT_EQUAL(int64_t(10000000), ethInfo.tickSize);
+    CPPUNIT_ASSERT_EQUAL(int64_t(1000000), ethInfo.minQuantity);
+    CPPUNIT_ASSERT_EQUAL(int64_t(1000000000), ethInfo.minNotional);
+
+    const uint32_t missing = table.find("SRMISSING/USD");
+    CPPUNIT_ASSERT(missing != SymbolTable::INVALID_ID);
+    CPPUNIT_ASSERT_EQUAL(int64_t(0), table.info(missing).tickSize);
+
+    // Unparseable increments leave the symbol at its defaults.
+    const uint32_t bad = table.find("SRBAD/USD");
+    CPPUNIT_ASSERT_EQUAL(SymbolTable::DEFAULT_SIZE_DECIMALS, table.sizeDecimals(bad));
+    CPPUNIT_ASSERT_EQUAL(int64_t(0), table.info(bad).tickSize);
+
+    CPPUNIT_ASSERT_THROW(applyAssets(table, "{\"symbol\":\"SRBTC/USD\"}", {"SRBTC/USD"}), std::runtime_error);
+}
+
+void TestSymbolRegistry::testRegistryFromFile() {
+    const string path = "symbol_registry_test.json";
+    {
+        std::ofstream out(path);
+        out << R"([{"symbol":"SRSOL/USD","min_trade_increment":"0.01","price_increment":"0.0025"}])";
+    }
+
+    SymbolRegistryConfig config;
+    config.symbols = {"SRSOL/USD", "SRADA/USD"};
+    config.assetsFile = path;
+    CPPUNIT_ASSERT_EQUAL(size_t(1), loadSymbolRegistry(config, "key", "secret"));
+    std::remove(path.c_str());
+
+    SymbolTable& table = SymbolTable::get_instance();
+    CPPUNIT_ASSERT(table.find("SRADA/USD") != SymbolTable::INVALID_ID);
+    CPPUNIT_ASSERT_EQUAL(int64_t(250000), table.info(table.find("SRSOL/USD")).tickSize);
+
+    config.assetsFile = "does_not_exist.json";
+    CPPUNIT_ASSERT_THROW(loadSymbolRegistry(config, "key", "secret"), std::runtime_error);
+}
@@ -0,0 +1,23 @@
+#ifndef TESTSYMBOLREGISTRY_H
+#define TESTSYMBOLREGISTRY_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "symbol_registry.h"
+
+class TestSymbolRegistry : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestSymbolRegistry);
+    CPPUNIT_TEST(testOrderSymbols);
+    CPPUNIT_TEST(testLookupsFromPayloadBytes);
+    CPPUNIT_TEST(testAssetsSetScalesAndRules);
+    CPPUNIT_TEST(testRegistryFromFile);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testOrderSymbols();
+    void testLookupsFromPayloadBytes();
+    void testAssetsSetScalesAndRules();
+    void testRegistryFromFile();
+};
+
+#endif
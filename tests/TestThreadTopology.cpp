@@ -0,0 +1,53 @@
+#include "TestThreadTopology.h"
+#include <cppunit/TestAssert.h>
+#include <stdexcept>
+#include <thread>
+
+void TestThreadTopology::testParseRoles() {
+    const ThreadTopology topology =
+        ThreadTopology::parse("feeds=2:fifo=80;shards=4-6,9:fifo=70;gateway=3;logger=0;housekeeping=0-1;numa");
+
+    CPPUNIT_ASSERT_EQUAL(size_t(1), topology.feeds.size());
+    CPPUNIT_ASSERT_EQUAL(80, topology.feed(0).fifoPriority);
+    CPPUNIT_ASSERT(topology.feed(1).empty());
+
+    // One CPU per shard, in order.
+    CPPUNIT_ASSERT_EQUAL(size_t(4), topology.shards.size());
+    CPPUNIT_ASSERT(topology.shard(0).cpus == std::vector<int>({4}));
+    CPPUNIT_ASSERT(topology.shard(3).cpus == std::vector<int>({9}));
+    CPPUNIT_ASSERT_EQUAL(70, topology.shard(3).fifoPriority);
+
+    // Single-thread roles may use the whole list.
+    CPPUNIT_ASSERT(topology.housekeeping.cpus == std::vector<int>({0, 1}));
+    CPPUNIT_ASSERT_EQUAL(0, topology.orderGateway.fifoPriority);
+    CPPUNIT_ASSERT(topology.merger.cpus.empty());
+    CPPUNIT_ASSERT(topology.merger.numaLocal);
+    CPPUNIT_ASSERT(topology.shard(2).numaLocal);
+
+    const ThreadTopology none = ThreadTopology::parse("");
+    CPPUNIT_ASSERT(none.feeds.empty() && none.shards.empty() && none.logger.empty());
+}
+
+void TestThreadTopology::testParseRejectsBadSpecs() {
+    CPPUNIT_ASSERT_THROW(ThreadTopology::parse("decoder=1"), std::invalid_argument);
+    CPPUNIT_ASSERT_THROW(ThreadTopology::parse("feeds"), std::invalid_argument);
+    CPPUNIT_ASSERT_THROW(ThreadTopology::parse("feeds=x"), std::invalid_argument);
+    CPPUNIT_ASSERT_THROW(ThreadTopology::parse("shards=7-4"), std::invalid_argument);
+    CPPUNIT_ASSERT_THROW(ThreadTopology::parse("gateway=3:fifo=100"), std::invalid_argument);
+    CPPUNIT_ASSERT_THROW(ThreadTopology::parse("gateway=3:rr=10"), std::invalid_argument);
+}
+
+void TestThreadTopology::testPlacementIsReported() {
+    bool placed = false;
+    // Nothing requested always succeeds, even without privileges.
+    std::thread worker([&placed]() { placed = placeThisThread("topology-test", ThreadPlacement()); });
+    worker.join();
+    CPPUNIT_ASSERT(placed);
+
+    const std::string report = threadReport();
+    const size_t line = report.find("topology-test (tid ");
+    CPPUNIT_ASSERT(line != std::string::npos);
+    const std::string entry = report.substr(line, report.find('\n', line) - line);
+    CPPUNIT_ASSERT(entry.find("cpus any") != std::string::npos);
+    CPPUNIT_ASSERT(entry.find("failed") == std::string::npos);
+}
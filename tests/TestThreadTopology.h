@@ -0,0 +1,21 @@
+#ifndef TESTTHREADTOPOLOGY_H
+#define TESTTHREADTOPOLOGY_H
+
+#include <cppunit/TestFixture.h>
+#include <cppunit/extensions/HelperMacros.h>
+#include "thread_util.h"
+
+class TestThreadTopology : public CppUnit::TestFixture {
+    CPPUNIT_TEST_SUITE(TestThreadTopology);
+    CPPUNIT_TEST(testParseRoles);
+    CPPUNIT_TEST(testParseRejectsBadSpecs);
+    CPPUNIT_TEST(testPlacementIsReported);
+    CPPUNIT_TEST_SUITE_END();
+
+public:
+    void testParseRoles();
+    void testParseRejectsBadSpecs();
+    void testPlacementIsReported();
+};
+
+#endif
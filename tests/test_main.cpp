@@ -1,12 +1,60 @@
 #include <cppunit/ui/text/TestRunner.h>
 #include "TestAuthenticate.h"
+#include "TestBacktest.h"
+#include "TestBarStore.h"
+#include "TestCompactBar.h"
 #include "TestConnect.h"
+#include "TestFeedDecoder.h"
+#include "TestFeedSession.h"
+#include "TestIndicators.h"
+#include "TestJournal.h"
+#include "TestLatency.h"
+#include "TestLogger.h"
+#include "TestMarketFeed.h"
+#include "TestMatchingEngine.h"
+#include "TestMemoryPool.h"
+#include "TestOrderBatcher.h"
+#include "TestOrderBook.h"
+#include "TestOrderEncoder.h"
+#include "TestOrderGateway.h"
+#include "TestOrderManager.h"
+#include "TestRingBuffer.h"
+#include "TestRisk.h"
+#include "TestSessionPool.h"
+#include "TestShardPipeline.h"
+#include "TestStrategyEngine.h"
+#include "TestSymbolRegistry.h"
+#include "TestThreadTopology.h"
 
 int main(int argc, char* argv[]) {
     CppUnit::TextUi::TestRunner runner;
 
     runner.addTest(TestAuthenticate::suite());
+    runner.addTest(TestBacktest::suite());
+    runner.addTest(TestBarStore::suite());
     runner.addTest(TestConnect::suite());
+    runner.addTest(TestCompactBar::suite());
+    runner.addTest(TestFeedDecoder::suite());
+    runner.addTest(TestFeedSession::suite());
+    runner.addTest(TestIndicators::suite());
+    runner.addTest(TestJournal::suite());
+    runner.addTest(TestLatency::suite());
+    runner.addTest(TestLogger::suite());
+    runner.addTest(TestMarketFeed::suite());
+    runner.addTest(TestMatchingEngine::suite());
+    runner.addTest(TestMemoryPool::suite());
+    runner.addTest(TestOrderBatcher::suite());
+    runner.addTest(TestOrderBook::suite());
+    runner.addTest(TestOrderEncoder::suite());
+    runner.addTest(TestOrderGateway::suite());
+    runner.addTest(TestOrderManager::suite());
+    runner.addTest(TestRingBuffer::suite());
+    runner.addTest(TestRisk::suite());
+    runner.addTest(TestSessionPool::suite());
+    runner.addTest(TestShardPipeline::suite());
+    runner.addTest(TestStrategyEngine::suite());
+    runner.addTest(TestSymbolRegistry::suite());
+    runner.addTest(TestThreadTopology::suite());
 
     bool wasSuccessful = runner.run("", false);
     return wasSuccessful ? 0 : 1;
@@ -0,0 +1,200 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "backtest.h"
+#include "bar_store.h"
+#include "sma_crossover.h"
+#include "symbol_table.h"
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+namespace {
+    void usage(const char* program) {
+        cerr << "Usage: " << program << " SOURCE... [options]\n"
+             << "Sources (any number):\n"
+             << "  --csv FILE[:SYMBOL]   timestamp,open,high,low,close,volume[,trades[,vwap]] rows\n"
+             << "  --store ROOT          bars recorded by BAR_STORE, with --symbols and --days\n"
+             << "  --synthetic N         N random-walk minute bars per symbol in --symbols\n"
+             << "Options:\n"
+             << "  --symbols A,B         symbols for --store and --synthetic (default: SIM/USD)\n"
+             << "  --days N              days back from now to load from --store (default: 30)\n"
+             << "  --sweep               run the whole SMA parameter grid, not just 10/30\n"
+             << "  --qty X               order quantity in asset units (default: 1)\n"
+             << "  --threads N           worker threads (default: all cores)\n"
+             << "  --delay-bars N        bars between a signal and its fill (default: 1)\n"
+             << "  --slippage-bps X      market order slippage (default: 1)\n"
+             << "  --fee-bps X           fee on notional (default: 2.5)\n"
+             << "  --fills               print every fill" << endl;
+    }
+
+    struct StrategySpec {
+        string name;
+        StrategyFactory factory;
+    };
+
+    template <size_t Fast, size_t Slow>
+    StrategySpec sma(double qty) {
+        return StrategySpec{"sma " + std::to_string(Fast) + "/" + std::to_string(Slow), [qty]() {
+            return makeStrategyRunner(StrategyEngine<SmaCrossover<Fast, Slow>>(SmaCrossover<Fast, Slow>(qty)));
+        }};
+    }
+
+    // The windows are template parameters, so the grid is fixed at compile time.
+    std::vector<StrategySpec> sweep(double qty) {
+        return {sma<5, 30>(qty),  sma<5, 60>(qty),  sma<5, 120>(qty),
+                sma<10, 30>(qty), sma<10, 60>(qty), sma<10, 120>(qty),
+                sma<20, 30>(qty), sma<20, 60>(qty), sma<20, 120>(qty)};
+    }
+
+    std::vector<string> split(const string& text) {
+        std::vector<string> parts;
+        size_t start = 0;
+        while (start <= text.size()) {
+            size_t comma = text.find(',', start);
+            if (comma == string::npos) comma = text.size();
+            if (comma > start) parts.push_back(text.substr(start, comma - start));
+            start = comma + 1;
+        }
+        return parts;
+    }
+
+    void printFill(const BacktestFill& fill) {
+        cout << "  " << fill.timestampNs << " " << SymbolTable::get_instance().name(fill.symbolId) << " "
+             << (fill.side == OrderSide::Buy ? "buy " : "sell ") << fill.quantity << " @ " << fill.price
+             << " fee " << fill.fee << endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    std::vector<string> csvFiles;
+    string storeRoot;
+    size_t synthetic = 0;
+    std::vector<string> symbols{"SIM/USD"};
+    unsigned days = 30;
+    bool fullSweep = false;
+    double qty = 1.0;
+    size_t threads = 0;
+    BacktestConfig config;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (!std::strcmp(arg, "--sweep")) {
+            fullSweep = true;
+            continue;
+        }
+        if (!std::strcmp(arg, "--fills")) {
+            config.recordFills = true;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        if (!std::strcmp(arg, "--csv")) csvFiles.push_back(argv[++i]);
+        else if (!std::strcmp(arg, "--store")) storeRoot = argv[++i];
+        else if (!std::strcmp(arg, "--synthetic")) synthetic = static_cast<size_t>(std::atoll(argv[++i]));
+        else if (!std::strcmp(arg, "--symbols")) symbols = split(argv[++i]);
+        else if (!std::strcmp(arg, "--days")) days = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (!std::strcmp(arg, "--qty")) qty = std::atof(argv[++i]);
+        else if (!std::strcmp(arg, "--threads")) threads = static_cast<size_t>(std::atoi(argv[++i]));
+        else if (!std::strcmp(arg, "--delay-bars")) config.fills.delayBars = static_cast<unsigned>(std::atoi(argv[++i]));
+        else if (!std::strcmp(arg, "--slippage-bps")) config.fills.slippageBps = std::atof(argv[++i]);
+        else if (!std::strcmp(arg, "--fee-bps")) config.fills.feeBps = std::atof(argv[++i]);
+        else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+    if (csvFiles.empty() && storeRoot.empty() && synthetic == 0) {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    try {
+        // One bar series per symbol; each is an independent job per strategy.
+        std::map<string, std::vector<CompactBar>> series;
+        for (const string& spec : csvFiles) {
+            const size_t colon = spec.rfind(':');
+            const string path = colon == string::npos ? spec : spec.substr(0, colon);
+            const string symbol = colon == string::npos ? "CSV/USD" : spec.substr(colon + 1);
+            size_t skipped = 0;
+            size_t loaded = loadCsvBars(path, symbol, series[symbol], &skipped);
+            cout << "Loaded " << loaded << " bars for " << symbol << " from " << path;
+            if (skipped) cout << " (" << skipped << " malformed rows skipped)";
+            cout << endl;
+        }
+        if (!storeRoot.empty()) {
+            const int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::system_clock::now().time_since_epoch()).count();
+            const int64_t from = bar_store::dayStart(now) - static_cast<int64_t>(days) * bar_store::NS_PER_DAY;
+            for (const string& symbol : symbols) {
+                size_t loaded = loadStoredBars(storeRoot, symbol, from, now, series[symbol]);
+                cout << "Loaded " << loaded << " bars for " << symbol << " from " << storeRoot << endl;
+            }
+        }
+        if (synthetic) {
+            uint64_t seed = 1;
+            for (const string& symbol : symbols) {
+                syntheticBars(symbol, synthetic, seed++, series[symbol]);
+            }
+        }
+
+        const std::vector<StrategySpec> strategies = fullSweep ? sweep(qty) : std::vector<StrategySpec>{sma<10, 30>(qty)};
+        std::vector<BacktestJob> jobs;
+        for (const StrategySpec& strategy : strategies) {
+            for (const auto& entry : series) {
+                if (!entry.second.empty()) {
+                    jobs.push_back(BacktestJob{strategy.name, strategy.factory, &entry.second});
+                }
+            }
+        }
+
+        const auto start = std::chrono::steady_clock::now();
+        std::vector<BacktestResult> results = runBacktests(jobs, config, threads);
+        const double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        // Fold the per-symbol runs back into one line per strategy.
+        std::vector<BacktestResult> totals;
+        for (const StrategySpec& strategy : strategies) {
+            BacktestResult total;
+            total.name = strategy.name;
+            for (const BacktestResult& result : results) {
+                if (result.name == strategy.name) total.merge(result);
+            }
+            totals.push_back(std::move(total));
+        }
+
+        uint64_t bars = 0;
+        cout << std::fixed << std::setprecision(2);
+        for (const BacktestResult& total : totals) {
+            bars += total.bars;
+            cout << std::left << std::setw(12) << total.name << std::right
+                 << " net " << std::setw(12) << total.netPnl
+                 << " realized " << std::setw(12) << total.realizedPnl
+                 << " unrealized " << std::setw(10) << total.unrealizedPnl
+                 << " fees " << std::setw(9) << total.fees
+                 << " max dd " << std::setw(10) << total.maxDrawdown
+                 << " fills " << total.fills << "/" << total.intents
+                 << " strategy p50/p99 " << total.strategyLatency.p50Ns << "/" << total.strategyLatency.p99Ns << " ns"
+                 << endl;
+            for (const BacktestFill& fill : total.fillLog) {
+                printFill(fill);
+            }
+        }
+        cout << jobs.size() << " runs, " << bars << " bars in " << wall << " s ("
+             << std::setprecision(0) << (wall > 0 ? bars / wall : 0) << " bars/s)" << endl;
+    } catch (const std::exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,98 @@
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "exchange_simulator.h"
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+namespace {
+    volatile std::sig_atomic_t stopRequested = 0;
+
+    void onSignal(int) {
+        stopRequested = 1;
+    }
+
+    void usage(const char* program) {
+        cerr << "Usage: " << program << " [options]\n"
+             << "  --rest-port N        REST port (default 8443, 0 for ephemeral)\n"
+             << "  --stream-port N      market data WebSocket port (default 8444)\n"
+             << "  --no-tls             serve plain HTTP and ws://\n"
+             << "  --key K --secret S   require these credentials\n"
+             << "  --symbols A,B        symbols to generate (default BTC/USD)\n"
+             << "  --replay FILE        replay recorded frames instead of synthetic data\n"
+             << "  --interval-ms N      tick interval (default 100)\n"
+             << "  --latency-us N       order response latency\n"
+             << "  --jitter-us N        extra uniform order latency\n"
+             << "  --md-latency-us N    market data latency\n"
+             << "  --md-jitter-us N     extra uniform market data latency\n"
+             << "  --seed N             random seed for synthetic data" << endl;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    ExchangeSimulatorConfig config;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        auto value = [&]() -> const char* {
+            if (i + 1 >= argc) {
+                cerr << arg << " needs a value" << endl;
+                std::exit(EXIT_FAILURE);
+            }
+            return argv[++i];
+        };
+
+        if (!std::strcmp(arg, "--rest-port")) config.restPort = static_cast<unsigned short>(std::atoi(value()));
+        else if (!std::strcmp(arg, "--stream-port")) config.streamPort = static_cast<unsigned short>(std::atoi(value()));
+        else if (!std::strcmp(arg, "--no-tls")) config.tls = false;
+        else if (!std::strcmp(arg, "--key")) config.apiKey = value();
+        else if (!std::strcmp(arg, "--secret")) config.apiSecret = value();
+        else if (!std::strcmp(arg, "--replay")) config.replayPath = value();
+        else if (!std::strcmp(arg, "--interval-ms")) config.tickInterval = std::chrono::milliseconds(std::atoi(value()));
+        else if (!std::strcmp(arg, "--latency-us")) config.orderLatency.base = std::chrono::microseconds(std::atoi(value()));
+        else if (!std::strcmp(arg, "--jitter-us")) config.orderLatency.jitter = std::chrono::microseconds(std::atoi(value()));
+        else if (!std::strcmp(arg, "--md-latency-us")) config.marketDataLatency.base = std::chrono::microseconds(std::atoi(value()));
+        else if (!std::strcmp(arg, "--md-jitter-us")) config.marketDataLatency.jitter = std::chrono::microseconds(std::atoi(value()));
+        else if (!std::strcmp(arg, "--seed")) config.seed = static_cast<unsigned>(std::atoi(value()));
+        else if (!std::strcmp(arg, "--symbols")) {
+            config.symbols.clear();
+            std::stringstream list(value());
+            std::string symbol;
+            while (std::getline(list, symbol, ',')) {
+                if (!symbol.empty()) config.symbols.push_back(symbol);
+            }
+        } else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    try {
+        ExchangeSimulator simulator(config);
+        simulator.start();
+
+        while (!stopRequested) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+        }
+
+        simulator.stop();
+        MatchingEngineStats stats = simulator.engineStats();
+        cout << "Orders " << stats.orders << ", fills " << stats.fills << ", cancels " << stats.cancels
+             << ", rejects " << stats.rejects << endl;
+    } catch (const std::exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
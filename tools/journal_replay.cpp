@@ -0,0 +1,93 @@
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+#include "client.h"
+#include "sma_crossover.h"
+
+using std::cout;
+using std::cerr;
+using std::endl;
+
+namespace {
+    void usage(const char* program) {
+        cerr << "Usage: " << program << " JOURNAL [options]\n"
+             << "  --speed X            0 as fast as possible (default), 1 recorded pace, 2 twice as fast\n"
+             << "  --shards N           pipeline shards (default: cores - 1)\n"
+             << "  --execute HOST:PORT  send the resulting orders to an order endpoint\n"
+             << "                       (e.g. tools/exchange_simulator) instead of printing them" << endl;
+    }
+
+    // FNV-1a over the order stream; equal across runs of the same journal.
+    uint64_t fingerprint(const vector<Order>& orders) {
+        uint64_t hash = 1469598103934665603ULL;
+        for (const Order& order : orders) {
+            for (char ch : order.toJSON()) {
+                hash ^= static_cast<unsigned char>(ch);
+                hash *= 1099511628211ULL;
+            }
+        }
+        return hash;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 2 || argv[1][0] == '-') {
+        usage(argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    const std::string path = argv[1];
+    ReplayConfig replayConfig;
+    ShardPipelineConfig pipelineConfig;
+    std::string endpoint;
+
+    for (int i = 2; i < argc; ++i) {
+        const char* arg = argv[i];
+        if (i + 1 >= argc) {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+        if (!std::strcmp(arg, "--speed")) replayConfig.speed = std::atof(argv[++i]);
+        else if (!std::strcmp(arg, "--shards")) pipelineConfig.shards = static_cast<size_t>(std::atoi(argv[++i]));
+        else if (!std::strcmp(arg, "--execute")) endpoint = argv[++i];
+        else {
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    try {
+        WebClient client;
+        client.setMarketDataPipeline(pipelineConfig);
+        client.setStrategyFactory([]() {
+            return makeStrategyRunner(StrategyEngine<SmaCrossover<10, 30>>(SmaCrossover<10, 30>(0.001)));
+        });
+
+        ReplayStats stats = client.replay(path, replayConfig);
+        cout << "Replayed " << stats.frames << " frames (" << stats.bytes << " bytes, "
+             << stats.recordedNs / 1e9 << " s recorded) in " << stats.elapsedNs / 1e9 << " s" << endl;
+
+        if (!endpoint.empty()) {
+            const size_t colon = endpoint.rfind(':');
+            SessionPoolConfig orderEndpoint;
+            orderEndpoint.host = endpoint.substr(0, colon);
+            if (colon != std::string::npos) orderEndpoint.port = endpoint.substr(colon + 1);
+            client.setOrderEndpoint(orderEndpoint);
+            client.executeOrders();
+            return EXIT_SUCCESS;
+        }
+
+        vector<Order> orders = client.takeOrders();
+        for (const Order& order : orders) {
+            cout << order.toJSON() << endl;
+        }
+        cout << orders.size() << " orders, fingerprint " << std::hex << fingerprint(orders) << std::dec << endl;
+    } catch (const std::exception& e) {
+        cerr << "Error: " << e.what() << endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}